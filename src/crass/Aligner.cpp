@@ -32,30 +32,14 @@
  *                               A
  */
 #include <cstdlib>
+#include <algorithm>
+#include <emmintrin.h>
 #include <iostream>
 #include <libcrispr/Exception.h>
 #include "Aligner.h"
 #include "LoggerSimp.h"
 #include "SeqUtils.h"
-
-const unsigned char Aligner::seq_nt4_table[256] = {
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 0, 4, 1, 4, 4, 4, 2, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 0, 4, 1, 4, 4, 4, 2, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4
-    };
+#include "PackedKmer.h"
 
 // will convert any char to an A if it is not C,G,T
 const char Aligner::CHAR_TO_INDEX[128] = {
@@ -79,29 +63,63 @@ void Aligner::setMasterDR(std::string& master) {
     
 }
 
-void Aligner::alignSlave(StringToken& slaveDRToken) {
+void Aligner::alignSlaves(DR_Cluster& slaveDRTokens) {
+    
+    std::vector<int> slave_indexes;
+    std::vector<std::string> slave_drs;
+    for (int i = 0; i < (int)slaveDRTokens.size(); i++) {
+        // we've already done the master DR
+        if (slaveDRTokens[i] == AL_masterDRToken) {
+            continue;
+        }
+        AL_Offsets[slaveDRTokens[i]] = -1;
+        slave_indexes.push_back(i);
+        slave_drs.push_back(mStringCheck->getString(slaveDRTokens[i]));
+    }
     
-    AL_Offsets[slaveDRToken] = -1;
-    std::string slaveDR = mStringCheck->getString(slaveDRToken);
-    AlignerFlag_t flags;
-    int offset = getOffsetAgainstMaster(slaveDR, flags);
+    std::vector<int> offsets;
+    std::vector<AlignerFlag_t> flags;
+    getOffsetsAgainstMaster(slave_drs, offsets, flags);
     
-    if (flags[score_equal]) {
-        std::string extended_slave_dr;
-        extendSlaveDR(slaveDR, extended_slave_dr);
-        flags.reset();
-        offset = getOffsetAgainstMaster(extended_slave_dr, flags);
-        if (flags[score_equal]) {
-            logWarn("@Alignment Warning: Extended Slave scores equal",4);
-            logWarn("Cannot place slave: "<<slaveDR<<" ("<<slaveDRToken<<") in array", 4);
-            logWarn("Original slave: "<<slaveDR, 4);
-            logWarn("Extended Slave: "<<extended_slave_dr, 4);
-            logWarn("Master: "<<mStringCheck->getString(AL_masterDRToken), 4);
-            logWarn("******", 4);
-            flags[failed] = true;
+    // slaves that score the same both ways get another go with a couple
+    // of bases from the reads on either side
+    std::vector<int> equal_indexes;
+    std::vector<std::string> extended_slave_drs;
+    for (int i = 0; i < (int)slave_drs.size(); i++) {
+        if (flags[i][score_equal]) {
+            std::string extended_slave_dr;
+            extendSlaveDR(slave_drs[i], extended_slave_dr);
+            equal_indexes.push_back(i);
+            extended_slave_drs.push_back(extended_slave_dr);
+        }
+    }
+    if (!extended_slave_drs.empty()) {
+        std::vector<int> extended_offsets;
+        std::vector<AlignerFlag_t> extended_flags;
+        getOffsetsAgainstMaster(extended_slave_drs, extended_offsets, extended_flags);
+        for (int k = 0; k < (int)equal_indexes.size(); k++) {
+            int i = equal_indexes[k];
+            offsets[i] = extended_offsets[k];
+            flags[i] = extended_flags[k];
+            if (flags[i][score_equal]) {
+                logWarn("@Alignment Warning: Extended Slave scores equal",4);
+                logWarn("Cannot place slave: "<<slave_drs[i]<<" ("<<slaveDRTokens[slave_indexes[i]]<<") in array", 4);
+                logWarn("Original slave: "<<slave_drs[i], 4);
+                logWarn("Extended Slave: "<<extended_slave_drs[k], 4);
+                logWarn("Master: "<<mStringCheck->getString(AL_masterDRToken), 4);
+                logWarn("******", 4);
+                flags[i][failed] = true;
+            }
         }
     }
     
+    for (int i = 0; i < (int)slave_indexes.size(); i++) {
+        placeSlave(slaveDRTokens[slave_indexes[i]], offsets[i], flags[i]);
+    }
+}
+
+void Aligner::placeSlave(StringToken& slaveDRToken, int offset, AlignerFlag_t& flags) {
+    
     if (flags[failed]) {
         return;
     } 
@@ -109,8 +127,9 @@ void Aligner::alignSlave(StringToken& slaveDRToken) {
     if (flags[reversed] ) {
         // we need to reverse all the reads and the DR for these reads
         try {
-            ReadListIterator read_iter = mReads->at(slaveDRToken)->begin();
-            while (read_iter != mReads->at(slaveDRToken)->end()) 
+            ReadList& slave_reads = (*mReads)[slaveDRToken];
+            ReadListIterator read_iter = slave_reads.begin();
+            while (read_iter != slave_reads.end()) 
             {
                 (*read_iter)->reverseComplementSeq();
                 read_iter++;
@@ -124,16 +143,45 @@ void Aligner::alignSlave(StringToken& slaveDRToken) {
         }
         // fix the places where the DR is stored
         
-        slaveDR = reverseComplement(slaveDR);
-        StringToken st = mStringCheck->addString(slaveDR);
-        (*mReads)[st] = (*mReads)[slaveDRToken];
-        (*mReads)[slaveDRToken] = NULL;
-        slaveDRToken = st;
+        std::string slave_dr = reverseComplement(mStringCheck->getString(slaveDRToken));
+        if (AL_HoldTokens) {
+            AL_HeldSlaves.push_back(std::make_pair(slaveDRToken, slave_dr));
+        } else {
+            StringToken st = mStringCheck->addString(slave_dr);
+            mReads->move(slaveDRToken, st);
+            slaveDRToken = st;
+        }
     }
     AL_Offsets[slaveDRToken] = AL_Offsets[AL_masterDRToken] + offset;
     placeReadsInCoverageArray(slaveDRToken);
 }
 
+void Aligner::releaseSlaveTokens(DR_Cluster& slaveDRTokens) {
+    
+    // the old token is left in the offsets unplaced, the same as when
+    // the token is changed straight away
+    for (size_t i = 0; i < AL_HeldSlaves.size(); i++) {
+        StringToken old_token = AL_HeldSlaves[i].first;
+        StringToken st = mStringCheck->addString(AL_HeldSlaves[i].second);
+        mReads->move(old_token, st);
+        AL_Offsets[st] = AL_Offsets[old_token];
+        AL_Offsets[old_token] = -1;
+        std::replace(slaveDRTokens.begin(), slaveDRTokens.end(), old_token, st);
+    }
+    AL_HeldSlaves.clear();
+    AL_HoldTokens = false;
+}
+
+std::string Aligner::drSequence(StringToken drToken) {
+    
+    for (size_t i = 0; i < AL_HeldSlaves.size(); i++) {
+        if (AL_HeldSlaves[i].first == drToken) {
+            return AL_HeldSlaves[i].second;
+        }
+    }
+    return mStringCheck->getString(drToken);
+}
+
 void Aligner::generateConsensus() {
     
     logInfo("Calculating consensus sequence from aligned reads", 1)
@@ -141,36 +189,59 @@ void Aligner::generateConsensus() {
     logInfo("DR zone: " << AL_ZoneStart << " -> " << AL_ZoneEnd, 1);
 #endif
 
-	// chars we luv!
-    char alphabet[4] = {'A', 'C', 'G', 'T'};
+	// chars we luv! 'N' where there are no reads
+    static const char code_to_base[5] = {'N', 'A', 'C', 'G', 'T'};
 
 	
-	// populate the conservation array
+	//-----
+	// populate the conservation array, there is nothing outside the window.
+	// Four columns at a time: their counts are turned into a vector each
+	// of A, C, G and T. The consensus is the first base with the most
+	// reads and we need more than CRASS_DEF_MIN_READ_DEPTH reads to call it
+	//
     int num_GT_zero = 0;
-    for(int j = 0; j < AL_length; j++)
+    int num_columns = (int)AL_coverage.size() / 4;
+    AL_consensus.assign(num_columns, 'N');
+    AL_conservation.assign(num_columns, 0.0f);
+    __m128i min_depth = _mm_set1_epi32(CRASS_DEF_MIN_READ_DEPTH);
+    for(int j = 0; j < num_columns; j += 4)
 	{
-		int max_count = 0;
-		float total_count = 0.0;
-		for(int i = 0; i < 4; i++)
-		{
-			
-			total_count += static_cast<float>(AL_coverage[coverageIndex(j,alphabet[i])]);
-			if(AL_coverage[coverageIndex(j,alphabet[i])] > max_count)
-			{
-				max_count = AL_coverage[coverageIndex(j,alphabet[i])];
-				AL_consensus[j] = alphabet[i];
-			}
-		}
-		// we need at least CRASS_DEF_MIN_READ_DEPTH reads to call a DR
-		if(total_count > CRASS_DEF_MIN_READ_DEPTH)
-		{
-			AL_conservation[j] = static_cast<float>(max_count)/total_count;
-			num_GT_zero++;
-		}
-		else
-		{
-			AL_conservation[j] = 0;
-		}
+        __m128i a = _mm_loadu_si128((__m128i *)&(AL_coverage[4 * j]));
+        __m128i c = _mm_loadu_si128((__m128i *)&(AL_coverage[4 * j + 4]));
+        __m128i g = _mm_loadu_si128((__m128i *)&(AL_coverage[4 * j + 8]));
+        __m128i t = _mm_loadu_si128((__m128i *)&(AL_coverage[4 * j + 12]));
+        __m128i ac_lo = _mm_unpacklo_epi32(a, c);
+        __m128i gt_lo = _mm_unpacklo_epi32(g, t);
+        __m128i ac_hi = _mm_unpackhi_epi32(a, c);
+        __m128i gt_hi = _mm_unpackhi_epi32(g, t);
+        a = _mm_unpacklo_epi64(ac_lo, gt_lo);
+        c = _mm_unpackhi_epi64(ac_lo, gt_lo);
+        g = _mm_unpacklo_epi64(ac_hi, gt_hi);
+        t = _mm_unpackhi_epi64(ac_hi, gt_hi);
+        
+        // a base only takes over with strictly more reads
+        __m128i max_count = _mm_setzero_si128();
+        __m128i code = _mm_setzero_si128();
+        __m128i counts[4] = {a, c, g, t};
+        for(int i = 0; i < 4; i++)
+        {
+            __m128i more = _mm_cmpgt_epi32(counts[i], max_count);
+            max_count = _mm_or_si128(_mm_and_si128(more, counts[i]), _mm_andnot_si128(more, max_count));
+            code = _mm_or_si128(_mm_and_si128(more, _mm_set1_epi32(i + 1)), _mm_andnot_si128(more, code));
+        }
+        __m128i total_count = _mm_add_epi32(_mm_add_epi32(a, c), _mm_add_epi32(g, t));
+        __m128i deep = _mm_cmpgt_epi32(total_count, min_depth);
+        __m128 conservation = _mm_div_ps(_mm_cvtepi32_ps(max_count), _mm_cvtepi32_ps(total_count));
+        conservation = _mm_and_ps(conservation, _mm_castsi128_ps(deep));
+        
+        int codes[4];
+        _mm_storeu_si128((__m128i *)codes, code);
+        _mm_storeu_ps(&(AL_conservation[j]), conservation);
+        for(int i = 0; i < 4; i++)
+        {
+            AL_consensus[j + i] = code_to_base[codes[i]];
+        }
+        num_GT_zero += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(deep)));
 	}
     
     // trim these back a bit (if we trim too much we'll get it back right now anywho)
@@ -182,7 +253,7 @@ void Aligner::generateConsensus() {
         // first work from the left and trim back
 	    while(AL_ZoneStart > 0)
 	    {
-		    if(AL_conservation[AL_ZoneStart - 1] < CRASS_DEF_ZONE_EXT_CONS_CUT_OFF) 
+		    if(conservationAt(AL_ZoneStart - 1) < CRASS_DEF_ZONE_EXT_CONS_CUT_OFF) 
                 AL_ZoneStart++;
             else 
 			    break;
@@ -191,7 +262,7 @@ void Aligner::generateConsensus() {
 	    // next work from the right
 	    while(AL_ZoneEnd < AL_length - 1)
 	    {
-		    if(AL_conservation[AL_ZoneEnd + 1] < CRASS_DEF_ZONE_EXT_CONS_CUT_OFF)
+		    if(conservationAt(AL_ZoneEnd + 1) < CRASS_DEF_ZONE_EXT_CONS_CUT_OFF)
 			    AL_ZoneEnd--;
 		    else
 			    break;
@@ -200,7 +271,7 @@ void Aligner::generateConsensus() {
 	//same as the loops above but this time extend outward
 	while(AL_ZoneStart > 0)
 	{
-		if(AL_conservation[AL_ZoneStart - 1] >= CRASS_DEF_ZONE_EXT_CONS_CUT_OFF) 
+		if(conservationAt(AL_ZoneStart - 1) >= CRASS_DEF_ZONE_EXT_CONS_CUT_OFF) 
             AL_ZoneStart--;
         else 
 			break;    
@@ -209,7 +280,7 @@ void Aligner::generateConsensus() {
 	// next work to the right
 	while(AL_ZoneEnd < AL_length - 1)
 	{
-		if(AL_conservation[AL_ZoneEnd + 1] >= CRASS_DEF_ZONE_EXT_CONS_CUT_OFF)
+		if(conservationAt(AL_ZoneEnd + 1) >= CRASS_DEF_ZONE_EXT_CONS_CUT_OFF)
 			AL_ZoneEnd++;
 		else
 			break;
@@ -226,99 +297,255 @@ void Aligner::prepareSequenceForAlignment(std::string& sequence, uint8_t *transf
     size_t seq_length = sequence.length();
     size_t i;
     for (i = 0; i < seq_length; ++i) 
-        transformedSequence[i] = seq_nt4_table[(int)sequence[i]];
+        transformedSequence[i] = packBaseAnyCase(sequence[i]);
     
     // null terminate the sequences
     transformedSequence[seq_length] = '\0';
 
 }
 
-void Aligner::prepareSlaveForAlignment(std::string& slaveDR, 
-                                       uint8_t *slaveTransformedForward, 
-                                       uint8_t *slaveTransformedReverse) {
-    
-    prepareSequenceForAlignment(slaveDR, slaveTransformedForward);
-    std::string revcomp_slave_dr = reverseComplement(slaveDR);
-    prepareSequenceForAlignment(revcomp_slave_dr, slaveTransformedReverse);
-}
-
-int Aligner::getOffsetAgainstMaster(std::string& slaveDR, AlignerFlag_t& flags) {
-
-    int slave_dr_length = static_cast<int>(slaveDR.length());
-    uint8_t* slave_dr_forward = new uint8_t[slave_dr_length+1];
-    uint8_t* slave_dr_reverse = new uint8_t[slave_dr_length+1];
-    
-    prepareSlaveForAlignment(slaveDR, slave_dr_forward, slave_dr_reverse);
-
-    // query profile 
-    kswq_t *slave_forward_query_profile = 0;
-    kswq_t *slave_reverse_query_profile = 0;
+void Aligner::getOffsetsAgainstMaster(std::vector<std::string>& slaveDRs, 
+                                      std::vector<int>& offsets, 
+                                      std::vector<AlignerFlag_t>& flags) {
     
+    int num_slaves = static_cast<int>(slaveDRs.size());
+    offsets.assign(num_slaves, 0);
+    flags.assign(num_slaves, AlignerFlag_t());
     
+    // each slave takes two lanes, forward then reverse complement
+    std::vector<uint8_t> lanes[AL_BATCH_LANES];
+    int scores[AL_BATCH_LANES];
+    int lane_offsets[AL_BATCH_LANES];
     
-    // alignment of slave against master
-    kswr_t forward_return = ksw_align(slave_dr_length, 
-                                      slave_dr_forward, 
-                                      AL_masterDRLength, 
-                                      AL_masterDR, 
-                                      5, 
-                                      AL_scoringMatrix, 
-                                      AL_gapOpening, 
-                                      AL_gapExtension, 
-                                      AL_xtra, 
-                                      &slave_forward_query_profile);
+    for (int first_slave = 0; first_slave < num_slaves; first_slave += AL_BATCH_LANES/2) {
+        int batch_size = std::min(AL_BATCH_LANES/2, num_slaves - first_slave);
+        for (int i = 0; i < batch_size; ++i) {
+            std::string& slave_dr = slaveDRs[first_slave + i];
+            int slave_dr_length = static_cast<int>(slave_dr.length());
+            std::vector<uint8_t>& forward = lanes[2*i];
+            std::vector<uint8_t>& reverse = lanes[2*i + 1];
+            forward.resize(slave_dr_length);
+            reverse.resize(slave_dr_length);
+            for (int j = 0; j < slave_dr_length; ++j) {
+                uint8_t code = packBaseAnyCase(slave_dr[j]);
+                forward[j] = code;
+                reverse[slave_dr_length - 1 - j] = (code < 4) ? 3 - code : code;
+            }
+        }
+        alignBatch(lanes, 2*batch_size, scores, lane_offsets);
+        
+        // figure out which alignment was better
+        for (int i = 0; i < batch_size; ++i) {
+            int slave = first_slave + i;
+            int forward_score = scores[2*i];
+            int reverse_score = scores[2*i + 1];
+            if (reverse_score == forward_score) {
+                flags[slave][score_equal] = true;
+            } else if (reverse_score > forward_score && reverse_score >= AL_minAlignmentScore) {
+                flags[slave][reversed] = true;
+                offsets[slave] = lane_offsets[2*i + 1];
+            } else if (forward_score >= AL_minAlignmentScore) {
+                offsets[slave] = lane_offsets[2*i];
+            } else {
+                logWarn("@Alignment Warning: Slave Score Failure",4);
+                logWarn("Cannot place slave: "<<slaveDRs[slave]<<" ("<<mStringCheck->getToken(slaveDRs[slave])<<") in array", 4);
+                logWarn("Master: "<<mStringCheck->getString(AL_masterDRToken), 4);
+                logWarn("Forward score: "<<forward_score, 4);
+                logWarn("Reverse score: "<<reverse_score, 4);
+                logWarn("******", 4);
+                flags[slave][failed] = true;
+            }
+        }
+    }
+}
+
+void Aligner::alignBatch(std::vector<uint8_t>* slaves, 
+                         int numSlaves, 
+                         int * scores, 
+                         int * offsets) {
+    //-----
+    // Smith-Waterman with affine gaps, the same scoring as ksw, run with
+    // one slave in each lane. The master is the same for every lane so
+    // it walks down the rows while the columns are the slave positions.
+    //
+    // The low byte of every cell holds the diagonal (master - slave) the
+    // alignment started on, the score sits above it. Moving along the
+    // diagonal or through a gap doesn't touch the low byte and an empty
+    // cell is given its own diagonal, so whatever max picks carries its
+    // start along with it. Lanes which are too long for that are given
+    // to ksw one at a time.
+    //
+    // When alignments on different diagonals get the best score ksw and
+    // max don't break the tie the same way. One pass keeps the highest
+    // diagonal and one the lowest, if they differ the slave goes to ksw
+    // so that the offset is always the one ksw would give
+    //
+    int max_score = 0;
+    for (int k = 0; k < 25; ++k) {
+        max_score = std::max(max_score, static_cast<int>(AL_scoringMatrix[k]));
+    }
+    int max_length = 0;
+    bool packed[AL_BATCH_LANES];
+    for (int lane = 0; lane < numSlaves; ++lane) {
+        int lane_length = static_cast<int>(slaves[lane].size());
+        packed[lane] = (AL_masterDRLength <= AL_MAX_PACKED_LENGTH) && 
+                       (lane_length <= AL_MAX_PACKED_LENGTH) && 
+                       (std::min(AL_masterDRLength, lane_length) * max_score <= 0x7f);
+        if (packed[lane]) {
+            max_length = std::max(max_length, lane_length);
+        } else {
+            alignWithKsw(slaves[lane], scores + lane, offsets + lane);
+        }
+    }
     
+    // score of each master base against each column of the batch. Lanes
+    // which are shorter than the longest slave or not in use can't align
+    // past their end
+    std::vector<int16_t> profile((max_length + 1) * 5 * AL_BATCH_LANES, -0x4000);
+    for (int lane = 0; lane < numSlaves; ++lane) {
+        if (!packed[lane]) {
+            continue;
+        }
+        int lane_length = static_cast<int>(slaves[lane].size());
+        for (int j = 1; j <= lane_length; ++j) {
+            const int8_t * scores_for_base = AL_scoringMatrix + slaves[lane][j - 1];
+            int16_t * column = &(profile[j * 5 * AL_BATCH_LANES + lane]);
+            for (int base = 0; base < 5; ++base) {
+                column[base * AL_BATCH_LANES] = scores_for_base[base * 5] * 0x100;
+            }
+        }
+    }
     
-    kswr_t reverse_return = ksw_align(slave_dr_length, 
-                                      slave_dr_reverse, 
-                                      AL_masterDRLength, 
-                                      AL_masterDR, 
-                                      5, 
-                                      AL_scoringMatrix, 
-                                      AL_gapOpening, 
-                                      AL_gapExtension, 
-                                      AL_xtra, 
-                                      &slave_reverse_query_profile);
+    int16_t high_best[AL_BATCH_LANES];
+    int16_t low_best[AL_BATCH_LANES];
+    alignBatchPass(profile, max_length, false, high_best);
+    alignBatchPass(profile, max_length, true, low_best);
+    for (int lane = 0; lane < numSlaves; ++lane) {
+        if (!packed[lane]) {
+            continue;
+        }
+        int high_offset = (high_best[lane] & 0xff) - 0x80;
+        int low_offset = 0x80 - (low_best[lane] & 0xff);
+        if (high_offset == low_offset) {
+            scores[lane] = high_best[lane] >> 8;
+            offsets[lane] = high_offset;
+        } else {
+            alignWithKsw(slaves[lane], scores + lane, offsets + lane);
+        }
+    }
+}
+
+void Aligner::alignBatchPass(std::vector<int16_t>& profile, 
+                             int maxLength, 
+                             bool lowDiagonals, 
+                             int16_t * laneBest) {
+    //-----
+    // for the lowest diagonal it is stored backwards, 0x80 - diagonal,
+    // so that max still picks the one we want
+    //
+    int sign = (lowDiagonals) ? -1 : 1;
     
+    // the previous row of the matrix, H is the best score for the cell
+    // and F the best which ends in a gap in the slave
+    std::vector<int16_t> row_store((maxLength + 1) * 2 * AL_BATCH_LANES, -0x4000);
+    int16_t * H = &(row_store[0]);
+    int16_t * F = H + (maxLength + 1) * AL_BATCH_LANES;
+    for (int j = 0; j <= maxLength; ++j) {
+        for (int lane = 0; lane < AL_BATCH_LANES; ++lane) {
+            H[j * AL_BATCH_LANES + lane] = 0x80 - sign * j;
+        }
+    }
     
-    // free the query profile
-    free(slave_forward_query_profile); 
-    free(slave_reverse_query_profile);
-    delete slave_dr_reverse;
-    delete slave_dr_forward;
-    // figure out which alignment was better
-    if (reverse_return.score == forward_return.score) {
-        flags[score_equal] = true;
-        return 0;
+    __m128i gapoe = _mm_set1_epi16((AL_gapOpening + AL_gapExtension) * 0x100);
+    __m128i gape = _mm_set1_epi16(AL_gapExtension * 0x100);
+    __m128i step = _mm_set1_epi16(sign);
+    __m128i best = _mm_setzero_si128();
+    for (int i = 1; i <= AL_masterDRLength; ++i) {
+        int base = AL_masterDR[i - 1];
+        __m128i h_diag = _mm_set1_epi16(0x80 + sign * (i - 1));
+        __m128i h_left = _mm_set1_epi16(0x80 + sign * i);
+        __m128i e = _mm_set1_epi16(-0x4000);
+        // an empty cell, score zero on the diagonal of this cell
+        __m128i empty = _mm_set1_epi16(0x80 + sign * (i - 1));
+        for (int j = 1; j <= maxLength; ++j) {
+            int cell = j * AL_BATCH_LANES;
+            __m128i h_up = _mm_loadu_si128((__m128i *)(H + cell));
+            __m128i f = _mm_loadu_si128((__m128i *)(F + cell));
+            __m128i h = _mm_adds_epi16(h_diag, _mm_loadu_si128((__m128i *)&(profile[(j * 5 + base) * AL_BATCH_LANES])));
+            
+            // gap in the master
+            e = _mm_max_epi16(_mm_subs_epi16(e, gape), _mm_subs_epi16(h_left, gapoe));
+            // gap in the slave
+            f = _mm_max_epi16(_mm_subs_epi16(f, gape), _mm_subs_epi16(h_up, gapoe));
+            
+            h = _mm_max_epi16(h, e);
+            h = _mm_max_epi16(h, f);
+            h = _mm_max_epi16(h, empty);
+            best = _mm_max_epi16(best, h);
+            
+            _mm_storeu_si128((__m128i *)(H + cell), h);
+            _mm_storeu_si128((__m128i *)(F + cell), f);
+            h_diag = h_up;
+            h_left = h;
+            empty = _mm_subs_epi16(empty, step);
+        }
     }
-        
-    if (reverse_return.score > forward_return.score && reverse_return.score >= AL_minAlignmentScore) {
-        flags[reversed] = true;
-        //std::cout<<"R: "<< masterDR<<"\t"<< reverse_return.tb<<"\t"<< reverse_return.te+1<<"\t"<< rev_slave<<"\t"<< reverse_return.qb<<"\t"<< reverse_return.qe+1<<"\t"<< reverse_return.score<<"\t"<< reverse_return.score2<<"\t"<< reverse_return.te2<<"\t"<<reverse_return.tb - reverse_return.qb<<std::endl;
-        return reverse_return.tb - reverse_return.qb;
-    } else if (forward_return.score >= AL_minAlignmentScore) {
-        //std::cout<<"F: "<< masterDR<<"\t"<< forward_return.tb<<"\t"<< forward_return.te+1<<"\t"<< slaveDR<<"\t"<< forward_return.qb<<"\t"<< forward_return.qe+1<<"\t"<< forward_return.score<<"\t"<< forward_return.score2<<"\t"<< forward_return.te2<<"\t"<<forward_return.tb - forward_return.qb<<std::endl;
-        return forward_return.tb - forward_return.qb;
+    _mm_storeu_si128((__m128i *)laneBest, best);
+}
+
+void Aligner::alignWithKsw(std::vector<uint8_t>& slave, int * score, int * offset) {
+    kswr_t ret = ksw_align(static_cast<int>(slave.size()), 
+                           &(slave[0]), 
+                           AL_masterDRLength, 
+                           AL_masterDR, 
+                           5, 
+                           AL_scoringMatrix, 
+                           AL_gapOpening, 
+                           AL_gapExtension, 
+                           AL_xtra, 
+                           NULL);
+    *score = ret.score;
+    *offset = ret.tb - ret.qb;
+}
+
+void Aligner::growWindow(int first, int last) {
+    
+    // whole blocks, and at least double the window so that growing a
+    // column at a time doesn't copy it every time
+    int width = AL_WindowEnd - AL_WindowStart;
+    int new_start = AL_WindowStart;
+    int new_end = AL_WindowEnd;
+    if (0 == width) {
+        new_start = first;
+        new_end = last + 1;
     } else {
-        logWarn("@Alignment Warning: Slave Score Failure",4);
-        logWarn("Cannot place slave: "<<slaveDR<<" ("<<mStringCheck->getToken(slaveDR)<<") in array", 4);
-        logWarn("Master: "<<AL_masterDR, 4);
-        logWarn("Forward score: "<<forward_return.score, 4);
-        logWarn("Reverse score: "<<reverse_return.score, 4);
-        logWarn("******", 4);
-        flags[failed] = true;
-        return 0;
+        if (first < AL_WindowStart) {
+            new_start = std::min(first, AL_WindowStart - width);
+        }
+        if (last >= AL_WindowEnd) {
+            new_end = std::max(last + 1, AL_WindowEnd + width);
+        }
+    }
+    new_start = std::max(0, new_start - new_start % AL_WINDOW_BLOCK);
+    new_end = std::min(AL_length, new_end + (AL_WINDOW_BLOCK - new_end % AL_WINDOW_BLOCK) % AL_WINDOW_BLOCK);
+    if (new_start == AL_WindowStart && new_end == AL_WindowEnd) {
+        return;
     }
     
-    return 0;
+    // room for whole groups of four columns for generateConsensus
+    std::vector<int> coverage(((new_end - new_start + 3) & ~3) * 4, 0);
+    std::copy(AL_coverage.begin(), AL_coverage.end(), coverage.begin() + (AL_WindowStart - new_start) * 4);
+    AL_coverage.swap(coverage);
+    AL_WindowStart = new_start;
+    AL_WindowEnd = new_end;
 }
 
 void Aligner::placeReadsInCoverageArray(StringToken& currentDrToken) {
 
-    ReadListIterator read_iter = mReads->at(currentDrToken)->begin();
-    int current_dr_length = static_cast<int>(mStringCheck->getString(currentDrToken).length());
+    ReadListIterator read_iter = (*mReads)[currentDrToken].begin();
+    int current_dr_length = static_cast<int>(mStringCheck->getLength(currentDrToken));
     
-    while (read_iter != mReads->at(currentDrToken)->end()) 
+    while (read_iter != (*mReads)[currentDrToken].end()) 
     {
         // don't care about partials
         int dr_start_index = 0;
@@ -335,23 +562,19 @@ void Aligner::placeReadsInCoverageArray(StringToken& currentDrToken) {
             {
                 // we need to find the first kmer which matches the mode.
                 int this_read_start_pos = AL_Offsets[currentDrToken] - (*read_iter)->startStopsAt(dr_start_index);
-                for(int i = 0; i < (int)(*read_iter)->getSeqLength(); i++)
+                int read_length = (int)(*read_iter)->getSeqLength();
+                if(read_length > 0)
                 {
-                    char current_nt = (*read_iter)->getSeqCharAt(i);
-                    int index_b = i+this_read_start_pos; 
-
-                    if((index_b) >= AL_length)
+                    if(this_read_start_pos >= AL_length || (this_read_start_pos >= 0 && this_read_start_pos + read_length > AL_length))
                     {
                         logError("***FATAL*** MEMORY CORRUPTION: The consensus/coverage arrays are too short");
                     }
-                    if((index_b) < 0)
+                    if(this_read_start_pos < 0)
                     {
-                        logError("***FATAL*** MEMORY CORRUPTION: index = "<< index_b<<" less than array begining");
+                        logError("***FATAL*** MEMORY CORRUPTION: index = "<< this_read_start_pos<<" less than array begining");
                     }
-                    if(coverageIndex(index_b,current_nt) >= (int)AL_coverage.size()) {
-                        logError("***FATAL*** MEMORY CORRUPTION: index = "<<coverageIndex(index_b,current_nt)<<"("<<CHAR_TO_INDEX[(int)current_nt]<<" : "<<AL_length<<" : "<<index_b<<") >= "<<AL_coverage.size());
-                    }
-                    AL_coverage[coverageIndex(index_b,current_nt)]++;
+                    growWindow(this_read_start_pos, this_read_start_pos + read_length - 1);
+                    (*read_iter)->addBaseCounts(&(AL_coverage[(this_read_start_pos - AL_WindowStart) * 4]));
                 }
             }
             // go onto the next DR
@@ -374,8 +597,8 @@ void Aligner::extendSlaveDR(std::string &slaveDR, std::string &extendedSlaveDR){
     StringToken token = mStringCheck->getToken(slaveDR);
     
     // go into the reads and get the sequence of the DR plus a few bases on either side
-    ReadListIterator read_iter = mReads->at(token)->begin();
-    while (read_iter != mReads->at(token)->end()) 
+    ReadListIterator read_iter = (*mReads)[token].begin();
+    while (read_iter != (*mReads)[token].end()) 
     {
         // don't care about partials
         int dr_start_index = 0;
@@ -404,8 +627,8 @@ void Aligner::extendSlaveDR(std::string &slaveDR, std::string &extendedSlaveDR){
 
 
 void Aligner::calculateDRZone() {
-    ReadListIterator read_iter = mReads->at(AL_masterDRToken)->begin();
-    while (read_iter != mReads->at(AL_masterDRToken)->end()) 
+    ReadListIterator read_iter = (*mReads)[AL_masterDRToken].begin();
+    while (read_iter != (*mReads)[AL_masterDRToken].end()) 
     {
         // don't care about partials
         int dr_start_index = 0;
@@ -433,10 +656,10 @@ void Aligner::calculateDRZone() {
 }
 
 void Aligner::print() {
-    std::vector<int>::iterator iter;
-    for (int j = 1; j <= 4;++j) {
-        for (int i = 0; i < AL_length; ++i) {
-            std::cout<<AL_coverage[i*j]<<",";
+    char alphabet[4] = {'A', 'C', 'G', 'T'};
+    for (int j = 0; j < 4;++j) {
+        for (int i = AL_WindowStart; i < AL_WindowEnd; ++i) {
+            std::cout<<coverageAt(i, alphabet[j])<<",";
         }
         std::cout<<"$"<<std::endl;
     }
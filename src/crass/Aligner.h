@@ -44,7 +44,18 @@
 #include "crassDefines.h"
 
 
-#define coverageIndex(i,c) (((CHAR_TO_INDEX[(int)c] - 1) * AL_length) + i)
+// slaves are aligned this many at a time, one per 16 bit SSE2 lane
+#define AL_BATCH_LANES 8
+// longest sequence that fits in a batch, the start of the alignment is
+// kept in the low byte of each score
+#define AL_MAX_PACKED_LENGTH 127
+// the coverage arrays only hold the columns that reads have been placed
+// in, grown this many columns at a time
+#define AL_WINDOW_BLOCK 64
+
+// the four counts of a column sit next to each other, in the order
+// ReadHolder::addBaseCounts uses
+#define coverageIndex(i,c) ((((i) - AL_WindowStart) * 4) + CHAR_TO_INDEX[(int)c] - 1)
 
 typedef std::bitset<3> AlignerFlag_t;
 
@@ -59,26 +70,6 @@ class Aligner
     };
     
     
-    static const unsigned char seq_nt4_table[256];/* = {
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 0, 4, 1, 4, 4, 4, 2, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 0, 4, 1, 4, 4, 4, 2, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4
-    };*/
-    
-    
     // ASCII table that converts characters into the multiplier
     // used for finding the correct index in the coverage array
     static const char CHAR_TO_INDEX[128];/* = {
@@ -103,13 +94,13 @@ public:
     //int gapo = 5, gape = 2, minsc = 0, xtra = KSW_XSTART;
     Aligner(int length, ReadMap *wh_reads, StringCheck *wh_st, int gapo=5, int gape=2, int minsc=5, int xtra=KSW_XSTART): 
         AL_length(length),
-        AL_consensus(length,'N'), 
-        AL_conservation(length, 0.0f), 
-        AL_coverage(length*4, 0),
+        AL_WindowStart(0),
+        AL_WindowEnd(0),
         AL_gapOpening(gapo), 
         AL_gapExtension(gape), 
         AL_minAlignmentScore(minsc), 
-        AL_xtra(xtra) {
+        AL_xtra(xtra),
+        AL_HoldTokens(false) {
         
             // assign workhorse variables
             mReads = wh_reads;
@@ -141,7 +132,22 @@ public:
     
     void setMasterDR(std::string& master);
     
-    void alignSlave(StringToken& slaveDRToken);
+    // align every DR in the group against the master and place their
+    // reads in the coverage array. Tokens of DRs that had to be reverse
+    // complemented are updated in place unless the tokens are held
+    void alignSlaves(DR_Cluster& slaveDRTokens);
+
+    // reverse complemented slaves keep their old token until
+    // releaseSlaveTokens() so that aligning never changes the
+    // StringCheck or the ReadMap. The reads are still flipped
+    inline void holdSlaveTokens(void) { AL_HoldTokens = true; }
+
+    // give the held slaves their new tokens, in the order they were placed
+    void releaseSlaveTokens(DR_Cluster& slaveDRTokens);
+
+    // the sequence of a DR in the group, reverse complemented if it was
+    // flipped and its token is held
+    std::string drSequence(StringToken drToken);
 
     // add in all of the reads for this group to the coverage array
     void generateConsensus();
@@ -164,30 +170,50 @@ public:
     
     inline void setDRZoneEnd(int i){AL_ZoneEnd = i;}
     
-    inline int coverageAt(int i, char c){return AL_coverage.at(coverageIndex(i,c)); }
+    // columns outside the window have no reads in them
+    inline int coverageAt(int i, char c){return inWindow(i) ? AL_coverage[coverageIndex(i,c)] : 0; }
     
-    inline char consensusAt(int i){return AL_consensus.at(i);}
+    inline char consensusAt(int i){return inWindow(i) ? AL_consensus[i - AL_WindowStart] : 'N';}
     
-    inline float conservationAt(int i){return AL_conservation.at(i);}
+    inline float conservationAt(int i){return inWindow(i) ? AL_conservation[i - AL_WindowStart] : 0.0f;}
     
-    inline int depthAt(int i){return AL_coverage[coverageIndex(i,'A')] + AL_coverage[coverageIndex(i,'C')] + AL_coverage[coverageIndex(i,'G')] + AL_coverage[coverageIndex(i,'T')];}
+    inline int depthAt(int i){return coverageAt(i,'A') + coverageAt(i,'C') + coverageAt(i,'G') + coverageAt(i,'T');}
 
 private:
     // private methods
     //
     
-    // call ksw alignment to determine the offset for this slave against the master
-    int getOffsetAgainstMaster(std::string& slaveDR,
-                               AlignerFlag_t& flags);
+    // determine the offsets for these slaves against the master, both
+    // orientations of each slave are aligned in the same batch
+    void getOffsetsAgainstMaster(std::vector<std::string>& slaveDRs,
+                                 std::vector<int>& offsets,
+                                 std::vector<AlignerFlag_t>& flags);
+
+    // local alignment of the master against up to AL_BATCH_LANES
+    // sequences at once, one per SIMD lane. The offset is where the
+    // alignment starts on the master less where it starts on the slave.
+    // slaves are in ksw form and may be changed and put back by ksw
+    void alignBatch(std::vector<uint8_t>* slaves,
+                    int numSlaves,
+                    int * scores,
+                    int * offsets);
+
+    // one pass over the matrix for alignBatch, each lane ends up with its
+    // best score and the highest, or lowest, diagonal that gets it
+    void alignBatchPass(std::vector<int16_t>& profile,
+                        int maxLength,
+                        bool lowDiagonals,
+                        int16_t * laneBest);
+
+    // the same alignment through ksw for a single slave
+    void alignWithKsw(std::vector<uint8_t>& slave, int * score, int * offset);
+
+    // move the slave into place using the offset from the alignment
+    void placeSlave(StringToken& slaveDRToken, int offset, AlignerFlag_t& flags);
 
     // transform any sequence into the right form for ksw
     void prepareSequenceForAlignment(std::string& sequence, uint8_t *transformedSequence);
 
-    // transform a slave DR into the right form for ksw in both orientations
-    void prepareSlaveForAlignment(std::string& slaveDR,
-                                  uint8_t *slaveTransformedForward, 
-                                  uint8_t *slaveTransformedReverse);
-
     // transform the master DR into the right form for ksw
     inline void prepareMasterForAlignment(std::string& masterDR) {
         AL_masterDRLength = masterDR.length();
@@ -196,6 +222,11 @@ private:
     };
     
 
+    inline bool inWindow(int i){return i >= AL_WindowStart && i < AL_WindowEnd;}
+    
+    // make sure the columns first to last are in the window
+    void growWindow(int first, int last);
+
     void placeReadsInCoverageArray(StringToken& currentDRToken);
     
     void extendSlaveDR(std::string& slaveDR, std::string& extendedSlaveDR);
@@ -207,7 +238,11 @@ private:
     // length of the arrays
     int AL_length;
     
-    // Vectors to hold the alignment data
+    // the columns [start, end) of the arrays that are held
+    int AL_WindowStart;
+    int AL_WindowEnd;
+    
+    // Vectors to hold the alignment data for the window
     std::vector<char> AL_consensus;
     std::vector<float> AL_conservation;
     std::vector<int> AL_coverage;
@@ -227,6 +262,11 @@ private:
     int AL_masterDRLength;
     StringToken AL_masterDRToken;
     
+    // slaves that were flipped while the tokens were held, with their
+    // reverse complemented sequence
+    bool AL_HoldTokens;
+    std::vector<std::pair<StringToken, std::string> > AL_HeldSlaves;
+
     // "Glue" between WorkHorse
     ReadMap * mReads;
     StringCheck * mStringCheck;
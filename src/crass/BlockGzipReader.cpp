@@ -0,0 +1,462 @@
+/*
+ *  BlockGzipReader.cpp is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+// system includes
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <libcrispr/Exception.h>
+
+// local includes
+#include "BlockGzipReader.h"
+#include "crassDefines.h"
+
+InflatedBlock::~InflatedBlock(void)
+{
+    if (NULL != stream)
+    {
+        inflateEnd(stream);
+        delete stream;
+    }
+}
+
+void BlockInflateTask::run(int)
+{
+    BlockGzipReader::BlockJob job;
+    while (mReader->BR_Jobs->pop(job))
+    {
+        mReader->inflateJob(job);
+    }
+}
+
+BlockGzipReader::BlockGzipReader(int numThreads) :
+    BR_NumThreads((numThreads < 1) ? 1 : numThreads),
+    BR_Window(4 * BR_NumThreads),
+    BR_Fd(-1),
+    BR_Data(NULL),
+    BR_Size(0),
+    BR_Bgzf(false),
+    BR_ScanPos(0),
+    BR_ScanDone(false),
+    BR_Expected(0),
+    BR_Eof(false),
+    BR_Pool(NULL),
+    BR_Task(NULL),
+    BR_Jobs(NULL),
+    BR_JobsQueued(0),
+    BR_NextResult(0),
+    BR_Current(NULL),
+    BR_CurrentPos(0)
+{}
+
+BlockGzipReader::~BlockGzipReader(void)
+{
+    close();
+}
+
+bool BlockGzipReader::open(const char * fileName)
+{
+    //-----
+    // only regular files can be mapped, pipes and stdin go through zlib
+    //
+    BR_Fd = ::open(fileName, O_RDONLY);
+    if (BR_Fd < 0)
+    {
+        return false;
+    }
+    struct stat file_stat;
+    if (0 != fstat(BR_Fd, &file_stat) || !S_ISREG(file_stat.st_mode) || file_stat.st_size < 18)
+    {
+        close();
+        return false;
+    }
+    BR_Size = file_stat.st_size;
+    void * map = mmap(NULL, BR_Size, PROT_READ, MAP_PRIVATE, BR_Fd, 0);
+    if (MAP_FAILED == map)
+    {
+        BR_Size = 0;
+        close();
+        return false;
+    }
+    madvise(map, BR_Size, MADV_SEQUENTIAL);
+    BR_Data = static_cast<const unsigned char *>(map);
+
+    uint64_t block_size;
+    if (isBgzfHeader(0, block_size))
+    {
+        BR_Bgzf = true;
+    }
+    else if (isGzipHeader(0))
+    {
+        // a lone member can't be split up, zlib is as good as it gets
+        uint64_t offset, end;
+        BR_ScanPos = 1;
+        if (!nextCandidate(offset, end))
+        {
+            close();
+            return false;
+        }
+        BR_ScanPos = 0;
+        BR_ScanDone = false;
+    }
+    else
+    {
+        close();
+        return false;
+    }
+
+    BR_Jobs = new WorkQueue<BlockJob>(BR_Window);
+    BR_Task = new BlockInflateTask(this);
+    BR_Pool = new ThreadPool(BR_NumThreads);
+    BR_Pool->start(BR_Task);
+    return true;
+}
+
+void BlockGzipReader::close(void)
+{
+    if (NULL != BR_Pool)
+    {
+        BR_Jobs->close();
+        try {
+            BR_Pool->join();
+        } catch (crispr::exception& e) {
+            // the workers don't throw, nothing to add here
+        }
+        delete BR_Pool;
+        BR_Pool = NULL;
+    }
+    delete BR_Task;
+    BR_Task = NULL;
+    delete BR_Jobs;
+    BR_Jobs = NULL;
+
+    std::map<unsigned long, InflatedBlock *>::iterator done_iter = BR_Done.begin();
+    while (done_iter != BR_Done.end())
+    {
+        delete done_iter->second;
+        done_iter++;
+    }
+    BR_Done.clear();
+    delete BR_Current;
+    BR_Current = NULL;
+
+    if (NULL != BR_Data)
+    {
+        munmap(const_cast<unsigned char *>(BR_Data), BR_Size);
+        BR_Data = NULL;
+    }
+    if (BR_Fd >= 0)
+    {
+        ::close(BR_Fd);
+        BR_Fd = -1;
+    }
+}
+
+bool BlockGzipReader::isGzipHeader(uint64_t offset)
+{
+    //-----
+    // magic number, deflate and no reserved flags set
+    //
+    if (offset + 10 > BR_Size)
+    {
+        return false;
+    }
+    const unsigned char * header = BR_Data + offset;
+    return (0x1f == header[0] && 0x8b == header[1] && 8 == header[2] && 0 == (header[3] & 0xe0));
+}
+
+bool BlockGzipReader::isBgzfHeader(uint64_t offset, uint64_t& blockSize)
+{
+    //-----
+    // a gzip header with a 'BC' extra field holding the block size
+    //
+    if (offset + 18 > BR_Size || !isGzipHeader(offset))
+    {
+        return false;
+    }
+    const unsigned char * header = BR_Data + offset;
+    if (0 == (header[3] & 4) ||
+        (header[10] | (header[11] << 8)) < 6 ||
+        'B' != header[12] ||
+        'C' != header[13] ||
+        2 != (header[14] | (header[15] << 8)))
+    {
+        return false;
+    }
+    blockSize = (header[16] | (header[17] << 8)) + 1;
+    return (offset + blockSize <= BR_Size);
+}
+
+bool BlockGzipReader::nextCandidate(uint64_t& offset, uint64_t& end)
+{
+    if (BR_ScanDone)
+    {
+        return false;
+    }
+    if (BR_Bgzf)
+    {
+        uint64_t block_size;
+        if (isBgzfHeader(BR_ScanPos, block_size))
+        {
+            offset = BR_ScanPos;
+            end = offset + block_size;
+            BR_ScanPos = end;
+            return true;
+        }
+        // end of the chain, anything after it has to be found the hard way
+        BR_Bgzf = false;
+    }
+    while (BR_ScanPos < BR_Size)
+    {
+        const void * hit = memchr(BR_Data + BR_ScanPos, 0x1f, BR_Size - BR_ScanPos);
+        if (NULL == hit)
+        {
+            break;
+        }
+        uint64_t pos = static_cast<const unsigned char *>(hit) - BR_Data;
+        BR_ScanPos = pos + 1;
+        if (isGzipHeader(pos))
+        {
+            offset = pos;
+            end = BR_Size;
+            return true;
+        }
+    }
+    BR_ScanPos = BR_Size;
+    BR_ScanDone = true;
+    return false;
+}
+
+void BlockGzipReader::queueJobs(void)
+{
+    //-----
+    // only the reading thread queues jobs and it never has more than
+    // the window out at once so the push can't block
+    //
+    while (BR_JobsQueued - BR_NextResult < BR_Window)
+    {
+        BlockJob job;
+        if (!nextCandidate(job.offset, job.end))
+        {
+            break;
+        }
+        job.index = BR_JobsQueued++;
+        BR_Jobs->push(job);
+    }
+}
+
+void BlockGzipReader::inflateBlock(InflatedBlock * block)
+{
+    z_stream * stream = block->stream;
+    block->data.resize(CRASS_DEF_INFLATE_BLOCK_SIZE);
+    stream->next_out = reinterpret_cast<Bytef *>(&(block->data[0]));
+    stream->avail_out = block->data.size();
+    while (true)
+    {
+        if (0 == stream->avail_in && block->inputPos < block->inputEnd)
+        {
+            uint64_t len = block->inputEnd - block->inputPos;
+            if (len > CRASS_DEF_INFLATE_BLOCK_SIZE)
+            {
+                len = CRASS_DEF_INFLATE_BLOCK_SIZE;
+            }
+            stream->next_in = const_cast<Bytef *>(BR_Data + block->inputPos);
+            stream->avail_in = len;
+            block->inputPos += len;
+        }
+        int ret = inflate(stream, Z_NO_FLUSH);
+        if (Z_STREAM_END == ret)
+        {
+            // inputPos now marks the end of the member
+            block->data.resize(block->data.size() - stream->avail_out);
+            block->inputPos = block->offset + stream->total_in;
+            block->status = InflatedBlock::blockDone;
+            break;
+        }
+        if (Z_OK != ret && Z_BUF_ERROR != ret)
+        {
+            // garbage
+            block->data.clear();
+            block->status = InflatedBlock::blockFailed;
+            break;
+        }
+        if (0 == stream->avail_in && block->inputPos >= block->inputEnd && 0 != stream->avail_out)
+        {
+            // a truncated member, keep what came out of it like gzread does
+            block->data.resize(block->data.size() - stream->avail_out);
+            block->status = InflatedBlock::blockFailed;
+            break;
+        }
+        if (0 == stream->avail_out)
+        {
+            block->status = InflatedBlock::blockPartial;
+            return;
+        }
+    }
+    inflateEnd(stream);
+    delete stream;
+    block->stream = NULL;
+}
+
+void BlockGzipReader::inflateJob(const BlockJob& job)
+{
+    InflatedBlock * block = new InflatedBlock();
+    block->offset = job.offset;
+    block->inputPos = job.offset;
+    block->inputEnd = job.end;
+    try {
+        block->stream = new z_stream();
+        if (Z_OK == inflateInit2(block->stream, 16 + MAX_WBITS))
+        {
+            inflateBlock(block);
+        }
+        else
+        {
+            delete block->stream;
+            block->stream = NULL;
+        }
+    } catch (std::exception& e) {
+        // the reading thread treats it as a bad member
+        delete block;
+        block = new InflatedBlock();
+        block->offset = job.offset;
+    }
+    ScopedLock lock(BR_Mutex);
+    BR_Done[job.index] = block;
+    BR_BlockReady.signal();
+}
+
+bool BlockGzipReader::nextBlock(void)
+{
+    while (true)
+    {
+        queueJobs();
+        if (BR_NextResult == BR_JobsQueued)
+        {
+            return false;
+        }
+
+        InflatedBlock * block;
+        {
+            ScopedLock lock(BR_Mutex);
+            std::map<unsigned long, InflatedBlock *>::iterator done_iter;
+            while ((done_iter = BR_Done.find(BR_NextResult)) == BR_Done.end())
+            {
+                BR_BlockReady.wait(BR_Mutex);
+            }
+            block = done_iter->second;
+            BR_Done.erase(done_iter);
+        }
+        BR_NextResult++;
+
+        if (block->offset < BR_Expected)
+        {
+            // just a magic number inside the last member
+            delete block;
+            continue;
+        }
+        if (block->offset > BR_Expected)
+        {
+            // no member starts where the last one ended. zlib ignores
+            // trailing junk like this so we do as well
+            delete block;
+            return false;
+        }
+        if (InflatedBlock::blockFailed == block->status)
+        {
+            // a damaged member. gzread hands back what it could inflate
+            // and then reports the end of the input, so we stop here too
+            BR_Eof = true;
+        }
+        else if (InflatedBlock::blockDone == block->status)
+        {
+            BR_Expected = block->inputPos;
+        }
+        BR_Current = block;
+        BR_CurrentPos = 0;
+        return true;
+    }
+}
+
+int BlockGzipReader::read(char * buf, int len)
+{
+    int filled = 0;
+    while (filled < len)
+    {
+        if (NULL != BR_Current && BR_CurrentPos < BR_Current->data.size())
+        {
+            size_t n = BR_Current->data.size() - BR_CurrentPos;
+            if (n > static_cast<size_t>(len - filled))
+            {
+                n = len - filled;
+            }
+            memcpy(buf + filled, &(BR_Current->data[BR_CurrentPos]), n);
+            BR_CurrentPos += n;
+            filled += n;
+        }
+        else if (NULL != BR_Current && InflatedBlock::blockPartial == BR_Current->status)
+        {
+            // a big member, finish it off here
+            inflateBlock(BR_Current);
+            BR_CurrentPos = 0;
+            if (InflatedBlock::blockFailed == BR_Current->status)
+            {
+                // as in nextBlock, the damage ends the input
+                BR_Eof = true;
+            }
+            else if (InflatedBlock::blockDone == BR_Current->status)
+            {
+                BR_Expected = BR_Current->inputPos;
+            }
+        }
+        else
+        {
+            delete BR_Current;
+            BR_Current = NULL;
+            if (BR_Eof || !nextBlock())
+            {
+                BR_Eof = true;
+                break;
+            }
+        }
+    }
+    return filled;
+}
+
+int BlockGzipReader::readCallback(void * handle, char * buf, int len)
+{
+    return static_cast<BlockGzipReader *>(handle)->read(buf, len);
+}
@@ -0,0 +1,165 @@
+/*
+ *  BlockGzipReader.h is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Inflates gzip files made of many members (bgzip output, or files that
+ *  were simply cat'ed together) on a pool of threads. The file is mapped
+ *  into memory and every member is inflated on its own, the inflated
+ *  blocks are handed back in file order through read(), which has the
+ *  same contract as gzread.
+ *
+ *  BGZF blocks carry their compressed size so they can be found without
+ *  looking at the data. For other files every gzip magic number is a
+ *  candidate member; candidates that turn out to sit inside another member
+ *  are thrown away and members too big for one block are finished off
+ *  serially by the reading thread.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+#ifndef crass_BlockGzipReader_h
+#define crass_BlockGzipReader_h
+
+// system includes
+#include <map>
+#include <vector>
+#include <stdint.h>
+#include <zlib.h>
+
+// local includes
+#include "ThreadPool.h"
+
+class BlockGzipReader;
+
+// a member (or the start of one) that has been inflated
+struct InflatedBlock
+{
+    enum {
+        blockDone,              // the whole member is in data
+        blockPartial,           // data is full, stream holds the rest
+        blockFailed             // not a gzip member, or a truncated one
+    };
+
+    InflatedBlock(void) : offset(0), inputPos(0), inputEnd(0), status(blockFailed), stream(NULL) {}
+    ~InflatedBlock(void);
+
+    uint64_t offset;            // start of the member in the file
+    uint64_t inputPos;          // next compressed byte to hand to zlib
+    uint64_t inputEnd;          // the member cannot go past here
+    int status;
+    std::vector<char> data;
+    z_stream * stream;
+};
+
+// the worker side of the reader
+class BlockInflateTask : public ThreadTask
+{
+    public:
+        BlockInflateTask(BlockGzipReader * reader) : mReader(reader) {}
+
+        void run(int threadNumber);
+
+    private:
+        BlockGzipReader * mReader;
+};
+
+class BlockGzipReader
+{
+    public:
+        BlockGzipReader(int numThreads);
+        ~BlockGzipReader(void);
+
+        // map the file and decide if it is worth inflating in parallel.
+        // Returns false for anything that is not a bgzip file or a gzip
+        // file with more than one member; the caller should use zlib
+        bool open(const char * fileName);
+
+        // fill buf with up to len bytes of inflated data. Less than len
+        // is only returned at the end of the file
+        int read(char * buf, int len);
+
+        // kseq style callback, handle is a BlockGzipReader
+        static int readCallback(void * handle, char * buf, int len);
+
+    private:
+        friend class BlockInflateTask;
+
+        struct BlockJob
+        {
+            unsigned long index;
+            uint64_t offset;
+            uint64_t end;
+        };
+
+        BlockGzipReader(const BlockGzipReader&);
+        BlockGzipReader& operator=(const BlockGzipReader&);
+
+        bool isBgzfHeader(uint64_t offset, uint64_t& blockSize);
+        bool isGzipHeader(uint64_t offset);
+
+        // the next place in the file that might be the start of a member
+        bool nextCandidate(uint64_t& offset, uint64_t& end);
+
+        // keep the workers busy
+        void queueJobs(void);
+
+        // move on to the next member in the file, false at the end
+        bool nextBlock(void);
+
+        // pump more data through zlib, used by the workers for the first
+        // chunk of a member and by read() for any members that are left over
+        void inflateBlock(InflatedBlock * block);
+
+        void inflateJob(const BlockJob& job);
+
+        void close(void);
+
+        int BR_NumThreads;
+        unsigned long BR_Window;                            // max jobs in flight
+        int BR_Fd;
+        const unsigned char * BR_Data;                      // the mapped file
+        uint64_t BR_Size;
+        bool BR_Bgzf;                                       // still walking a chain of bgzf blocks
+        uint64_t BR_ScanPos;                                // where to look for the next candidate
+        bool BR_ScanDone;
+        uint64_t BR_Expected;                               // where the next real member starts
+        bool BR_Eof;
+
+        ThreadPool * BR_Pool;
+        BlockInflateTask * BR_Task;
+        WorkQueue<BlockJob> * BR_Jobs;
+        unsigned long BR_JobsQueued;
+        unsigned long BR_NextResult;
+        Mutex BR_Mutex;
+        Condition BR_BlockReady;
+        std::map<unsigned long, InflatedBlock *> BR_Done;   // finished jobs by index
+
+        InflatedBlock * BR_Current;
+        size_t BR_CurrentPos;
+};
+
+#endif //crass_BlockGzipReader_h
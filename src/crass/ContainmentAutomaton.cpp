@@ -0,0 +1,151 @@
+/*
+ *  ContainmentAutomaton.cpp is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+// system includes
+#include <deque>
+
+// local includes
+#include "ContainmentAutomaton.h"
+
+ContainmentAutomaton::ContainmentAutomaton(const std::vector<std::string>& patterns) :
+    CA_AlphabetSize(0)
+{
+    for (int c = 0; c < 256; c++)
+    {
+        CA_Symbol[c] = -1;
+    }
+    std::vector<std::string>::const_iterator pattern_iter;
+    for (pattern_iter = patterns.begin(); pattern_iter != patterns.end(); pattern_iter++)
+    {
+        for (size_t i = 0; i < pattern_iter->length(); i++)
+        {
+            int c = static_cast<unsigned char>((*pattern_iter)[i]);
+            if (-1 == CA_Symbol[c])
+            {
+                CA_Symbol[c] = CA_AlphabetSize++;
+            }
+        }
+    }
+
+    //-----
+    // the trie, 0 is the root and no state ever goes back to it so a 0
+    // in the goto table means there is no edge yet
+    //
+    CA_Goto.assign(CA_AlphabetSize, 0);
+    CA_FirstPattern.assign(1, -1);
+    for (int pattern = 0; pattern < static_cast<int>(patterns.size()); pattern++)
+    {
+        const std::string& pattern_seq = patterns[pattern];
+        if (pattern_seq.empty())
+        {
+            continue;
+        }
+        int state = 0;
+        for (size_t i = 0; i < pattern_seq.length(); i++)
+        {
+            int edge = state * CA_AlphabetSize + CA_Symbol[static_cast<unsigned char>(pattern_seq[i])];
+            if (0 == CA_Goto[edge])
+            {
+                CA_Goto[edge] = static_cast<int>(CA_FirstPattern.size());
+                CA_FirstPattern.push_back(-1);
+                CA_Goto.resize(CA_Goto.size() + CA_AlphabetSize, 0);
+            }
+            state = CA_Goto[edge];
+        }
+        if (-1 == CA_FirstPattern[state])
+        {
+            CA_FirstPattern[state] = pattern;
+        }
+    }
+
+    //-----
+    // breadth first, so the failure of every state is finished before the
+    // state is. Missing edges are filled in from the failure state and each
+    // state takes the lowest pattern of its failure as well
+    //
+    std::vector<int> failure(CA_FirstPattern.size(), 0);
+    std::deque<int> queue;
+    for (int symbol = 0; symbol < CA_AlphabetSize; symbol++)
+    {
+        if (0 != CA_Goto[symbol])
+        {
+            queue.push_back(CA_Goto[symbol]);
+        }
+    }
+    while (!queue.empty())
+    {
+        int state = queue.front();
+        queue.pop_front();
+        int fail = failure[state];
+        if (-1 != CA_FirstPattern[fail] && (-1 == CA_FirstPattern[state] || CA_FirstPattern[fail] < CA_FirstPattern[state]))
+        {
+            CA_FirstPattern[state] = CA_FirstPattern[fail];
+        }
+        for (int symbol = 0; symbol < CA_AlphabetSize; symbol++)
+        {
+            int edge = state * CA_AlphabetSize + symbol;
+            if (0 != CA_Goto[edge])
+            {
+                failure[CA_Goto[edge]] = CA_Goto[fail * CA_AlphabetSize + symbol];
+                queue.push_back(CA_Goto[edge]);
+            }
+            else
+            {
+                CA_Goto[edge] = CA_Goto[fail * CA_AlphabetSize + symbol];
+            }
+        }
+    }
+}
+
+int ContainmentAutomaton::firstPatternIn(const std::string& text)
+{
+    int first_pattern = -1;
+    int state = 0;
+    for (size_t i = 0; i < text.length(); i++)
+    {
+        int symbol = CA_Symbol[static_cast<unsigned char>(text[i])];
+        if (-1 == symbol)
+        {
+            // no pattern gets past this character
+            state = 0;
+            continue;
+        }
+        state = CA_Goto[state * CA_AlphabetSize + symbol];
+        int pattern = CA_FirstPattern[state];
+        if (-1 != pattern && (-1 == first_pattern || pattern < first_pattern))
+        {
+            first_pattern = pattern;
+        }
+    }
+    return first_pattern;
+}
@@ -0,0 +1,65 @@
+/*
+ *  ContainmentAutomaton.h is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  An Aho-Corasick automaton over a set of patterns that finds the first
+ *  pattern (by index) found anywhere in a text in one pass over the text.
+ *  The trie is turned into a full goto table over just the characters
+ *  the patterns use, so a text character costs one lookup.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+#ifndef crass_ContainmentAutomaton_h
+#define crass_ContainmentAutomaton_h
+
+// system includes
+#include <string>
+#include <vector>
+
+class ContainmentAutomaton
+{
+    public:
+        // empty patterns are left out
+        ContainmentAutomaton(const std::vector<std::string>& patterns);
+        ~ContainmentAutomaton(void) {}
+
+        // the lowest index of the patterns that occur in the text, -1 if
+        // none of them do
+        int firstPatternIn(const std::string& text);
+
+    private:
+        ContainmentAutomaton(const ContainmentAutomaton&);
+        ContainmentAutomaton& operator=(const ContainmentAutomaton&);
+
+        int CA_AlphabetSize;
+        int CA_Symbol[256];                                 // symbol of every character, -1 if no pattern has it
+        std::vector<int> CA_Goto;                           // CA_AlphabetSize per state, the root is state 0
+        std::vector<int> CA_FirstPattern;                   // lowest pattern ending at the state or any of its suffixes, -1 if none
+};
+
+#endif //crass_ContainmentAutomaton_h
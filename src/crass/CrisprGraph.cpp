@@ -0,0 +1,334 @@
+/*
+ *  CrisprGraph.cpp is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+// system includes
+#include <algorithm>
+#include <sstream>
+
+// local includes
+#include "CrisprGraph.h"
+#include "GraphDrawingDefines.h"
+#include "LoggerSimp.h"
+#include <libcrispr/Exception.h>
+
+// the type of the edge going back the other way
+static EDGE_TYPE returnEdgeType(EDGE_TYPE type)
+{
+    switch(type)
+    {
+        case CN_EDGE_FORWARD:
+            return CN_EDGE_BACKWARD;
+        case CN_EDGE_BACKWARD:
+            return CN_EDGE_FORWARD;
+        case CN_EDGE_JUMPING_F:
+            return CN_EDGE_JUMPING_B;
+        case CN_EDGE_JUMPING_B:
+            return CN_EDGE_JUMPING_F;
+        default:
+            throw crispr::runtime_exception(__FILE__,
+                                            __LINE__,
+                                            __PRETTY_FUNCTION__,
+                                            "Unknown edge type");
+    }
+}
+
+//
+// Building
+//
+void CrisprGraph::addNode(CrisprNode * node)
+{
+    node->setIndex(static_cast<int>(CG_Nodes.size()));
+    CG_Nodes.push_back(node);
+}
+
+void CrisprGraph::addEdge(CrisprNode * node, CrisprNode * partnerNode, EDGE_TYPE type)
+{
+    if(CG_Frozen)
+    {
+        throw crispr::runtime_exception(__FILE__,
+                                        __LINE__,
+                                        __PRETTY_FUNCTION__,
+                                        "Cannot add an edge to a frozen graph");
+    }
+    PendingEdge pending;
+    pending.node = static_cast<unsigned int>(node->getIndex());
+    pending.partner = static_cast<unsigned int>(partnerNode->getIndex());
+    pending.type = static_cast<unsigned int>(type);
+    CG_Pending.push_back(pending);
+
+    // most reads add edges that are already here
+    if(CG_Pending.size() >= CG_CompactAt)
+    {
+        compactPending();
+        CG_CompactAt = std::max(CG_CompactAt, 2 * CG_Pending.size());
+    }
+}
+
+bool CrisprGraph::pendingLess(const PendingEdge& a, const PendingEdge& b)
+{
+    if(a.node != b.node)
+        return a.node < b.node;
+    if(a.type != b.type)
+        return a.type < b.type;
+    return a.partner < b.partner;
+}
+
+bool CrisprGraph::pendingEqual(const PendingEdge& a, const PendingEdge& b)
+{
+    return a.node == b.node && a.type == b.type && a.partner == b.partner;
+}
+
+void CrisprGraph::compactPending(void)
+{
+    std::sort(CG_Pending.begin(), CG_Pending.end(), pendingLess);
+    CG_Pending.erase(std::unique(CG_Pending.begin(), CG_Pending.end(), pendingEqual), CG_Pending.end());
+}
+
+void CrisprGraph::freeze(void)
+{
+    //-----
+    // lay the edges out by node then type then partner
+    //
+    if(CG_Frozen)
+        return;
+    compactPending();
+
+    size_t num_nodes = CG_Nodes.size();
+    CG_Attached.assign(num_nodes, true);
+    CG_Ranks.assign(4 * num_nodes, 0);
+    CG_EdgeStart.assign(4 * num_nodes + 1, 0);
+    CG_EdgeTarget.resize(CG_Pending.size());
+    CG_EdgeFlags.assign(CG_Pending.size(), CG_EDGE_ACTIVE);
+
+    for(size_t i = 0; i < CG_Pending.size(); i++)
+    {
+        CG_Ranks[4 * CG_Pending[i].node + CG_Pending[i].type]++;
+        CG_EdgeTarget[i] = CG_Pending[i].partner;
+    }
+    for(size_t i = 0; i < 4 * num_nodes; i++)
+    {
+        CG_EdgeStart[i + 1] = CG_EdgeStart[i] + static_cast<unsigned int>(CG_Ranks[i]);
+    }
+    std::vector<PendingEdge>().swap(CG_Pending);
+    CG_Frozen = true;
+}
+
+//
+// Nodes
+//
+unsigned int CrisprGraph::findEdge(int index, EDGE_TYPE type, int partner)
+{
+    std::vector<unsigned int>::iterator first = CG_EdgeTarget.begin() + edgeBegin(index, type);
+    std::vector<unsigned int>::iterator last = CG_EdgeTarget.begin() + edgeEnd(index, type);
+    std::vector<unsigned int>::iterator target_iter = std::lower_bound(first, last, static_cast<unsigned int>(partner));
+    if(target_iter != last && *target_iter == static_cast<unsigned int>(partner))
+        return static_cast<unsigned int>(target_iter - CG_EdgeTarget.begin());
+    return edgeEnd(index, type);
+}
+
+void CrisprGraph::detachNode(int index)
+{
+    //-----
+    // detach this node. The partners lose the rank of the type of the
+    // edge on this side, and a partner with no rank left is detached
+    // as well but not walked from
+    //
+    static const EDGE_TYPE detach_order[4] = {CN_EDGE_FORWARD, CN_EDGE_BACKWARD, CN_EDGE_JUMPING_F, CN_EDGE_JUMPING_B};
+    for(int i = 0; i < 4; i++)
+    {
+        EDGE_TYPE type = detach_order[i];
+        for(unsigned int edge = edgeBegin(index, type); edge < edgeEnd(index, type); edge++)
+        {
+            int partner = CG_EdgeTarget[edge];
+            if(!isEdgeActive(edge) || !CG_Attached[partner])
+                continue;
+
+            unsigned int return_edge = findEdge(partner, type, index);
+            if(return_edge != edgeEnd(partner, type))
+            {
+                CG_EdgeFlags[return_edge] &= ~CG_EDGE_ACTIVE;
+            }
+            else
+            {
+                return_edge = findEdge(partner, returnEdgeType(type), index);
+                if(return_edge != edgeEnd(partner, returnEdgeType(type)))
+                    CG_EdgeFlags[return_edge] |= CG_EDGE_MIRRORED;
+            }
+            CG_EdgeFlags[edge] &= ~CG_EDGE_ACTIVE;
+            CG_Ranks[4 * partner + type]--;
+            if(0 == getTotalRank(partner))
+                CG_Attached[partner] = false;
+        }
+    }
+    CG_Attached[index] = false;
+}
+
+int CrisprGraph::firstPartner(int index, EDGE_TYPE type)
+{
+    int first_partner = -1;
+    if(edgeBegin(index, type) < edgeEnd(index, type))
+        first_partner = CG_EdgeTarget[edgeBegin(index, type)];
+
+    EDGE_TYPE return_type = returnEdgeType(type);
+    for(unsigned int edge = edgeBegin(index, return_type); edge < edgeEnd(index, return_type); edge++)
+    {
+        int partner = CG_EdgeTarget[edge];
+        if(-1 != first_partner && partner >= first_partner)
+            break;
+        if(CG_EdgeFlags[edge] & CG_EDGE_MIRRORED)
+        {
+            first_partner = partner;
+            break;
+        }
+    }
+    return first_partner;
+}
+
+void CrisprGraph::addReadCoverage(int index, EDGE_TYPE type, std::map<StringToken, int>& countingMap)
+{
+    for(unsigned int edge = edgeBegin(index, type); edge < edgeEnd(index, type); edge++)
+    {
+        // check if he's attached
+        if(!isEdgeActive(edge))
+            continue;
+
+        CrisprNode * partner_node = CG_Nodes[CG_EdgeTarget[edge]];
+#ifdef DEBUG
+        logInfo("Edge: "<<partner_node->getID(), 10);
+#endif
+        // get the headers
+        std::vector<StringToken>::iterator inner_rh_iter = partner_node->beginHeaders();
+        std::vector<StringToken>::iterator inner_rh_last = partner_node->endHeaders();
+        while(inner_rh_iter != inner_rh_last)
+        {
+            std::map<StringToken, int>::iterator cm_iter = countingMap.find(*inner_rh_iter);
+            if(cm_iter != countingMap.end())
+            {
+                cm_iter->second++;
+#ifdef DEBUG
+                logInfo("\t\tIncrementing: "<<*inner_rh_iter<<" : "<<cm_iter->second, 10);
+#endif
+            }
+            inner_rh_iter++;
+        }
+    }
+}
+
+int CrisprGraph::getDiscountedCoverage(int index)
+{
+    //-----
+    // We test whether the reads for the nodes forward or
+    // backward of the current node are shared
+    // This prevents the coverage from being exadgerated
+    // if two different spacers share a kmer
+    //
+    CrisprNode * node = CG_Nodes[index];
+    std::map<StringToken, int> counting_map;
+
+    // initialise the counting map to inlcude all the reads we care about
+    std::vector<StringToken>::iterator rh_iter;
+    for(rh_iter = node->beginHeaders(); rh_iter != node->endHeaders(); ++rh_iter)
+    {
+        counting_map[*rh_iter] = 0;
+    }
+#ifdef DEBUG
+    logInfo("Node: "<<node->getID()<<" Headers size:"<<counting_map.size(), 10);
+#endif
+    // now update the counting map with reads found on the innner connecting nodes
+    if(node->isForward())
+    {
+        addReadCoverage(index, CN_EDGE_FORWARD, counting_map);
+        addReadCoverage(index, CN_EDGE_JUMPING_B, counting_map);
+    }
+    else
+    {
+        addReadCoverage(index, CN_EDGE_JUMPING_F, counting_map);
+        addReadCoverage(index, CN_EDGE_BACKWARD, counting_map);
+    }
+    int ret_val = 0;
+    std::map<StringToken, int>::iterator cm_iter;
+    for(cm_iter = counting_map.begin(); cm_iter != counting_map.end(); cm_iter++)
+    {
+        if(cm_iter->second > 1)
+            ret_val++;
+    }
+    return ret_val;
+}
+
+//
+// File IO / printing
+//
+void CrisprGraph::printEdgesOfType(int index,
+                                   EDGE_TYPE type,
+                                   std::ostream &dataOut,
+                                   StringCheck * ST,
+                                   std::string label,
+                                   bool showDetached,
+                                   bool longDesc)
+{
+    for(unsigned int edge = edgeBegin(index, type); edge < edgeEnd(index, type); edge++)
+    {
+        // check if the edge is active
+        if(isEdgeActive(edge) || showDetached)
+        {
+            CrisprNode * partner_node = CG_Nodes[CG_EdgeTarget[edge]];
+            std::stringstream ss;
+            if(longDesc)
+                ss << partner_node->getID() << "_" << ST->getString(partner_node->getID());
+            else
+                ss << partner_node->getID();
+            gvEdge(dataOut,label,ss.str());
+        }
+    }
+}
+
+void CrisprGraph::printEdges(int index,
+                             std::ostream &dataOut,
+                             StringCheck * ST,
+                             std::string label,
+                             bool showDetached,
+                             bool printBackEdges,
+                             bool longDesc)
+{
+    //-----
+    // print the edges so that the first member of the pair is first
+    //
+    printEdgesOfType(index, CN_EDGE_FORWARD, dataOut, ST, label, showDetached, longDesc);
+    printEdgesOfType(index, CN_EDGE_JUMPING_F, dataOut, ST, label, showDetached, longDesc);
+
+    if(printBackEdges)
+    {
+        printEdgesOfType(index, CN_EDGE_BACKWARD, dataOut, ST, label, showDetached, longDesc);
+        printEdgesOfType(index, CN_EDGE_JUMPING_B, dataOut, ST, label, showDetached, longDesc);
+    }
+}
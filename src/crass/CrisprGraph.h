@@ -0,0 +1,180 @@
+/*
+ *  CrisprGraph.h is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  The edges between the CrisprNodes of a NodeManager. Edges are only
+ *  collected while the reads are added; once they are all in the graph
+ *  is frozen into compressed sparse rows. Every node has an index and
+ *  the edges of one type for one node are a run of the edge arrays,
+ *  sorted by the index of the node at the other end. Nothing is added
+ *  or removed after that, detaching a node only flips bits and ranks,
+ *  which all live in flat arrays indexed by the node.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+#ifndef crass_CrisprGraph_h
+#define crass_CrisprGraph_h
+
+// system includes
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// local includes
+#include "CrisprNode.h"
+#include "StringCheck.h"
+
+class CrisprGraph
+{
+    public:
+        CrisprGraph(void) : CG_Frozen(false), CG_CompactAt(1024) {}
+        ~CrisprGraph(void) {}
+
+        //----
+        // Building
+        //
+        // give the node the next index
+        void addNode(CrisprNode * node);
+
+        // edges are one way, add the edge back as well. Adding the same
+        // edge twice is fine
+        void addEdge(CrisprNode * node, CrisprNode * partnerNode, EDGE_TYPE type);
+
+        // make the edge arrays, no edges can be added after this
+        void freeze(void);
+
+        inline bool isFrozen(void) { return CG_Frozen; }
+
+        //----
+        // Nodes
+        //
+        inline int size(void) { return static_cast<int>(CG_Nodes.size()); }
+
+        inline CrisprNode * getNode(int index) { return CG_Nodes[index]; }
+
+        inline bool isAttached(int index) { return CG_Attached[index]; }
+        inline bool isAttached(CrisprNode * node) { return CG_Attached[node->getIndex()]; }
+
+        void detachNode(int index);
+        inline void detachNode(CrisprNode * node) { detachNode(node->getIndex()); }
+
+        inline int getRank(int index, EDGE_TYPE type) { return CG_Ranks[4 * index + type]; }
+
+        inline int getInnerRank(int index)
+        {
+            return CG_Ranks[4 * index + CN_EDGE_BACKWARD] + CG_Ranks[4 * index + CN_EDGE_FORWARD];
+        }
+
+        inline int getJumpingRank(int index)
+        {
+            return CG_Ranks[4 * index + CN_EDGE_JUMPING_F] + CG_Ranks[4 * index + CN_EDGE_JUMPING_B];
+        }
+
+        inline int getTotalRank(int index) { return getInnerRank(index) + getJumpingRank(index); }
+
+        // Return a (possibly) lower version of the coverage used when
+        // removing bubbles
+        int getDiscountedCoverage(int index);
+
+        //----
+        // Edges, walk them with
+        // for (unsigned int edge = edgeBegin(i, type); edge < edgeEnd(i, type); edge++)
+        //
+        inline unsigned int edgeBegin(int index, EDGE_TYPE type) { return CG_EdgeStart[4 * index + type]; }
+
+        inline unsigned int edgeEnd(int index, EDGE_TYPE type) { return CG_EdgeStart[4 * index + type + 1]; }
+
+        // index of the node at the other end
+        inline int edgeTarget(unsigned int edge) { return CG_EdgeTarget[edge]; }
+
+        // an edge goes inactive when the node it comes from is detached
+        inline bool isEdgeActive(unsigned int edge) { return 0 != (CG_EdgeFlags[edge] & CG_EDGE_ACTIVE); }
+
+        // the lowest index joined to this node by an edge of this type,
+        // counting the nodes detached through an edge of the opposite
+        // type, -1 if there are none
+        int firstPartner(int index, EDGE_TYPE type);
+
+        //----
+        // File IO / printing
+        //
+        void printEdges(int index,
+                        std::ostream &dataOut,
+                        StringCheck * ST,
+                        std::string label,
+                        bool showDetached,
+                        bool printBackEdges,
+                        bool longDesc);
+
+    private:
+        enum {
+            CG_EDGE_ACTIVE = 1,                             // the node this edge comes from is attached
+            CG_EDGE_MIRRORED = 2                            // the partner was detached and now lists this node under the opposite type
+        };
+
+        typedef struct {
+            unsigned int node;
+            unsigned int partner;
+            unsigned int type;
+        } PendingEdge;
+
+        CrisprGraph(const CrisprGraph&);
+        CrisprGraph& operator=(const CrisprGraph&);
+
+        static bool pendingLess(const PendingEdge& a, const PendingEdge& b);
+        static bool pendingEqual(const PendingEdge& a, const PendingEdge& b);
+        void compactPending(void);
+
+        // find the edge between these two nodes, edgeEnd if there is none
+        unsigned int findEdge(int index, EDGE_TYPE type, int partner);
+
+        void addReadCoverage(int index, EDGE_TYPE type, std::map<StringToken, int>& countingMap);
+
+        void printEdgesOfType(int index,
+                              EDGE_TYPE type,
+                              std::ostream &dataOut,
+                              StringCheck * ST,
+                              std::string label,
+                              bool showDetached,
+                              bool longDesc);
+
+        bool CG_Frozen;
+        std::vector<PendingEdge> CG_Pending;                // edges added before freezing
+        size_t CG_CompactAt;                                // drop duplicate pending edges when there are this many
+
+        std::vector<CrisprNode *> CG_Nodes;                 // indexed by node
+        std::vector<bool> CG_Attached;
+        std::vector<int> CG_Ranks;                          // four per node, indexed by EDGE_TYPE
+        std::vector<unsigned int> CG_EdgeStart;             // four per node plus one, the edges of a type are [start, next start)
+        std::vector<unsigned int> CG_EdgeTarget;            // index of the partner node
+        std::vector<unsigned char> CG_EdgeFlags;            // CG_EDGE_ACTIVE | CG_EDGE_MIRRORED
+};
+
+#endif //crass_CrisprGraph_h
@@ -37,314 +37,20 @@
 // system includes
 #include <vector>
 #include <string>
-#include <sstream>
 #include <fstream>
 
 // local includes
 #include "CrisprNode.h"
-#include "LoggerSimp.h"
 #include "crassDefines.h"
-#include "GraphDrawingDefines.h"
 #include "Rainbow.h"
 #include "StringCheck.h"
 #include "libcrispr.h"
 #include "ReadHolder.h"
 #include <libcrispr/Exception.h>
 
-//
-// Edge level functions
-//
-bool CrisprNode::addEdge(CrisprNode * parterNode, EDGE_TYPE type)
-{
-    //-----
-    // Add a new edge return success if the partner has been added
-    // 
-    
-    // get the right edge list
-    edgeList * add_list = getEdges(type);
-    
-    // now see we haven't added it before
-    if(add_list->find(parterNode) == add_list->end())
-    {
-        // new guy
-        (*add_list)[parterNode] = true;
-        switch(type)
-        {
-            case CN_EDGE_FORWARD:
-                mInnerRank_F++;
-                break;
-            case CN_EDGE_BACKWARD:
-                mInnerRank_B++;
-                break;
-            case CN_EDGE_JUMPING_F:
-                mJumpingRank_F++;
-                break;
-            case CN_EDGE_JUMPING_B:
-                mJumpingRank_B++;
-                break;
-            default:
-            	throw crispr::runtime_exception(__FILE__,
-                                                __LINE__,
-                                                __PRETTY_FUNCTION__,
-                                                "Unknown edge type");
-        }
-        return true;
-    }
-    return false;
-}
-
-edgeList * CrisprNode::getEdges(EDGE_TYPE type)
-{
-    //-----
-    // get edges of a particular type
-    //
-    switch(type)
-    {
-        case CN_EDGE_FORWARD:
-            return &mForwardEdges;
-        case CN_EDGE_BACKWARD:
-            return &mBackwardEdges;
-        case CN_EDGE_JUMPING_F:
-            return &mJumpingForwardEdges;
-        case CN_EDGE_JUMPING_B:
-            return &mJumpingBackwardEdges;
-        default:
-            throw crispr::runtime_exception(__FILE__,
-                                            __LINE__,
-                                            __PRETTY_FUNCTION__,
-                                            "Unknown edge type");
-    }
-}
-
-void CrisprNode::calculateReadCoverage(edgeList * currentList, std::map<StringToken, int>& countingMap)
-{
-    edgeListIterator eli;
-    for (eli = currentList->begin(); eli != currentList->end(); eli++)
-    {
-    	// check if he's attached
-    	if(! eli->second)
-    	{
-            continue;
-        }
-#ifdef DEBUG
-        logInfo("Edge: "<<(eli->first)->getID(), 10);
-#endif
-        // get the headers
-        std::vector<StringToken> * inner_headers = (eli->first)->getReadHeaders();
-        std::vector<StringToken>::iterator inner_rh_iter = inner_headers->begin();
-        std::vector<StringToken>::iterator inner_rh_last = inner_headers->end();
-        while(inner_rh_iter != inner_rh_last)
-        {
-            if(countingMap.find(*inner_rh_iter) != countingMap.end()) {
-                countingMap[*inner_rh_iter]++;
-#ifdef DEBUG
-                logInfo("\t\tIncrementing: "<<*inner_rh_iter<<" : "<<countingMap[*inner_rh_iter], 10);
-#endif
-            }
-            inner_rh_iter++;
-        }
-    }
-}
-
-
-int CrisprNode::getDiscountedCoverage(void)
-{
-	//-----
-	// Return a (possibly) lower version of the coverage
-	// used when removing bubbles
-	//
-    // We test whether the reads for the nodes forward or
-    // backward of the current node are shared
-    // This prevents the coverage from being exadgerated 
-    // if two different spacers share a kmer
-	std::map<StringToken, int> counting_map;
-	
-	// initialise the counting map to inlcude all the reads we care about
-	std::vector<StringToken>::iterator rh_iter = mReadHeaders.begin();
-	for (rh_iter = mReadHeaders.begin(); rh_iter != mReadHeaders.end(); ++rh_iter) {
-		counting_map[*rh_iter] = 0;
-#ifdef DEBUG
-        logInfo("Node :"<<mid<<" Header: "<<*rh_iter, 10);
-#endif
-	}
-#ifdef DEBUG
-    logInfo("Node: "<<mid<<" Headers size:"<<mReadHeaders.size(), 10);
-    logInfo("\tForward: "<<mForwardEdges.size(), 10);
-    logInfo("\tBackward: "<<mBackwardEdges.size(), 10);
-    logInfo("\tJForward: "<<mJumpingForwardEdges.size(), 10);
-    logInfo("\tJBackward: "<<mJumpingBackwardEdges.size(), 10);
-#endif
-	// now update the counting map with reads found on the innner connecting nodes -> perhaps one of these lists is empty?
-    if(mIsForward) {
-        // first forward
-         calculateReadCoverage(&mForwardEdges, counting_map);
-        // then backward
-         calculateReadCoverage(&mJumpingBackwardEdges, counting_map);	
-    } else {
-        // first forward
-         calculateReadCoverage(&mJumpingForwardEdges, counting_map);
-        // then backward
-         calculateReadCoverage(&mBackwardEdges, counting_map);	
-    }    
-    int ret_val = 0;
-    std::map<StringToken, int>::iterator cm_iter = counting_map.begin();
-    std::map<StringToken, int>::iterator cm_last = counting_map.end();
-    while(cm_iter != cm_last)
-    {
-    	if(cm_iter->second > 1)
-    		ret_val++;
-    	cm_iter++;
-    }
-    
-    return ret_val;
-}
-
-
-//
-// Node level functions
-//
-void CrisprNode::setEdgeAttachState(edgeList * currentList, bool attachState, EDGE_TYPE currentType)
-{
-    edgeListIterator eli;
-    for (eli = currentList->begin(); eli != currentList->end(); eli++) {
-
-        // go through each edge, check if it's not the right state
-        if((eli->second ^ attachState) && (eli->first)->isAttached())
-        {
-            // this edge is not the right state and the corresponding node is actually attached
-            edgeList * other_eli = (eli->first)->getEdges(currentType);
-            (*other_eli)[this] = attachState;
-            eli->second = attachState;
-            (eli->first)->updateRank(attachState, currentType);
-            if((eli->first)->getTotalRank() == 0)
-            	(eli->first)->setAsDetached();
-        }
-    }
-}
-
-void CrisprNode::setAttach(bool attachState)
-{
-    //-----
-    // detach or re-attach this node
-    //
-    
-    // find and attached nodes and set the edges to attachState
-    setEdgeAttachState(&mForwardEdges, attachState, CN_EDGE_FORWARD);
-
-    setEdgeAttachState(&mBackwardEdges, attachState, CN_EDGE_BACKWARD);
-
-    setEdgeAttachState(&mJumpingForwardEdges, attachState, CN_EDGE_JUMPING_F);
-
-    setEdgeAttachState(&mJumpingBackwardEdges, attachState, CN_EDGE_JUMPING_B);
-    
-    // set our state
-    mAttached =  attachState;       
-}
-
-int CrisprNode::getRank(EDGE_TYPE type)
-{
-    //-----
-    // return the rank of the node
-    //
-    switch(type)
-    {
-        case CN_EDGE_FORWARD:
-            return mInnerRank_F;
-        case CN_EDGE_BACKWARD:
-            return mInnerRank_B;
-        case CN_EDGE_JUMPING_F:
-            return mJumpingRank_F;
-        case CN_EDGE_JUMPING_B:
-            return mJumpingRank_B;
-        default:
-            throw crispr::runtime_exception(__FILE__,
-                                            __LINE__,
-                                            __PRETTY_FUNCTION__,
-                                            "Unknown edge type");
-    }
-}
-
-void CrisprNode::updateRank(bool attachState, EDGE_TYPE type)
-{
-    //-----
-	// increment or decrement the rank of this type
-    //
-	int increment = -1;
-	if(attachState)
-		increment = 1;
-	switch(type)
-	{
-		case CN_EDGE_FORWARD:
-			mInnerRank_F += increment;
-            break;
-		case CN_EDGE_BACKWARD:
-			mInnerRank_B += increment;
-            break;
-		case CN_EDGE_JUMPING_F:
-			mJumpingRank_F += increment;
-            break;
-		case CN_EDGE_JUMPING_B:
-			mJumpingRank_B += increment;
-            break;
-        default:
-        	throw crispr::runtime_exception(__FILE__,
-                                            __LINE__,
-                                            __PRETTY_FUNCTION__,
-                                            "Unknown edge type");
-	}
-}
-
 //
 // File IO / printing
 //
-void CrisprNode::printEdgesForList(edgeList * currentList,
-                       std::ostream &dataOut,
-                       StringCheck * ST,
-                       std::string label, 
-                       bool showDetached, 
-                       bool longDesc)
-{
-    edgeListIterator eli; 
-    for (eli = currentList->begin(); eli != currentList->end(); eli++) {
-        // check if the edge is active
-        if((eli->second) || showDetached)
-        {
-        	std::stringstream ss;
-        	if(longDesc)
-        		ss << (eli->first)->getID() << "_" << ST->getString((eli->first)->getID());
-        	else
-        		ss << (eli->first)->getID();
-            gvEdge(dataOut,label,ss.str());
-        }
-    }
-}
-
-
-
-void CrisprNode::printEdges(std::ostream &dataOut, 
-                            StringCheck * ST, 
-                            std::string label, 
-                            bool showDetached, 
-                            bool printBackEdges, 
-                            bool longDesc)
-{
-    //-----
-    // print the edges so that the first member of the pair is first
-    //
-        
-    // now print the edges
-    printEdgesForList(&mForwardEdges, dataOut, ST, label, showDetached, longDesc);
-    printEdgesForList(&mJumpingForwardEdges, dataOut, ST, label, showDetached, longDesc);
-    
-    if(printBackEdges)
-    {
-        printEdgesForList(&mBackwardEdges, dataOut, ST, label, showDetached, longDesc);
-
-        printEdgesForList(&mJumpingBackwardEdges, dataOut, ST, label, showDetached, longDesc);
-
-    }
-}
-
 std::vector<std::string> CrisprNode::getReadHeaders(StringCheck * ST)
 {
 	//-----
@@ -0,0 +1,434 @@
+/*
+ *  DRClusterer.cpp is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+// system includes
+#include <algorithm>
+
+// local includes
+#include "DRClusterer.h"
+#include "ThreadPool.h"
+
+//
+// ConcurrentUnionFind
+//
+ConcurrentUnionFind::ConcurrentUnionFind(int size) : 
+    UF_Parent(size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        UF_Parent[i] = i;
+    }
+}
+
+int ConcurrentUnionFind::find(int element)
+{
+    //-----
+    // path halving, a lost race only means the path stays a bit longer
+    //
+    int parent = parentOf(element);
+    while (parent != element)
+    {
+        int grand_parent = parentOf(parent);
+        if (grand_parent != parent)
+        {
+            __sync_bool_compare_and_swap(&(UF_Parent[element]), parent, grand_parent);
+        }
+        element = grand_parent;
+        parent = parentOf(element);
+    }
+    return element;
+}
+
+void ConcurrentUnionFind::join(int a, int b)
+{
+    //-----
+    // hang the larger root off the smaller one. If another thread moved
+    // the larger root first then look again
+    //
+    while (true)
+    {
+        a = find(a);
+        b = find(b);
+        if (a == b)
+        {
+            return;
+        }
+        if (a > b)
+        {
+            std::swap(a, b);
+        }
+        if (__sync_bool_compare_and_swap(&(UF_Parent[b]), b, a))
+        {
+            return;
+        }
+    }
+}
+
+//
+// The three passes, each thread takes every numThreads'th item
+//
+class KmerCuttingTask : public ThreadTask
+{
+    public:
+        KmerCuttingTask(DRClusterer * clusterer) : mClusterer(clusterer) {}
+
+        void run(int threadNumber)
+        {
+            int num_sequences = static_cast<int>(mClusterer->DC_Kmers.size());
+            for (int i = threadNumber; i < num_sequences; i += mClusterer->DC_NumThreads)
+            {
+                mClusterer->cutKmers(i);
+            }
+        }
+
+    private:
+        DRClusterer * mClusterer;
+};
+
+class KmerJoiningTask : public ThreadTask
+{
+    public:
+        KmerJoiningTask(DRClusterer * clusterer) : mClusterer(clusterer) {}
+
+        void run(int threadNumber)
+        {
+            int num_sequences = static_cast<int>(mClusterer->DC_Kmers.size());
+            std::vector<int> shared_counts(num_sequences, 0);
+            std::vector<int> touched;
+            for (int i = threadNumber; i < num_sequences; i += mClusterer->DC_NumThreads)
+            {
+                mClusterer->joinSequence(i, shared_counts, touched);
+            }
+        }
+
+    private:
+        DRClusterer * mClusterer;
+};
+
+class KmerCountingTask : public ThreadTask
+{
+    public:
+        KmerCountingTask(DRClusterer * clusterer) : mClusterer(clusterer) {}
+
+        void run(int threadNumber)
+        {
+            int num_clusters = static_cast<int>(mClusterer->DC_Clusters->size());
+            for (int i = threadNumber; i < num_clusters; i += mClusterer->DC_NumThreads)
+            {
+                mClusterer->countKmers(i);
+            }
+        }
+
+    private:
+        DRClusterer * mClusterer;
+};
+
+//
+// DRClusterer
+//
+DRClusterer::DRClusterer(unsigned int kmerLength, int minSharedKmers, int numThreads) : 
+    DC_KmerLength(kmerLength),
+    DC_MinShared((minSharedKmers < 1) ? 1 : minSharedKmers),
+    DC_NumThreads((numThreads < 1) ? 1 : numThreads),
+    DC_Sequences(NULL),
+    DC_Sets(NULL),
+    DC_Clusters(NULL),
+    DC_KmerCounts(NULL)
+{}
+
+bool DRClusterer::postingLess(const KmerPosting& a, const KmerPosting& b)
+{
+    if (a.kmer != b.kmer)
+    {
+        return a.kmer < b.kmer;
+    }
+    return a.sequence < b.sequence;
+}
+
+void DRClusterer::cluster(const std::vector<std::string>& sequences,
+                          std::vector<std::vector<int> >& clusters,
+                          std::vector<KmerHashMap<int> >& kmerCounts)
+{
+    int num_sequences = static_cast<int>(sequences.size());
+    ThreadPool pool(DC_NumThreads);
+    DC_Sequences = &sequences;
+    DC_Kmers.assign(num_sequences, std::vector<PackedKmer>());
+    DC_UniqueKmers.assign(num_sequences, std::vector<PackedKmer>());
+
+    // cut the kmers
+    KmerCuttingTask cutting_task(this);
+    pool.run(&cutting_task);
+
+    //-----
+    // one posting for each different kmer of each sequence. A sequence
+    // with fewer different kmers than need to be shared can't join
+    // anything so it gets none
+    //
+    DC_Postings.clear();
+    for (int i = 0; i < num_sequences; i++)
+    {
+        if (static_cast<int>(DC_UniqueKmers[i].size()) < DC_MinShared)
+        {
+            continue;
+        }
+        for (size_t j = 0; j < DC_UniqueKmers[i].size(); j++)
+        {
+            KmerPosting posting;
+            posting.kmer = DC_UniqueKmers[i][j];
+            posting.sequence = i;
+            DC_Postings.push_back(posting);
+        }
+    }
+    std::sort(DC_Postings.begin(), DC_Postings.end(), postingLess);
+    DC_NextPosting.resize(DC_Postings.size());
+    for (size_t i = 0; i < DC_NextPosting.size(); i++)
+    {
+        DC_NextPosting[i] = static_cast<int>(i) + 1;
+    }
+
+    // join the sequences that share enough kmers
+    ConcurrentUnionFind sets(num_sequences);
+    DC_Sets = &sets;
+    KmerJoiningTask joining_task(this);
+    pool.run(&joining_task);
+
+    //-----
+    // the root of a set is its first sequence so walking the sequences in
+    // order makes the clusters in the order of their first member
+    //
+    clusters.clear();
+    std::vector<int> cluster_of_root(num_sequences, -1);
+    for (int i = 0; i < num_sequences; i++)
+    {
+        int root = sets.find(i);
+        if (-1 == cluster_of_root[root])
+        {
+            cluster_of_root[root] = static_cast<int>(clusters.size());
+            clusters.push_back(std::vector<int>());
+        }
+        clusters[cluster_of_root[root]].push_back(i);
+    }
+
+    // count the kmers of each cluster
+    kmerCounts.clear();
+    kmerCounts.resize(clusters.size());
+    DC_Clusters = &clusters;
+    DC_KmerCounts = &kmerCounts;
+    KmerCountingTask counting_task(this);
+    pool.run(&counting_task);
+
+    std::vector<std::vector<PackedKmer> >().swap(DC_Kmers);
+    std::vector<std::vector<PackedKmer> >().swap(DC_UniqueKmers);
+    std::vector<KmerPosting>().swap(DC_Postings);
+    std::vector<int>().swap(DC_NextPosting);
+    DC_Sequences = NULL;
+    DC_Sets = NULL;
+    DC_Clusters = NULL;
+    DC_KmerCounts = NULL;
+}
+
+void DRClusterer::cutKmers(int sequence)
+{
+    //-----
+    // Kmers with anything other than ACGT in them don't say anything
+    // about the group
+    //
+    const std::string& seq = (*DC_Sequences)[sequence];
+    std::vector<PackedKmer>& kmers = DC_Kmers[sequence];
+    RollingKmer rolling_kmer(DC_KmerLength);
+    for (size_t i = 0; i < seq.length(); i++)
+    {
+        if (rolling_kmer.push(seq[i]))
+        {
+            kmers.push_back(rolling_kmer.canonical());
+        }
+    }
+    std::vector<PackedKmer>& unique_kmers = DC_UniqueKmers[sequence];
+    unique_kmers.assign(kmers.begin(), kmers.end());
+    std::sort(unique_kmers.begin(), unique_kmers.end());
+    unique_kmers.erase(std::unique(unique_kmers.begin(), unique_kmers.end()), unique_kmers.end());
+}
+
+int DRClusterer::postingOf(PackedKmer kmer, int sequence)
+{
+    KmerPosting posting;
+    posting.kmer = kmer;
+    posting.sequence = sequence;
+    return static_cast<int>(std::lower_bound(DC_Postings.begin(), DC_Postings.end(), posting, postingLess) - DC_Postings.begin());
+}
+
+bool DRClusterer::sharesEnough(int a, int b)
+{
+    std::vector<PackedKmer>& kmers_a = DC_UniqueKmers[a];
+    std::vector<PackedKmer>& kmers_b = DC_UniqueKmers[b];
+    size_t i = 0;
+    size_t j = 0;
+    int shared = 0;
+    while (i < kmers_a.size() && j < kmers_b.size())
+    {
+        if (kmers_a[i] < kmers_b[j])
+        {
+            i++;
+        }
+        else if (kmers_b[j] < kmers_a[i])
+        {
+            j++;
+        }
+        else
+        {
+            if (++shared == DC_MinShared)
+            {
+                return true;
+            }
+            i++;
+            j++;
+        }
+    }
+    return false;
+}
+
+int DRClusterer::skipJoined(int posting, int end, int sequence)
+{
+    //-----
+    // Every posting from posting up to DC_NextPosting[posting] is in the
+    // same set as posting. Sets never split so that stays true, and
+    // stretches that are in the same set as this sequence are glued
+    // together for the ones that come after
+    //
+    int next = nextPostingOf(posting);
+    while (next < end && DC_Sets->find(DC_Postings[next].sequence) == DC_Sets->find(sequence))
+    {
+        next = nextPostingOf(next);
+    }
+    int current;
+    while ((current = nextPostingOf(posting)) < next)
+    {
+        if (__sync_bool_compare_and_swap(&(DC_NextPosting[posting]), current, next))
+        {
+            break;
+        }
+    }
+    return next;
+}
+
+void DRClusterer::joinSequence(int sequence, std::vector<int>& sharedCounts, std::vector<int>& touched)
+{
+    //-----
+    // Only the earlier sequences are looked at, the later ones look back
+    // at this one. Sequences that are already in the same set as this one
+    // are skipped, sets never split
+    //
+    std::vector<PackedKmer>& kmers = DC_UniqueKmers[sequence];
+    if (static_cast<int>(kmers.size()) < DC_MinShared)
+    {
+        return;
+    }
+
+    //-----
+    // Most of the time a sequence shares a lot with the one before it on
+    // the same kmer. Checking those pairs first joins this sequence to
+    // its group straight away, so the walk below can step over the group
+    // instead of counting up every member of it
+    //
+    std::vector<PackedKmer>::iterator kmer_iter;
+    for (kmer_iter = kmers.begin(); kmer_iter != kmers.end(); kmer_iter++)
+    {
+        int posting = postingOf(*kmer_iter, sequence);
+        if (0 == posting || DC_Postings[posting - 1].kmer != *kmer_iter)
+        {
+            continue;
+        }
+        int other = DC_Postings[posting - 1].sequence;
+        if (0 != sharedCounts[other])
+        {
+            continue;
+        }
+        sharedCounts[other] = 1;
+        touched.push_back(other);
+        if (DC_Sets->find(other) != DC_Sets->find(sequence) && sharesEnough(other, sequence))
+        {
+            DC_Sets->join(other, sequence);
+        }
+    }
+    for (size_t i = 0; i < touched.size(); i++)
+    {
+        sharedCounts[touched[i]] = 0;
+    }
+    touched.clear();
+
+    // count the kmers shared with every earlier sequence in another set
+    for (kmer_iter = kmers.begin(); kmer_iter != kmers.end(); kmer_iter++)
+    {
+        int posting = postingOf(*kmer_iter, 0);
+
+        // the posting for this sequence ends the run
+        int end = postingOf(*kmer_iter, sequence);
+        while (posting < end)
+        {
+            int other = DC_Postings[posting].sequence;
+            if (DC_Sets->find(other) == DC_Sets->find(sequence))
+            {
+                posting = skipJoined(posting, end, sequence);
+                continue;
+            }
+            if (0 == sharedCounts[other])
+            {
+                touched.push_back(other);
+            }
+            if (++sharedCounts[other] == DC_MinShared)
+            {
+                DC_Sets->join(other, sequence);
+            }
+            posting++;
+        }
+    }
+    for (size_t i = 0; i < touched.size(); i++)
+    {
+        sharedCounts[touched[i]] = 0;
+    }
+    touched.clear();
+}
+
+void DRClusterer::countKmers(int cluster)
+{
+    KmerHashMap<int>& counts = (*DC_KmerCounts)[cluster];
+    std::vector<int>::iterator member_iter;
+    for (member_iter = (*DC_Clusters)[cluster].begin(); member_iter != (*DC_Clusters)[cluster].end(); member_iter++)
+    {
+        std::vector<PackedKmer>::iterator kmer_iter;
+        for (kmer_iter = DC_Kmers[*member_iter].begin(); kmer_iter != DC_Kmers[*member_iter].end(); kmer_iter++)
+        {
+            counts[*kmer_iter]++;
+        }
+    }
+}
@@ -0,0 +1,139 @@
+/*
+ *  DRClusterer.h is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Groups DR variants that share kmers. The laurenized kmers of every
+ *  variant are cut on all threads, then every pair of variants with at
+ *  least the minimum number of kmers in common is joined in a union-find
+ *  the threads share. A cluster is a connected component, so which
+ *  thread gets to a pair first makes no difference to the clusters.
+ *  Variants already in the same set are stepped over a stretch at a
+ *  time, so one big family clusters in close to linear time.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+#ifndef crass_DRClusterer_h
+#define crass_DRClusterer_h
+
+// system includes
+#include <string>
+#include <vector>
+
+// local includes
+#include "PackedKmer.h"
+
+//-----
+// A union-find on ints that any number of threads can join at once. The
+// root of a set is always its smallest member
+//
+class ConcurrentUnionFind
+{
+    public:
+        ConcurrentUnionFind(int size);
+
+        int find(int element);
+
+        void join(int a, int b);
+
+    private:
+        ConcurrentUnionFind(const ConcurrentUnionFind&);
+        ConcurrentUnionFind& operator=(const ConcurrentUnionFind&);
+
+        inline int parentOf(int element) { return *static_cast<volatile int *>(&(UF_Parent[element])); }
+
+        std::vector<int> UF_Parent;
+};
+
+class DRClusterer
+{
+    public:
+        DRClusterer(unsigned int kmerLength, int minSharedKmers, int numThreads);
+
+        //-----
+        // Clusters hold indexes into sequences, both the clusters and the
+        // members of each one are in the order of their first index.
+        // kmerCounts holds the count of every kmer cut from the members
+        // of the cluster at the same place in clusters
+        //
+        void cluster(const std::vector<std::string>& sequences,
+                     std::vector<std::vector<int> >& clusters,
+                     std::vector<KmerHashMap<int> >& kmerCounts);
+
+    private:
+        friend class KmerCuttingTask;
+        friend class KmerJoiningTask;
+        friend class KmerCountingTask;
+
+        // a kmer cut from one of the sequences
+        struct KmerPosting
+        {
+            PackedKmer kmer;
+            int sequence;
+        };
+
+        DRClusterer(const DRClusterer&);
+        DRClusterer& operator=(const DRClusterer&);
+
+        static bool postingLess(const KmerPosting& a, const KmerPosting& b);
+
+        // every kmer of the sequence in order, repeats and all, and the
+        // sorted kmers without repeats
+        void cutKmers(int sequence);
+
+        // the first posting at or after the kmer and sequence
+        int postingOf(PackedKmer kmer, int sequence);
+
+        // true if the two sequences have at least DC_MinShared kmers in common
+        bool sharesEnough(int a, int b);
+
+        // the next posting of the run that may not be in the same set as
+        // the sequence, stopping at end
+        int skipJoined(int posting, int end, int sequence);
+
+        inline int nextPostingOf(int posting) { return *static_cast<volatile int *>(&(DC_NextPosting[posting])); }
+
+        // join the sequence to the earlier sequences it shares enough kmers with
+        void joinSequence(int sequence, std::vector<int>& sharedCounts, std::vector<int>& touched);
+
+        void countKmers(int cluster);
+
+        unsigned int DC_KmerLength;
+        int DC_MinShared;
+        int DC_NumThreads;
+
+        const std::vector<std::string> * DC_Sequences;
+        std::vector<std::vector<PackedKmer> > DC_Kmers;     // indexed by sequence
+        std::vector<std::vector<PackedKmer> > DC_UniqueKmers;
+        std::vector<KmerPosting> DC_Postings;               // sorted by kmer then sequence, no repeats
+        std::vector<int> DC_NextPosting;                    // the postings from here to there are in one set
+        ConcurrentUnionFind * DC_Sets;
+        std::vector<std::vector<int> > * DC_Clusters;
+        std::vector<KmerHashMap<int> > * DC_KmerCounts;
+};
+
+#endif //crass_DRClusterer_h
@@ -0,0 +1,259 @@
+/*
+ *  InputReaders.cpp is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+// system includes
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <libcrispr/Exception.h>
+
+// local includes
+#include "InputReaders.h"
+#include "crassDefines.h"
+
+// views are handed to kseq as ints
+#define MAX_VIEW_SIZE (1 << 30)
+
+MappedFileReader::MappedFileReader(void) :
+    MF_Fd(-1),
+    MF_Data(NULL),
+    MF_Size(0),
+    MF_Pos(0)
+{}
+
+MappedFileReader::~MappedFileReader(void)
+{
+    close();
+}
+
+bool MappedFileReader::open(const char * fileName)
+{
+    MF_Fd = ::open(fileName, O_RDONLY);
+    if (MF_Fd < 0)
+    {
+        return false;
+    }
+    struct stat file_stat;
+    if (0 != fstat(MF_Fd, &file_stat) || !S_ISREG(file_stat.st_mode) || 0 == file_stat.st_size)
+    {
+        close();
+        return false;
+    }
+    void * map = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, MF_Fd, 0);
+    if (MAP_FAILED == map)
+    {
+        close();
+        return false;
+    }
+    madvise(map, file_stat.st_size, MADV_SEQUENTIAL);
+    MF_Data = static_cast<char *>(map);
+    MF_Size = file_stat.st_size;
+    return true;
+}
+
+void MappedFileReader::close(void)
+{
+    if (NULL != MF_Data)
+    {
+        munmap(MF_Data, MF_Size);
+        MF_Data = NULL;
+    }
+    if (MF_Fd >= 0)
+    {
+        ::close(MF_Fd);
+        MF_Fd = -1;
+    }
+}
+
+int MappedFileReader::viewCallback(void * handle, char ** buf)
+{
+    MappedFileReader * reader = static_cast<MappedFileReader *>(handle);
+    uint64_t len = reader->MF_Size - reader->MF_Pos;
+    if (len > MAX_VIEW_SIZE)
+    {
+        len = MAX_VIEW_SIZE;
+    }
+    *buf = reader->MF_Data + reader->MF_Pos;
+    reader->MF_Pos += len;
+    return static_cast<int>(len);
+}
+
+void ReadAheadTask::run(int)
+{
+    mReader->fillChunks();
+}
+
+ReadAheadReader::ReadAheadReader(void) :
+    RA_Fd(-1),
+    RA_Free(CRASS_DEF_READ_AHEAD_CHUNKS),
+    RA_Full(CRASS_DEF_READ_AHEAD_CHUNKS),
+    RA_Current(NULL),
+    RA_Pool(NULL),
+    RA_Task(NULL)
+{}
+
+ReadAheadReader::~ReadAheadReader(void)
+{
+    close();
+}
+
+bool ReadAheadReader::open(const char * fileName)
+{
+    RA_Fd = ::open(fileName, O_RDONLY);
+    if (RA_Fd < 0)
+    {
+        return false;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(RA_Fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    for (int i = 0; i < CRASS_DEF_READ_AHEAD_CHUNKS; i++)
+    {
+        Chunk * chunk = new Chunk();
+        chunk->data.resize(CRASS_DEF_READ_AHEAD_SIZE);
+        chunk->length = 0;
+        RA_Chunks.push_back(chunk);
+        RA_Free.push(chunk);
+    }
+    RA_Task = new ReadAheadTask(this);
+    RA_Pool = new ThreadPool(1);
+    RA_Pool->start(RA_Task);
+    return true;
+}
+
+void ReadAheadReader::fillChunks(void)
+{
+    //-----
+    // keep reading until the end of the file or until the reader is closed.
+    // errors can't be thrown from here so they are passed on with the
+    // end of file marker
+    //
+    Chunk * chunk;
+    while (RA_Free.pop(chunk))
+    {
+        chunk->length = 0;
+        while (chunk->length < CRASS_DEF_READ_AHEAD_SIZE)
+        {
+            ssize_t got = ::read(RA_Fd, &(chunk->data[chunk->length]), CRASS_DEF_READ_AHEAD_SIZE - chunk->length);
+            if (got < 0)
+            {
+                if (EINTR == errno)
+                {
+                    continue;
+                }
+                RA_Error = strerror(errno);
+                chunk->length = 0;
+                break;
+            }
+            if (0 == got)
+            {
+                break;
+            }
+            chunk->length += static_cast<int>(got);
+        }
+        bool last = (chunk->length < CRASS_DEF_READ_AHEAD_SIZE);
+        if (!RA_Full.push(chunk) || last)
+        {
+            break;
+        }
+    }
+    // a short chunk is the last one, make sure an empty one follows it
+    if (RA_Free.pop(chunk))
+    {
+        chunk->length = 0;
+        RA_Full.push(chunk);
+    }
+}
+
+void ReadAheadReader::close(void)
+{
+    if (NULL != RA_Pool)
+    {
+        RA_Free.close();
+        RA_Full.close();
+        try {
+            RA_Pool->join();
+        } catch (crispr::exception& e) {
+            // the reading thread doesn't throw
+        }
+        delete RA_Pool;
+        RA_Pool = NULL;
+    }
+    delete RA_Task;
+    RA_Task = NULL;
+    for (size_t i = 0; i < RA_Chunks.size(); i++)
+    {
+        delete RA_Chunks[i];
+    }
+    RA_Chunks.clear();
+    RA_Current = NULL;
+    if (RA_Fd >= 0)
+    {
+        ::close(RA_Fd);
+        RA_Fd = -1;
+    }
+}
+
+int ReadAheadReader::viewCallback(void * handle, char ** buf)
+{
+    ReadAheadReader * reader = static_cast<ReadAheadReader *>(handle);
+    if (NULL != reader->RA_Current)
+    {
+        // kseq has finished with it
+        reader->RA_Free.push(reader->RA_Current);
+        reader->RA_Current = NULL;
+    }
+    Chunk * chunk;
+    if (!reader->RA_Full.pop(chunk))
+    {
+        return 0;
+    }
+    if (0 == chunk->length)
+    {
+        reader->RA_Free.push(chunk);
+        if (!reader->RA_Error.empty())
+        {
+            throw crispr::exception(__FILE__,
+                                    __LINE__,
+                                    __PRETTY_FUNCTION__,
+                                    ("Could not read input file: " + reader->RA_Error).c_str());
+        }
+        return 0;
+    }
+    reader->RA_Current = chunk;
+    *buf = &(chunk->data[0]);
+    return chunk->length;
+}
@@ -0,0 +1,126 @@
+/*
+ *  InputReaders.h is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Ways of getting an uncompressed file to kseq without going through
+ *  zlib. Both hand kseq views of their own memory so nothing is copied
+ *  into the kstream buffer. MappedFileReader maps the whole file,
+ *  ReadAheadReader reads large chunks on a second thread so that the
+ *  disk is kept busy while the current chunk is being parsed.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+#ifndef crass_InputReaders_h
+#define crass_InputReaders_h
+
+// system includes
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// local includes
+#include "ThreadPool.h"
+
+class MappedFileReader
+{
+    public:
+        MappedFileReader(void);
+        ~MappedFileReader(void);
+
+        // false if the file is not a regular file or can't be mapped
+        bool open(const char * fileName);
+
+        // kseq view callback, handle is a MappedFileReader
+        static int viewCallback(void * handle, char ** buf);
+
+    private:
+        MappedFileReader(const MappedFileReader&);
+        MappedFileReader& operator=(const MappedFileReader&);
+
+        void close(void);
+
+        int MF_Fd;
+        char * MF_Data;
+        uint64_t MF_Size;
+        uint64_t MF_Pos;                                    // start of the next view
+};
+
+class ReadAheadReader;
+
+// the reading side of a ReadAheadReader
+class ReadAheadTask : public ThreadTask
+{
+    public:
+        ReadAheadTask(ReadAheadReader * reader) : mReader(reader) {}
+
+        void run(int threadNumber);
+
+    private:
+        ReadAheadReader * mReader;
+};
+
+class ReadAheadReader
+{
+    public:
+        ReadAheadReader(void);
+        ~ReadAheadReader(void);
+
+        // false if the file can't be opened
+        bool open(const char * fileName);
+
+        // kseq view callback, handle is a ReadAheadReader
+        static int viewCallback(void * handle, char ** buf);
+
+    private:
+        friend class ReadAheadTask;
+
+        struct Chunk
+        {
+            std::vector<char> data;
+            int length;                                     // 0 marks the end of the file
+        };
+
+        ReadAheadReader(const ReadAheadReader&);
+        ReadAheadReader& operator=(const ReadAheadReader&);
+
+        // called on the reading thread
+        void fillChunks(void);
+
+        void close(void);
+
+        int RA_Fd;
+        std::vector<Chunk *> RA_Chunks;
+        WorkQueue<Chunk *> RA_Free;                         // chunks waiting to be read into
+        WorkQueue<Chunk *> RA_Full;                         // chunks waiting to be parsed
+        Chunk * RA_Current;                                 // the chunk kseq is looking at
+        std::string RA_Error;                               // set by the reading thread
+        ThreadPool * RA_Pool;
+        ReadAheadTask * RA_Task;
+};
+
+#endif //crass_InputReaders_h
@@ -48,6 +48,9 @@
 
 LoggerSimp* LoggerSimp::mInstance = NULL;
 
+// where this thread's lines go instead of the global handle, if anywhere
+static __thread std::ostream * threadCapture = NULL;
+
 LoggerSimp* LoggerSimp::Inst(void) {
     if(mInstance == NULL){
         mInstance = new LoggerSimp();
@@ -190,6 +193,21 @@ std::string LoggerSimp::int2Str(int input)
     return s;
 }
 
+void LoggerSimp::captureThread(std::ostream * capture)
+{
+    //-----
+    // lines logged by this thread go to capture until it is set back to NULL
+    //
+    threadCapture = capture;
+}
+
+std::ostream * LoggerSimp::getStream(void)
+{
+    if(threadCapture != NULL)
+        return threadCapture;
+    return mGlobalHandle;
+}
+
 std::string LoggerSimp::timeToString(bool elapsed)
 {
     //-----
@@ -197,13 +215,14 @@ std::string LoggerSimp::timeToString(bool elapsed)
     //
     struct tm * timeinfo;
     char buffer [80];
+    time_t current_time;
     
-    time ( &mCurrentTime );
+    time ( &current_time );
     
     if(elapsed)
     {
         std::string tmp = "";
-        int tot_secs = (int)(difftime(mCurrentTime, mStartTime));
+        int tot_secs = (int)(difftime(current_time, mStartTime));
         int tot_days = tot_secs / 86400;
         if(tot_days)
         {
@@ -227,7 +246,7 @@ std::string LoggerSimp::timeToString(bool elapsed)
     }
     else
     {
-        timeinfo = localtime ( &mCurrentTime );
+        timeinfo = localtime ( &current_time );
         strftime (buffer,80,"%d/%m/%Y_%I:%M",timeinfo);
         std::string tmp(buffer);
         return tmp;
@@ -81,6 +81,8 @@ public:
     // Operations
     std::string int2Str(int input);                                      // convert an into to a string
     std::string timeToString(bool elapsed);                              // write out the current time, prettylike
+    void captureThread(std::ostream * capture);                          // send this thread's lines to capture, NULL to stop
+    std::ostream * getStream(void);                                      // where this thread's lines go
     void closeLogFile(void);                                        // close the log file down
     void openLogFile(void);                                         // open the log file
     void clearLogFile(void);                                        // clear the logFile at the start
@@ -101,7 +103,6 @@ private:
     std::string mLogFile;                                                // this is the file we'll be writing out to
     int mLogLevel;                                                  // which logging level are we at?
     time_t mStartTime;                                              // the time when the logger was created
-    time_t mCurrentTime;                                            // now, .. no ... NOW! NOW!
     bool mFileOpen;                                                 // is the log file open?
 };
 
@@ -116,21 +117,21 @@ static LoggerSimp* logger = LoggerSimp::Inst();                     // this make
 // for logging info
 #define logInfo(cOUTsTRING, ll) { \
 if(logger->getLogLevel() >= ll) { \
-(*(logger->mGlobalHandle)) << logger->timeToString(true) << "\tI   " << cOUTsTRING << std::endl; \
+(*(logger->getStream())) << logger->timeToString(true) << "\tI   " << cOUTsTRING << std::endl; \
 } \
 }
 
 // for errors
 #define logError(cOUTsTRING) { \
 std::stringstream s; s<<cOUTsTRING;\
-(*(logger->mGlobalHandle)) << logger->timeToString(true) << "\tERR " << __FILE__ << " : " << __PRETTY_FUNCTION__ << " : " << __LINE__ << ": " <<  cOUTsTRING << std::endl; \
+(*(logger->getStream())) << logger->timeToString(true) << "\tERR " << __FILE__ << " : " << __PRETTY_FUNCTION__ << " : " << __LINE__ << ": " <<  cOUTsTRING << std::endl; \
 throw crispr::exception(__FILE__, __LINE__, __PRETTY_FUNCTION__,s.str().c_str());\
 }
 
 // for warnings
 #define logWarn(cOUTsTRING, ll) { \
 if(logger->getLogLevel() >= ll) { \
-(*(logger->mGlobalHandle)) << logger->timeToString(true) << "\tW   " << cOUTsTRING << std::endl; \
+(*(logger->getStream())) << logger->timeToString(true) << "\tW   " << cOUTsTRING << std::endl; \
 } \
 }
 
@@ -147,19 +148,19 @@ if(logger->getLogLevel() >= ll) { \
 // for logging info
 #define logInfo(cOUTsTRING, ll) { \
 if(logger->getLogLevel() >= ll) { \
-(*(logger->mGlobalHandle)) << logger->timeToString(true) << "\tI   " << __FILE__ << " : " << __PRETTY_FUNCTION__ << " : " << __LINE__ << ": " <<  cOUTsTRING << std::endl; \
+(*(logger->getStream())) << logger->timeToString(true) << "\tI   " << __FILE__ << " : " << __PRETTY_FUNCTION__ << " : " << __LINE__ << ": " <<  cOUTsTRING << std::endl; \
 } \
 }
 
 // for errors
 #define logError(cOUTsTRING) { \
-(*(logger->mGlobalHandle)) << logger->timeToString(true) << "\tERR " << __FILE__ << " : " << __PRETTY_FUNCTION__ << " : " << __LINE__ << ": " <<  cOUTsTRING << std::endl; \
+(*(logger->getStream())) << logger->timeToString(true) << "\tERR " << __FILE__ << " : " << __PRETTY_FUNCTION__ << " : " << __LINE__ << ": " <<  cOUTsTRING << std::endl; \
 }
 
 // for warnings
 #define logWarn(cOUTsTRING, ll) { \
 if(logger->getLogLevel() >= ll) { \
-(*(logger->mGlobalHandle)) << logger->timeToString(true) << "\tW   " << __FILE__ << " : " << __PRETTY_FUNCTION__ << " : " << __LINE__ << ": " <<  cOUTsTRING << std::endl; \
+(*(logger->getStream())) << logger->timeToString(true) << "\tW   " << __FILE__ << " : " << __PRETTY_FUNCTION__ << " : " << __LINE__ << ": " <<  cOUTsTRING << std::endl; \
 } \
 }
 
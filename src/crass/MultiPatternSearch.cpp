@@ -0,0 +1,539 @@
+/*
+ *  MultiPatternSearch.cpp is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+// system includes
+#include <algorithm>
+#include <utility>
+
+// local includes
+#include "MultiPatternSearch.h"
+
+// spreads packed kmers over the table
+#define KEY_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
+MultiPatternSearch::MultiPatternSearch(const std::vector<std::string>& patterns, unsigned int maxErrors) :
+    MP_KeyLength(32),
+    MP_KeyMask(0),
+    MP_TableShift(64),
+    MP_MaxErrors(maxErrors),
+    MP_SeedLength(0),
+    MP_SeedMask(0),
+    MP_SeedTableShift(64)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        MP_Code[i] = 4;
+        if ((i >= 'a' && i <= 'z') || (i >= '0' && i <= '9'))
+        {
+            MP_Letter[i] = static_cast<char>(i);
+        }
+        else if (i >= 'A' && i <= 'Z')
+        {
+            MP_Letter[i] = static_cast<char>(i - 'A' + 'a');
+        }
+        else
+        {
+            MP_Letter[i] = ' ';
+        }
+    }
+    MP_Code['A'] = MP_Code['a'] = 0;
+    MP_Code['C'] = MP_Code['c'] = 1;
+    MP_Code['G'] = MP_Code['g'] = 2;
+    MP_Code['T'] = MP_Code['t'] = 3;
+
+    size_t shortest = 0;
+    MP_PatternStart.push_back(0);
+    std::vector<std::string>::const_iterator pat_iter;
+    for (pat_iter = patterns.begin(); pat_iter != patterns.end(); ++pat_iter)
+    {
+        if (pat_iter == patterns.begin() || pat_iter->length() < shortest)
+        {
+            shortest = pat_iter->length();
+        }
+        for (size_t i = 0; i < pat_iter->length(); i++)
+        {
+            MP_Patterns.push_back(MP_Letter[static_cast<unsigned char>((*pat_iter)[i])]);
+        }
+        MP_PatternStart.push_back(MP_Patterns.size());
+    }
+
+    //-----
+    // the key can't be longer than the shortest pattern, an empty
+    // pattern never matches
+    //
+    if (shortest < MP_KeyLength)
+    {
+        MP_KeyLength = (0 == shortest) ? 1 : static_cast<unsigned int>(shortest);
+    }
+    MP_KeyMask = (32 == MP_KeyLength) ? ~0ULL : ((1ULL << (2 * MP_KeyLength)) - 1);
+
+    // key every pattern, sorting keeps the patterns for a key in order
+    std::vector<std::pair<uint64_t, uint32_t> > keyed;
+    for (uint32_t p = 0; p < patterns.size(); p++)
+    {
+        const std::string& pattern = patterns[p];
+        if (pattern.length() < MP_KeyLength)
+        {
+            continue;
+        }
+        uint64_t key = 0;
+        bool odd = false;
+        for (unsigned int i = 0; i < MP_KeyLength; i++)
+        {
+            unsigned char code = MP_Code[static_cast<unsigned char>(pattern[i])];
+            if (4 == code)
+            {
+                odd = true;
+                break;
+            }
+            key = (key << 2) | code;
+        }
+        if (odd)
+        {
+            MP_Odd.push_back(p);
+        }
+        else
+        {
+            keyed.push_back(std::make_pair(key, p));
+        }
+    }
+    std::sort(keyed.begin(), keyed.end());
+    buildTable(keyed, MP_Table, MP_TableShift, MP_Ids);
+
+    // exact matches are always looked for first
+    if (0 == MP_MaxErrors)
+    {
+        return;
+    }
+
+    //-----
+    // With errors + 1 seeds laid end to end in a pattern at least one of
+    // them must be in the text without any errors. Seeds with anything
+    // other than ACGT in them can't be keyed, patterns that have them
+    // are only found through their other seeds
+    //
+    MP_SeedLength = static_cast<unsigned int>(shortest / (MP_MaxErrors + 1));
+    if (MP_SeedLength > 32)
+    {
+        MP_SeedLength = 32;
+    }
+    else if (0 == MP_SeedLength)
+    {
+        MP_SeedLength = 1;
+    }
+    MP_SeedMask = (32 == MP_SeedLength) ? ~0ULL : ((1ULL << (2 * MP_SeedLength)) - 1);
+
+    std::vector<std::pair<uint64_t, Seed> > keyed_seeds;
+    MP_Peq.assign(8 * patterns.size(), 0);
+    for (uint32_t p = 0; p < patterns.size(); p++)
+    {
+        const std::string& pattern = patterns[p];
+        for (unsigned int s = 0; s <= MP_MaxErrors; s++)
+        {
+            size_t offset = s * MP_SeedLength;
+            if (offset + MP_SeedLength > pattern.length())
+            {
+                break;
+            }
+            uint64_t key = 0;
+            bool odd = false;
+            for (unsigned int i = 0; i < MP_SeedLength; i++)
+            {
+                unsigned char code = MP_Code[static_cast<unsigned char>(pattern[offset + i])];
+                if (4 == code)
+                {
+                    odd = true;
+                    break;
+                }
+                key = (key << 2) | code;
+            }
+            if (!odd)
+            {
+                Seed seed = {p, static_cast<uint32_t>(offset)};
+                keyed_seeds.push_back(std::make_pair(key, seed));
+            }
+        }
+
+        // match masks for the bit-parallel alignment
+        size_t length = pattern.length();
+        if (length <= 64)
+        {
+            for (size_t i = 0; i < length; i++)
+            {
+                unsigned char code = MP_Code[static_cast<unsigned char>(pattern[i])];
+                if (code < 4)
+                {
+                    MP_Peq[8 * p + code] |= (1ULL << i);
+                    MP_Peq[8 * p + 4 + code] |= (1ULL << (length - 1 - i));
+                }
+            }
+        }
+    }
+    std::sort(keyed_seeds.begin(), keyed_seeds.end());
+    buildTable(keyed_seeds, MP_SeedTable, MP_SeedTableShift, MP_Seeds);
+}
+
+template <class T>
+void MultiPatternSearch::buildTable(const std::vector<std::pair<uint64_t, T> >& keyed,
+                                    std::vector<Slot>& table,
+                                    int& tableShift,
+                                    std::vector<T>& ids)
+{
+    size_t num_keys = 0;
+    for (size_t i = 0; i < keyed.size(); i++)
+    {
+        if (0 == i || keyed[i].first != keyed[i - 1].first)
+        {
+            num_keys++;
+        }
+    }
+    size_t table_size = 1;
+    tableShift = 64;
+    while (table_size < 2 * num_keys)
+    {
+        table_size <<= 1;
+        tableShift--;
+    }
+    Slot empty_slot = {0, 0, 0};
+    table.assign(table_size, empty_slot);
+
+    ids.reserve(keyed.size());
+    size_t slot = 0;
+    for (size_t i = 0; i < keyed.size(); i++)
+    {
+        if (0 == i || keyed[i].first != keyed[i - 1].first)
+        {
+            slot = (64 == tableShift) ? 0 : static_cast<size_t>((keyed[i].first * KEY_MULTIPLIER) >> tableShift);
+            while (0 != table[slot].count)
+            {
+                slot = (slot + 1) & (table_size - 1);
+            }
+            table[slot].key = keyed[i].first;
+            table[slot].first = static_cast<uint32_t>(ids.size());
+        }
+        table[slot].count++;
+        ids.push_back(keyed[i].second);
+    }
+}
+
+const MultiPatternSearch::Slot * MultiPatternSearch::findSlot(const std::vector<Slot>& table, int tableShift, uint64_t key) const
+{
+    size_t mask = table.size() - 1;
+    size_t slot = (64 == tableShift) ? 0 : static_cast<size_t>((key * KEY_MULTIPLIER) >> tableShift);
+    while (0 != table[slot].count)
+    {
+        if (table[slot].key == key)
+        {
+            return &(table[slot]);
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+bool MultiPatternSearch::matchesAt(const std::string& text, size_t position, uint32_t patternIndex) const
+{
+    size_t start = MP_PatternStart[patternIndex];
+    size_t length = MP_PatternStart[patternIndex + 1] - start;
+    if (position + length > text.length())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        if (MP_Letter[static_cast<unsigned char>(text[position + i])] != MP_Patterns[start + i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MultiPatternSearch::search(const std::string& text, int& position, int& length, int& patternIndex, bool& exact) const
+{
+    //-----
+    // a read that holds a pattern untouched is found the same way with or
+    // without errors, the approximate search only sees the rest
+    //
+    exact = true;
+    if (searchExact(text, position, length, patternIndex))
+    {
+        return true;
+    }
+    if (0 == MP_MaxErrors)
+    {
+        return false;
+    }
+    exact = false;
+    return searchApproximate(text, position, length, patternIndex);
+}
+
+bool MultiPatternSearch::searchExact(const std::string& text, int& position, int& length, int& patternIndex) const
+{
+    if (MP_Ids.empty() && MP_Odd.empty())
+    {
+        return false;
+    }
+
+    //-----
+    // roll a key along the text remembering the last non-ACGT character
+    //
+    uint64_t key = 0;
+    long last_odd = -1;
+    long text_length = static_cast<long>(text.length());
+    long key_length = static_cast<long>(MP_KeyLength);
+    for (long i = 0; i < text_length; i++)
+    {
+        unsigned char code = MP_Code[static_cast<unsigned char>(text[i])];
+        if (4 == code)
+        {
+            last_odd = i;
+        }
+        key = ((key << 2) | (code & 3)) & MP_KeyMask;
+
+        long start = i - key_length + 1;
+        if (start < 0)
+        {
+            continue;
+        }
+        uint32_t found = 0;
+        bool is_found = false;
+        if (last_odd < start)
+        {
+            const Slot * slot = findSlot(MP_Table, MP_TableShift, key);
+            if (NULL == slot)
+            {
+                continue;
+            }
+            for (uint32_t j = slot->first; j < slot->first + slot->count && !is_found; j++)
+            {
+                if (matchesAt(text, start, MP_Ids[j]))
+                {
+                    found = MP_Ids[j];
+                    is_found = true;
+                }
+            }
+        }
+        else
+        {
+            for (size_t j = 0; j < MP_Odd.size() && !is_found; j++)
+            {
+                if (matchesAt(text, start, MP_Odd[j]))
+                {
+                    found = MP_Odd[j];
+                    is_found = true;
+                }
+            }
+        }
+        if (is_found)
+        {
+            position = static_cast<int>(start);
+            length = static_cast<int>(MP_PatternStart[found + 1] - MP_PatternStart[found]);
+            patternIndex = static_cast<int>(found);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MultiPatternSearch::searchApproximate(const std::string& text, int& position, int& length, int& patternIndex) const
+{
+    if (MP_Seeds.empty())
+    {
+        return false;
+    }
+
+    uint64_t key = 0;
+    long last_odd = -1;
+    long text_length = static_cast<long>(text.length());
+    long seed_length = static_cast<long>(MP_SeedLength);
+    long max_errors = static_cast<long>(MP_MaxErrors);
+    for (long i = 0; i < text_length; i++)
+    {
+        unsigned char code = MP_Code[static_cast<unsigned char>(text[i])];
+        if (4 == code)
+        {
+            last_odd = i;
+        }
+        key = ((key << 2) | (code & 3)) & MP_SeedMask;
+
+        long start = i - seed_length + 1;
+        if (start < 0 || last_odd >= start)
+        {
+            continue;
+        }
+        const Slot * slot = findSlot(MP_SeedTable, MP_SeedTableShift, key);
+        if (NULL == slot)
+        {
+            continue;
+        }
+        for (uint32_t j = slot->first; j < slot->first + slot->count; j++)
+        {
+            //-----
+            // where the pattern would be if it had no errors, give or
+            // take the number of indels allowed
+            //
+            const Seed& seed = MP_Seeds[j];
+            long pattern_length = static_cast<long>(MP_PatternStart[seed.pattern + 1] - MP_PatternStart[seed.pattern]);
+            long first = start - static_cast<long>(seed.offset) - max_errors;
+            long last = start - static_cast<long>(seed.offset) + pattern_length - 1 + max_errors;
+            if (first < 0)
+            {
+                first = 0;
+            }
+            if (last >= text_length)
+            {
+                last = text_length - 1;
+            }
+            if (last - first + 1 < pattern_length - max_errors)
+            {
+                continue;
+            }
+
+            long match_end;
+            if (alignPattern(seed.pattern, text, first, last, false, match_end) > max_errors)
+            {
+                continue;
+            }
+            long match_start;
+            alignPattern(seed.pattern, text, match_end, first, true, match_start);
+            position = static_cast<int>(match_start);
+            length = static_cast<int>(match_end - match_start + 1);
+            patternIndex = static_cast<int>(seed.pattern);
+            return true;
+        }
+    }
+    return false;
+}
+
+int MultiPatternSearch::alignPattern(uint32_t patternIndex,
+                                     const std::string& text,
+                                     long from,
+                                     long to,
+                                     bool reverse,
+                                     long& bestPosition) const
+{
+    const char * pattern = &(MP_Patterns[MP_PatternStart[patternIndex]]);
+    int length = static_cast<int>(MP_PatternStart[patternIndex + 1] - MP_PatternStart[patternIndex]);
+    long step = reverse ? -1 : 1;
+    int best_score = length + 1;
+    bestPosition = from;
+
+    if (length <= 64)
+    {
+        //-----
+        // Myers' bit-vector algorithm, the pattern can start anywhere
+        // in the text so there is no carry into the bottom bit
+        //
+        const uint64_t * peq = &(MP_Peq[8 * patternIndex + (reverse ? 4 : 0)]);
+        uint64_t high_bit = 1ULL << (length - 1);
+        uint64_t pv = ~0ULL;
+        uint64_t mv = 0;
+        int score = length;
+        for (long pos = from; pos != to + step; pos += step)
+        {
+            unsigned char c = static_cast<unsigned char>(text[pos]);
+            uint64_t eq;
+            if (MP_Code[c] < 4)
+            {
+                eq = peq[MP_Code[c]];
+            }
+            else
+            {
+                eq = 0;
+                for (int i = 0; i < length; i++)
+                {
+                    if (pattern[i] == MP_Letter[c])
+                    {
+                        eq |= 1ULL << (reverse ? length - 1 - i : i);
+                    }
+                }
+            }
+            uint64_t xv = eq | mv;
+            uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+            uint64_t ph = mv | ~(xh | pv);
+            uint64_t mh = pv & xh;
+            if (ph & high_bit)
+            {
+                score++;
+            }
+            else if (mh & high_bit)
+            {
+                score--;
+            }
+            ph <<= 1;
+            mh <<= 1;
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+            if (score < best_score)
+            {
+                best_score = score;
+                bestPosition = pos;
+            }
+        }
+        return best_score;
+    }
+
+    // too long for one word, plain dynamic programming
+    std::vector<int> column(length + 1);
+    for (int i = 0; i <= length; i++)
+    {
+        column[i] = i;
+    }
+    for (long pos = from; pos != to + step; pos += step)
+    {
+        char letter = MP_Letter[static_cast<unsigned char>(text[pos])];
+        int diagonal = 0;
+        for (int i = 1; i <= length; i++)
+        {
+            char pattern_letter = reverse ? pattern[length - i] : pattern[i - 1];
+            int cell = diagonal + ((pattern_letter == letter) ? 0 : 1);
+            if (column[i] + 1 < cell)
+            {
+                cell = column[i] + 1;
+            }
+            if (column[i - 1] + 1 < cell)
+            {
+                cell = column[i - 1] + 1;
+            }
+            diagonal = column[i];
+            column[i] = cell;
+        }
+        if (column[length] < best_score)
+        {
+            best_score = column[length];
+            bestPosition = pos;
+        }
+    }
+    return best_score;
+}
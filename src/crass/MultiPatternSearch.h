@@ -0,0 +1,144 @@
+/*
+ *  MultiPatternSearch.h is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Finds the leftmost of a large set of patterns in a read. Every pattern
+ *  is keyed on its first bases packed two bits to a base (up to 32 of
+ *  them) and the keys go into one flat open addressing table, so a read is
+ *  searched with one table lookup per position no matter how many patterns
+ *  there are. Patterns with anything other than ACGT in their key are
+ *  rare, they are kept on the side and checked wherever the read has
+ *  something other than ACGT too. Case is ignored and any character that
+ *  is not a letter or a digit matches any other such character.
+ *
+ *  When errors are allowed a text without an exact match is searched
+ *  again. Every pattern is cut into errors + 1 seeds, at least one of
+ *  which has to be in the text untouched. Seeds are looked up the same
+ *  way and every hit is checked with a bit-parallel edit distance (Myers)
+ *  over the part of the text the pattern could be in.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+#ifndef crass_MultiPatternSearch_h
+#define crass_MultiPatternSearch_h
+
+// system includes
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdint.h>
+
+class MultiPatternSearch
+{
+    public:
+        // maxErrors is the number of mismatches or indels allowed in a match
+        MultiPatternSearch(const std::vector<std::string>& patterns, unsigned int maxErrors = 0);
+        ~MultiPatternSearch(void) {}
+
+        // find the leftmost place in text where any of the patterns start,
+        // if more than one pattern starts there the one that came first in
+        // the list wins. When errors are allowed and no pattern is in the
+        // text untouched the first seed in the text that leads to a match
+        // decides instead. length is the length of
+        // the match in the text and exact is false if it has errors in it.
+        // Returns false if there are no patterns in the text. Only reads
+        // the tables so many threads can search at once
+        bool search(const std::string& text, int& position, int& length, int& patternIndex, bool& exact) const;
+
+        inline size_t numPatterns(void) const { return MP_PatternStart.size() - 1; }
+
+    private:
+        struct Slot
+        {
+            uint64_t key;
+            uint32_t first;                                 // index into the ids for the table
+            uint32_t count;                                 // 0 for an empty slot
+        };
+
+        struct Seed
+        {
+            uint32_t pattern;
+            uint32_t offset;                                // where the seed is in the pattern
+
+            // seeds for a key are tried in pattern order
+            bool operator<(const Seed& other) const
+            {
+                return (pattern < other.pattern) || (pattern == other.pattern && offset < other.offset);
+            }
+        };
+
+        // make an open addressing table for sorted keys, the ids for each
+        // key end up together in ids
+        template <class T>
+        void buildTable(const std::vector<std::pair<uint64_t, T> >& keyed,
+                        std::vector<Slot>& table,
+                        int& tableShift,
+                        std::vector<T>& ids);
+
+        const Slot * findSlot(const std::vector<Slot>& table, int tableShift, uint64_t key) const;
+
+        // check the pattern against the text starting at position
+        bool matchesAt(const std::string& text, size_t position, uint32_t patternIndex) const;
+
+        bool searchExact(const std::string& text, int& position, int& length, int& patternIndex) const;
+
+        bool searchApproximate(const std::string& text, int& position, int& length, int& patternIndex) const;
+
+        // the lowest edit distance of the pattern against any part of the
+        // text that ends (or starts when reverse is set) at a position
+        // between from and to. The first position to reach it is put in
+        // bestPosition
+        int alignPattern(uint32_t patternIndex,
+                         const std::string& text,
+                         long from,
+                         long to,
+                         bool reverse,
+                         long& bestPosition) const;
+
+        unsigned int MP_KeyLength;                          // bases in a key
+        uint64_t MP_KeyMask;
+        int MP_TableShift;                                  // 64 - log2 of the table size
+        unsigned char MP_Code[256];                         // 0 - 3 for ACGT, 4 for anything else
+        char MP_Letter[256];                                // what is actually compared
+
+        std::vector<Slot> MP_Table;
+        std::vector<uint32_t> MP_Ids;                       // patterns grouped by key, in order
+        std::vector<uint32_t> MP_Odd;                       // patterns with non-ACGT keys, in order
+        std::vector<char> MP_Patterns;                      // every pattern as MP_Letter
+        std::vector<size_t> MP_PatternStart;                // start of every pattern, plus one past the end
+
+        unsigned int MP_MaxErrors;
+        unsigned int MP_SeedLength;
+        uint64_t MP_SeedMask;
+        int MP_SeedTableShift;
+        std::vector<Slot> MP_SeedTable;
+        std::vector<Seed> MP_Seeds;                         // seeds grouped by key
+        std::vector<uint64_t> MP_Peq;                       // ACGT match masks for each pattern, forwards then reversed
+};
+
+#endif //crass_MultiPatternSearch_h
@@ -133,6 +133,17 @@ bool NodeManager::addReadHolder(ReadHolder * RH)
     }
 }
 
+void NodeManager::freezeGraph(void)
+{
+    //-----
+    // lay the node graph out flat, no more reads can be added
+    //
+    NM_Graph.freeze();
+
+    // no more spacers either, walk them in key order from now on
+    NM_Spacers.sortByKey();
+}
+
 //----
 // private function called from addReadHolder to split the read into spacers and pass it through to others
 //
@@ -222,6 +233,60 @@ bool NodeManager::splitReadHolder(ReadHolder * RH)
 	return true;
 }
 
+//----
+// Private function to find the node for a kmer cut from a spacer. Nodes are
+// looked up by their packed kmer, the string is still stored in the string
+// check as the token is the node ID
+//
+CrisprNode * NodeManager::getKmerNode(std::string& kmer, bool forward)
+{
+    PackedKmer packed_kmer = 0;
+    bool packed = (kmer.length() <= PK_MAX_KMER_LENGTH) && packKmer(kmer, 0, static_cast<unsigned int>(kmer.length()), packed_kmer);
+    
+    StringToken st = 0;
+    if(packed)
+    {
+        StringToken * packed_st = NM_KmerTokens.find(packed_kmer);
+        if(NULL != packed_st)
+        {
+            st = *packed_st;
+        }
+    }
+    else
+    {
+        st = NM_StringCheck.getToken(kmer);
+    }
+    
+    // if they have been added previously then token != 0
+    if(0 != st)
+    {
+        // we already have a node for this guy
+        CrisprNode * kmer_node = NM_Nodes[st];
+        kmer_node->incrementCount();
+        return kmer_node;
+    }
+    
+    // first time we've seen this guy. Make some new objects
+    st = NM_StringCheck.addString(kmer);
+    CrisprNode * kmer_node = new CrisprNode(st);
+    if(!forward)
+    {
+        kmer_node->setForward(false);
+    }
+    
+    // add them to the pile
+    NM_Nodes[st] = kmer_node;
+    NM_Graph.addNode(kmer_node);
+    if(packed)
+    {
+        NM_KmerTokens[packed_kmer] = st;
+    }
+#ifdef DEBUG
+    logInfo("creating node "<<st<<" with string: "<<kmer, 10);
+#endif
+    return kmer_node;
+}
+
 //----
 // Private function called from splitReadHolder to cut the kmers and make the nodes
 //
@@ -239,47 +304,12 @@ void NodeManager::addCrisprNodes(CrisprNode ** prevNode, std::string& workingStr
     
     CrisprNode * first_kmer_node;
     CrisprNode * second_kmer_node;
-    SpacerKey this_sp_key;
-    
-    // check to see if these kmers are already stored
-    StringToken st1 = NM_StringCheck.getToken(first_kmer);
-    
-    // if they have been added previously then token != 0
-    if(0 == st1)
-    {
-        // first time we've seen this guy. Make some new objects
-        st1 = NM_StringCheck.addString(first_kmer);
-        first_kmer_node = new CrisprNode(st1);
-        
-        // add them to the pile
-        NM_Nodes[st1] = first_kmer_node;
-#ifdef DEBUG
-        logInfo("creating node "<<st1<<" with string: "<<first_kmer, 10);
-#endif
-    }
-    else
-    {
-        // we already have a node for this guy
-        first_kmer_node = NM_Nodes[st1];
-        first_kmer_node->incrementCount();
-    }
     
-    StringToken st2 = NM_StringCheck.getToken(second_kmer);
-    if(0 == st2)
-    {
-        st2 = NM_StringCheck.addString(second_kmer);
-        second_kmer_node = new CrisprNode(st2);
-        second_kmer_node->setForward(false);
-        NM_Nodes[st2] = second_kmer_node;
-#ifdef DEBUG
-        logInfo("creating node "<<st2<<" with string: "<<second_kmer, 10);
-#endif
-    }
-    else
-    {
-        second_kmer_node = NM_Nodes[st2];
-        second_kmer_node->incrementCount();
-    }
+    // find the nodes for these kmers, making them if they're new
+    first_kmer_node = getKmerNode(first_kmer, true);
+    second_kmer_node = getKmerNode(second_kmer, false);
+    StringToken st1 = first_kmer_node->getID();
+    StringToken st2 = second_kmer_node->getID();
 
     // add in the read headers for the two CrisprNodes
     first_kmer_node->addReadHeader(headerSt);
@@ -291,11 +321,10 @@ void NodeManager::addCrisprNodes(CrisprNode ** prevNode, std::string& workingStr
     // make sure prevNode is not NULL
     if (NULL != *prevNode) 
     {
-        this_sp_key = makeSpacerKey(st1, (*prevNode)->getID());
-        if(NM_Spacers.find(this_sp_key) == NM_Spacers.end())
+        if(NULL == NM_Spacers.find(makeSpacerKey(st1, (*prevNode)->getID())))
         {
-            (*prevNode)->addEdge(first_kmer_node, CN_EDGE_JUMPING_F);
-            first_kmer_node->addEdge(*prevNode, CN_EDGE_JUMPING_B);
+            NM_Graph.addEdge(*prevNode, first_kmer_node, CN_EDGE_JUMPING_F);
+            NM_Graph.addEdge(first_kmer_node, *prevNode, CN_EDGE_JUMPING_B);
         }
     }
     
@@ -313,9 +342,9 @@ void NodeManager::addCrisprNodes(CrisprNode ** prevNode, std::string& workingStr
     SpacerInstance * curr_spacer;
     
     // check to see if we already have it here
-    this_sp_key = makeSpacerKey(st1, st2);
+    SpacerInstance *& table_spacer = NM_Spacers[makeSpacerKey(st1, st2)];
     
-    if(NM_Spacers.find(this_sp_key) == NM_Spacers.end())
+    if(NULL == table_spacer)
     {
         // new instance
         StringToken sp_str_token = NM_StringCheck.getToken(workingString);
@@ -324,7 +353,8 @@ void NodeManager::addCrisprNodes(CrisprNode ** prevNode, std::string& workingStr
             sp_str_token = NM_StringCheck.addString(workingString);
     	}
         curr_spacer = new SpacerInstance(sp_str_token, first_kmer_node, second_kmer_node);
-        NM_Spacers[this_sp_key] = curr_spacer;
+        table_spacer = curr_spacer;
+        NM_SpacerGraph.addSpacer(curr_spacer);
 #ifdef SEARCH_SINGLETON
         if (debug_iter != debugger->end()) {
             debug_iter->second.addSpacer(workingString);
@@ -335,13 +365,13 @@ void NodeManager::addCrisprNodes(CrisprNode ** prevNode, std::string& workingStr
 #endif
 
         // make the inner edge
-        first_kmer_node->addEdge(second_kmer_node, CN_EDGE_FORWARD);
-        second_kmer_node->addEdge(first_kmer_node, CN_EDGE_BACKWARD);
+        NM_Graph.addEdge(first_kmer_node, second_kmer_node, CN_EDGE_FORWARD);
+        NM_Graph.addEdge(second_kmer_node, first_kmer_node, CN_EDGE_BACKWARD);
     }
     else
     {
         // increment the number of times we've seen this guy
-        (NM_Spacers[this_sp_key])->incrementCount();
+        table_spacer->incrementCount();
     }
     
     *prevNode = second_kmer_node;
@@ -355,31 +385,13 @@ void NodeManager::addSecondCrisprNode(CrisprNode ** prevNode, std::string& worki
     std::string second_kmer = workingString.substr(workingString.length() - NM_Opts->cNodeKmerLength, NM_Opts->cNodeKmerLength );
     CrisprNode * second_kmer_node;
     
-    // check to see if these kmers are already stored
-    StringToken st2 = NM_StringCheck.getToken(second_kmer);
-    
-    // if they have been added previously then token != 0
-    if(0 == st2)
-    {
-        // first time we've seen this guy. Make some new objects
-        st2 = NM_StringCheck.addString(second_kmer);
-        second_kmer_node = new CrisprNode(st2);
-        second_kmer_node->setForward(false);
-        
-        // add them to the pile
-        NM_Nodes[st2] = second_kmer_node;
-    }
-    else
-    {
-        // we already have a node for this guy
-        second_kmer_node = NM_Nodes[st2];
-        (NM_Nodes[st2])->incrementCount();
-    }
+    // find the node for this kmer, making it if it's new
+    second_kmer_node = getKmerNode(second_kmer, false);
 #ifdef SEARCH_SINGLETON
     SearchCheckerList::iterator debug_iter = debugger->find(NM_StringCheck.getString(headerSt));
     if (debug_iter != debugger->end()) {
         // interesting read
-        debug_iter->second.addNode(st2);
+        debug_iter->second.addNode(second_kmer_node->getID());
     }
 #endif
     // add in the read headers for the this CrisprNode
@@ -400,25 +412,9 @@ void NodeManager::addFirstCrisprNode(CrisprNode ** prevNode, std::string& workin
     std::string first_kmer = workingString.substr(0, NM_Opts->cNodeKmerLength);
     CrisprNode * first_kmer_node;
     
-    // check to see if these kmers are already stored
-    StringToken st1 = NM_StringCheck.getToken(first_kmer);
-    
-    // if they have been added previously then token != 0
-    if(0 == st1)
-    {
-        // first time we've seen this guy. Make some new objects
-        st1 = NM_StringCheck.addString(first_kmer);
-        first_kmer_node = new CrisprNode(st1);
-        
-        // add them to the pile
-        NM_Nodes[st1] = first_kmer_node;
-    }
-    else
-    {
-        // we already have a node for this guy
-        first_kmer_node = NM_Nodes[st1];
-        (NM_Nodes[st1])->incrementCount();
-    }
+    // find the node for this kmer, making it if it's new
+    first_kmer_node = getKmerNode(first_kmer, true);
+    StringToken st1 = first_kmer_node->getID();
 #ifdef SEARCH_SINGLETON
     SearchCheckerList::iterator debug_iter = debugger->find(NM_StringCheck.getString(headerSt));
     if (debug_iter != debugger->end()) {
@@ -433,11 +429,10 @@ void NodeManager::addFirstCrisprNode(CrisprNode ** prevNode, std::string& workin
     // check to see if we already have it here
     if(NULL != *prevNode)
     {
-        SpacerKey this_sp_key = makeSpacerKey(st1, (*prevNode)->getID());
-        if(NM_Spacers.find(this_sp_key) == NM_Spacers.end())
+        if(NULL == NM_Spacers.find(makeSpacerKey(st1, (*prevNode)->getID())))
         {
-            (*prevNode)->addEdge(first_kmer_node, CN_EDGE_JUMPING_F);
-            first_kmer_node->addEdge(*prevNode, CN_EDGE_JUMPING_B);
+            NM_Graph.addEdge(*prevNode, first_kmer_node, CN_EDGE_JUMPING_F);
+            NM_Graph.addEdge(first_kmer_node, *prevNode, CN_EDGE_JUMPING_B);
         }
     }
 }
@@ -453,17 +448,15 @@ void NodeManager::findCapNodes(NodeVector * capNodes)
     //
     capNodes->clear();
     
-    NodeListIterator all_node_iter = NM_Nodes.begin();
-    while (all_node_iter != NM_Nodes.end()) 
+    for (int node = 0; node < NM_Graph.size(); node++) 
     {
-        if((all_node_iter->second)->isAttached())
+        if(NM_Graph.isAttached(node))
         {
-            if ((all_node_iter->second)->getTotalRank() == 1) 
+            if (NM_Graph.getTotalRank(node) == 1) 
             {
-                capNodes->push_back(all_node_iter->second);
+                capNodes->push_back(NM_Graph.getNode(node));
             }
         }
-        all_node_iter++;
     }
 }
 
@@ -474,13 +467,11 @@ void NodeManager::findAllNodes(NodeVector * allNodes)
     //
     allNodes->clear();
     
-    NodeListIterator all_node_iter = NM_Nodes.begin();
-    while (all_node_iter != NM_Nodes.end()) 
+    for (int node = 0; node < NM_Graph.size(); node++) 
     {
-        if((all_node_iter->second)->isAttached())
+        if(NM_Graph.isAttached(node))
         {
-            allNodes->push_back(all_node_iter->second);
-            all_node_iter++;
+            allNodes->push_back(NM_Graph.getNode(node));
         }
     }
 }
@@ -493,18 +484,16 @@ void NodeManager::findAllNodes(NodeVector * capNodes, NodeVector * otherNodes)
     capNodes->clear();
     otherNodes->clear();
     
-    NodeListIterator all_node_iter = NM_Nodes.begin();
-    while (all_node_iter != NM_Nodes.end()) 
+    for (int node = 0; node < NM_Graph.size(); node++) 
     {
-        if((all_node_iter->second)->isAttached())
+        if(NM_Graph.isAttached(node))
         {
-            int rank = (all_node_iter->second)->getTotalRank(); 
+            int rank = NM_Graph.getTotalRank(node); 
             if (rank == 1) 
-            { capNodes->push_back(all_node_iter->second); }
+            { capNodes->push_back(NM_Graph.getNode(node)); }
             else
-            { otherNodes->push_back(all_node_iter->second); }
+            { otherNodes->push_back(NM_Graph.getNode(node)); }
         }
-        all_node_iter++;
     }
 }
 
@@ -519,36 +508,35 @@ int NodeManager::findCapsAt(NodeVector * capNodes, bool searchForward, bool isIn
     //
     capNodes->clear();
     
-    if(queryNode->isAttached())
+    int query_node = queryNode->getIndex();
+    if(NM_Graph.isAttached(query_node))
     {
         // first, find what type of edge we are searching for.
-        edgeListIterator el_iter;
-        edgeList * el;
+        EDGE_TYPE type;
         if(searchForward)
         {
             if(isInner)
-                el = queryNode->getEdges(CN_EDGE_FORWARD);
+                type = CN_EDGE_FORWARD;
             else
-                el = queryNode->getEdges(CN_EDGE_JUMPING_F);
+                type = CN_EDGE_JUMPING_F;
         }
         else
         {
             if(isInner)
-                el = queryNode->getEdges(CN_EDGE_BACKWARD);
+                type = CN_EDGE_BACKWARD;
             else
-                el = queryNode->getEdges(CN_EDGE_JUMPING_B);
+                type = CN_EDGE_JUMPING_B;
         }
-        el_iter = el->begin();
-        while(el_iter != el->end())
+        for(unsigned int edge = NM_Graph.edgeBegin(query_node, type); edge < NM_Graph.edgeEnd(query_node, type); edge++)
         {
             // make sure we only look at attached edges
-            if(el_iter->second)
+            if(NM_Graph.isEdgeActive(edge))
             {
-                CrisprNode * attached_node = el_iter->first;
-                if(1 == attached_node->getTotalRank())
+                int attached_node = NM_Graph.edgeTarget(edge);
+                if(1 == NM_Graph.getTotalRank(attached_node))
                 {
                     // this guy is a cap!
-                    capNodes->push_back(attached_node);
+                    capNodes->push_back(NM_Graph.getNode(attached_node));
                 }
                 else
                 {
@@ -560,8 +548,6 @@ int NodeManager::findCapsAt(NodeVector * capNodes, bool searchForward, bool isIn
                     }
                 }
             }
-            
-            el_iter++;
         }
     }
     return (int)capNodes->size();
@@ -570,23 +556,26 @@ int NodeManager::findCapsAt(NodeVector * capNodes, bool searchForward, bool isIn
 
 bool NodeManager::getSpacerEdgeFromCap(WalkingManager * walkElem, SpacerInstance * currentSpacer)
 {
-    if (currentSpacer->getSpacerRank() == 1) 
+    if (NM_SpacerGraph.getRank(currentSpacer) == 1) 
     {
-        SpacerEdgeVector_Iterator iter = currentSpacer->begin();
-        
-        while (iter != currentSpacer->end()) 
+        for (unsigned int edge = NM_SpacerGraph.edgeBegin(currentSpacer); edge < NM_SpacerGraph.edgeEnd(currentSpacer); edge++) 
         {
-            if (((*iter)->edge)->isAttached()) 
+            if (!NM_SpacerGraph.isLive(edge))
             {
-                if (0 == ((*iter)->edge)->getContigID()) 
+                continue;
+            }
+            SpacerInstance * edge_spacer = NM_SpacerGraph.edgeTarget(edge);
+            if (edge_spacer->isAttached()) 
+            {
+                if (0 == edge_spacer->getContigID()) 
                 {
-                    walkElem->setSecondNode((*iter)->edge);
+                    walkElem->setSecondNode(edge_spacer);
                     walkElem->setFirstNode(currentSpacer);
-                    walkElem->setWantedEdge((*iter)->d);
+                    walkElem->setWantedEdge(NM_SpacerGraph.edgeDirection(edge));
                 } 
                 else 
                 {
-                    currentSpacer->setContigID(((*iter)->edge)->getContigID());
+                    currentSpacer->setContigID(edge_spacer->getContigID());
                     return false;
                 }
             } 
@@ -594,7 +583,6 @@ bool NodeManager::getSpacerEdgeFromCap(WalkingManager * walkElem, SpacerInstance
             {
                 return false;
             }
-            iter++;
         }
     }
     else 
@@ -611,19 +599,22 @@ bool NodeManager::getSpacerEdgeFromCap(WalkingManager * walkElem, SpacerInstance
 bool NodeManager::getSpacerEdgeFromCross(WalkingManager * walkElem, SpacerInstance * currentSpacer )
 {
     // check that the edge is a path node
-    if (currentSpacer->getSpacerRank() == 2) 
+    if (NM_SpacerGraph.getRank(currentSpacer) == 2) 
     {
-        SpacerEdgeVector_Iterator iter = currentSpacer->begin();
-        
-        while (iter != currentSpacer->end()) 
+        for (unsigned int edge = NM_SpacerGraph.edgeBegin(currentSpacer); edge < NM_SpacerGraph.edgeEnd(currentSpacer); edge++) 
         {
-            if (((*iter)->edge)->isAttached()) 
+            if (!NM_SpacerGraph.isLive(edge))
+            {
+                continue;
+            }
+            SpacerInstance * edge_spacer = NM_SpacerGraph.edgeTarget(edge);
+            if (edge_spacer->isAttached()) 
             {
-                if (0 == ((*iter)->edge)->getContigID()) 
+                if (0 == edge_spacer->getContigID()) 
                 {
-                    walkElem->setSecondNode((*iter)->edge);
+                    walkElem->setSecondNode(edge_spacer);
                     walkElem->setFirstNode(currentSpacer);
-                    walkElem->setWantedEdge((*iter)->d);
+                    walkElem->setWantedEdge(NM_SpacerGraph.edgeDirection(edge));
                     return true;
                 } 
             } 
@@ -631,7 +622,6 @@ bool NodeManager::getSpacerEdgeFromCross(WalkingManager * walkElem, SpacerInstan
             {
                 return false;
             }
-            iter++;
         }
     }
     else 
@@ -647,25 +637,29 @@ bool NodeManager::getSpacerEdgeFromCross(WalkingManager * walkElem, SpacerInstan
 
 bool NodeManager::stepThroughSpacerPath(WalkingManager * walkElem, SpacerInstance ** previousNode)
 {
-    switch ((walkElem->second())->getSpacerRank()) 
+    SpacerInstance * current_spacer = walkElem->second();
+    switch (NM_SpacerGraph.getRank(current_spacer)) 
     {
         case 2:
         {
             // path node?
             // check to see if the other edge is going in the same direction as wantedDirection
-            SpacerEdgeVector_Iterator iter = (walkElem->second())->begin();
-            while (iter != (walkElem->second())->end()) 
+            for (unsigned int edge = NM_SpacerGraph.edgeBegin(current_spacer); edge < NM_SpacerGraph.edgeEnd(current_spacer); edge++) 
             {
+                if (!NM_SpacerGraph.isLive(edge))
+                {
+                    continue;
+                }
                 // make sure the edge is attached, in the right direction, not the incomming edge and not assigned to a contig already
-                if ((*iter)->edge->isAttached()  && 
-                    ((*iter)->d == walkElem->getEdgeType()) && 
-                    ((*iter)->edge->getID() != walkElem->first()->getID()) && 
-                    ((*iter)->edge->getContigID() == 0)) 
+                SpacerInstance * edge_spacer = NM_SpacerGraph.edgeTarget(edge);
+                if (edge_spacer->isAttached()  && 
+                    (NM_SpacerGraph.edgeDirection(edge) == walkElem->getEdgeType()) && 
+                    (edge_spacer->getID() != walkElem->first()->getID()) && 
+                    (edge_spacer->getContigID() == 0)) 
                 {
-                    *previousNode = walkElem->shift((*iter)->edge);
+                    *previousNode = walkElem->shift(edge_spacer);
                     return true;
                 } 
-                iter++;
             }
             break;
         }
@@ -705,49 +699,50 @@ int NodeManager::cleanGraph(void)
         nv_iter = nv_cap.begin();
         while(nv_iter != nv_cap.end())
         {
+            int cap_node = (*nv_iter)->getIndex();
             // we can just lop off caps joined by jumpers (perhaps)
-            if ((*nv_iter)->getInnerRank() == 0)
+            if (NM_Graph.getInnerRank(cap_node) == 0)
             {
                 // make sure that this guy is linked to a cross node
-                edgeList * el;
-                if(0 != (*nv_iter)->getRank(CN_EDGE_JUMPING_F))
-                    el = (*nv_iter)->getEdges(CN_EDGE_JUMPING_F);
+                EDGE_TYPE type;
+                if(0 != NM_Graph.getRank(cap_node, CN_EDGE_JUMPING_F))
+                    type = CN_EDGE_JUMPING_F;
                 else
-                    el = (*nv_iter)->getEdges(CN_EDGE_JUMPING_B);
+                    type = CN_EDGE_JUMPING_B;
                 
                 // there is only one guy in this list!
-                int other_rank = ((el->begin())->first)->getTotalRank();
+                int other_rank = NM_Graph.getTotalRank(NM_Graph.firstPartner(cap_node, type));
                 if(other_rank != 2)
                     detach_list.push_back(*nv_iter);
             }
             else
             {
                 // make sure that this guy is linked to a cross node
-                edgeList * el;
+                EDGE_TYPE type;
                 bool is_forward;
-                if(0 != (*nv_iter)->getRank(CN_EDGE_FORWARD))
+                if(0 != NM_Graph.getRank(cap_node, CN_EDGE_FORWARD))
                 {
-                    el = (*nv_iter)->getEdges(CN_EDGE_FORWARD);
+                    type = CN_EDGE_FORWARD;
                     is_forward = false;
                 }
                 else
                 {
-                    el = (*nv_iter)->getEdges(CN_EDGE_BACKWARD);
+                    type = CN_EDGE_BACKWARD;
                     is_forward = true;
                 }
                 
                 // there is only one guy in this list!
-                CrisprNode * joining_node = ((el->begin())->first); 
-                int other_rank = joining_node->getTotalRank();
+                int joining_node = NM_Graph.firstPartner(cap_node, type); 
+                int other_rank = NM_Graph.getTotalRank(joining_node);
                 if(other_rank != 2)
                 {
                     // this guy joins onto a crossnode
                     // check to see if he is the only cap here!
                     NodeVector caps_at_join;
-                    if(findCapsAt(&caps_at_join, is_forward, true, true, joining_node) > 1)
+                    if(findCapsAt(&caps_at_join, is_forward, true, true, NM_Graph.getNode(joining_node)) > 1)
                     {
                         // this is a fork at the end of an arm
-                        fork_choice_map.insert(std::pair<CrisprNode *, CrisprNode *>(joining_node, *nv_iter)) ;
+                        fork_choice_map.insert(std::pair<CrisprNode *, CrisprNode *>(NM_Graph.getNode(joining_node), *nv_iter)) ;
                     }
                     else
                     {
@@ -803,7 +798,7 @@ int NodeManager::cleanGraph(void)
         nv_iter = detach_list.begin();
         while(nv_iter != detach_list.end())
         {
-            (*nv_iter)->detachNode();
+            NM_Graph.detachNode(*nv_iter);
             nv_iter++;
         }
     
@@ -814,17 +809,18 @@ int NodeManager::cleanGraph(void)
         nv_iter = nv_other.begin();
         while(nv_iter != nv_other.end())
         {
-            switch ((*nv_iter)->getTotalRank()) 
+            int other_node = (*nv_iter)->getIndex();
+            switch (NM_Graph.getTotalRank(other_node)) 
             {
                 case 2:
                 {
                     // check that there is one inner and one jumping edge
-                    if (!((*nv_iter)->getInnerRank() && (*nv_iter)->getJumpingRank())) 
+                    if (!(NM_Graph.getInnerRank(other_node) && NM_Graph.getJumpingRank(other_node))) 
                     {
     #ifdef DEBUG
                         logInfo("node "<<(*nv_iter)->getID()<<" has only two edges of the same type -- cannot be linear -- detaching", 8);
     #endif
-                        (*nv_iter)->detachNode();
+                        NM_Graph.detachNode(other_node);
                         some_detached = true;
                     }
                     break;
@@ -835,14 +831,14 @@ int NodeManager::cleanGraph(void)
                 default:
                 {
                     // get the rank for the the inner and jumping edges.
-                    if((*nv_iter)->getInnerRank() != 1)
+                    if(NM_Graph.getInnerRank(other_node) != 1)
                     {
                         // there are multiple inner edges for this guy
                         if(clearBubbles(*nv_iter, CN_EDGE_FORWARD))
                         	some_detached = true;
                     }
                     
-                    if((*nv_iter)->getJumpingRank() != 1)
+                    if(NM_Graph.getJumpingRank(other_node) != 1)
                     {
                         // there are multiple jumping edges for this guy
                         if(clearBubbles(*nv_iter, CN_EDGE_JUMPING_F))
@@ -865,49 +861,48 @@ bool NodeManager::clearBubbles(CrisprNode * rootNode, EDGE_TYPE currentEdgeType)
 	bool some_detached = false;
 	
     // get a list of edges
-    edgeList * curr_edges = rootNode->getEdges(currentEdgeType);
+    int root_node = rootNode->getIndex();
+    EDGE_TYPE opposite_edge_type = getOppositeEdgeType(currentEdgeType);
     
     // the key is the hashed values of both the root node and the edge
-    // the value is the node id of the edge
+    // the value is the node index of the edge
     std::map<int, int> bubble_map;
     
     // now go through each of the edges and make a hashed key for the edge 
-    edgeListIterator curr_edges_iter; //= curr_edges->begin();
-    for (curr_edges_iter = curr_edges->begin(); curr_edges_iter != curr_edges->end(); ++curr_edges_iter) {
+    for (unsigned int curr_edge = NM_Graph.edgeBegin(root_node, currentEdgeType); curr_edge < NM_Graph.edgeEnd(root_node, currentEdgeType); ++curr_edge) {
         
-        if ( !(curr_edges_iter->first)->isAttached()) 
+        int curr_node = NM_Graph.edgeTarget(curr_edge);
+        if ( !NM_Graph.isAttached(curr_node)) 
         {
             continue;
         }
         // we want to go through all the edges of the nodes above (2nd degree separation)
         // and since we used the forward edges to get here we now want the opposite (Jummping_F)
-        edgeList * edges_of_curr_edge = (curr_edges_iter->first)->getEdges(getOppositeEdgeType(currentEdgeType));
-        
-        edgeListIterator edges_of_curr_edge_iter; //= edges_of_curr_edge->begin();
-        for (edges_of_curr_edge_iter = edges_of_curr_edge->begin(); edges_of_curr_edge_iter != edges_of_curr_edge->end(); ++edges_of_curr_edge_iter) 
+        for (unsigned int edge_of_curr_edge = NM_Graph.edgeBegin(curr_node, opposite_edge_type); edge_of_curr_edge < NM_Graph.edgeEnd(curr_node, opposite_edge_type); ++edge_of_curr_edge) 
         {
             // make sue that this guy is attached
-            if (! (edges_of_curr_edge_iter->first)->isAttached()) 
+            int second_node = NM_Graph.edgeTarget(edge_of_curr_edge);
+            if (! NM_Graph.isAttached(second_node)) 
             {
                 continue;
             }
             // so now we're at the second degree of separation for our edges
             // again make a key but check to see if the key exists in the hash
             
-            int new_key = makeKey(rootNode->getID(), (edges_of_curr_edge_iter->first)->getID());
+            int new_key = makeKey(rootNode->getID(), NM_Graph.getNode(second_node)->getID());
             if (bubble_map.find(new_key) == bubble_map.end()) 
             {
                 // first time we've seen him
-                bubble_map[new_key] = (curr_edges_iter->first)->getID();
+                bubble_map[new_key] = curr_node;
             } 
             else 
             {
                 // aha! he is pointing back onto the same guy as someone else.  We have a bubble!
                 //get the CrisprNode of the first guy
                 
-                CrisprNode * first_node = NM_Nodes[bubble_map[new_key]];
+                int first_node = bubble_map[new_key];
 #ifdef DEBUG
-                logInfo("Bubble found conecting "<<rootNode->getID()<<" : "<<first_node->getID()<<" : "<<(edges_of_curr_edge_iter->first)->getID()<< " : "<<(curr_edges_iter->first)->getID(), 8);
+                logInfo("Bubble found conecting "<<rootNode->getID()<<" : "<<NM_Graph.getNode(first_node)->getID()<<" : "<<NM_Graph.getNode(second_node)->getID()<< " : "<<NM_Graph.getNode(curr_node)->getID(), 8);
 #endif
                 //perform a coverage test on the nodes that end up here and kill the one with the least coverage
                 
@@ -917,32 +912,32 @@ bool NodeManager::clearBubbles(CrisprNode * rootNode, EDGE_TYPE currentEdgeType)
                 // NodeManager to calculate the average and stdev of the coverage and then remove a node only if
                 // it is below 1 stdev of the average, else it could be a biological thing that this bubble exists.
                 
-                if (first_node->getDiscountedCoverage() > (curr_edges_iter->first)->getDiscountedCoverage()) 
+                if (NM_Graph.getDiscountedCoverage(first_node) > NM_Graph.getDiscountedCoverage(curr_node)) 
                 {
 #ifdef DEBUG
-                    logInfo("Node "<<first_node->getID()<<" has higher discounted coverage ("<<first_node->getDiscountedCoverage()<<") than Node "<<(curr_edges_iter->first)->getID()<<" ("<<(curr_edges_iter->first)->getDiscountedCoverage()<<")", 8);
+                    logInfo("Node "<<NM_Graph.getNode(first_node)->getID()<<" has higher discounted coverage ("<<NM_Graph.getDiscountedCoverage(first_node)<<") than Node "<<NM_Graph.getNode(curr_node)->getID()<<" ("<<NM_Graph.getDiscountedCoverage(curr_node)<<")", 8);
 #endif
                     
                     // the first guy has greater coverage so detach our current node
-                    (curr_edges_iter->first)->detachNode();
+                    NM_Graph.detachNode(curr_node);
                     some_detached = true;
 #ifdef DEBUG
-                    logInfo("Detaching "<<(curr_edges_iter->first)->getID()<<" as it has lower coverage", 8);
+                    logInfo("Detaching "<<NM_Graph.getNode(curr_node)->getID()<<" as it has lower coverage", 8);
 #endif
                 } 
                 else 
                 {
 #ifdef DEBUG
-                    logInfo("Node "<<first_node->getID()<<" has lower discounted coverage ("<<first_node->getDiscountedCoverage()<<") than Node "<<(curr_edges_iter->first)->getID()<<" ("<<(curr_edges_iter->first)->getDiscountedCoverage()<<")", 8);
+                    logInfo("Node "<<NM_Graph.getNode(first_node)->getID()<<" has lower discounted coverage ("<<NM_Graph.getDiscountedCoverage(first_node)<<") than Node "<<NM_Graph.getNode(curr_node)->getID()<<" ("<<NM_Graph.getDiscountedCoverage(curr_node)<<")", 8);
 #endif
                     // the first guy was lower so kill him
-                    first_node->detachNode();
+                    NM_Graph.detachNode(first_node);
                     some_detached = true;
 #ifdef DEBUG
-                    logInfo("Detaching "<<first_node->getID()<<" as it has lower coverage", 8);
+                    logInfo("Detaching "<<NM_Graph.getNode(first_node)->getID()<<" as it has lower coverage", 8);
 #endif
                     // replace the existing key (to check for triple bubbles)
-                    bubble_map[new_key] = (curr_edges_iter->first)->getID();
+                    bubble_map[new_key] = curr_node;
                 }
             }
         }
@@ -1007,7 +1002,7 @@ void NodeManager::clearContigs(void)
             SpacerVectorIterator sp_iter = (cl_iter->second)->begin();
             while(sp_iter != (cl_iter->second)->end())
             {
-                (NM_Spacers[*sp_iter])->setContigID(0);
+                (NM_Spacers.find(*sp_iter))->setContigID(0);
                 sp_iter++;
             }
             delete cl_iter->second;
@@ -1024,14 +1019,12 @@ void NodeManager::findAllForwardAttachedNodes(NodeVector * nodes)
     //
     nodes->clear();
     
-    NodeListIterator all_node_iter = NM_Nodes.begin();
-    while (all_node_iter != NM_Nodes.end()) 
+    for (int node = 0; node < NM_Graph.size(); node++) 
     {
-        if((all_node_iter->second)->isAttached()&& (all_node_iter->second)->isForward())
+        if(NM_Graph.isAttached(node) && (NM_Graph.getNode(node))->isForward())
         {
-            nodes->push_back(all_node_iter->second);
+            nodes->push_back(NM_Graph.getNode(node));
         }
-        all_node_iter++;
     }
 }
 
@@ -1045,10 +1038,10 @@ int NodeManager::buildSpacerGraph(void)
     while(spacers_iter != NM_Spacers.end()) 
     {
         // get the last node of this spacer
-        CrisprNode * rq_leader_node = (spacers_iter->second)->getLeader();
-        CrisprNode * rq_last_node = (spacers_iter->second)->getLast();
+        int rq_leader_node = ((spacers_iter->second)->getLeader())->getIndex();
+        int rq_last_node = ((spacers_iter->second)->getLast())->getIndex();
         
-        if(rq_last_node->isAttached() && rq_leader_node->isAttached())
+        if(NM_Graph.isAttached(rq_last_node) && NM_Graph.isAttached(rq_leader_node))
         {
             // mark this guy as attached
             (spacers_iter->second)->setAttached(true);
@@ -1058,21 +1051,19 @@ int NodeManager::buildSpacerGraph(void)
             logInfo("Spacer "<<debug_spacer->getID()<<" composed of nodes "<<(debug_spacer->getLeader())->getID()<<" "<<(debug_spacer->getLast())->getID(), 8);
 #endif
             // now get all the jumping forward edges from this node
-            edgeList * qel = rq_last_node->getEdges(CN_EDGE_JUMPING_F);
-            edgeListIterator qel_iter = qel->begin();
-            while(qel_iter != qel->end())
+            for(unsigned int qel = NM_Graph.edgeBegin(rq_last_node, CN_EDGE_JUMPING_F); qel < NM_Graph.edgeEnd(rq_last_node, CN_EDGE_JUMPING_F); qel++)
             {
-                if((qel_iter->first)->isAttached() && (qel_iter->first)->isForward())
+                int jumping_node = NM_Graph.edgeTarget(qel);
+                if(NM_Graph.isAttached(jumping_node) && (NM_Graph.getNode(jumping_node))->isForward())
                 {
                     // a forward attached node. Now check for inner edges.
-                    edgeList * el = (qel_iter->first)->getEdges(CN_EDGE_FORWARD);
-                    edgeListIterator el_iter = el->begin();
-                    while(el_iter != el->end())
+                    for(unsigned int el = NM_Graph.edgeBegin(jumping_node, CN_EDGE_FORWARD); el < NM_Graph.edgeEnd(jumping_node, CN_EDGE_FORWARD); el++)
                     {
-                        if((el_iter->first)->isAttached())
+                        int inner_node = NM_Graph.edgeTarget(el);
+                        if(NM_Graph.isAttached(inner_node))
                         {
                             // bingo!
-                            SpacerInstance * next_spacer = NM_Spacers[makeSpacerKey((el_iter->first)->getID(), (qel_iter->first)->getID())];
+                            SpacerInstance * next_spacer = NM_Spacers.find(makeSpacerKey((NM_Graph.getNode(inner_node))->getID(), (NM_Graph.getNode(jumping_node))->getID()));
                             
                             if (next_spacer == spacers_iter->second) {
                                 //logError("Spacer "<<spacers_iter->second << " with id "<< (spacers_iter->second)->getID()<< " has an edge to itself... aborting edge "<<next_spacer <<" : "<< spacers_iter->second);
@@ -1081,23 +1072,15 @@ int NodeManager::buildSpacerGraph(void)
                             {
                                 // we can add an edge for these two spacers
                                 // add the forward edge to the next spacer
-                                spacerEdgeStruct * new_edge = new spacerEdgeStruct();
-                                new_edge->edge = next_spacer;
-                                new_edge->d = FORWARD;
-                                (spacers_iter->second)->addEdge(new_edge);
+                                NM_SpacerGraph.addEdge(spacers_iter->second, next_spacer, FORWARD);
                                 
                                 // add the corresponding reverse edge to the current spacer
-                                spacerEdgeStruct * new_edge2 = new spacerEdgeStruct();
-                                new_edge2->edge = spacers_iter->second;
-                                new_edge2->d = REVERSE;
-                                next_spacer->addEdge(new_edge2);
+                                NM_SpacerGraph.addEdge(next_spacer, spacers_iter->second, REVERSE);
                             }
 
                         }
-                        el_iter++;
                     }
                 }
-                qel_iter++;
             }
         }
         else
@@ -1106,6 +1089,9 @@ int NodeManager::buildSpacerGraph(void)
         }
         spacers_iter++;
     }
+    
+    // the spacer graph is read only from here on
+    NM_SpacerGraph.freeze();
     return 0;
 }
 
@@ -1116,7 +1102,7 @@ void NodeManager::getAllSpacerCaps(SpacerInstanceVector * sv)
     {
         if((sp_iter->second)->isAttached() )
         {
-            if ((sp_iter->second)->getSpacerRank() == 1) 
+            if (NM_SpacerGraph.getRank(sp_iter->second) == 1) 
             {
                 sv->push_back(sp_iter->second);
             }
@@ -1163,11 +1149,11 @@ int NodeManager::cleanSpacerGraph(void)
         {
             if((sp_iter->second)->isAttached())
             {
-                if(sp_iter->second->isFur())
+                if(NM_SpacerGraph.isFur(sp_iter->second))
                 {
                     //std::cout << "a: " << (sp_iter->second) <<" round: "<<round<< std::endl;
                     //(sp_iter->second)->printContents();
-                    sp_iter->second->detachFromSpacerGraph();
+                    NM_SpacerGraph.detachFromSpacerGraph(sp_iter->second);
                     cleaned_some = true;
                 }
             }
@@ -1181,12 +1167,12 @@ int NodeManager::cleanSpacerGraph(void)
             //std::cout<<"Testing Attached: "<<(*sp_iter->second).getID()<<std::endl;
             if((sp_iter->second)->isAttached())
             {
-                if(!sp_iter->second->isViable())
+                if(!NM_SpacerGraph.isViable(sp_iter->second))
                 {
                     //std::cout << "b: " << sp_iter->second <<" round: "<<round<< std::endl;
                     //(sp_iter->second)->printContents();
 
-                    sp_iter->second->detachFromSpacerGraph();
+                    NM_SpacerGraph.detachFromSpacerGraph(sp_iter->second);
                     cleaned_some = true;
                 }
             }
@@ -1219,20 +1205,20 @@ void NodeManager::removeSpacerBubbles(void)
             continue;
         }
         // we only car about rank 2 or over nodes
-        if(2 > current_spacer->getSpacerRank())
+        if(2 > NM_SpacerGraph.getRank(current_spacer))
         {
             continue;
         }
         // first make a list of the forward and backward spacers
-        SpacerEdgeVector_Iterator edge_iter = current_spacer->begin();
         SpacerInstanceVector f_spacers, r_spacers;
-        while(edge_iter != current_spacer->end())
+        for(unsigned int edge = NM_SpacerGraph.edgeBegin(current_spacer); edge < NM_SpacerGraph.edgeEnd(current_spacer); edge++)
         {
-            if((*edge_iter)->d == REVERSE)
-                r_spacers.push_back((*edge_iter)->edge);
+            if(!NM_SpacerGraph.isLive(edge))
+                continue;
+            if(NM_SpacerGraph.edgeDirection(edge) == REVERSE)
+                r_spacers.push_back(NM_SpacerGraph.edgeTarget(edge));
             else
-                f_spacers.push_back((*edge_iter)->edge);
-            edge_iter++;
+                f_spacers.push_back(NM_SpacerGraph.edgeTarget(edge));
         }
         
         // now make a list of spacer keys 
@@ -1259,8 +1245,8 @@ void NodeManager::removeSpacerBubbles(void)
                 else
                 {
                     // bubble! -- perhaps, settle down son. We need to R-E-S-P-E-C-T directionality.                    
-                    if (curent_reverse_spacer->find(current_spacer) != curent_reverse_spacer->end()) {
-                        if (curent_reverse_spacer->find(bubble_map[tmp_key]) != curent_reverse_spacer->end()) {
+                    if (NM_SpacerGraph.hasEdge(curent_reverse_spacer, current_spacer)) {
+                        if (NM_SpacerGraph.hasEdge(curent_reverse_spacer, bubble_map[tmp_key])) {
                             continue;
                         }
                     }
@@ -1281,7 +1267,7 @@ void NodeManager::removeSpacerBubbles(void)
                     else
                     {
                         // coverages are equal, kill the one with the lower rank
-                        if(bubble_map[tmp_key]->getSpacerRank() < current_spacer->getSpacerRank())
+                        if(NM_SpacerGraph.getRank(bubble_map[tmp_key]) < NM_SpacerGraph.getRank(current_spacer))
                         {
                             // stored guy has lower coverage!
                             detach_list.push_back(bubble_map[tmp_key]);
@@ -1302,7 +1288,7 @@ void NodeManager::removeSpacerBubbles(void)
     SpacerInstanceVector_Iterator dl_iter = detach_list.begin();
     while(dl_iter != detach_list.end())
     {
-        (*dl_iter)->detachFromSpacerGraph();
+        NM_SpacerGraph.detachFromSpacerGraph(*dl_iter);
         dl_iter++;
     }
     
@@ -1346,7 +1332,7 @@ int NodeManager::splitIntoContigs(void)
             
             current_contig_spacers.push_back(walk_elem->first());
             
-            if ((walk_elem->second())->getSpacerRank() == 1) 
+            if (NM_SpacerGraph.getRank(walk_elem->second()) == 1) 
             {
                 // end of path
                 current_contig_spacers.push_back(walk_elem->second());
@@ -1380,13 +1366,17 @@ bool NodeManager::walkFromCross(SpacerInstanceList * crossNodes)
         (*cross_node_iter)->setContigID(NM_NextContigID++);
         // walk along those edges as long as possible making sure that the first edge is not a 
         // cross node and that the nodes don't already have a contig id
-        SpacerEdgeVector_Iterator edge_iter = (*cross_node_iter)->begin();
-        while (edge_iter != (*cross_node_iter)->end()) 
+        for (unsigned int edge = NM_SpacerGraph.edgeBegin(*cross_node_iter); edge < NM_SpacerGraph.edgeEnd(*cross_node_iter); ++edge) 
         {
+            if (!NM_SpacerGraph.isLive(edge))
+            {
+                continue;
+            }
             // go through all the edges of the cross node that do not have a contig id
-            if (((*edge_iter)->edge->isAttached()) && (0 == (*edge_iter)->edge->getContigID())) 
+            SpacerInstance * edge_spacer = NM_SpacerGraph.edgeTarget(edge);
+            if ((edge_spacer->isAttached()) && (0 == edge_spacer->getContigID())) 
             {
-                if( getSpacerEdgeFromCross(walk_elem, (*edge_iter)->edge))
+                if( getSpacerEdgeFromCross(walk_elem, edge_spacer))
                 {
 
                     SpacerInstanceVector current_contig_nodes;
@@ -1399,7 +1389,7 @@ bool NodeManager::walkFromCross(SpacerInstanceList * crossNodes)
                         }
                     } while (stepThroughSpacerPath(walk_elem, &previous_node));
                     
-                    if ((walk_elem->second())->getSpacerRank() == 1 && (walk_elem->second())->isAttached()) 
+                    if (NM_SpacerGraph.getRank(walk_elem->second()) == 1 && (walk_elem->second())->isAttached()) 
                     {
                         // end of path
                         current_contig_nodes.push_back(walk_elem->second());
@@ -1419,10 +1409,9 @@ bool NodeManager::walkFromCross(SpacerInstanceList * crossNodes)
                 else 
                 {                    
                     // means that the edge is a cross node so push it back on to the list
-                    crossNodes->push_back((*edge_iter)->edge);
+                    crossNodes->push_back(edge_spacer);
                 }
             }
-            ++edge_iter;
         }
         cross_node_iter++;
     }
@@ -1463,7 +1452,7 @@ void NodeManager::dumpReads(std::string readsFileName, bool showDetached)
             CrisprNode * Cleader = SI->getLeader();
             CrisprNode * Clast = SI->getLast();
             
-            if(showDetached || ((SI->getLeader())->isAttached() && (SI->getLast())->isAttached()))
+            if(showDetached || (NM_Graph.isAttached(SI->getLeader()) && NM_Graph.isAttached(SI->getLast())))
             {
                 std::vector<std::string> headers = Cleader->getReadHeaders(&NM_StringCheck);
                 std::vector<std::string>::iterator h_iter = headers.begin();
@@ -1510,7 +1499,7 @@ void NodeManager::addSpacersToDOM(crispr::xml::writer * xmlDoc,
     while(spacer_iter != NM_Spacers.end())
     {
         SpacerInstance * SI = spacer_iter->second;
-        if((showDetached || ((SI->getLeader())->isAttached() && (SI->getLast())->isAttached())) && !(SI->isFlanker()))
+        if((showDetached || (NM_Graph.isAttached(SI->getLeader()) && NM_Graph.isAttached(SI->getLast()))) && !(SI->isFlanker()))
         {
             std::set<StringToken> nr_tokens;
             getHeadersForSpacers(SI, nr_tokens);
@@ -1538,7 +1527,7 @@ void NodeManager::addFlankersToDOM(crispr::xml::writer * xmlDoc,
     SpacerInstanceVector_Iterator iter;
     for (iter = NM_FlankerNodes.begin(); iter != NM_FlankerNodes.end(); iter++) {
         SpacerInstance * SI = *iter;
-        if(showDetached || ((SI->getLeader())->isAttached() && (SI->getLast())->isAttached()))
+        if(showDetached || (NM_Graph.isAttached(SI->getLeader()) && NM_Graph.isAttached(SI->getLast())))
         {
             std::set<StringToken> nr_tokens;
             getHeadersForSpacers(SI, nr_tokens);
@@ -1589,21 +1578,25 @@ void NodeManager::printAssemblyToDOM(crispr::xml::writer * xmlDoc, xercesc::DOME
                     xercesc::DOMElement * bspacers = NULL;
                     xercesc::DOMElement * fflankers = NULL;
                     xercesc::DOMElement * bflankers = NULL;
-                    SpacerEdgeVector_Iterator sp_iter = SI->begin();
-                    while (sp_iter != SI->end()) 
+                    for (unsigned int edge = NM_SpacerGraph.edgeBegin(SI); edge < NM_SpacerGraph.edgeEnd(SI); ++edge) 
                     {
-                        if ((*sp_iter)->edge->isAttached()) 
+                        if (!NM_SpacerGraph.isLive(edge))
+                        {
+                            continue;
+                        }
+                        SpacerInstance * edge_spacer = NM_SpacerGraph.edgeTarget(edge);
+                        if (edge_spacer->isAttached()) 
                         {
 
-                            std::string edge_id = (SI->isFlanker()) ? "FL" + to_string((*sp_iter)->edge->getID()) : "SP" + to_string((*sp_iter)->edge->getID());
+                            std::string edge_id = (SI->isFlanker()) ? "FL" + to_string(edge_spacer->getID()) : "SP" + to_string(edge_spacer->getID());
                             std::string drid = "DR1";
                             std::string drconf = "0";
                             std::string directjoin = "0";
-                            switch ((*sp_iter)->d) 
+                            switch (NM_SpacerGraph.edgeDirection(edge)) 
                             {
                                 case FORWARD:
                                 {
-                                    if ((*sp_iter)->edge->isFlanker()) {
+                                    if (edge_spacer->isFlanker()) {
                                         if (ff) 
                                         {
                                             // we've already created <fflankers>
@@ -1637,7 +1630,7 @@ void NodeManager::printAssemblyToDOM(crispr::xml::writer * xmlDoc, xercesc::DOME
                                 }
                                 case REVERSE:
                                 {
-                                    if ((*sp_iter)->edge->isFlanker()) {
+                                    if (edge_spacer->isFlanker()) {
                                         if (bf) 
                                         {
                                             // we've already created <bflankers>
@@ -1675,7 +1668,6 @@ void NodeManager::printAssemblyToDOM(crispr::xml::writer * xmlDoc, xercesc::DOME
                                 }
                             }
                         }
-                        ++sp_iter;
                     }
                     if (bspacers != NULL) 
                     {
@@ -1833,7 +1825,7 @@ void NodeManager::printDebugGraph(std::ostream &dataOut, std::string title, bool
     while (nl_iter != nodeEnd()) 
     {
         // check whether we should print
-        if((nl_iter->second)->isAttached() | showDetached)
+        if(NM_Graph.isAttached(nl_iter->second) | showDetached)
         {
             printDebugNodeAttributes(dataOut, nl_iter->second ,NM_DebugRainbow.getColour((nl_iter->second)->getCoverage()), longDesc);
         }
@@ -1845,14 +1837,14 @@ void NodeManager::printDebugGraph(std::ostream &dataOut, std::string title, bool
     while (nl_iter != nodeEnd()) 
     {
         // check whether we should print
-        if((nl_iter->second)->isAttached() | showDetached)
+        if(NM_Graph.isAttached(nl_iter->second) | showDetached)
         {
             std::stringstream ss;
             if(longDesc)
                 ss << (nl_iter->second)->getID() << "_" << NM_StringCheck.getString((nl_iter->second)->getID());
             else
                 ss << (nl_iter->second)->getID();
-            (nl_iter->second)->printEdges(dataOut, &NM_StringCheck, ss.str(), showDetached, printBackEdges, longDesc);
+            NM_Graph.printEdges((nl_iter->second)->getIndex(), dataOut, &NM_StringCheck, ss.str(), showDetached, printBackEdges, longDesc);
         }
         nl_iter++;
     }
@@ -1892,7 +1884,7 @@ bool NodeManager::printSpacerGraph(std::string& outFileName, std::string title,
     SpacerListIterator spi_iter = NM_Spacers.begin();
     while (spi_iter != NM_Spacers.end()) 
     {
-        if ((spi_iter->second)->isAttached() && (showSingles || (0 != (spi_iter->second)->getSpacerRank()))) 
+        if ((spi_iter->second)->isAttached() && (showSingles || (0 != NM_SpacerGraph.getRank(spi_iter->second)))) 
         {
             at_least_one_spacer = true;
             // print the graphviz nodes
@@ -1921,23 +1913,26 @@ bool NodeManager::printSpacerGraph(std::string& outFileName, std::string title,
         spi_iter = NM_Spacers.begin();
         while (spi_iter != NM_Spacers.end()) 
         {
-            if ((spi_iter->second)->isAttached() && (showSingles || (0 != (spi_iter->second)->getSpacerRank()))) 
+            if ((spi_iter->second)->isAttached() && (showSingles || (0 != NM_SpacerGraph.getRank(spi_iter->second)))) 
             {
                 // print the graphviz nodes
                 std::string label = getSpacerGraphLabel(spi_iter->second, longDesc);
                 // print the node attribute
                 // now print the edges
-                SpacerEdgeVector_Iterator edge_iter = (spi_iter->second)->begin();
-                while (edge_iter != (spi_iter->second)->end()) 
+                for (unsigned int edge = NM_SpacerGraph.edgeBegin(spi_iter->second); edge < NM_SpacerGraph.edgeEnd(spi_iter->second); edge++) 
                 {
-                    if (((*edge_iter)->edge)->isAttached() && (*edge_iter)->d == FORWARD && (showSingles || (0 != ((*edge_iter)->edge)->getSpacerRank()))) 
+                    if (!NM_SpacerGraph.isLive(edge))
+                    {
+                        continue;
+                    }
+                    SpacerInstance * edge_spacer = NM_SpacerGraph.edgeTarget(edge);
+                    if (edge_spacer->isAttached() && NM_SpacerGraph.edgeDirection(edge) == FORWARD && (showSingles || (0 != NM_SpacerGraph.getRank(edge_spacer)))) 
                     {
                         
                         // get the label for our edge
                         // print the graphviz nodes
-                        gvSpEdge(data_out, label, getSpacerGraphLabel((*edge_iter)->edge, longDesc));
+                        gvSpEdge(data_out, label, getSpacerGraphLabel(edge_spacer, longDesc));
                     }
-                    edge_iter++;
                 }
             }   
             spi_iter++;
@@ -1989,6 +1984,13 @@ void NodeManager::printAllSpacers(void)
     while(sp_iter != NM_Spacers.end())
     {
         (sp_iter->second)->printContents(); 
+        for(unsigned int edge = NM_SpacerGraph.edgeBegin(sp_iter->second); edge < NM_SpacerGraph.edgeEnd(sp_iter->second); edge++)
+        {
+            if(NM_SpacerGraph.isLive(edge))
+            {
+                std::cout << " --> " << NM_SpacerGraph.edgeTarget(edge) << " : " << NM_SpacerGraph.edgeDirection(edge) << std::endl;
+            }
+        }
         sp_iter++;
     }
 }
@@ -2042,10 +2044,10 @@ void NodeManager::generateFlankers(bool showDetached)
         {
             SpacerInstance * SI = spacer_iter->second;
  
-            if(showDetached || ((SI->getLeader())->isAttached() && (SI->getLast())->isAttached()))
+            if(showDetached || (NM_Graph.isAttached(SI->getLeader()) && NM_Graph.isAttached(SI->getLast())))
             {
                 /*if(SI->isCap()) {*/
-                    int spacer_length = (int)(NM_StringCheck.getString(SI->getID())).length();
+                    int spacer_length = (int)NM_StringCheck.getLength(SI->getID());
                     if (spacer_length > upper_bound || spacer_length < lower_bound) {
                         SI->setFlanker(true);
                         NM_FlankerNodes.push_back(SI);
@@ -52,9 +52,13 @@
 #include "NodeManager.h"
 #include "crassDefines.h"
 #include "CrisprNode.h"
+#include "CrisprGraph.h"
 #include "SpacerInstance.h"
+#include "SpacerGraph.h"
+#include "SpacerTable.h"
 #include "libcrispr.h"
 #include "StringCheck.h"
+#include "PackedKmer.h"
 #include "ReadHolder.h"
 #include "GraphDrawingDefines.h"
 #include "Rainbow.h"
@@ -69,8 +73,8 @@
 typedef std::map<StringToken, CrisprNode *> NodeList;
 typedef std::map<StringToken, CrisprNode *>::iterator NodeListIterator;
 
-typedef std::map<SpacerKey, SpacerInstance *> SpacerList;
-typedef std::map<SpacerKey, SpacerInstance *>::iterator SpacerListIterator;
+typedef SpacerTable SpacerList;
+typedef SpacerTable::iterator SpacerListIterator;
 
 typedef std::vector<CrisprNode *> NodeVector;
 typedef std::vector<CrisprNode *>::iterator NodeVectorIterator;
@@ -126,6 +130,9 @@ class NodeManager {
 
 		bool addReadHolder(ReadHolder * RH);
 
+        // call once all the reads are in, the node graph is read only after this
+        void freezeGraph(void);
+
         NodeListIterator nodeBegin(void) { return NM_Nodes.begin(); } 
         NodeListIterator nodeEnd(void) { return NM_Nodes.end(); }
         
@@ -261,6 +268,8 @@ class NodeManager {
 	// functions
 		bool splitReadHolder(ReadHolder * RH);
 
+		CrisprNode * getKmerNode(std::string& kmer, bool forward);
+    
 		void addCrisprNodes(CrisprNode ** prevNode, 
                             std::string& workingString, 
                             StringToken headerSt,
@@ -283,7 +292,10 @@ class NodeManager {
     // members
         std::string NM_DirectRepeatSequence;  				// the sequence of this managers direct repeat
         NodeList NM_Nodes;                    				// list of CrisprNodes this manager manages
+        CrisprGraph NM_Graph;                               // edges between the CrisprNodes
+        KmerHashMap<StringToken> NM_KmerTokens;             // node IDs by packed kmer
         SpacerList NM_Spacers;                				// list of all the spacers
+        SpacerGraph NM_SpacerGraph;                         // edges between the spacers
         ReadList NM_ReadList;                 				// list of readholders
         StringCheck NM_StringCheck;           				// string check object for unique strings 
         Rainbow NM_DebugRainbow;              				// the Rainbow class for making colours
@@ -0,0 +1,372 @@
+/*
+ *  PackedKmer.h is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Two bit DNA for everything that cuts kmers. Only upper case ACGT are
+ *  packed and A < C < G < T, so packed kmers sort the same way as the
+ *  strings they came from and the smaller of a kmer and its reverse
+ *  complement is its laurenized form. Also has counters keyed by packed
+ *  kmers, a flat array for short kmers and an open addressing map for
+ *  the rest.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+#ifndef crass_PackedKmer_h
+#define crass_PackedKmer_h
+
+// system includes
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// the longest kmer that fits in a PackedKmer
+#define PK_MAX_KMER_LENGTH      32
+
+// code for anything that isn't an upper case ACGT
+#define PK_NOT_ACGT             4
+
+typedef uint64_t PackedKmer;
+
+static const unsigned char PK_BASE_CODE[256] = {
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 0, 4, 1, 4, 4, 4, 2, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4
+};
+
+static const char PK_CODE_BASE[4] = {'A', 'C', 'G', 'T'};
+
+// the reverse complement of the four bases packed in a byte
+static const unsigned char PK_REVCOMP_BYTE[256] = {
+    0xff, 0xbf, 0x7f, 0x3f, 0xef, 0xaf, 0x6f, 0x2f, 0xdf, 0x9f, 0x5f, 0x1f, 0xcf, 0x8f, 0x4f, 0x0f,
+    0xfb, 0xbb, 0x7b, 0x3b, 0xeb, 0xab, 0x6b, 0x2b, 0xdb, 0x9b, 0x5b, 0x1b, 0xcb, 0x8b, 0x4b, 0x0b,
+    0xf7, 0xb7, 0x77, 0x37, 0xe7, 0xa7, 0x67, 0x27, 0xd7, 0x97, 0x57, 0x17, 0xc7, 0x87, 0x47, 0x07,
+    0xf3, 0xb3, 0x73, 0x33, 0xe3, 0xa3, 0x63, 0x23, 0xd3, 0x93, 0x53, 0x13, 0xc3, 0x83, 0x43, 0x03,
+    0xfe, 0xbe, 0x7e, 0x3e, 0xee, 0xae, 0x6e, 0x2e, 0xde, 0x9e, 0x5e, 0x1e, 0xce, 0x8e, 0x4e, 0x0e,
+    0xfa, 0xba, 0x7a, 0x3a, 0xea, 0xaa, 0x6a, 0x2a, 0xda, 0x9a, 0x5a, 0x1a, 0xca, 0x8a, 0x4a, 0x0a,
+    0xf6, 0xb6, 0x76, 0x36, 0xe6, 0xa6, 0x66, 0x26, 0xd6, 0x96, 0x56, 0x16, 0xc6, 0x86, 0x46, 0x06,
+    0xf2, 0xb2, 0x72, 0x32, 0xe2, 0xa2, 0x62, 0x22, 0xd2, 0x92, 0x52, 0x12, 0xc2, 0x82, 0x42, 0x02,
+    0xfd, 0xbd, 0x7d, 0x3d, 0xed, 0xad, 0x6d, 0x2d, 0xdd, 0x9d, 0x5d, 0x1d, 0xcd, 0x8d, 0x4d, 0x0d,
+    0xf9, 0xb9, 0x79, 0x39, 0xe9, 0xa9, 0x69, 0x29, 0xd9, 0x99, 0x59, 0x19, 0xc9, 0x89, 0x49, 0x09,
+    0xf5, 0xb5, 0x75, 0x35, 0xe5, 0xa5, 0x65, 0x25, 0xd5, 0x95, 0x55, 0x15, 0xc5, 0x85, 0x45, 0x05,
+    0xf1, 0xb1, 0x71, 0x31, 0xe1, 0xa1, 0x61, 0x21, 0xd1, 0x91, 0x51, 0x11, 0xc1, 0x81, 0x41, 0x01,
+    0xfc, 0xbc, 0x7c, 0x3c, 0xec, 0xac, 0x6c, 0x2c, 0xdc, 0x9c, 0x5c, 0x1c, 0xcc, 0x8c, 0x4c, 0x0c,
+    0xf8, 0xb8, 0x78, 0x38, 0xe8, 0xa8, 0x68, 0x28, 0xd8, 0x98, 0x58, 0x18, 0xc8, 0x88, 0x48, 0x08,
+    0xf4, 0xb4, 0x74, 0x34, 0xe4, 0xa4, 0x64, 0x24, 0xd4, 0x94, 0x54, 0x14, 0xc4, 0x84, 0x44, 0x04,
+    0xf0, 0xb0, 0x70, 0x30, 0xe0, 0xa0, 0x60, 0x20, 0xd0, 0x90, 0x50, 0x10, 0xc0, 0x80, 0x40, 0x00
+};
+
+inline unsigned char packBase(char base)
+{
+    return PK_BASE_CODE[static_cast<unsigned char>(base)];
+}
+
+// lower case acgt get the same codes as upper case
+inline unsigned char packBaseAnyCase(char base)
+{
+    return PK_BASE_CODE[static_cast<unsigned char>(base) & 0xdf];
+}
+
+inline char unpackBase(unsigned char code)
+{
+    return PK_CODE_BASE[code];
+}
+
+inline PackedKmer kmerMask(unsigned int kmerLength)
+{
+    return (kmerLength >= PK_MAX_KMER_LENGTH) ? ~static_cast<PackedKmer>(0) : ((static_cast<PackedKmer>(1) << (2 * kmerLength)) - 1);
+}
+
+//-----
+// Pack the kmerLength bases starting at start. False if any of them
+// aren't ACGT
+//
+inline bool packKmer(const std::string& seq, size_t start, unsigned int kmerLength, PackedKmer& kmer)
+{
+    kmer = 0;
+    for (size_t i = start; i < start + kmerLength; i++)
+    {
+        unsigned char code = packBase(seq[i]);
+        if (PK_NOT_ACGT == code)
+        {
+            return false;
+        }
+        kmer = (kmer << 2) | code;
+    }
+    return true;
+}
+
+inline std::string unpackKmer(PackedKmer kmer, unsigned int kmerLength)
+{
+    std::string seq(kmerLength, 'A');
+    for (int i = static_cast<int>(kmerLength) - 1; i >= 0; i--)
+    {
+        seq[i] = unpackBase(kmer & 3);
+        kmer >>= 2;
+    }
+    return seq;
+}
+
+inline PackedKmer reverseComplementKmer(PackedKmer kmer, unsigned int kmerLength)
+{
+    //-----
+    // a byte at a time from the back of the kmer to the front of the
+    // reverse complement. The unused high bits come out as Ts on the end
+    // and are shifted away
+    //
+    PackedKmer revcomp = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        revcomp = (revcomp << 8) | PK_REVCOMP_BYTE[kmer & 0xff];
+        kmer >>= 8;
+    }
+    return revcomp >> (2 * (PK_MAX_KMER_LENGTH - kmerLength));
+}
+
+//-----
+// the smaller of the kmer and its reverse complement, which is the packed
+// form of the laurenized kmer
+//
+inline PackedKmer canonicalKmer(PackedKmer kmer, unsigned int kmerLength)
+{
+    PackedKmer revcomp = reverseComplementKmer(kmer, kmerLength);
+    return (revcomp < kmer) ? revcomp : kmer;
+}
+
+//-----
+// Slides along a sequence a base at a time keeping the packed kmer that
+// ends at the last base and its reverse complement
+//
+class RollingKmer
+{
+    public:
+        RollingKmer(unsigned int kmerLength) : 
+            RK_Length(kmerLength),
+            RK_Mask(kmerMask(kmerLength)),
+            RK_TopShift(2 * (kmerLength - 1)),
+            RK_Forward(0),
+            RK_Reverse(0),
+            RK_Valid(0)
+        {}
+
+        // true when the last kmerLength bases were all ACGT
+        inline bool push(char base)
+        {
+            unsigned char code = packBase(base);
+            if (PK_NOT_ACGT == code)
+            {
+                RK_Valid = 0;
+                return false;
+            }
+            RK_Forward = ((RK_Forward << 2) | code) & RK_Mask;
+            RK_Reverse = (RK_Reverse >> 2) | (static_cast<PackedKmer>(3 - code) << RK_TopShift);
+            if (RK_Valid < RK_Length)
+            {
+                RK_Valid++;
+            }
+            return RK_Valid == RK_Length;
+        }
+
+        inline void reset(void) { RK_Valid = 0; }
+
+        inline PackedKmer forward(void) const { return RK_Forward; }
+
+        inline PackedKmer reverse(void) const { return RK_Reverse; }
+
+        inline PackedKmer canonical(void) const { return (RK_Reverse < RK_Forward) ? RK_Reverse : RK_Forward; }
+
+    private:
+        unsigned int RK_Length;
+        PackedKmer RK_Mask;
+        unsigned int RK_TopShift;
+        PackedKmer RK_Forward;
+        PackedKmer RK_Reverse;
+        unsigned int RK_Valid;                              // ACGT bases in a row, up to RK_Length
+};
+
+//-----
+// A counter for every kmer of one length. Only for short kmers, it holds
+// 4^kmerLength counts
+//
+class KmerArrayCounter
+{
+    public:
+        KmerArrayCounter(unsigned int kmerLength) : 
+            KA_Counts(static_cast<size_t>(1) << (2 * kmerLength), 0)
+        {}
+
+        inline void add(PackedKmer kmer) { KA_Counts[kmer]++; }
+
+        inline int count(PackedKmer kmer) const { return KA_Counts[kmer]; }
+
+        inline int maxCount(void) const
+        {
+            int max_count = 0;
+            for (size_t i = 0; i < KA_Counts.size(); i++)
+            {
+                if (KA_Counts[i] > max_count)
+                {
+                    max_count = KA_Counts[i];
+                }
+            }
+            return max_count;
+        }
+
+    private:
+        std::vector<int> KA_Counts;
+};
+
+//-----
+// Open addressing map from a packed kmer to VALUE. Linear probing in a
+// power of two table that is never more than half full
+//
+template <class VALUE>
+class KmerHashMap
+{
+    public:
+        KmerHashMap(void) : 
+            KH_Keys(16),
+            KH_Values(16),
+            KH_Used(16, 0),
+            KH_Size(0),
+            KH_Shift(60)
+        {}
+
+        // NULL if the kmer isn't in the map
+        inline VALUE * find(PackedKmer kmer)
+        {
+            size_t slot = findSlot(kmer);
+            return KH_Used[slot] ? &(KH_Values[slot]) : NULL;
+        }
+
+        // the value for the kmer, a new VALUE() if it wasn't there
+        inline VALUE& operator[](PackedKmer kmer)
+        {
+            size_t slot = findSlot(kmer);
+            if (!KH_Used[slot])
+            {
+                if (2 * (KH_Size + 1) > KH_Keys.size())
+                {
+                    grow();
+                    slot = findSlot(kmer);
+                }
+                KH_Keys[slot] = kmer;
+                KH_Values[slot] = VALUE();
+                KH_Used[slot] = 1;
+                KH_Size++;
+            }
+            return KH_Values[slot];
+        }
+
+        inline size_t size(void) const { return KH_Size; }
+
+        void swap(KmerHashMap& other)
+        {
+            KH_Keys.swap(other.KH_Keys);
+            KH_Values.swap(other.KH_Values);
+            KH_Used.swap(other.KH_Used);
+            std::swap(KH_Size, other.KH_Size);
+            std::swap(KH_Shift, other.KH_Shift);
+        }
+
+        //-----
+        // Walk the map, start with slot at 0. False when there is nothing
+        // left, the order is the table order
+        //
+        inline bool next(size_t& slot, PackedKmer& kmer, VALUE *& value)
+        {
+            while (slot < KH_Keys.size())
+            {
+                size_t current = slot++;
+                if (KH_Used[current])
+                {
+                    kmer = KH_Keys[current];
+                    value = &(KH_Values[current]);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        inline size_t findSlot(PackedKmer kmer) const
+        {
+            size_t mask = KH_Keys.size() - 1;
+            size_t slot = static_cast<size_t>((kmer * 0x9E3779B97F4A7C15ULL) >> KH_Shift);
+            while (KH_Used[slot] && KH_Keys[slot] != kmer)
+            {
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        }
+
+        void grow(void)
+        {
+            std::vector<PackedKmer> old_keys;
+            std::vector<VALUE> old_values;
+            std::vector<unsigned char> old_used;
+            old_keys.swap(KH_Keys);
+            old_values.swap(KH_Values);
+            old_used.swap(KH_Used);
+            KH_Keys.resize(old_keys.size() * 2);
+            KH_Values.resize(old_keys.size() * 2);
+            KH_Used.assign(old_keys.size() * 2, 0);
+            KH_Shift--;
+            for (size_t i = 0; i < old_keys.size(); i++)
+            {
+                if (old_used[i])
+                {
+                    size_t slot = findSlot(old_keys[i]);
+                    KH_Keys[slot] = old_keys[i];
+                    KH_Values[slot] = old_values[i];
+                    KH_Used[slot] = 1;
+                }
+            }
+        }
+
+        std::vector<PackedKmer> KH_Keys;
+        std::vector<VALUE> KH_Values;
+        std::vector<unsigned char> KH_Used;
+        size_t KH_Size;
+        unsigned int KH_Shift;                              // 64 - log2(table size)
+};
+
+#endif //crass_PackedKmer_h
@@ -22,6 +22,10 @@
 
 #include "PatternMatcher.h"
 #include <algorithm>
+#include <stdint.h>
+
+// longest string that fits in a single bit vector
+#define BIT_VECTOR_LENGTH 64
 
 int PatternMatcher::bmpSearch(const std::string &text, const std::string &pattern){
     size_t textSize = text.size();
@@ -108,8 +112,83 @@ std::vector<int> PatternMatcher::computeBmpLast(const std::string &pattern){
     return bmpLast;
 }
 
+//-----
+// Hyyro's bit-vector version of Myers' algorithm with transpositions, the
+// rows of the matrix are one bit each so a whole column is done with a few
+// word operations. peq holds a bit for every row whose character matches.
+// Like the dynamic programming version transpositions are only counted
+// from the third row and column on
+//
+static int bitParallelDistance(const uint64_t * peq, int rows, const std::string& target)
+{
+    uint64_t high_bit = 1ULL << (rows - 1);
+    uint64_t vp = ~0ULL;
+    uint64_t vn = 0;
+    uint64_t d0 = 0;
+    uint64_t pm_prev = 0;
+    int score = rows;
+    for (size_t j = 0; j < target.length(); j++)
+    {
+        uint64_t pm = peq[static_cast<unsigned char>(target[j])];
+        uint64_t tr = 0;
+        if (j >= 2)
+        {
+            tr = ((((~d0) & pm) << 1) & pm_prev) & ~3ULL;
+        }
+        d0 = (((pm & vp) + vp) ^ vp) | pm | vn | tr;
+        uint64_t hp = vn | ~(d0 | vp);
+        uint64_t hn = d0 & vp;
+        if (hp & high_bit)
+        {
+            score++;
+        }
+        else if (hn & high_bit)
+        {
+            score--;
+        }
+        hp = (hp << 1) | 1;
+        hn <<= 1;
+        vp = hn | ~(d0 | hp);
+        vn = hp & d0;
+        pm_prev = pm;
+    }
+    return score;
+}
+
 int PatternMatcher::levenstheinDistance( std::string& source,  std::string& target) {
     
+    int n = (int)source.length();
+    int m = (int)target.length();
+    if (n == 0) {
+        return m;
+    }
+    if (m == 0) {
+        return n;
+    }
+    
+    // the distance is symmetric so put the shorter string down the rows
+    const std::string& rows = (n <= m) ? source : target;
+    const std::string& columns = (n <= m) ? target : source;
+    if (rows.length() > BIT_VECTOR_LENGTH) {
+        return levenstheinDistanceDP(source, target);
+    }
+    
+    // only clear the entries that get looked at
+    uint64_t peq[256];
+    for (size_t i = 0; i < rows.length(); i++) {
+        peq[static_cast<unsigned char>(rows[i])] = 0;
+    }
+    for (size_t j = 0; j < columns.length(); j++) {
+        peq[static_cast<unsigned char>(columns[j])] = 0;
+    }
+    for (size_t i = 0; i < rows.length(); i++) {
+        peq[static_cast<unsigned char>(rows[i])] |= (1ULL << i);
+    }
+    return bitParallelDistance(peq, static_cast<int>(rows.length()), columns);
+}
+
+int PatternMatcher::levenstheinDistanceDP(const std::string& source, const std::string& target) {
+    
     // Step 1
     
     int n = (int)source.length();
@@ -201,4 +280,37 @@ float PatternMatcher::getStringSimilarity(std::string& s1, std::string& s2)
     	return 0;
     float edit_distance =  levenstheinDistance(s1 ,  s2);
     return 1.0 - (edit_distance/max_length);
+}
+
+void PatternMatcher::getStringSimilarities(const std::string& query, 
+                                           const std::vector<std::string>& targets, 
+                                           std::vector<float>& similarities)
+{
+    //-----
+    // The match bits for the query only need working out once, a query
+    // too long for one word goes through the single pair version
+    //
+    similarities.resize(targets.size());
+    uint64_t peq[256];
+    bool query_fits = (query.length() >= 3 && query.length() <= BIT_VECTOR_LENGTH);
+    if (query_fits) {
+        std::fill(peq, peq + 256, 0);
+        for (size_t i = 0; i < query.length(); i++) {
+            peq[static_cast<unsigned char>(query[i])] |= (1ULL << i);
+        }
+    }
+    for (size_t t = 0; t < targets.size(); t++) {
+        const std::string& target = targets[t];
+        if (query.length() < 3 || target.length() < 3) {
+            similarities[t] = 0;
+        } else if (query_fits) {
+            float max_length = std::max(query.length(), target.length());
+            float edit_distance = bitParallelDistance(peq, static_cast<int>(query.length()), target);
+            similarities[t] = 1.0 - (edit_distance/max_length);
+        } else {
+            std::string s1 = query;
+            std::string s2 = target;
+            similarities[t] = getStringSimilarity(s1, s2);
+        }
+    }
 }
\ No newline at end of file
@@ -35,10 +35,19 @@ public:
     static int levenstheinDistance( std::string& source,  std::string& target);
     
     static float getStringSimilarity(std::string& s1, std::string& s2);
+    
+    // the similarity of query to every one of targets, the same values as
+    // calling getStringSimilarity on each pair
+    static void getStringSimilarities(const std::string& query, 
+                                      const std::vector<std::string>& targets, 
+                                      std::vector<float>& similarities);
 
 private:
     static std::vector<int> computeBmpLast(const std::string& pattern);
     
+    // plain dynamic programming version of levenstheinDistance
+    static int levenstheinDistanceDP(const std::string& source, const std::string& target);
+    
     PatternMatcher();
     PatternMatcher(const PatternMatcher&);
     const PatternMatcher& operator=(const PatternMatcher&);
@@ -0,0 +1,174 @@
+/*
+ *  ReadCache.cpp is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+// system includes
+#include <cstring>
+#include <libcrispr/Exception.h>
+
+// local includes
+#include "ReadCache.h"
+#include "PackedKmer.h"
+
+ReadCache::ReadCache(size_t memoryLimit, bool keepQualities) :
+    RC_MemoryLimit(memoryLimit),
+    RC_MemoryUsage(0),
+    RC_KeepQualities(keepQualities),
+    RC_Overflowed(false)
+{
+    RC_SeqStart.push_back(0);
+    RC_ExceptionStart.push_back(0);
+    RC_TextStart.push_back(0);
+}
+
+bool ReadCache::add(const char * header,
+                    const char * comment,
+                    const char * sequence,
+                    const char * quality)
+{
+    if (RC_Overflowed)
+    {
+        return false;
+    }
+
+    size_t text_before = RC_Text.size();
+    size_t words_before = RC_Packed.size();
+    size_t exceptions_before = RC_ExceptionChar.size();
+
+    unsigned char flags = 0;
+    RC_Text.insert(RC_Text.end(), header, header + strlen(header) + 1);
+    if (NULL != comment)
+    {
+        flags |= hasComment;
+        RC_Text.insert(RC_Text.end(), comment, comment + strlen(comment) + 1);
+    }
+    if (NULL != quality && RC_KeepQualities)
+    {
+        flags |= hasQuality;
+        RC_Text.insert(RC_Text.end(), quality, quality + strlen(quality) + 1);
+    }
+    RC_TextStart.push_back(RC_Text.size());
+    RC_Flags.push_back(flags);
+
+    packSequence(sequence);
+
+    RC_MemoryUsage += (RC_Text.size() - text_before) +
+                      (RC_Packed.size() - words_before) * sizeof(uint64_t) +
+                      (RC_ExceptionChar.size() - exceptions_before) * (sizeof(uint32_t) + sizeof(char)) +
+                      sizeof(uint64_t) + 2 * sizeof(size_t) + sizeof(unsigned char);
+
+    if (RC_MemoryUsage > RC_MemoryLimit)
+    {
+        overflow();
+        return false;
+    }
+    return true;
+}
+
+void ReadCache::packSequence(const char * sequence)
+{
+    //-----
+    // append the sequence to the packed array, bases are stored
+    // back to back so reads can start part way through a word
+    //
+    uint64_t pos = RC_SeqStart.back();
+    uint32_t read_pos = 0;
+    for (const char * c = sequence; *c != '\0'; c++, pos++, read_pos++)
+    {
+        unsigned char code = packBase(*c);
+        if (code > 3)
+        {
+            RC_ExceptionPos.push_back(read_pos);
+            RC_ExceptionChar.push_back(*c);
+            code = 0;
+        }
+        if ((pos & 31) == 0)
+        {
+            RC_Packed.push_back(0);
+        }
+        RC_Packed.back() |= static_cast<uint64_t>(code) << ((pos & 31) << 1);
+    }
+    RC_SeqStart.push_back(pos);
+    RC_ExceptionStart.push_back(RC_ExceptionChar.size());
+}
+
+void ReadCache::getRead(size_t index, ReadHolder& holder)
+{
+    if (index >= size())
+    {
+        throw crispr::exception(__FILE__,
+                                __LINE__,
+                                __PRETTY_FUNCTION__,
+                                "Read index is past the end of the cache");
+    }
+
+    uint64_t start = RC_SeqStart[index];
+    uint64_t end = RC_SeqStart[index + 1];
+    RC_Buffer.resize(end - start);
+    for (uint64_t pos = start; pos < end; pos++)
+    {
+        RC_Buffer[pos - start] = unpackBase((RC_Packed[pos >> 5] >> ((pos & 31) << 1)) & 3);
+    }
+    for (size_t i = RC_ExceptionStart[index]; i < RC_ExceptionStart[index + 1]; i++)
+    {
+        RC_Buffer[RC_ExceptionPos[i]] = RC_ExceptionChar[i];
+    }
+
+    // same order as when the read comes from kseq
+    const char * text = &(RC_Text[RC_TextStart[index]]);
+    holder.setSequence(RC_Buffer);
+    holder.setHeader(text);
+    text += strlen(text) + 1;
+    if (RC_Flags[index] & hasComment)
+    {
+        holder.setComment(text);
+        text += strlen(text) + 1;
+    }
+    if (RC_Flags[index] & hasQuality)
+    {
+        holder.setQual(text);
+    }
+}
+
+void ReadCache::overflow(void)
+{
+    RC_Overflowed = true;
+    RC_MemoryUsage = 0;
+    std::vector<uint64_t>().swap(RC_Packed);
+    std::vector<uint64_t>(1, 0).swap(RC_SeqStart);
+    std::vector<uint32_t>().swap(RC_ExceptionPos);
+    std::vector<char>().swap(RC_ExceptionChar);
+    std::vector<size_t>(1, 0).swap(RC_ExceptionStart);
+    std::vector<char>().swap(RC_Text);
+    std::vector<size_t>(1, 0).swap(RC_TextStart);
+    std::vector<unsigned char>().swap(RC_Flags);
+}
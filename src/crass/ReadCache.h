@@ -0,0 +1,102 @@
+/*
+ *  ReadCache.h is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Holds the reads that were not recruited during the first pass so that
+ *  the singleton finder does not have to decompress and parse the input
+ *  files a second time. Sequences are packed two bits to a base with any
+ *  non-ACGT characters stored on the side, headers and comments are kept
+ *  in one flat buffer. If the cache grows past its memory limit it throws
+ *  everything away and the caller falls back to re-reading the files.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+#ifndef crass_ReadCache_h
+#define crass_ReadCache_h
+
+// system includes
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// local includes
+#include "ReadHolder.h"
+
+class ReadCache
+{
+    public:
+        // memoryLimit is in bytes. Quality strings are only stored if keepQualities is set
+        ReadCache(size_t memoryLimit, bool keepQualities);
+        ~ReadCache(void) {}
+
+        // add a read. A NULL comment or quality means the read did not have one.
+        // returns false if the cache is (now) over its memory limit
+        bool add(const char * header,
+                 const char * comment,
+                 const char * sequence,
+                 const char * quality);
+
+        // fill a fresh ReadHolder with the read at this index, exactly as
+        // it would have been made when reading the input file
+        void getRead(size_t index, ReadHolder& holder);
+
+        // throw away everything and stop accepting reads
+        void overflow(void);
+
+        inline size_t size(void) { return RC_SeqStart.size() - 1; }
+
+        // false once the memory limit has been hit
+        inline bool isValid(void) { return !RC_Overflowed; }
+
+        inline size_t memoryUsage(void) { return RC_MemoryUsage; }
+
+    private:
+        enum {
+            hasComment = 1,
+            hasQuality = 2
+        };
+
+        void packSequence(const char * sequence);
+
+        size_t RC_MemoryLimit;
+        size_t RC_MemoryUsage;                              // approximate bytes in use
+        bool RC_KeepQualities;
+        bool RC_Overflowed;
+
+        std::vector<uint64_t> RC_Packed;                    // 32 bases per word
+        std::vector<uint64_t> RC_SeqStart;                  // first base of every read, plus one past the end
+        std::vector<uint32_t> RC_ExceptionPos;              // position in the read of a non-ACGT character
+        std::vector<char> RC_ExceptionChar;                 // and the character itself
+        std::vector<size_t> RC_ExceptionStart;              // first exception of every read, plus one past the end
+        std::vector<char> RC_Text;                          // header\0[comment\0][quality\0] for every read
+        std::vector<size_t> RC_TextStart;                   // start of the text of every read
+        std::vector<unsigned char> RC_Flags;                // hasComment | hasQuality
+        std::string RC_Buffer;                              // scratch space for unpacking
+};
+
+#endif //crass_ReadCache_h
@@ -42,16 +42,166 @@
 #include <stdexcept>
 // local includes
 #include "ReadHolder.h"
+#include "PackedKmer.h"
 #include "SeqUtils.h"
 #include "SmithWaterman.h"
 #include "LoggerSimp.h"
 #include <libcrispr/Exception.h>
 
 
+void ReadHolder::init(void)
+{
+    RH_Data = new ReadData();
+    RH_Store = NULL;
+    RH_StoreIndex = 0;
+    RH_IsFasta = true;
+    RH_WasLowLexi = false;
+    RH_isSqueezed = false;
+    RH_LastDREnd = 0; 
+    RH_NextSpacerStart = 0; 
+    RH_RepeatLength = 0;
+}
+
+ReadHolder::ReadHolder(ReadHolder& other, ReadStore * store)
+{
+    RH_Data = NULL;
+    RH_Store = NULL;
+    *this = other;
+    RH_StoreIndex = store->add(RH_Data->seq, 
+                               RH_Data->header, 
+                               RH_Data->comment, 
+                               RH_Data->qual, 
+                               RH_Data->startStops, 
+                               RH_Data->runStarts);
+    RH_Store = store;
+    delete RH_Data;
+    RH_Data = NULL;
+}
+
+ReadHolder::ReadHolder(const ReadHolder& other)
+{
+    RH_Data = NULL;
+    RH_Store = NULL;
+    *this = other;
+}
+
+ReadHolder& ReadHolder::operator=(const ReadHolder& other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+    ReadData * data = new ReadData();
+    if (NULL == other.RH_Store)
+    {
+        *data = *(other.RH_Data);
+    }
+    else
+    {
+        ReadStore * store = other.RH_Store;
+        unsigned int index = other.RH_StoreIndex;
+        store->getSequence(index, data->seq);
+        data->header = store->header(index);
+        data->comment = store->comment(index);
+        data->qual = store->quality(index);
+        data->startStops.assign(store->startStopsBegin(index), store->startStopsEnd(index));
+        store->getRunStarts(index, data->runStarts);
+    }
+    delete RH_Data;
+    RH_Data = data;
+    RH_Store = NULL;
+    RH_StoreIndex = 0;
+    RH_IsFasta = other.RH_IsFasta;
+    RH_WasLowLexi = other.RH_WasLowLexi;
+    RH_isSqueezed = other.RH_isSqueezed;
+    RH_LastDREnd = other.RH_LastDREnd;
+    RH_NextSpacerStart = other.RH_NextSpacerStart;
+    RH_RepeatLength = other.RH_RepeatLength;
+    return *this;
+}
+
+void ReadHolder::clear(void)
+{
+    if (NULL == RH_Data)
+    {
+        // let go of the store
+        RH_Data = new ReadData();
+        RH_Store = NULL;
+        RH_StoreIndex = 0;
+    }
+    RH_Data->seq.clear();
+    RH_Data->startStops.clear();
+    RH_Data->header.clear();
+    RH_Data->runStarts.clear();
+    RH_Data->comment.clear();
+    RH_Data->qual.clear();
+    RH_NextSpacerStart = 0; 
+    RH_isSqueezed = false;
+    RH_IsFasta = false;
+}
+
+void ReadHolder::detach(void)
+{
+    if (NULL != RH_Store)
+    {
+        // assigning a stored read makes a copy that isn't stored
+        ReadHolder copy(*this);
+        *this = copy;
+    }
+}
+
+std::string& ReadHolder::workingSeq(std::string& buffer)
+{
+    if (NULL == RH_Store)
+    {
+        return RH_Data->seq;
+    }
+    RH_Store->getSequence(RH_StoreIndex, buffer);
+    return buffer;
+}
+
+StartStopList& ReadHolder::workingStartStops(StartStopList& buffer)
+{
+    if (NULL == RH_Store)
+    {
+        return RH_Data->startStops;
+    }
+    buffer.assign(RH_Store->startStopsBegin(RH_StoreIndex), RH_Store->startStopsEnd(RH_StoreIndex));
+    return buffer;
+}
+
+StartStopList& ReadHolder::workingRunStarts(StartStopList& buffer)
+{
+    if (NULL == RH_Store)
+    {
+        return RH_Data->runStarts;
+    }
+    RH_Store->getRunStarts(RH_StoreIndex, buffer);
+    return buffer;
+}
+
+void ReadHolder::saveStartStops(StartStopList& startStops)
+{
+    if (NULL != RH_Store)
+    {
+        RH_Store->setStartStops(RH_StoreIndex, startStops);
+    }
+}
+
+std::string ReadHolder::seqSubstr(size_t i, size_t j)
+{
+    if (NULL == RH_Store)
+    {
+        return RH_Data->seq.substr(i, j);
+    }
+    return getSeq().substr(i, j);
+}
 
 // the input must be an even number which will be the start of the repeat
 unsigned int ReadHolder::getRepeatAt(unsigned int i)
 {
+    StartStopList start_stops_buffer;
+    StartStopList& start_stops = workingStartStops(start_stops_buffer);
     if (i % 2 != 0) 
     {
         std::stringstream ss;
@@ -61,7 +211,7 @@ unsigned int ReadHolder::getRepeatAt(unsigned int i)
 		                        __PRETTY_FUNCTION__,
 		                        ss);
     }
-    if (i > RH_StartStops.size()) 
+    if (i > start_stops.size()) 
     {
         std::stringstream ss;
 		ss<<"Index is greater than the length of the Vector: "<<i;
@@ -70,10 +220,12 @@ unsigned int ReadHolder::getRepeatAt(unsigned int i)
 		                        __PRETTY_FUNCTION__,
 		                        ss);
     }
-    return RH_StartStops[i];
+    return start_stops[i];
 }
 std::string ReadHolder::repeatStringAt(unsigned int i)
 {
+    StartStopList start_stops_buffer;
+    StartStopList& start_stops = workingStartStops(start_stops_buffer);
 	if (i % 2 != 0) 
     {
         std::stringstream ss;
@@ -83,7 +235,7 @@ std::string ReadHolder::repeatStringAt(unsigned int i)
 		                        __PRETTY_FUNCTION__,
 		                        ss);		
     }
-    if (i > RH_StartStops.size()) 
+    if (i > start_stops.size()) 
     {
         std::stringstream ss;
 		ss<<"Index is greater than the length of the Vector: "<<i;
@@ -92,11 +244,15 @@ std::string ReadHolder::repeatStringAt(unsigned int i)
 		                        __PRETTY_FUNCTION__,
 		                        ss);
     }
-    return RH_Seq.substr(RH_StartStops[i], RH_StartStops[i + 1] - RH_StartStops[i] + 1);
+    return substr(start_stops[i], start_stops[i + 1] - start_stops[i] + 1);
 }
 
 std::string ReadHolder::spacerStringAt(unsigned int i)
 {
+    std::string seq_buffer;
+    std::string& seq = workingSeq(seq_buffer);
+    StartStopList start_stops_buffer;
+    StartStopList& start_stops = workingStartStops(start_stops_buffer);
     if (i % 2 != 0) 
     {
         std::stringstream ss;
@@ -106,10 +262,10 @@ std::string ReadHolder::spacerStringAt(unsigned int i)
 		                        __PRETTY_FUNCTION__,
 		                        ss);		
     }
-    if (i > RH_StartStops.size()) 
+    if (i > start_stops.size()) 
     {
         std::stringstream ss;
-		ss<<"Index is greater than the length of the Vector: "<<i<<" >= "<<RH_StartStops.size();
+		ss<<"Index is greater than the length of the Vector: "<<i<<" >= "<<start_stops.size();
 		throw crispr::exception(__FILE__,
 		                        __LINE__,
 		                        __PRETTY_FUNCTION__,
@@ -119,13 +275,13 @@ std::string ReadHolder::spacerStringAt(unsigned int i)
     unsigned int curr_spacer_start_index = 0;
     unsigned int curr_spacer_end_index = 0;
     try {
-        curr_spacer_start_index = RH_StartStops.at(i + 1) + 1;
-        curr_spacer_end_index = RH_StartStops.at(i + 2) - 1;
-        tmp_seq = RH_Seq.substr(curr_spacer_start_index, (curr_spacer_end_index - curr_spacer_start_index));
+        curr_spacer_start_index = start_stops.at(i + 1) + 1;
+        curr_spacer_end_index = start_stops.at(i + 2) - 1;
+        tmp_seq = seq.substr(curr_spacer_start_index, (curr_spacer_end_index - curr_spacer_start_index));
     } catch (std::out_of_range& e) {
 
         throw crispr::substring_exception(e.what(), 
-                                            RH_Seq.c_str(), 
+                                            seq.c_str(), 
                                             curr_spacer_start_index,
                                             (curr_spacer_end_index - curr_spacer_start_index), 
                                             __FILE__,
@@ -155,7 +311,7 @@ unsigned int ReadHolder::getAverageSpacerLength()
     if(getFirstSpacer(&tmp_string))
     {		
         // check to make sure that the read doesn't start on a spacer
-        if(*(RH_StartStops.begin()) == 0)
+        if(front() == 0)
         {
             // starts on a DR
             stored_len = (int)tmp_string.length();
@@ -170,7 +326,7 @@ unsigned int ReadHolder::getAverageSpacerLength()
             stored_len = (int)tmp_string.length();
         }
         // check to make sure that the read doesn't end on a spacer
-        if(RH_StartStops.back() == (RH_Seq.length() - 1))
+        if(back() == (unsigned int)(getSeqLength() - 1))
         {
             // ends on a DR
             num_spacers++;
@@ -198,7 +354,7 @@ void ReadHolder::getAllSpacerStrings(std::vector<std::string>& spacers)
         if(getFirstSpacer(&tmp_string))
         {		
             // check to make sure that the read doesn't start on a spacer
-            if(*(RH_StartStops.begin()) == 0)
+            if(front() == 0)
             {
                 // starts on a DR
                 spacers.push_back(tmp_string);
@@ -210,7 +366,7 @@ void ReadHolder::getAllSpacerStrings(std::vector<std::string>& spacers)
                 spacers.push_back(tmp_string);
             }
             // check to make sure that the read doesn't end on a spacer
-            if(RH_StartStops.back() != (RH_Seq.length() - 1))
+            if(back() != (unsigned int)(getSeqLength() - 1))
             {
                 // ends on a Spacer
                 spacers.pop_back();
@@ -256,6 +412,8 @@ int ReadHolder::averageRepeatLength()
 
 void ReadHolder::startStopsAdd(unsigned int i, unsigned int j)
 {
+    StartStopList start_stops_buffer;
+    StartStopList& start_stops = workingStartStops(start_stops_buffer);
 #ifdef DEBUG	
 	if(((int)i < 0) || ((int)j < 0)) { 
 		std::stringstream ss;
@@ -273,7 +431,7 @@ void ReadHolder::startStopsAdd(unsigned int i, unsigned int j)
 		                        __PRETTY_FUNCTION__,
 		                        ss);
 	}
-	if((i > RH_Seq.length()) || (j > RH_Seq.length())) { 
+	if((i > (unsigned int)getSeqLength()) || (j > (unsigned int)getSeqLength())) { 
 		std::stringstream ss;
 		ss<<"Too long! " << i << " : " << j;
 		throw crispr::exception(__FILE__,
@@ -282,12 +440,13 @@ void ReadHolder::startStopsAdd(unsigned int i, unsigned int j)
 		                        ss);
 	}
 #endif
-    this->RH_StartStops.push_back(i);
+    start_stops.push_back(i);
     if(j >= (unsigned int)getSeqLength())
     {
     	j = (unsigned int)getSeqLength() - 1;
     }
-    this->RH_StartStops.push_back(j);
+    start_stops.push_back(j);
+    saveStartStops(start_stops);
 }
 
 void ReadHolder::dropPartials(void)
@@ -295,21 +454,24 @@ void ReadHolder::dropPartials(void)
     //-----
     // Drop any partial DRs
     //
-    StartStopListIterator r_iter = RH_StartStops.begin();
+    StartStopList start_stops_buffer;
+    StartStopList& start_stops = workingStartStops(start_stops_buffer);
+    StartStopListIterator r_iter = start_stops.begin();
     if(*r_iter == 0)
     {
         logInfo("\tDropping front partial repeat "<<*r_iter << " == 0", 8);
         // this is a partial
-        RH_StartStops.erase(r_iter, r_iter+2);
+        start_stops.erase(r_iter, r_iter+2);
     }
     
-    r_iter = RH_StartStops.end() - 1;
-    if(*r_iter >= (unsigned int)RH_Seq.length() - 1)
+    r_iter = start_stops.end() - 1;
+    if(*r_iter >= (unsigned int)getSeqLength() - 1)
     {
-        logInfo("\tDropping end partial repeat "<<*r_iter<<"; seq_len - rep_len = "<< (unsigned int)RH_Seq.length() - RH_RepeatLength<< "; seq_len = "<<RH_Seq.length()<<"; rep_len = "<<RH_RepeatLength, 8);
+        logInfo("\tDropping end partial repeat "<<*r_iter<<"; seq_len - rep_len = "<< (unsigned int)getSeqLength() - RH_RepeatLength<< "; seq_len = "<<getSeqLength()<<"; rep_len = "<<RH_RepeatLength, 8);
         // this is a partial
-        RH_StartStops.erase(r_iter-1, RH_StartStops.end());
+        start_stops.erase(r_iter-1, start_stops.end());
     }
+    saveStartStops(start_stops);
 }
 
 void ReadHolder::reverseStartStops(void)
@@ -321,10 +483,12 @@ void ReadHolder::reverseStartStops(void)
     //
     // we need to fix this mo-fo
     
+    StartStopList start_stops_buffer;
+    StartStopList& start_stops = workingStartStops(start_stops_buffer);
     StartStopList tmp_ss;
     
-    int seq_len = (int)RH_Seq.length();
-    int true_start_offset = seq_len - RH_StartStops.back() - 1;
+    int seq_len = getSeqLength();
+    int true_start_offset = seq_len - start_stops.back() - 1;
 #ifdef DEBUG
     if (true_start_offset < 0) 
     {
@@ -332,7 +496,7 @@ void ReadHolder::reverseStartStops(void)
 		std::stringstream ss;
 		ss<<"The first direct repeat position is a negative number: "
 		  <<true_start_offset<<"\nSeq_len: "<<seq_len
-		  << "Final spacer index: "<<RH_StartStops.back();
+		  << "Final spacer index: "<<start_stops.back();
 		throw crispr::exception(__FILE__,
                                 __LINE__,
                                 __PRETTY_FUNCTION__,
@@ -340,12 +504,12 @@ void ReadHolder::reverseStartStops(void)
                                 );
     }
 #endif
-    StartStopListRIterator ss_iter = RH_StartStops.rbegin();
+    StartStopListRIterator ss_iter = start_stops.rbegin();
     
     unsigned int prev_pos_fixed = true_start_offset;
     unsigned int prev_pos_orig = *ss_iter;
    
-    while(ss_iter != RH_StartStops.rend())
+    while(ss_iter != start_stops.rend())
     {
         unsigned int gap = prev_pos_orig - *ss_iter;
         prev_pos_fixed += gap;
@@ -369,11 +533,12 @@ void ReadHolder::reverseStartStops(void)
         prev_pos_orig = *ss_iter;
         ss_iter++;
     }
-    RH_StartStops.clear();
-    RH_StartStops.insert(RH_StartStops.begin(), tmp_ss.begin(), tmp_ss.end());
+    start_stops.clear();
+    start_stops.insert(start_stops.begin(), tmp_ss.begin(), tmp_ss.end());
+    saveStartStops(start_stops);
 }
 
-void ReadHolder::updateStartStops(int frontOffset, std::string * DR, const options * opts)
+void ReadHolder::updateStartStops(int frontOffset, std::string * DR, PartialRepeatAligner * partialAligner, const options * opts)
 {
     //-----
     // Update the start and stops to capture the largest part
@@ -382,10 +547,14 @@ void ReadHolder::updateStartStops(int frontOffset, std::string * DR, const optio
     // Take this opportunity to look for partials at either end of the read
     //
     
+    std::string seq_buffer;
+    std::string& seq = workingSeq(seq_buffer);
+    StartStopList start_stops_buffer;
+    StartStopList& start_stops = workingStartStops(start_stops_buffer);
     int DR_length = static_cast<int>(DR->length());
     
-    StartStopListIterator ss_iter = RH_StartStops.begin();
-    while(ss_iter != RH_StartStops.end())
+    StartStopListIterator ss_iter = start_stops.begin();
+    while(ss_iter != start_stops.end())
     {
 
         int usable_length = DR_length - 1;
@@ -403,7 +572,7 @@ void ReadHolder::updateStartStops(int frontOffset, std::string * DR, const optio
             *ss_iter -= frontOffset;
         }
 #ifdef DEBUG
-        if(*ss_iter > static_cast<unsigned int>(RH_Seq.length())) { 
+        if(*ss_iter > static_cast<unsigned int>(seq.length())) { 
 			std::stringstream ss;
 			ss<<"Something wrong with front offset! " 
 				<<"ss iter: "<<*ss_iter << " \n " 
@@ -419,9 +588,9 @@ void ReadHolder::updateStartStops(int frontOffset, std::string * DR, const optio
         *ss_iter = *(ss_iter - 1) + usable_length;
         
         // correct if we have gone beyond the end of the read
-        if(*ss_iter >= RH_Seq.length())
+        if(*ss_iter >= seq.length())
         {
-            *ss_iter = static_cast<unsigned int>(RH_Seq.length()) - 1;
+            *ss_iter = static_cast<unsigned int>(seq.length()) - 1;
         }
         ss_iter++;
         
@@ -429,14 +598,14 @@ void ReadHolder::updateStartStops(int frontOffset, std::string * DR, const optio
 
     // now we check to see if we can find one more DRs on the front or back of this mofo
     // front first
-    ss_iter = RH_StartStops.begin();
+    ss_iter = start_stops.begin();
     if((*ss_iter) > opts->lowSpacerSize)
     {
         // we should look for a DR here
         int part_s, part_e;
         part_s = part_e = 0;
 
-		stringPair sp = smithWaterman(RH_Seq, *DR, &part_s, &part_e, 0, (static_cast<int>((*ss_iter)) - opts->lowSpacerSize), CRASS_DEF_PARTIAL_SIM_CUT_OFF);
+		stringPair sp = partialAligner->align(seq, &part_s, &part_e, 0, (static_cast<int>((*ss_iter)) - opts->lowSpacerSize), CRASS_DEF_PARTIAL_SIM_CUT_OFF);
 		if(0 != part_e)
 		{
 			if (part_e - part_s >= CRASS_DEF_MIN_PARTIAL_LENGTH) 
@@ -454,7 +623,7 @@ void ReadHolder::updateStartStops(int frontOffset, std::string * DR, const optio
 						                        __PRETTY_FUNCTION__,
 						                        (ss.str()).c_str());
 					}
-					if(part_e > (int)RH_Seq.length()) { 
+					if(part_e > (int)seq.length()) { 
 						std::stringstream ss;
 						ss <<"SS longer than read: " << part_e;
 						throw crispr::exception(__FILE__,
@@ -463,34 +632,35 @@ void ReadHolder::updateStartStops(int frontOffset, std::string * DR, const optio
 						                        (ss.str()).c_str());	
 					}
 #endif
-					std::reverse(RH_StartStops.begin(), RH_StartStops.end());
-					RH_StartStops.push_back(part_e);
-					RH_StartStops.push_back(0);
-					std::reverse(RH_StartStops.begin(), RH_StartStops.end());
+					std::reverse(start_stops.begin(), start_stops.end());
+					start_stops.push_back(part_e);
+					start_stops.push_back(0);
+					std::reverse(start_stops.begin(), start_stops.end());
 				}
 			}
 		}
     }
+    saveStartStops(start_stops);
+    
     // then the back
-    unsigned int end_dist = static_cast<unsigned int>(RH_Seq.length()) - RH_StartStops.back();
+    unsigned int end_dist = static_cast<unsigned int>(seq.length()) - start_stops.back();
     if(end_dist > (unsigned int)(opts->lowSpacerSize))
     {
         // we should look for a DR here
         int part_s, part_e;
         part_s = part_e = 0;
 
-		stringPair sp = smithWaterman(RH_Seq, 
-		                              *DR, 
-		                              &part_s, 
-		                              &part_e, 
-		                              (RH_StartStops.back() + opts->lowSpacerSize), 
-		                              (end_dist - opts->lowSpacerSize), 
-		                              CRASS_DEF_PARTIAL_SIM_CUT_OFF);
+		stringPair sp = partialAligner->align(seq, 
+		                                      &part_s, 
+		                                      &part_e, 
+		                                      (start_stops.back() + opts->lowSpacerSize), 
+		                                      (end_dist - opts->lowSpacerSize), 
+		                                      CRASS_DEF_PARTIAL_SIM_CUT_OFF);
 		if(0 != part_e)
 		{
 			if (part_e - part_s >= CRASS_DEF_MIN_PARTIAL_LENGTH) 
 			{
-				if((((int)(RH_Seq.length()) - 1 ) == part_e) && (0 == DR->find(sp.second)))
+				if((((int)(seq.length()) - 1 ) == part_e) && (0 == DR->find(sp.second)))
 				{
 #ifdef DEBUG
 					logInfo("adding partial direct repeat to end",10);
@@ -527,14 +697,14 @@ std::string ReadHolder::DRLowLexi(void)
         // choose the dr that is not a partial ( no start at 0 or end at length)
         
         // take the second
-        if (RH_StartStops.front() == 0)
+        if (front() == 0)
         {
             tmp_dr = repeatStringAt(2);
             rev_comp = reverseComplement(tmp_dr);
         }
         
         // take the first
-        else if (RH_StartStops.back() == static_cast<unsigned int>(RH_Seq.length()))
+        else if (back() == static_cast<unsigned int>(getSeqLength()))
         {
             tmp_dr = repeatStringAt(0);
             rev_comp = reverseComplement(tmp_dr);
@@ -542,8 +712,8 @@ std::string ReadHolder::DRLowLexi(void)
         // if they both are then just take whichever is longer
         else
         {
-            int lenA = RH_StartStops.at(1) - RH_StartStops.at(0);
-            int lenB = RH_StartStops.at(3) - RH_StartStops.at(2);
+            int lenA = startStopsAt(1) - startStopsAt(0);
+            int lenB = startStopsAt(3) - startStopsAt(2);
             
             if (lenA > lenB)
             {
@@ -571,7 +741,7 @@ std::string ReadHolder::DRLowLexi(void)
         // the direct repeat is in it lowest lexicographical form
         RH_WasLowLexi = true;
 #ifdef DEBUG
-        logInfo("DR in low lexi"<<endl<<RH_Seq, 9);
+        logInfo("DR in low lexi"<<endl<<getSeq(), 9);
 #endif
         return tmp_dr;
     }
@@ -580,26 +750,89 @@ std::string ReadHolder::DRLowLexi(void)
         reverseComplementSeq();
         RH_WasLowLexi = false;
 #ifdef DEBUG
-        logInfo("DR not in low lexi"<<endl<<RH_Seq, 9);
+        logInfo("DR not in low lexi"<<endl<<getSeq(), 9);
 #endif
         return rev_comp;
     }
 }
 
+std::string ReadHolder::DRLowLexi(const std::string& knownRepeat)
+{
+    //-----
+    // Orientate a READ based on low lexi of a DR we already know, used
+    // when the repeat in the read has errors in it
+    //
+    std::string rev_comp = reverseComplement(knownRepeat);
+    if (knownRepeat < rev_comp)
+    {
+        RH_WasLowLexi = true;
+        return knownRepeat;
+    }
+    else
+    {
+        reverseComplementSeq();
+        RH_WasLowLexi = false;
+        return rev_comp;
+    }
+}
+
+void ReadHolder::addBaseCounts(int * counts)
+{
+    if (NULL != RH_Store)
+    {
+        RH_Store->addBaseCounts(RH_StoreIndex, counts);
+        return;
+    }
+    for (size_t i = 0; i < RH_Data->seq.length(); i++)
+    {
+        unsigned char code = packBaseAnyCase(RH_Data->seq[i]);
+        counts[4 * i + ((code > 3) ? 0 : code)]++;
+    }
+}
+
 void ReadHolder::reverseComplementSeq(void)
 {
     //-----
     // Reverse complement the read and fix the start stops
     // 
 
-    RH_Seq = reverseComplement(RH_Seq);
-	if(RH_Seq.empty()) {
+    if(NULL != RH_Store)
+    {
+        if(0 == RH_Store->length(RH_StoreIndex)) {
+            throw crispr::runtime_exception(__FILE__,
+                                            __LINE__,
+                                            __PRETTY_FUNCTION__,
+                                            "Sequence corrupted during reverse complement!"
+                                            );
+        }
+        RH_Store->reverseComplement(RH_StoreIndex);
+        RH_Store->reverseRunStarts(RH_StoreIndex);
+        reverseStartStops();
+        RH_WasLowLexi = !RH_WasLowLexi;
+        return;
+    }
+    
+    std::string& seq = RH_Data->seq;
+    seq = reverseComplement(seq);
+	if(seq.empty()) {
 		throw crispr::runtime_exception(__FILE__,
 		                                __LINE__,
 		                                __PRETTY_FUNCTION__,
 		                                "Sequence corrupted during reverse complement!"
 		                                );
 	}
+    if(RH_isSqueezed)
+    {
+        // the runs are now in the opposite order
+        StartStopList& run_starts = RH_Data->runStarts;
+        unsigned int length = run_starts.back();
+        std::reverse(run_starts.begin(), run_starts.end());
+        StartStopListIterator run_iter;
+        for(run_iter = run_starts.begin(); run_iter != run_starts.end(); run_iter++)
+        {
+            *run_iter = length - *run_iter;
+        }
+    }
     reverseStartStops();
     RH_WasLowLexi = !RH_WasLowLexi;
 }
@@ -611,7 +844,11 @@ void ReadHolder::encode(void)
     // Encode the sequence using RLE
     // Yo FOOL! ONly call this mofo B4 you make any start stops!
     //
-    if(RH_StartStops.size() != 0)
+    // The sequence is squeezed in place. For each base left we keep where
+    // its run started in the original sequence, with one extra entry for
+    // the original length, so the run lengths are the differences
+    //
+    if(getStartStopListSize() != 0)
         throw crispr::exception(__FILE__,
                                 __LINE__,
                                 __PRETTY_FUNCTION__,
@@ -620,50 +857,31 @@ void ReadHolder::encode(void)
     {
         return;
     } 
-    else 
+    detach();
+    std::string& seq = RH_Data->seq;
+    StartStopList& run_starts = RH_Data->runStarts;
+
+    unsigned int length = static_cast<unsigned int>(seq.length());
+    run_starts.resize(length + 1);
+    unsigned int squeezed_length = 0;
+    if(0 != length)
     {
-        std::stringstream rle, seq;
-        rle<<this->RH_Seq[0];
-        seq<<this->RH_Seq[0];
-		//std::cout<<"seq length: "<<RH_Seq.length()<<std::endl;
-		//std::cout<<"orig seq: "<<RH_Seq<<std::endl;
-		int length = static_cast<int>(this->RH_Seq.length());
-        for (int  i = 1; i < length; i++) 
+        run_starts[0] = 0;
+        squeezed_length = 1;
+        for (unsigned int i = 1; i < length; i++) 
         {
-            if (this->RH_Seq[i] == this->RH_Seq[i - 1]) 
-            {
-                int count = 0;
-                do {
-                    count++;
-                    i++;
-                } while ((i < length) && (this->RH_Seq[i] == this->RH_Seq[i - 1])); 
-
-				if(i < length) {
-                	rle << count << this->RH_Seq[i];
-                	seq<<this->RH_Seq[i];
-					//std::cout<<"b-index: "<<i<<" base: "<<this->RH_Seq[i]<<std::endl;
-				} else {
-					rle <<count;
-					/*throw crispr::runtime_exception(__FILE__,
-					                                __LINE__,
-					                                __PRETTY_FUNCTION__,
-					                                "Assigning index past end of string");
-													*/
-				}
-            }
-            else
-            {
-                rle << this->RH_Seq[i];
-                seq << this->RH_Seq[i];
-				//std::cout<<"e-index: "<<i<<" base: "<<this->RH_Seq[i]<<std::endl;
-            }
+            // the write never gets ahead of the read. It is only kept
+            // if the base differs from the last one kept
+            char base = seq[i];
+            seq[squeezed_length] = base;
+            run_starts[squeezed_length] = i;
+            squeezed_length += (base != seq[squeezed_length - 1]);
         }
-		//std::cout<<"seq: \""<<seq.str().c_str()<<'"'<<std::endl;
-		//std::cout<<"rle: \""<<rle.str().c_str()<<'"'<<std::endl;
-        this->RH_Seq = seq.str();
-        this->RH_Rle = rle.str();
-        this->RH_isSqueezed = true;
     }
+    run_starts[squeezed_length] = length;
+    run_starts.resize(squeezed_length + 1);
+    seq.resize(squeezed_length);
+    this->RH_isSqueezed = true;
 }
 
 void ReadHolder::decode(void)
@@ -672,9 +890,38 @@ void ReadHolder::decode(void)
     // Go from RLE to normal
     // Call it anytime. Fixes start stops
     //
-    std::string tmp = this->expand(true);
+    if (!this->RH_isSqueezed) 
+    {
+        return;
+    }
+    detach();
+    std::string& seq = RH_Data->seq;
+    StartStopList& start_stops = RH_Data->startStops;
+    StartStopList& run_starts = RH_Data->runStarts;
+    
+    // move the start stops onto the first base of their runs
+    unsigned int squeezed_length = static_cast<unsigned int>(seq.length());
+    StartStopListIterator ss_iter;
+    for(ss_iter = start_stops.begin(); ss_iter != start_stops.end(); ss_iter++)
+    {
+        if(*ss_iter < squeezed_length)
+        {
+            *ss_iter = run_starts[*ss_iter];
+        }
+    }
+    
+    // grow the sequence back out from the end so that nothing is
+    // overwritten before it is read
+    seq.resize(run_starts[squeezed_length]);
+    for(int i = static_cast<int>(squeezed_length) - 1; i >= 0; i--)
+    {
+        char base = seq[i];
+        for(unsigned int j = run_starts[i]; j < run_starts[i + 1]; j++)
+        {
+            seq[j] = base;
+        }
+    }
     this->RH_isSqueezed = false;
-    this->RH_Seq = tmp;
 }
 
 
@@ -691,65 +938,58 @@ std::string ReadHolder::expand(bool fixStopStarts)
     //----
     // Expand the string from RLE and fix stope starts as needed
     //
+    if (!this->RH_isSqueezed) 
+    {
+        return getSeq();
+    } 
+    if(fixStopStarts)
+    {
+        decode();
+        return getSeq();
+    }
     
+    std::string seq_buffer;
+    std::string& seq = workingSeq(seq_buffer);
+    StartStopList run_starts_buffer;
+    StartStopList& run_starts = workingRunStarts(run_starts_buffer);
+    unsigned int squeezed_length = static_cast<unsigned int>(seq.length());
+    std::string expanded;
+    expanded.reserve(run_starts[squeezed_length]);
+    for(unsigned int i = 0; i < squeezed_length; i++)
+    {
+        expanded.append(run_starts[i + 1] - run_starts[i], seq[i]);
+    }
+    return expanded;
+}
+
+std::string ReadHolder::getSeqRle(void)
+{
+    //----
+    // The squeezed sequence with the number of bases removed from each
+    // run written after the base, eg. AAAC -> A2C. Empty if the read
+    // isn't squeezed
+    //
     if (!this->RH_isSqueezed) 
     {
-        return this->RH_Seq;
+        return std::string();
     } 
-    else 
+    
+    std::string seq_buffer;
+    std::string& seq = workingSeq(seq_buffer);
+    StartStopList run_starts_buffer;
+    StartStopList& run_starts = workingRunStarts(run_starts_buffer);
+    std::stringstream rle;
+    unsigned int squeezed_length = static_cast<unsigned int>(seq.length());
+    for(unsigned int i = 0; i < squeezed_length; i++)
     {
-        std::stringstream tmp;
-        
-        int main_index = 0;
-        int new_index = 0;
-        int old_index = 0;
-        int stop_index = static_cast<int>(RH_Rle.length());
-        int next_ss_index = -1;
-        StartStopListIterator ss_iter = RH_StartStops.begin();
-        
-        // no point in fixing starts and stops if there are none
-        if(RH_StartStops.size() == 0) { fixStopStarts = false; }
-        
-        if(fixStopStarts)
+        rle << seq[i];
+        unsigned int removed = run_starts[i + 1] - run_starts[i] - 1;
+        if(0 != removed)
         {
-            next_ss_index = *ss_iter;
-        }
-        
-        while (main_index < stop_index) 
-        {
-            if (isdigit(RH_Rle[main_index])) 
-            {
-                int count = RH_Rle[main_index] - '0';
-                new_index += count;
-                while (count != 0) 
-                {
-                    tmp << RH_Rle[main_index -1];
-                    count--;
-                }
-            }
-            else
-            {
-                if(next_ss_index == old_index)
-                {
-                    *ss_iter = new_index;
-                    ss_iter++;
-                    if(ss_iter != RH_StartStops.end())
-                    {
-                        next_ss_index = *ss_iter;
-                    }
-                    else
-                    {
-                        next_ss_index = -1;
-                    }
-                }
-                tmp << RH_Rle[main_index];
-                old_index++;
-                new_index++;
-            }
-            main_index++;
+            rle << removed;
         }
-        return tmp.str();
     }
+    return rle.str();
 }
 
 // cut DRs and Specers
@@ -768,21 +1008,25 @@ bool ReadHolder::getNextDR(std::string * retStr)
     //-----
     // cut the next DR or return false if it all stuffs up
     //
+    std::string seq_buffer;
+    std::string& seq = workingSeq(seq_buffer);
+    StartStopList start_stops_buffer;
+    StartStopList& start_stops = workingStartStops(start_stops_buffer);
     // make the iterator point to the start of the next DR
-    StartStopListIterator ss_iter = RH_StartStops.begin() + RH_LastDREnd;
+    StartStopListIterator ss_iter = start_stops.begin() + RH_LastDREnd;
     
     // find out where to start and stop the cuts
     int start_cut = -1;
     int end_cut = -1;
     
-    if(ss_iter < RH_StartStops.end())
+    if(ss_iter < start_stops.end())
     {
         start_cut = *ss_iter;
     }
     else
         return false;
     ss_iter++;
-    if(ss_iter < RH_StartStops.end())
+    if(ss_iter < start_stops.end())
     {
         end_cut = *ss_iter;
     }
@@ -795,7 +1039,7 @@ bool ReadHolder::getNextDR(std::string * retStr)
     int dist = end_cut - start_cut;
     if(0 != dist)
     {
-        *retStr = RH_Seq.substr(start_cut, dist + 1);
+        *retStr = seq.substr(start_cut, dist + 1);
         RH_LastDREnd+=2;
         return true;
     }
@@ -824,12 +1068,16 @@ bool ReadHolder::getNextSpacer(std::string * retStr)
     //-----
     // cut the next Spacer or return false if it all stuffs up
     //
+    std::string seq_buffer;
+    std::string& seq = workingSeq(seq_buffer);
+    StartStopList start_stops_buffer;
+    StartStopList& start_stops = workingStartStops(start_stops_buffer);
 	
 	// first check to see if our index offset makes any sense at all
-	if(RH_NextSpacerStart > ((int)(RH_StartStops.size()) - 1))
+	if(RH_NextSpacerStart > ((int)(start_stops.size()) - 1))
 	{
         //std::stringstream ss;
-        //ss << "Next spacer start is greater than length "<<RH_NextSpacerStart<<" > "<<RH_StartStops.size() - 1;
+        //ss << "Next spacer start is greater than length "<<RH_NextSpacerStart<<" > "<<start_stops.size() - 1;
         //throw crispr::exception(__FILE__,
         //                        __LINE__,
         //                        __PRETTY_FUNCTION__,
@@ -838,7 +1086,7 @@ bool ReadHolder::getNextSpacer(std::string * retStr)
 	}
 	
 	// get an iterator into the ss list
-    StartStopListIterator ss_iter = RH_StartStops.begin();
+    StartStopListIterator ss_iter = start_stops.begin();
     
     if(0 == RH_NextSpacerStart)
     {
@@ -848,9 +1096,9 @@ bool ReadHolder::getNextSpacer(std::string * retStr)
     		// read starts with a spacer
     		// the next spacer starts after the first DR
             try {
-                *retStr = RH_Seq.substr(0, *ss_iter);
+                *retStr = seq.substr(0, *ss_iter);
             } catch (std::out_of_range& e) {
-                throw crispr::substring_exception(e.what(), RH_Seq.c_str(), 0, *ss_iter, __FILE__, __LINE__, __PRETTY_FUNCTION__);
+                throw crispr::substring_exception(e.what(), seq.c_str(), 0, *ss_iter, __FILE__, __LINE__, __PRETTY_FUNCTION__);
             }
     		RH_NextSpacerStart = 1;
     	}
@@ -860,12 +1108,12 @@ bool ReadHolder::getNextSpacer(std::string * retStr)
             ss_iter++;
             int start_cut = (*ss_iter) + 1;
     		ss_iter++;
-    		if(ss_iter < RH_StartStops.end())
+    		if(ss_iter < start_stops.end())
     		{
                 try {
-                    *retStr = RH_Seq.substr(start_cut, *ss_iter - start_cut);
+                    *retStr = seq.substr(start_cut, *ss_iter - start_cut);
                 } catch (std::out_of_range& e) {
-                    throw crispr::substring_exception(e.what(), RH_Seq.c_str(), start_cut, (*ss_iter - start_cut), __FILE__, __LINE__, __PRETTY_FUNCTION__);
+                    throw crispr::substring_exception(e.what(), seq.c_str(), start_cut, (*ss_iter - start_cut), __FILE__, __LINE__, __PRETTY_FUNCTION__);
                 }
             }
     		else
@@ -873,9 +1121,9 @@ bool ReadHolder::getNextSpacer(std::string * retStr)
                 // only one DR in thie whole guy!
                 try {
                     
-                    *retStr = RH_Seq.substr(start_cut, RH_Seq.length() - start_cut);
+                    *retStr = seq.substr(start_cut, seq.length() - start_cut);
                 } catch (std::exception& e) {
-                    throw crispr::substring_exception(e.what(), RH_Seq.c_str(), start_cut, (int)(RH_Seq.length() - start_cut), __FILE__, __LINE__, __PRETTY_FUNCTION__);
+                    throw crispr::substring_exception(e.what(), seq.c_str(), start_cut, (int)(seq.length() - start_cut), __FILE__, __LINE__, __PRETTY_FUNCTION__);
 
                 }
     		}
@@ -889,19 +1137,19 @@ bool ReadHolder::getNextSpacer(std::string * retStr)
     	
         ss_iter += RH_NextSpacerStart;
     	// we've been here before
-    	if(RH_NextSpacerStart == ((int)(RH_StartStops.size()) - 1))
+    	if(RH_NextSpacerStart == ((int)(start_stops.size()) - 1))
     	{
     		// last one
-            if(*ss_iter < (RH_Seq.length() - 1))
+            if(*ss_iter < (seq.length() - 1))
             {
             	// read ends with a spacer
                 try {
-                    *retStr = RH_Seq.substr(*ss_iter + 1);
+                    *retStr = seq.substr(*ss_iter + 1);
                     RH_NextSpacerStart+=2;
                     return true;
                 } catch (std::exception& e) {
                     throw crispr::substring_exception(e.what(), 
-                                                      RH_Seq.c_str(),
+                                                      seq.c_str(),
                                                       0, 
                                                       *ss_iter, 
                                                       __FILE__, 
@@ -913,10 +1161,10 @@ bool ReadHolder::getNextSpacer(std::string * retStr)
             {
             	// read ends with a DR. No more spacers to get
 #ifdef DEBUG
-            	if(*ss_iter > (RH_Seq.length() - 1))
+            	if(*ss_iter > (seq.length() - 1))
             	{
                     this->printContents(std::cerr);
-                    logError( "ss list out of range; "<<*ss_iter<< " > "<<RH_Seq.length() - 1);
+                    logError( "ss list out of range; "<<*ss_iter<< " > "<<seq.length() - 1);
             	}
 #endif
                 return false;    		
@@ -929,12 +1177,12 @@ bool ReadHolder::getNextSpacer(std::string * retStr)
             ss_iter++;
     		int length = *ss_iter - start_cut;
             try {
-                *retStr = RH_Seq.substr(start_cut, length);
+                *retStr = seq.substr(start_cut, length);
     		    RH_NextSpacerStart += 2;
                 return true;
             } catch (std::exception& e) {
                 throw crispr::substring_exception(e.what(), 
-                                                  RH_Seq.c_str(), 
+                                                  seq.c_str(), 
                                                   0, 
                                                   *ss_iter, 
                                                   __FILE__, 
@@ -975,7 +1223,7 @@ std::string ReadHolder::toStringInColumns(void)
     //add 1 to each position, to offset programming languagues that begin at 0 rather than 1
     for (unsigned int m = 0; m < getStartStopListSize(); m+=2)
     {   //repeat = getRepeat(m);
-        str << RH_StartStops[m] + 1 << "\t\t" << repeatStringAt((unsigned int)m) << "\t";
+        str << (*this)[m] + 1 << "\t\t" << repeatStringAt((unsigned int)m) << "\t";
         
         // print spacer
         // because there are no spacers after the last repeat, we stop early (m < crisprIndexVector.size() - 1)
@@ -1019,7 +1267,7 @@ std::string ReadHolder::splitApart(void)
     stringstream ss;
     std::string working_str;
     std::string sep_str = " ";
-    StartStopListIterator ss_iter = RH_StartStops.begin();
+    StartStopListIterator ss_iter = begin();
     try {
         if(0 == *ss_iter)
         {
@@ -1127,18 +1375,22 @@ std::string ReadHolder::splitApartSimple(void)
     // produce a string of the read split into DR and spacers
     // without using the nextDR, nextSpacer functions.
     //
+    std::string seq_buffer;
+    std::string& seq = workingSeq(seq_buffer);
+    StartStopList start_stops_buffer;
+    StartStopList& start_stops = workingStartStops(start_stops_buffer);
     stringstream ss;
     std::string sep_str = " ";
     unsigned int prev_end = 0;
     
-    StartStopListIterator ss_iter = RH_StartStops.begin();
-    while(ss_iter != RH_StartStops.end())
+    StartStopListIterator ss_iter = start_stops.begin();
+    while(ss_iter != start_stops.end())
     {
         if(0 == *ss_iter)
         {
             // starts with a DR
             ss_iter++;
-            ss << "DR: " << RH_Seq.substr(0, *ss_iter + 1) << sep_str;
+            ss << "DR: " << seq.substr(0, *ss_iter + 1) << sep_str;
             prev_end = *ss_iter;
         }
         else
@@ -1154,21 +1406,21 @@ std::string ReadHolder::splitApartSimple(void)
                 length = *ss_iter - prev_end  - 1;
                 prev_end++;
             }
-            ss << "SP: " << RH_Seq.substr(prev_end, length) << sep_str;
+            ss << "SP: " << seq.substr(prev_end, length) << sep_str;
             int start = *ss_iter;
             ss_iter++;
-            ss << "DR: " << RH_Seq.substr(start, *ss_iter - start + 1) << sep_str;
+            ss << "DR: " << seq.substr(start, *ss_iter - start + 1) << sep_str;
             prev_end = *ss_iter;
             
         }
         
-        if(RH_StartStops.end() == (ss_iter + 1))
+        if(start_stops.end() == (ss_iter + 1))
         {
             // this is the last one.
-            if((RH_Seq.length() - 1) != *ss_iter)
+            if((seq.length() - 1) != *ss_iter)
             {
                 // ends on spacer
-                ss << "SP: " << RH_Seq.substr(prev_end + 1);
+                ss << "SP: " << seq.substr(prev_end + 1);
             }
         }
         ss_iter++;
@@ -1182,17 +1434,21 @@ void ReadHolder::printContents(void)
     //-----
     // la!
     //
-    std::cout <<"Header: "<< RH_Header <<"\n"
+    std::string seq_buffer;
+    std::string& seq = workingSeq(seq_buffer);
+    StartStopList start_stops_buffer;
+    StartStopList& start_stops = workingStartStops(start_stops_buffer);
+    std::cout <<"Header: "<< getHeader() <<"\n"
 		<< "LowLexi: " << RH_WasLowLexi << " \n ";
-    StartStopListIterator ss_iter = RH_StartStops.begin();
-    while(ss_iter != RH_StartStops.end())
+    StartStopListIterator ss_iter = start_stops.begin();
+    while(ss_iter != start_stops.end())
     {
         std::cout << *ss_iter << ",";
         ss_iter++;
     }
     std::cout << std::endl;
-    std::cout << "Sequence:"<< RH_Seq << std::endl;
-    std::cout << "Len: " << RH_Seq.length() << std::endl;
+    std::cout << "Sequence:"<< seq << std::endl;
+    std::cout << "Len: " << seq.length() << std::endl;
     std::cout << "---------------------------------------------" << std::endl;
     std::cout << "---------------------------------------------" << std::endl;
     
@@ -1202,17 +1458,21 @@ void ReadHolder::printContents(std::ostream& out)
     //-----
     // la!
     //
-    out <<"Header: "<< RH_Header <<"\n"
+    std::string seq_buffer;
+    std::string& seq = workingSeq(seq_buffer);
+    StartStopList start_stops_buffer;
+    StartStopList& start_stops = workingStartStops(start_stops_buffer);
+    out <<"Header: "<< getHeader() <<"\n"
 		<< "LowLexi: " << RH_WasLowLexi << " \n ";
-    StartStopListIterator ss_iter = RH_StartStops.begin();
-    while(ss_iter != RH_StartStops.end())
+    StartStopListIterator ss_iter = start_stops.begin();
+    while(ss_iter != start_stops.end())
     {
         out << *ss_iter << ",";
         ss_iter++;
     }
     out << std::endl;
-    out << "Sequence:"<< RH_Seq << std::endl;
-    out << "Len: " << RH_Seq.length() << std::endl;
+    out << "Sequence:"<< seq << std::endl;
+    out << "Len: " << seq.length() << std::endl;
     out << "---------------------------------------------" << std::endl;
     out << "---------------------------------------------" << std::endl;
     
@@ -1223,10 +1483,14 @@ void ReadHolder::logContents(int logLevel)
     //-----
     // LA!
     //
+    std::string seq_buffer;
+    std::string& seq = workingSeq(seq_buffer);
+    StartStopList start_stops_buffer;
+    StartStopList& start_stops = workingStartStops(start_stops_buffer);
     stringstream ss;
-    ss << RH_Header << " -- " << RH_WasLowLexi << " -- ";
-    StartStopListIterator ss_iter = RH_StartStops.begin();
-    while(ss_iter != RH_StartStops.end())
+    ss << getHeader() << " -- " << RH_WasLowLexi << " -- ";
+    StartStopListIterator ss_iter = start_stops.begin();
+    while(ss_iter != start_stops.end())
     {
         ss << *ss_iter << ",";
         ss_iter++;
@@ -1234,32 +1498,35 @@ void ReadHolder::logContents(int logLevel)
     std::string bob;
     ss >> bob;
     logInfo(bob, logLevel);
-    logInfo(RH_Seq, logLevel);
+    logInfo(seq, logLevel);
 }
 
 
 std::ostream& ReadHolder::print (std::ostream& s)
 {
+    std::string seq_buffer;
+    std::string& seq = workingSeq(seq_buffer);
+    std::string comment = getComment();
 #ifdef OUTPUT_READS_FASTQ
     if (RH_IsFasta) 
     {
 #endif
-        s<<'>'<<RH_Header;
-        if (RH_Comment.length() > 0) 
+        s<<'>'<<getHeader();
+        if (comment.length() > 0) 
         {
-            s<<'_'<<RH_Comment;
+            s<<'_'<<comment;
         }
-        s<<std::endl<<RH_Seq;
+        s<<std::endl<<seq;
 #ifdef OUTPUT_READS_FASTQ
     } 
     else 
     {
-        s<<'@'<<RH_Header<<std::endl<<RH_Seq<<std::endl<<'+';
-        if (RH_Comment.length() > 0) 
+        s<<'@'<<getHeader()<<std::endl<<seq<<std::endl<<'+';
+        if (comment.length() > 0) 
         {
-            s<<RH_Comment<<std::endl;
+            s<<comment<<std::endl;
         }
-        s<<RH_Qual;
+        s<<getQual();
     }
 #endif
     return s;
@@ -6,7 +6,9 @@
 // OVERVIEW:
 //
 //  Main class for all things read related.  Holds information about the
-//  sequence and the direct repeats contained in the read
+//  sequence and the direct repeats contained in the read. Once a read
+//  has been recruited it is moved into a ReadStore and the ReadHolder
+//  is only a handle onto it
 //
 // --------------------------------------------------------------------
 //  Copyright  2011 Michael Imelfort and Connor Skennerton
@@ -44,13 +46,12 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <stdexcept>
 // local includes
 #include "crassDefines.h"
+#include "ReadStore.h"
 
-// typedefs
-typedef std::vector<unsigned int> StartStopList;
-typedef std::vector<unsigned int>::iterator StartStopListIterator;
-typedef std::vector<unsigned int>::reverse_iterator StartStopListRIterator;
+class PartialRepeatAligner;
 
 
 
@@ -62,88 +63,73 @@ class ReadHolder
 
         ReadHolder() 
         { 
-            RH_LastDREnd = 0; 
-            RH_NextSpacerStart = 0; 
-            RH_isSqueezed = false;
-            RH_IsFasta = true;
+            init();
         }  
         
         ReadHolder(std::string s, std::string h) 
         {
-            RH_Seq = s; 
-            RH_Header = h; 
-            RH_LastDREnd = 0; 
-            RH_NextSpacerStart = 0; 
-            RH_isSqueezed = false;
-            RH_IsFasta = true;
-
+            init();
+            RH_Data->seq = s; 
+            RH_Data->header = h; 
         }
 
         ReadHolder(const char * s, const char * h) 
         {
-            RH_Seq = s; 
-            RH_Header = h;
-            RH_LastDREnd = 0; 
-            RH_NextSpacerStart = 0; 
-            RH_isSqueezed = false;
-            RH_IsFasta = true;
-
+            init();
+            RH_Data->seq = s; 
+            RH_Data->header = h;
         }
         ReadHolder(std::string s, std::string h, std::string c, std::string q) 
         {
-            RH_Seq = s; 
-            RH_Header = h; 
-            RH_Comment = c;
-            RH_Qual = q;
-            RH_LastDREnd = 0; 
-            RH_NextSpacerStart = 0; 
-            RH_isSqueezed = false;
+            init();
+            RH_Data->seq = s; 
+            RH_Data->header = h; 
+            RH_Data->comment = c;
+            RH_Data->qual = q;
             RH_IsFasta = false;
         }
         
         ReadHolder(const char * s, const char * h, const char * c, const char * q) 
         {
-            RH_Seq = s; 
-            RH_Header = h;
-            RH_Comment = c;
-            RH_Qual = q;
-            RH_LastDREnd = 0; 
-            RH_NextSpacerStart = 0; 
-            RH_isSqueezed = false;
+            init();
+            RH_Data->seq = s; 
+            RH_Data->header = h;
+            RH_Data->comment = c;
+            RH_Data->qual = q;
             RH_IsFasta = false;
-
         }
         
+        // copy the read into the store, this holder is then just a handle onto it
+        ReadHolder(ReadHolder& other, ReadStore * store);
+        
+        // copies of a stored read are not stored
+        ReadHolder(const ReadHolder& other);
+        
+        ReadHolder& operator=(const ReadHolder& other);
+        
         ~ReadHolder(void)
         {
-            clear();
+            delete RH_Data;
         }
         
-        void clear(void)
+        void clear(void);
+
+        inline bool isStored(void)
         {
-            RH_Seq.clear();
-            RH_StartStops.clear();
-            RH_Header.clear();
-            RH_Rle.clear();
-            RH_Comment.clear();
-            RH_Qual.clear();
-            RH_NextSpacerStart = 0; 
-            RH_isSqueezed = false;
-            RH_IsFasta = false;
+            return (NULL != RH_Store);
         }
 
-
     
         //----
         // Getters
         //
         inline std::string getComment(void)
         {
-            return this->RH_Comment;
+            return (NULL == RH_Store) ? RH_Data->comment : std::string(RH_Store->comment(RH_StoreIndex));
         }
         inline std::string getQual(void)
         {
-            return this->RH_Qual;
+            return (NULL == RH_Store) ? RH_Data->qual : std::string(RH_Store->quality(RH_StoreIndex));
         }
         inline bool getIsFasta(void)
         {
@@ -151,18 +137,21 @@ class ReadHolder
         }
         inline std::string getSeq(void)
         {
-            return this->RH_Seq;
+            if (NULL == RH_Store)
+            {
+                return RH_Data->seq;
+            }
+            std::string seq;
+            RH_Store->getSequence(RH_StoreIndex, seq);
+            return seq;
         }
     
         inline std::string getHeader(void)
         {
-            return this->RH_Header;
+            return (NULL == RH_Store) ? RH_Data->header : std::string(RH_Store->header(RH_StoreIndex));
         }
         
-        inline std::string getSeqRle(void)
-        {
-            return this->RH_Rle;
-        }
+        std::string getSeqRle(void);            // the squeezed sequence with the run lengths written in
     
         inline bool getLowLexi(void)
         {
@@ -176,7 +165,7 @@ class ReadHolder
         
         inline StartStopList getStartStopList(void)
         {
-            return this->RH_StartStops;
+            return StartStopList(begin(), end());
         }
         
         inline int getLastDRPos(void)
@@ -203,13 +192,13 @@ class ReadHolder
         // which is equal to the start of the last repeat
         inline int getLastRepeatStart()
         {
-            StartStopListIterator iter = RH_StartStops.end() - 2;
+            StartStopListIterator iter = end() - 2;
             return *iter;
         }
         
         inline unsigned int numRepeats()
         {
-            return (unsigned int)(RH_StartStops.size()/2);
+            return getStartStopListSize()/2;
         }
         
         inline unsigned int numSpacers()
@@ -219,21 +208,21 @@ class ReadHolder
         
         unsigned int front(void)
         {
-            return RH_StartStops.front();
+            return *begin();
         }
         unsigned int back(void)
         {
-            return RH_StartStops.back();
+            return *(end() - 1);
         }
         
         int getSeqLength(void)
         {
-            return (int)RH_Seq.length();
+            return (NULL == RH_Store) ? (int)RH_Data->seq.length() : (int)RH_Store->length(RH_StoreIndex);
         }
         
         unsigned int getStartStopListSize(void)
         {
-            return (int)RH_StartStops.size();
+            return (NULL == RH_Store) ? (unsigned int)RH_Data->startStops.size() : RH_Store->startStopsSize(RH_StoreIndex);
         }
     
         inline unsigned int getRepeatLength()
@@ -243,9 +232,13 @@ class ReadHolder
     
         inline char getSeqCharAt(int i)
         {
-            return RH_Seq[i];
+            return (NULL == RH_Store) ? RH_Data->seq[i] : RH_Store->baseAt(RH_StoreIndex, i);
         }
         
+        // add one to counts[4 * i + code] for every base i of the read,
+        // A C G T are 0 to 3 and anything else counts as an A
+        void addBaseCounts(int * counts);
+        
         unsigned int getRepeatAt(unsigned int i);
 
         std::string repeatStringAt(unsigned int i);
@@ -267,17 +260,20 @@ class ReadHolder
         // 
         inline void setComment(std::string _comment)
         {
-            RH_Comment = _comment;
+            detach();
+            RH_Data->comment = _comment;
         }
         inline void setQual(std::string _qual)
         {
-            RH_Qual = _qual;
+            detach();
+            RH_Data->qual = _qual;
             RH_IsFasta = false;
         }
         inline void setSequence(std::string _sequence)
         {
+            detach();
             RH_RepeatLength = 0;
-            RH_Seq = _sequence;
+            RH_Data->seq = _sequence;
         }
 
         inline void setRepeatLength(int length)
@@ -297,7 +293,8 @@ class ReadHolder
     
         inline void setHeader(std::string h)
         {
-            this->RH_Header = h;
+            detach();
+            this->RH_Data->header = h;
         }
         
         inline void setDRLowLexi(bool b)
@@ -328,14 +325,29 @@ class ReadHolder
 
         int startStopsAt(int i)
         {
-            return this->RH_StartStops.at(i);
+            if (NULL == RH_Store)
+            {
+                return this->RH_Data->startStops.at(i);
+            }
+            if (i < 0 || i >= (int)RH_Store->startStopsSize(RH_StoreIndex))
+            {
+                throw std::out_of_range("ReadHolder::startStopsAt");
+            }
+            return *(begin() + i);
         }        
         void startStopsAdd(unsigned int, unsigned int);
 
 
 		void clearStartStops(void)
 		{
-			RH_StartStops.clear();
+			if (NULL == RH_Store)
+			{
+				RH_Data->startStops.clear();
+			}
+			else
+			{
+				RH_Store->setStartStops(RH_StoreIndex, StartStopList());
+			}
 		}
 		
 		void removeRepeat(unsigned int val);
@@ -344,8 +356,8 @@ class ReadHolder
 	
 		void reverseStartStops(void);           // fix start stops what got corrupted during revcomping
 	
-		// update the DR after finding the TRUE DR
-		void updateStartStops(int frontOffset, std::string * DR, const options * opts);
+		// update the DR after finding the TRUE DR, partialAligner must be made from the same DR
+		void updateStartStops(int frontOffset, std::string * DR, PartialRepeatAligner * partialAligner, const options * opts);
 		
 		// the positions are the start positions of the direct repeats
 		// 
@@ -354,54 +366,58 @@ class ReadHolder
 			return (getRepeatAt(pos2) - getRepeatAt(pos1));
 		}
 
+        // for a stored read these point into the store and are not
+        // valid once the start stops of any stored read grow
         StartStopListIterator begin(void)
         {
-            return this->RH_StartStops.begin();
+            return (NULL == RH_Store) ? this->RH_Data->startStops.begin() : RH_Store->startStopsBegin(RH_StoreIndex);
         }
         
         StartStopListIterator end(void)
         {
-            return this->RH_StartStops.end();
+            return (NULL == RH_Store) ? this->RH_Data->startStops.end() : RH_Store->startStopsEnd(RH_StoreIndex);
         }
 
 
         unsigned int& operator[]( const unsigned int i)
         {
-            return this->RH_StartStops[i];
+            return *(begin() + i);
         }
 
 
         std::string substr(int i, int j)
         {
-            return RH_Seq.substr(i, j);
+            return seqSubstr(i, j);
         }
         
         std::string substr(int i)
         {
-            return RH_Seq.substr(i);
+            return seqSubstr(i, std::string::npos);
         }
         
         std::string substr(unsigned int i, unsigned int j)
         {
-            return RH_Seq.substr(i, j );
+            return seqSubstr(i, j);
         }
         
         std::string substr(unsigned int i)
         {
-            return RH_Seq.substr(i);
+            return seqSubstr(i, std::string::npos);
         }
         
         std::string substr(size_t i, size_t j)
         {
-            return RH_Seq.substr(i, j );
+            return seqSubstr(i, j);
         }
         
         std::string substr(size_t i)
         {
-            return RH_Seq.substr(i);
+            return seqSubstr(i, std::string::npos);
         }
     
         std::string DRLowLexi(void);            // Put the sequence in the form that makes the DR in it's laurenized form
+
+        std::string DRLowLexi(const std::string& knownRepeat);  // as above but the DR is given, not cut from the read
     
         void reverseComplementSeq(void);        // reverse complement the sequence and fix the start stops
         
@@ -436,15 +452,37 @@ class ReadHolder
         inline std::ostream& print(std::ostream& s);
     
     private:
+        // the parts of a read that aren't in a ReadStore
+        struct ReadData
+        {
+            std::string seq;                    // The DR_lowlexi sequence of this read
+            std::string header;                 // Header for the sequence
+            std::string comment;                // The comment attribute of the sequence
+            std::string qual;                   // The quality of the sequence
+            StartStopList startStops;           // start stops for DRs, (must be even in length!)
+            StartStopList runStarts;            // where the run of each squeezed base starts in the original sequence, plus the original length
+        };
+
+        void init(void);
+        
+        // make a stored read a normal one again so that it can be changed freely
+        void detach(void);
+        
+        // the sequence, start stops and run starts to work on. A stored read
+        // is copied into the buffer, start stops are written back with saveStartStops
+        std::string& workingSeq(std::string& buffer);
+        StartStopList& workingStartStops(StartStopList& buffer);
+        StartStopList& workingRunStarts(StartStopList& buffer);
+        void saveStartStops(StartStopList& startStops);
+        
+        std::string seqSubstr(size_t i, size_t j);
+        
         // members
-        std::string RH_Rle;                     // Run length encoded string
-        std::string RH_Header;                  // Header for the sequence
-        std::string RH_Comment;                 // The comment attribute of the sequence
-        std::string RH_Qual;                    // The quality of the sequence
+        ReadData * RH_Data;                     // NULL when the read is in a ReadStore
+        ReadStore * RH_Store;                   // the store holding the read, or NULL
+        unsigned int RH_StoreIndex;             // the read in RH_Store
         bool RH_IsFasta;                        // boolean to tell us if the read is fastq or fasta
-        std::string RH_Seq;                     // The DR_lowlexi sequence of this read
         bool RH_WasLowLexi;                     // was the sequence DR_low lexi in the file?
-        StartStopList RH_StartStops;            // start stops for DRs, (must be even in length!)
         bool RH_isSqueezed;                     // Bool to tell whether the read has homopolymers removed
         int RH_LastDREnd;                       // the end of the last DR cut (offset of the iterator)
         int RH_NextSpacerStart;                 // the end of the last spacer cut (offset of the iterator)
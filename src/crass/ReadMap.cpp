@@ -0,0 +1,98 @@
+/*
+ *  ReadMap.cpp is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+// local includes
+#include "ReadMap.h"
+
+void ReadMap::deleteReads(ReadList& readList)
+{
+    ReadListIterator read_iter = readList.begin();
+    while(read_iter != readList.end())
+    {
+        if(*read_iter != NULL)
+        {
+            delete *read_iter;
+        }
+        read_iter++;
+    }
+}
+
+void ReadMap::erase(StringToken token)
+{
+    if (RM_Lists.contains(token))
+    {
+        deleteReads(RM_Lists[token]);
+        RM_Lists.erase(token);
+    }
+}
+
+void ReadMap::move(StringToken from, StringToken to)
+{
+    if (from == to)
+    {
+        return;
+    }
+    ReadList& to_list = RM_Lists[to];
+    deleteReads(to_list);
+    to_list.clear();
+    if (RM_Lists.contains(from))
+    {
+        to_list.swap(RM_Lists[from]);
+        RM_Lists.erase(from);
+    }
+}
+
+void ReadMap::clear(void)
+{
+    for (StringToken token = 0; token < end(); token++)
+    {
+        if (RM_Lists.contains(token))
+        {
+            deleteReads(RM_Lists[token]);
+        }
+    }
+    RM_Lists.clear();
+}
+
+size_t ReadMap::numberOfReads(void) const
+{
+    size_t count = 0;
+    for (StringToken token = 0; token < end(); token++)
+    {
+        if (RM_Lists.contains(token))
+        {
+            count += RM_Lists.at(token).size();
+        }
+    }
+    return count;
+}
@@ -0,0 +1,90 @@
+/*
+ *  ReadMap.h is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  The reads found by the searches, grouped by the DR (as a StringToken)
+ *  they were found with. The lists sit in a TokenTable indexed by the
+ *  token. The map owns the reads; they are deleted along with their DR
+ *  or with the map, so a ReadList taken from it must not outlive it.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+#ifndef crass_ReadMap_h
+#define crass_ReadMap_h
+
+// system includes
+#include <cstddef>
+#include <vector>
+
+// local includes
+#include "ReadHolder.h"
+#include "StringCheck.h"
+#include "TokenTable.h"
+
+typedef std::vector<ReadHolder *> ReadList;
+typedef std::vector<ReadHolder *>::iterator ReadListIterator;
+
+class ReadMap
+{
+    public:
+        ReadMap(void) {}
+        ~ReadMap(void) { clear(); }
+
+        // true if reads were found with this DR
+        inline bool contains(StringToken token) const { return RM_Lists.contains(token); }
+
+        // the reads found with this DR, an empty list if there weren't any
+        inline ReadList& operator[](StringToken token) { return RM_Lists[token]; }
+
+        // delete the reads found with this DR
+        void erase(StringToken token);
+
+        // give the reads of one DR to another, any reads the other
+        // DR had are deleted
+        void move(StringToken from, StringToken to);
+
+        void clear(void);
+
+        // number of DRs with reads
+        inline size_t size(void) const { return RM_Lists.size(); }
+
+        // one past the largest token there has been
+        inline StringToken end(void) const { return RM_Lists.end(); }
+
+        size_t numberOfReads(void) const;
+
+    private:
+        ReadMap(const ReadMap&);
+        ReadMap& operator=(const ReadMap&);
+
+        static void deleteReads(ReadList& readList);
+
+        TokenTable<ReadList> RM_Lists;
+};
+
+#endif //crass_ReadMap_h
@@ -0,0 +1,131 @@
+/*
+ *  ReadOrdinalSet.cpp is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+// system includes
+#include <algorithm>
+
+// local includes
+#include "ReadOrdinalSet.h"
+
+// a list this long takes as much room as a bitmap of the whole chunk
+#define CHUNK_BITS      (1 << 16)
+#define MAX_LIST_SIZE   (CHUNK_BITS / 16)
+
+ReadOrdinalSet::~ReadOrdinalSet(void)
+{
+    for (size_t i = 0; i < RO_Files.size(); i++)
+    {
+        for (size_t j = 0; j < RO_Files[i].size(); j++)
+        {
+            delete RO_Files[i][j];
+        }
+    }
+}
+
+void ReadOrdinalSet::add(unsigned int fileIndex, uint64_t ordinal)
+{
+    if (fileIndex >= RO_Files.size())
+    {
+        RO_Files.resize(fileIndex + 1);
+    }
+    std::vector<Chunk *>& chunks = RO_Files[fileIndex];
+    size_t chunk_index = static_cast<size_t>(ordinal >> 16);
+    if (chunk_index >= chunks.size())
+    {
+        chunks.resize(chunk_index + 1, NULL);
+    }
+    if (NULL == chunks[chunk_index])
+    {
+        chunks[chunk_index] = new Chunk();
+    }
+    Chunk * chunk = chunks[chunk_index];
+    uint16_t low = static_cast<uint16_t>(ordinal & 0xffff);
+
+    if (!chunk->bits.empty())
+    {
+        uint64_t mask = static_cast<uint64_t>(1) << (low & 63);
+        if (0 == (chunk->bits[low >> 6] & mask))
+        {
+            chunk->bits[low >> 6] |= mask;
+            RO_Size++;
+        }
+        return;
+    }
+
+    // reads are nearly always added in file order
+    if (chunk->list.empty() || low > chunk->list.back())
+    {
+        chunk->list.push_back(low);
+    }
+    else
+    {
+        std::vector<uint16_t>::iterator list_iter = std::lower_bound(chunk->list.begin(), chunk->list.end(), low);
+        if (*list_iter == low)
+        {
+            return;
+        }
+        chunk->list.insert(list_iter, low);
+    }
+    RO_Size++;
+
+    if (chunk->list.size() > MAX_LIST_SIZE)
+    {
+        chunk->bits.resize(CHUNK_BITS / 64, 0);
+        for (size_t i = 0; i < chunk->list.size(); i++)
+        {
+            chunk->bits[chunk->list[i] >> 6] |= static_cast<uint64_t>(1) << (chunk->list[i] & 63);
+        }
+        std::vector<uint16_t>().swap(chunk->list);
+    }
+}
+
+bool ReadOrdinalSet::contains(unsigned int fileIndex, uint64_t ordinal) const
+{
+    if (fileIndex >= RO_Files.size())
+    {
+        return false;
+    }
+    const std::vector<Chunk *>& chunks = RO_Files[fileIndex];
+    size_t chunk_index = static_cast<size_t>(ordinal >> 16);
+    if (chunk_index >= chunks.size() || NULL == chunks[chunk_index])
+    {
+        return false;
+    }
+    const Chunk * chunk = chunks[chunk_index];
+    uint16_t low = static_cast<uint16_t>(ordinal & 0xffff);
+    if (!chunk->bits.empty())
+    {
+        return 0 != (chunk->bits[low >> 6] & (static_cast<uint64_t>(1) << (low & 63)));
+    }
+    return std::binary_search(chunk->list.begin(), chunk->list.end(), low);
+}
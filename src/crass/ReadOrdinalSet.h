@@ -0,0 +1,75 @@
+/*
+ *  ReadOrdinalSet.h is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  A set of reads, each one named by the index of its input file and its
+ *  position in that file. The positions of a file are split into chunks
+ *  of 65536; a chunk holds a sorted list of the low 16 bits of its reads
+ *  until a bitmap would be smaller, so sparse sets cost two bytes a read
+ *  and dense ones a bit a read.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+#ifndef crass_ReadOrdinalSet_h
+#define crass_ReadOrdinalSet_h
+
+// system includes
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+class ReadOrdinalSet
+{
+    public:
+        ReadOrdinalSet(void) : RO_Size(0) {}
+        ~ReadOrdinalSet(void);
+
+        void add(unsigned int fileIndex, uint64_t ordinal);
+
+        bool contains(unsigned int fileIndex, uint64_t ordinal) const;
+
+        // number of reads in the set
+        inline size_t size(void) const { return RO_Size; }
+
+        inline bool empty(void) const { return 0 == RO_Size; }
+
+    private:
+        struct Chunk
+        {
+            std::vector<uint16_t> list;                     // sorted, while the chunk is sparse
+            std::vector<uint64_t> bits;                     // empty until the chunk is dense
+        };
+
+        ReadOrdinalSet(const ReadOrdinalSet&);
+        ReadOrdinalSet& operator=(const ReadOrdinalSet&);
+
+        std::vector<std::vector<Chunk *> > RO_Files;        // the chunks of every file, NULL if empty
+        size_t RO_Size;
+};
+
+#endif //crass_ReadOrdinalSet_h
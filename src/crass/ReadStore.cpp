@@ -0,0 +1,299 @@
+/*
+ *  ReadStore.cpp is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+// system includes
+#include <algorithm>
+#include <cstring>
+
+// local includes
+#include "ReadStore.h"
+#include "PackedKmer.h"
+#include "SeqUtils.h"
+#include "crassDefines.h"
+
+ReadStore::ReadStore(bool keepQualities) :
+    RS_MemoryUsage(0),
+    RS_KeepQualities(keepQualities)
+{
+    RS_ExceptionStart.push_back(0);
+    RS_RunLengthsStart.push_back(0);
+    RS_LongRunsStart.push_back(0);
+}
+
+unsigned int ReadStore::add(const std::string& sequence,
+                            const std::string& header,
+                            const std::string& comment,
+                            const std::string& quality,
+                            const StartStopList& startStops,
+                            const StartStopList& runStarts)
+{
+    unsigned int index = static_cast<unsigned int>(size());
+
+    size_t text_before = RS_Text.size();
+    size_t words_before = RS_Packed.size();
+    size_t exceptions_before = RS_ExceptionChar.size();
+    size_t start_stops_before = RS_StartStops.size();
+
+    //-----
+    // text
+    //
+    unsigned char flags = 0;
+    RS_TextStart.push_back(RS_Text.size());
+    RS_Text.insert(RS_Text.end(), header.c_str(), header.c_str() + header.length() + 1);
+    if (!comment.empty())
+    {
+        flags |= hasComment;
+        RS_Text.insert(RS_Text.end(), comment.c_str(), comment.c_str() + comment.length() + 1);
+    }
+    if (!quality.empty() && RS_KeepQualities)
+    {
+        flags |= hasQuality;
+        RS_Text.insert(RS_Text.end(), quality.c_str(), quality.c_str() + quality.length() + 1);
+    }
+    RS_Flags.push_back(flags);
+
+    //-----
+    // sequence, starting on a fresh word
+    //
+    uint64_t pos = static_cast<uint64_t>(RS_Packed.size()) << 5;
+    RS_SeqStart.push_back(pos);
+    RS_Length.push_back(static_cast<uint32_t>(sequence.length()));
+    for (uint32_t read_pos = 0; read_pos < sequence.length(); read_pos++, pos++)
+    {
+        unsigned char code = packBase(sequence[read_pos]);
+        if (code > 3)
+        {
+            RS_ExceptionPos.push_back(read_pos);
+            RS_ExceptionChar.push_back(sequence[read_pos]);
+            code = 0;
+        }
+        if ((pos & 31) == 0)
+        {
+            RS_Packed.push_back(0);
+        }
+        RS_Packed.back() |= static_cast<uint64_t>(code) << ((pos & 31) << 1);
+    }
+    RS_ExceptionStart.push_back(RS_ExceptionChar.size());
+
+    //-----
+    // start stops, with some room for the partials
+    //
+    RS_StartStopsStart.push_back(RS_StartStops.size());
+    RS_StartStopsSize.push_back(static_cast<uint32_t>(startStops.size()));
+    RS_StartStopsRoom.push_back(static_cast<uint32_t>(startStops.size()) + CRASS_DEF_START_STOP_ROOM);
+    RS_StartStops.insert(RS_StartStops.end(), startStops.begin(), startStops.end());
+    RS_StartStops.resize(RS_StartStops.size() + CRASS_DEF_START_STOP_ROOM, 0);
+
+    //-----
+    // run starts, as the length of each run
+    //
+    size_t runs_before = RS_RunLengths.size() + RS_LongRuns.size() * sizeof(uint32_t);
+    for (size_t i = 1; i < runStarts.size(); i++)
+    {
+        unsigned int run_length = runStarts[i] - runStarts[i - 1];
+        if (run_length > 255)
+        {
+            RS_LongRuns.push_back(run_length);
+            run_length = 0;
+        }
+        RS_RunLengths.push_back(static_cast<unsigned char>(run_length));
+    }
+    RS_RunLengthsStart.push_back(RS_RunLengths.size());
+    RS_LongRunsStart.push_back(RS_LongRuns.size());
+
+    RS_MemoryUsage += (RS_Text.size() - text_before) +
+                      (RS_Packed.size() - words_before) * sizeof(uint64_t) +
+                      (RS_ExceptionChar.size() - exceptions_before) * (sizeof(uint32_t) + sizeof(char)) +
+                      (RS_StartStops.size() - start_stops_before) * sizeof(unsigned int) +
+                      (RS_RunLengths.size() + RS_LongRuns.size() * sizeof(uint32_t) - runs_before) +
+                      sizeof(uint64_t) + 5 * sizeof(size_t) + 3 * sizeof(uint32_t) + sizeof(unsigned char);
+    return index;
+}
+
+char ReadStore::baseAt(unsigned int index, unsigned int pos)
+{
+    size_t first = RS_ExceptionStart[index];
+    size_t last = RS_ExceptionStart[index + 1];
+    if (first != last)
+    {
+        std::vector<uint32_t>::iterator exception_iter = std::lower_bound(RS_ExceptionPos.begin() + first,
+                                                                          RS_ExceptionPos.begin() + last,
+                                                                          pos);
+        if (exception_iter != RS_ExceptionPos.begin() + last && *exception_iter == pos)
+        {
+            return RS_ExceptionChar[exception_iter - RS_ExceptionPos.begin()];
+        }
+    }
+    return unpackBase(packedCode(RS_SeqStart[index] + pos));
+}
+
+void ReadStore::addBaseCounts(unsigned int index, int * counts)
+{
+    //-----
+    // straight from the packed words, a word at a time. The non-ACGT
+    // characters went in as some base, swap it for theirs afterwards
+    //
+    uint64_t start = RS_SeqStart[index];
+    uint32_t length = RS_Length[index];
+    const uint64_t * word = &(RS_Packed[start >> 5]);
+    int * column = counts;
+    for (uint32_t i = 0; i < length; i += 32, word++)
+    {
+        uint64_t codes = *word;
+        uint32_t in_word = std::min(static_cast<uint32_t>(32), length - i);
+        for (uint32_t j = 0; j < in_word; j++, codes >>= 2, column += 4)
+        {
+            column[codes & 3]++;
+        }
+    }
+    for (size_t i = RS_ExceptionStart[index]; i < RS_ExceptionStart[index + 1]; i++)
+    {
+        uint32_t pos = RS_ExceptionPos[i];
+        unsigned char code = packBaseAnyCase(RS_ExceptionChar[i]);
+        counts[4 * pos + packedCode(start + pos)]--;
+        counts[4 * pos + ((code > 3) ? 0 : code)]++;
+    }
+}
+
+void ReadStore::getSequence(unsigned int index, std::string& sequence)
+{
+    uint64_t start = RS_SeqStart[index];
+    uint32_t length = RS_Length[index];
+    sequence.resize(length);
+    for (uint32_t i = 0; i < length; i++)
+    {
+        sequence[i] = unpackBase(packedCode(start + i));
+    }
+    for (size_t i = RS_ExceptionStart[index]; i < RS_ExceptionStart[index + 1]; i++)
+    {
+        sequence[RS_ExceptionPos[i]] = RS_ExceptionChar[i];
+    }
+}
+
+void ReadStore::reverseComplement(unsigned int index)
+{
+    //-----
+    // swap the bases from both ends in towards the middle, the
+    // complement of a packed base is 3 - code. No other read
+    // shares the words so nothing else is disturbed
+    //
+    uint64_t start = RS_SeqStart[index];
+    uint32_t length = RS_Length[index];
+    for (uint32_t i = 0; i < (length + 1) / 2; i++)
+    {
+        uint64_t front = start + i;
+        uint64_t back = start + length - 1 - i;
+        uint64_t front_code = 3 - packedCode(back);
+        uint64_t back_code = 3 - packedCode(front);
+        RS_Packed[front >> 5] = (RS_Packed[front >> 5] & ~(static_cast<uint64_t>(3) << ((front & 31) << 1))) | (front_code << ((front & 31) << 1));
+        RS_Packed[back >> 5] = (RS_Packed[back >> 5] & ~(static_cast<uint64_t>(3) << ((back & 31) << 1))) | (back_code << ((back & 31) << 1));
+    }
+
+    size_t first = RS_ExceptionStart[index];
+    size_t last = RS_ExceptionStart[index + 1];
+    if (first != last)
+    {
+        for (size_t i = first; i < last; i++)
+        {
+            RS_ExceptionPos[i] = length - 1 - RS_ExceptionPos[i];
+        }
+        std::reverse(RS_ExceptionPos.begin() + first, RS_ExceptionPos.begin() + last);
+        std::string exception_chars = ::reverseComplement(std::string(RS_ExceptionChar.begin() + first, RS_ExceptionChar.begin() + last));
+        std::copy(exception_chars.begin(), exception_chars.end(), RS_ExceptionChar.begin() + first);
+    }
+}
+
+const char * ReadStore::comment(unsigned int index)
+{
+    if (RS_Flags[index] & hasComment)
+    {
+        const char * text = header(index);
+        return text + strlen(text) + 1;
+    }
+    return "";
+}
+
+const char * ReadStore::quality(unsigned int index)
+{
+    if (RS_Flags[index] & hasQuality)
+    {
+        const char * text = header(index);
+        text += strlen(text) + 1;
+        if (RS_Flags[index] & hasComment)
+        {
+            text += strlen(text) + 1;
+        }
+        return text;
+    }
+    return "";
+}
+
+void ReadStore::setStartStops(unsigned int index, const StartStopList& startStops)
+{
+    if (startStops.size() > RS_StartStopsRoom[index])
+    {
+        // no room left, move the read to the end
+        RS_StartStopsStart[index] = RS_StartStops.size();
+        RS_StartStopsRoom[index] = static_cast<uint32_t>(startStops.size()) + CRASS_DEF_START_STOP_ROOM;
+        RS_StartStops.resize(RS_StartStops.size() + RS_StartStopsRoom[index], 0);
+        RS_MemoryUsage += RS_StartStopsRoom[index] * sizeof(unsigned int);
+    }
+    std::copy(startStops.begin(), startStops.end(), RS_StartStops.begin() + RS_StartStopsStart[index]);
+    RS_StartStopsSize[index] = static_cast<uint32_t>(startStops.size());
+}
+
+void ReadStore::getRunStarts(unsigned int index, StartStopList& runStarts)
+{
+    runStarts.clear();
+    size_t first = RS_RunLengthsStart[index];
+    size_t last = RS_RunLengthsStart[index + 1];
+    if (first == last)
+    {
+        return;
+    }
+    runStarts.reserve(last - first + 1);
+    size_t long_run = RS_LongRunsStart[index];
+    unsigned int run_start = 0;
+    runStarts.push_back(run_start);
+    for (size_t i = first; i < last; i++)
+    {
+        run_start += (0 == RS_RunLengths[i]) ? RS_LongRuns[long_run++] : RS_RunLengths[i];
+        runStarts.push_back(run_start);
+    }
+}
+
+void ReadStore::reverseRunStarts(unsigned int index)
+{
+    std::reverse(RS_RunLengths.begin() + RS_RunLengthsStart[index], RS_RunLengths.begin() + RS_RunLengthsStart[index + 1]);
+    std::reverse(RS_LongRuns.begin() + RS_LongRunsStart[index], RS_LongRuns.begin() + RS_LongRunsStart[index + 1]);
+}
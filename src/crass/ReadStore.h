@@ -0,0 +1,168 @@
+/*
+ *  ReadStore.h is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Holds the reads that were recruited by the searches. Every read is a
+ *  row in a set of flat columns and a ReadHolder made from the store is
+ *  just a handle onto its row. Sequences are packed two bits to a base
+ *  with any non-ACGT characters stored on the side, every read starts on
+ *  a fresh word so a read can be reverse complemented without touching
+ *  its neighbours. Headers and comments share one text buffer, qualities
+ *  are only kept if asked for. The start stops of all the reads live in
+ *  one array with a little room left after each read for the partials
+ *  found later on; a read that outgrows its room is moved to the end.
+ *  Squeezed reads keep the length of the run behind each base in a byte.
+ *
+ *  Nothing is ever removed, the memory goes when the store does. The
+ *  store is not thread safe.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+#ifndef crass_ReadStore_h
+#define crass_ReadStore_h
+
+// system includes
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// typedefs
+typedef std::vector<unsigned int> StartStopList;
+typedef std::vector<unsigned int>::iterator StartStopListIterator;
+typedef std::vector<unsigned int>::reverse_iterator StartStopListRIterator;
+
+class ReadStore
+{
+    public:
+        // Quality strings are only stored if keepQualities is set
+        ReadStore(bool keepQualities);
+        ~ReadStore(void) {}
+
+        // copy a read into the store and return its index. runStarts is
+        // empty unless the read has had its homopolymers squeezed
+        unsigned int add(const std::string& sequence,
+                         const std::string& header,
+                         const std::string& comment,
+                         const std::string& quality,
+                         const StartStopList& startStops,
+                         const StartStopList& runStarts);
+
+        inline size_t size(void) { return RS_Flags.size(); }
+
+        inline size_t memoryUsage(void) { return RS_MemoryUsage; }
+
+        //----
+        // Sequence
+        //
+        inline unsigned int length(unsigned int index) { return RS_Length[index]; }
+
+        char baseAt(unsigned int index, unsigned int pos);
+
+        // add one to counts[4 * pos + code] for every base of the read, the
+        // codes of A C G T are 0 to 3 and any other character counts as an A
+        void addBaseCounts(unsigned int index, int * counts);
+
+        void getSequence(unsigned int index, std::string& sequence);
+
+        // reverse complement in place, the start stops are left alone
+        void reverseComplement(unsigned int index);
+
+        //----
+        // Text
+        //
+        inline const char * header(unsigned int index) { return &(RS_Text[RS_TextStart[index]]); }
+
+        // empty if the read has none or it was not kept
+        const char * comment(unsigned int index);
+
+        const char * quality(unsigned int index);
+
+        //----
+        // Start stops
+        //
+        inline StartStopListIterator startStopsBegin(unsigned int index)
+        {
+            return RS_StartStops.begin() + RS_StartStopsStart[index];
+        }
+
+        inline StartStopListIterator startStopsEnd(unsigned int index)
+        {
+            return RS_StartStops.begin() + RS_StartStopsStart[index] + RS_StartStopsSize[index];
+        }
+
+        inline unsigned int startStopsSize(unsigned int index) { return RS_StartStopsSize[index]; }
+
+        // replace the start stops. Iterators into the start stops of
+        // any read are not valid after this
+        void setStartStops(unsigned int index, const StartStopList& startStops);
+
+        //----
+        // Run starts of a squeezed read, kept as run lengths
+        //
+        void getRunStarts(unsigned int index, StartStopList& runStarts);
+
+        // the runs are in the opposite order once the read is reverse complemented
+        void reverseRunStarts(unsigned int index);
+
+    private:
+        enum {
+            hasComment = 1,
+            hasQuality = 2
+        };
+
+        ReadStore(const ReadStore&);
+        ReadStore& operator=(const ReadStore&);
+
+        inline unsigned char packedCode(uint64_t pos)
+        {
+            return (RS_Packed[pos >> 5] >> ((pos & 31) << 1)) & 3;
+        }
+
+        size_t RS_MemoryUsage;                              // approximate bytes in use
+        bool RS_KeepQualities;
+
+        std::vector<uint64_t> RS_Packed;                    // 32 bases per word
+        std::vector<uint64_t> RS_SeqStart;                  // first base of every read, always the start of a word
+        std::vector<uint32_t> RS_Length;                    // length of every read
+        std::vector<uint32_t> RS_ExceptionPos;              // position in the read of a non-ACGT character
+        std::vector<char> RS_ExceptionChar;                 // and the character itself
+        std::vector<size_t> RS_ExceptionStart;              // first exception of every read, plus one past the end
+        std::vector<char> RS_Text;                          // header\0[comment\0][quality\0] for every read
+        std::vector<size_t> RS_TextStart;                   // start of the text of every read
+        std::vector<unsigned char> RS_Flags;                // hasComment | hasQuality
+        StartStopList RS_StartStops;                        // start stops of every read, with room to grow
+        std::vector<size_t> RS_StartStopsStart;             // first start stop of every read
+        std::vector<uint32_t> RS_StartStopsSize;
+        std::vector<uint32_t> RS_StartStopsRoom;            // how many start stops fit before the next read
+        std::vector<unsigned char> RS_RunLengths;           // length of the run behind every squeezed base, 0 if it is too long
+        std::vector<size_t> RS_RunLengthsStart;             // first run length of every read, plus one past the end
+        std::vector<uint32_t> RS_LongRuns;                  // the runs too long for RS_RunLengths
+        std::vector<size_t> RS_LongRunsStart;               // first long run of every read, plus one past the end
+};
+
+#endif //crass_ReadStore_h
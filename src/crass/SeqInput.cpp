@@ -0,0 +1,122 @@
+/*
+ *  SeqInput.cpp is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+// system includes
+#include <cstdio>
+#include <cstring>
+
+// local includes
+#include "SeqInput.h"
+#include "BlockGzipReader.h"
+#include "InputReaders.h"
+#include "SeqUtils.h"
+#include "LoggerSimp.h"
+
+SeqInput::SeqInput(const char * fileName, const options& opts) :
+    SI_GzFile(NULL),
+    SI_BlockReader(NULL),
+    SI_MappedReader(NULL),
+    SI_ReadAheadReader(NULL),
+    SI_Seq(NULL)
+{
+    if (0 != strcmp(fileName, "-"))
+    {
+        if (isGzipped(fileName))
+        {
+            //-----
+            // with one thread there is no one to hand the inflating to
+            //
+            if (opts.numThreads > 1)
+            {
+                SI_BlockReader = new BlockGzipReader(opts.numThreads);
+                if (SI_BlockReader->open(fileName))
+                {
+                    logInfo("Inflating "<<fileName<<" on "<<opts.numThreads<<" threads", 3);
+                    SI_Seq = kseq_init_reader(SI_BlockReader, BlockGzipReader::readCallback);
+                    return;
+                }
+                delete SI_BlockReader;
+                SI_BlockReader = NULL;
+            }
+        }
+        else if (INPUT_MMAP == opts.inputBackend)
+        {
+            SI_MappedReader = new MappedFileReader();
+            if (SI_MappedReader->open(fileName))
+            {
+                SI_Seq = kseq_init_view(SI_MappedReader, MappedFileReader::viewCallback);
+                return;
+            }
+            delete SI_MappedReader;
+            SI_MappedReader = NULL;
+        }
+        else if (INPUT_READ_AHEAD == opts.inputBackend)
+        {
+            SI_ReadAheadReader = new ReadAheadReader();
+            if (SI_ReadAheadReader->open(fileName))
+            {
+                SI_Seq = kseq_init_view(SI_ReadAheadReader, ReadAheadReader::viewCallback);
+                return;
+            }
+            delete SI_ReadAheadReader;
+            SI_ReadAheadReader = NULL;
+        }
+    }
+    SI_GzFile = getFileHandle(fileName);
+    SI_Seq = kseq_init(SI_GzFile);
+}
+
+SeqInput::~SeqInput(void)
+{
+    kseq_destroy(SI_Seq);
+    if (NULL != SI_GzFile)
+    {
+        gzclose(SI_GzFile);
+    }
+    delete SI_BlockReader;
+    delete SI_MappedReader;
+    delete SI_ReadAheadReader;
+}
+
+bool SeqInput::isGzipped(const char * fileName)
+{
+    FILE * fp = fopen(fileName, "rb");
+    if (NULL == fp)
+    {
+        return false;
+    }
+    unsigned char magic[2];
+    bool gzipped = (2 == fread(magic, 1, 2, fp) && 0x1f == magic[0] && 0x8b == magic[1]);
+    fclose(fp);
+    return gzipped;
+}
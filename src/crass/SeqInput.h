@@ -0,0 +1,74 @@
+/*
+ *  SeqInput.h is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Opens a sequence file for kseq and picks the way the bytes are read.
+ *  bgzip and multi-member gzip files are inflated on a pool of threads,
+ *  other gzip files and stdin go through zlib. Uncompressed files are
+ *  read with the backend chosen in the options (see INPUT_BACKEND).
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+#ifndef crass_SeqInput_h
+#define crass_SeqInput_h
+
+// system includes
+#include <zlib.h>
+
+// local includes
+#include "crassDefines.h"
+#include "kseq.h"
+
+class BlockGzipReader;
+class MappedFileReader;
+class ReadAheadReader;
+
+class SeqInput
+{
+    public:
+        // exits if the file can't be opened, same as getFileHandle
+        SeqInput(const char * fileName, const options& opts);
+        ~SeqInput(void);
+
+        inline kseq_t * seq(void) { return SI_Seq; }
+
+    private:
+        SeqInput(const SeqInput&);
+        SeqInput& operator=(const SeqInput&);
+
+        // true if the file starts with the gzip magic number
+        bool isGzipped(const char * fileName);
+
+        gzFile SI_GzFile;
+        BlockGzipReader * SI_BlockReader;
+        MappedFileReader * SI_MappedReader;
+        ReadAheadReader * SI_ReadAheadReader;
+        kseq_t * SI_Seq;
+};
+
+#endif //crass_SeqInput_h
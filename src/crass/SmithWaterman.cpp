@@ -58,6 +58,7 @@
 #include <sys/time.h>
 #include <map>
 #include <exception>
+#include <algorithm>
 
 // local includes
 #include "SmithWaterman.h"
@@ -300,9 +301,106 @@ stringPair smithWaterman(std::string& seqA, std::string& seqB, int * aStartAlign
     }
 }
 
+PartialRepeatAligner::PartialRepeatAligner(const std::string& DR) :
+    PR_DR(DR),
+    PR_Scores(2 * (DR.length() + 1), 0)
+{}
 
+PartialRepeatAligner::~PartialRepeatAligner(void)
+{}
 
-
-
-
-
+stringPair PartialRepeatAligner::align(std::string& seqA, int * aStartAlign, int * aEndAlign, int aStartSearch, int aSearchLen, double similarity)
+{
+    //-----
+    // Align the DR to the part of seqA between aStartSearch and
+    // aStartSearch + aSearchLen. This is smithWaterman with only two
+    // rows of scores kept and nothing allocated once the buffers are big
+    // enough. The scores are added up in the same order, in doubles, and
+    // go through the same findMax so that equal scores, and ones that
+    // only differ by rounding, fall the way smithWaterman has them
+    //
+    *aStartAlign = 0;
+    *aEndAlign = 0;
+    int length_seq_B = static_cast<int>(PR_DR.length());
+    if((0 == length_seq_B) || (0 >= aSearchLen))
+    {
+        return stringPair("","");
+    }
+    
+    int width = length_seq_B + 1;
+    std::fill(PR_Scores.begin(), PR_Scores.begin() + width, 0);
+    PR_Trace.resize((aSearchLen + 1) * width);
+    double matrix_max = -1;
+    int i_max = 0, j_max = 0;
+    for(int i = 1; i <= aSearchLen; i++)
+    {
+        double * previous = &(PR_Scores[((i - 1) & 1) * width]);
+        double * current = &(PR_Scores[(i & 1) * width]);
+        char a = seqA[aStartSearch + i - 1];
+        for(int j = 1; j <= length_seq_B; j++)
+        {
+            int index = -1;
+            current[j] = findMax(previous[j - 1] + SW_SIM_SCORE(a, PR_DR[j - 1]), 
+                                 previous[j] + SW_GAP, 
+                                 current[j - 1] + SW_GAP, 
+                                 0, 
+                                 &index);
+            PR_Trace[i * width + j] = static_cast<unsigned char>(index);
+            if(current[j] > matrix_max)
+            {
+                matrix_max = current[j];
+                i_max = i;
+                j_max = j;
+            }
+        }
+    }
+    // walk back the way smithWaterman does
+    int current_i = i_max;
+    int current_j = j_max;
+    while(true)
+    {
+        int next_i = current_i;
+        int next_j = current_j;
+        switch(PR_Trace[current_i * width + current_j])
+        {
+            case 0:
+                next_i--;
+                next_j--;
+                break;
+            case 1:
+                next_i--;
+                break;
+            case 2:
+                next_j--;
+                break;
+            default:
+                break;
+        }
+        if((0 == next_j) || (0 == next_i) || ((current_i == next_i) && (current_j == next_j)))
+        {
+            break;
+        }
+        current_i = next_i;
+        current_j = next_j;
+    }
+    int a_start = current_i - 1;
+    int b_start = current_j - 1;
+    
+    // smithWaterman adds the start of the search to the length of the cut,
+    // so for a window at the back of a read it runs on to the end. The
+    // similarity is worked out on the same strings
+    std::string a_ret = seqA.substr(aStartSearch + a_start, i_max - a_start + aStartSearch);
+    std::string b_ret = PR_DR.substr(b_start, j_max - b_start);
+    if(0 != similarity)
+    {
+        double similarity_ld = 1.0 - (PatternMatcher::levenstheinDistance(a_ret, b_ret) /(double)a_ret.length()); 
+        if(similarity_ld < similarity)
+        {
+            // no go joe
+            return stringPair("","");
+        }
+    }
+    *aStartAlign = aStartSearch + a_start;
+    *aEndAlign = aStartSearch + i_max - 1;
+    return stringPair(a_ret, b_ret);
+}
@@ -56,6 +56,7 @@
 // system includes
 #include <string>
 #include <map>
+#include <vector>
 
 #define SW_MATCH                (1.2)
 #define SW_MISMATCH             (-1)
@@ -83,4 +84,28 @@ stringPair smithWaterman(std::string& seqA, std::string& seqB, int * aStartAlign
 // two int references  aStartAlign, aEndAlign 
 stringPair smithWaterman(std::string& seqA, std::string& seqB, int * aStartAlign, int * aEndAlign, int aStartSearch, int aEndSearch);
 
+//-----
+// Looks for partial copies of one DR in many reads. The matrix is kept
+// from read to read instead of being made for each one. align() keeps
+// the contract of the similarity version of smithWaterman above with
+// seqB fixed to the DR, down to which of two equally good alignments
+// it picks
+//
+class PartialRepeatAligner
+{
+    public:
+        PartialRepeatAligner(const std::string& DR);
+        ~PartialRepeatAligner(void);
+
+        stringPair align(std::string& seqA, int * aStartAlign, int * aEndAlign, int aStartSearch, int aSearchLen, double similarity);
+
+    private:
+        PartialRepeatAligner(const PartialRepeatAligner&);
+        PartialRepeatAligner& operator=(const PartialRepeatAligner&);
+
+        std::string PR_DR;
+        std::vector<double> PR_Scores;                      // two rows of the smithWaterman matrix
+        std::vector<unsigned char> PR_Trace;                // the findMax index of every cell
+};
+
 #endif // __SMITH_WATERMAN_H
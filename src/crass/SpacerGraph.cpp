@@ -0,0 +1,198 @@
+/*
+ *  SpacerGraph.cpp is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+// local includes
+#include "SpacerGraph.h"
+#include "LoggerSimp.h"
+#include <libcrispr/Exception.h>
+
+//
+// Building
+//
+void SpacerGraph::addSpacer(SpacerInstance * spacer)
+{
+    spacer->setIndex(static_cast<int>(SG_Spacers.size()));
+    SG_Spacers.push_back(spacer);
+}
+
+void SpacerGraph::addEdge(SpacerInstance * spacer, SpacerInstance * partner, SI_EdgeDirection d)
+{
+    if(SG_Frozen)
+    {
+        throw crispr::runtime_exception(__FILE__,
+                                        __LINE__,
+                                        __PRETTY_FUNCTION__,
+                                        "Cannot add an edge to a frozen graph");
+    }
+    PendingEdge pending;
+    pending.spacer = static_cast<unsigned int>(spacer->getIndex());
+    pending.partner = static_cast<unsigned int>(partner->getIndex());
+    pending.d = d;
+    SG_Pending.push_back(pending);
+}
+
+void SpacerGraph::freeze(void)
+{
+    //-----
+    // a counting sort on the spacer keeps the edges of each spacer in order
+    //
+    if(SG_Frozen)
+        return;
+
+    size_t num_spacers = SG_Spacers.size();
+    SG_Ranks.assign(num_spacers, 0);
+    SG_EdgeStart.assign(num_spacers + 1, 0);
+    SG_EdgeTarget.resize(SG_Pending.size());
+    SG_EdgeFlags.resize(SG_Pending.size());
+
+    std::vector<PendingEdge>::iterator pe_iter;
+    for(pe_iter = SG_Pending.begin(); pe_iter != SG_Pending.end(); pe_iter++)
+    {
+        SG_Ranks[pe_iter->spacer]++;
+    }
+    for(size_t i = 0; i < num_spacers; i++)
+    {
+        SG_EdgeStart[i + 1] = SG_EdgeStart[i] + static_cast<unsigned int>(SG_Ranks[i]);
+    }
+
+    std::vector<unsigned int> next_edge(SG_EdgeStart.begin(), SG_EdgeStart.end() - 1);
+    for(pe_iter = SG_Pending.begin(); pe_iter != SG_Pending.end(); pe_iter++)
+    {
+        unsigned int edge = next_edge[pe_iter->spacer]++;
+        SG_EdgeTarget[edge] = pe_iter->partner;
+        SG_EdgeFlags[edge] = (FORWARD == pe_iter->d) ? (SG_EDGE_LIVE | SG_EDGE_FORWARD) : SG_EDGE_LIVE;
+    }
+    std::vector<PendingEdge>().swap(SG_Pending);
+    SG_Frozen = true;
+}
+
+//
+// Spacers
+//
+bool SpacerGraph::isFur(SpacerInstance * spacer)
+{
+    //-----
+    // Check to see if the spacer is a cap joined onto a non-cap
+    //
+    int index = spacer->getIndex();
+    if(1 != getRank(index))
+        return false;
+
+    for(unsigned int edge = edgeBegin(index); edge < edgeEnd(index); edge++)
+    {
+        if(isLive(edge) && getRank(SG_EdgeTarget[edge]) > 2)
+            return true;
+    }
+    return false;
+}
+
+bool SpacerGraph::isViable(SpacerInstance * spacer)
+{
+    //-----
+    // Check to see if the spacer has forward AND reverse edges
+    //
+    int index = spacer->getIndex();
+
+    // zero rank spacers are viable by default
+    if(getRank(index) < 2)
+        return true;
+
+    bool has_forward = false;
+    bool has_reverse = false;
+    for(unsigned int edge = edgeBegin(index); edge < edgeEnd(index); edge++)
+    {
+        if(!isLive(edge))
+            continue;
+        if(REVERSE == edgeDirection(edge))
+            has_reverse = true;
+        else
+            has_forward = true;
+        if(has_reverse && has_forward)
+            return true;
+    }
+    return false;
+}
+
+bool SpacerGraph::hasEdge(SpacerInstance * spacer, SpacerInstance * partner)
+{
+    int index = spacer->getIndex();
+    unsigned int partner_index = static_cast<unsigned int>(partner->getIndex());
+    for(unsigned int edge = edgeBegin(index); edge < edgeEnd(index); edge++)
+    {
+        if(isLive(edge) && SG_EdgeTarget[edge] == partner_index)
+            return true;
+    }
+    return false;
+}
+
+void SpacerGraph::detachFromSpacerGraph(SpacerInstance * spacer)
+{
+    //-----
+    // remove this spacer from the graph
+    //
+    int index = spacer->getIndex();
+    if(0 == getRank(index))
+        return;
+    for(unsigned int edge = edgeBegin(index); edge < edgeEnd(index); edge++)
+    {
+        if(!isLive(edge))
+            continue;
+
+        // delete the return edge
+        if(!detachSpecificSpacer(SG_EdgeTarget[edge], index))
+            return;
+
+        SG_EdgeFlags[edge] &= ~SG_EDGE_LIVE;
+        SG_Ranks[index]--;
+    }
+}
+
+bool SpacerGraph::detachSpecificSpacer(int index, int target)
+{
+    if(0 == getRank(index))
+    {
+        logError("Trying to remove edge from zero rank spacer");
+        return false;
+    }
+    for(unsigned int edge = edgeBegin(index); edge < edgeEnd(index); edge++)
+    {
+        if(isLive(edge) && SG_EdgeTarget[edge] == static_cast<unsigned int>(target))
+        {
+            SG_EdgeFlags[edge] &= ~SG_EDGE_LIVE;
+            SG_Ranks[index]--;
+            return true;
+        }
+    }
+    logError("Could not find target: " << SG_Spacers[target]->getID());
+    return false;
+}
@@ -0,0 +1,130 @@
+/*
+ *  SpacerGraph.h is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  The edges between the SpacerInstances of a NodeManager, made once
+ *  the CrisprNode graph has been cleaned and then frozen into compressed
+ *  sparse rows. The edges of a spacer keep the order they were added in.
+ *  Removing an edge clears its bit, the rank of every spacer is the
+ *  number of edges it has left.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+#ifndef crass_SpacerGraph_h
+#define crass_SpacerGraph_h
+
+// system includes
+#include <vector>
+
+// local includes
+#include "SpacerInstance.h"
+
+class SpacerGraph
+{
+    public:
+        SpacerGraph(void) : SG_Frozen(false) {}
+        ~SpacerGraph(void) {}
+
+        //----
+        // Building
+        //
+        // give the spacer the next index
+        void addSpacer(SpacerInstance * spacer);
+
+        // edges are one way, add the edge back as well
+        void addEdge(SpacerInstance * spacer, SpacerInstance * partner, SI_EdgeDirection d);
+
+        // make the edge arrays, no edges can be added after this
+        void freeze(void);
+
+        //----
+        // Spacers
+        //
+        inline int getRank(int index) { return SG_Ranks[index]; }
+        inline int getRank(SpacerInstance * spacer) { return SG_Ranks[spacer->getIndex()]; }
+
+        // a cap joined onto a non-cap
+        bool isFur(SpacerInstance * spacer);
+
+        // has forward AND reverse edges, or less than two edges
+        bool isViable(SpacerInstance * spacer);
+
+        // true if there is an edge from the spacer to the partner
+        bool hasEdge(SpacerInstance * spacer, SpacerInstance * partner);
+
+        // remove all the edges of this spacer
+        void detachFromSpacerGraph(SpacerInstance * spacer);
+
+        //----
+        // Edges, walk them with
+        // for (unsigned int edge = edgeBegin(i); edge < edgeEnd(i); edge++) if (isLive(edge))
+        //
+        inline unsigned int edgeBegin(int index) { return SG_EdgeStart[index]; }
+        inline unsigned int edgeBegin(SpacerInstance * spacer) { return SG_EdgeStart[spacer->getIndex()]; }
+
+        inline unsigned int edgeEnd(int index) { return SG_EdgeStart[index + 1]; }
+        inline unsigned int edgeEnd(SpacerInstance * spacer) { return SG_EdgeStart[spacer->getIndex() + 1]; }
+
+        inline bool isLive(unsigned int edge) { return 0 != (SG_EdgeFlags[edge] & SG_EDGE_LIVE); }
+
+        inline SpacerInstance * edgeTarget(unsigned int edge) { return SG_Spacers[SG_EdgeTarget[edge]]; }
+
+        inline SI_EdgeDirection edgeDirection(unsigned int edge)
+        {
+            return (SG_EdgeFlags[edge] & SG_EDGE_FORWARD) ? FORWARD : REVERSE;
+        }
+
+    private:
+        enum {
+            SG_EDGE_LIVE = 1,
+            SG_EDGE_FORWARD = 2
+        };
+
+        typedef struct {
+            unsigned int spacer;
+            unsigned int partner;
+            SI_EdgeDirection d;
+        } PendingEdge;
+
+        SpacerGraph(const SpacerGraph&);
+        SpacerGraph& operator=(const SpacerGraph&);
+
+        // remove the first edge from the spacer to the target
+        bool detachSpecificSpacer(int index, int target);
+
+        bool SG_Frozen;
+        std::vector<PendingEdge> SG_Pending;                // edges added before freezing, in order
+
+        std::vector<SpacerInstance *> SG_Spacers;           // indexed by spacer
+        std::vector<int> SG_Ranks;                          // live edges of every spacer
+        std::vector<unsigned int> SG_EdgeStart;             // one per spacer plus one
+        std::vector<unsigned int> SG_EdgeTarget;            // index of the partner spacer
+        std::vector<unsigned char> SG_EdgeFlags;            // SG_EDGE_LIVE | SG_EDGE_FORWARD
+};
+
+#endif //crass_SpacerGraph_h
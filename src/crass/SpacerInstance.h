@@ -42,6 +42,7 @@
 // system includes
 #include <iostream>
 #include <list>
+#include <stdint.h>
 
 // local includes
 #include "crassDefines.h"
@@ -49,19 +50,14 @@
 #include "StringCheck.h"
 
 class SpacerInstance;
-// we hash together string tokens to make a unique key for each spacer
-typedef unsigned int SpacerKey;
+// we pack together string tokens to make a unique key for each spacer
+typedef uint64_t SpacerKey;
 
 enum SI_EdgeDirection {
     REVERSE = 0,
     FORWARD = 1
 };
 
-typedef struct{ 
-    SpacerInstance * edge; 
-    SI_EdgeDirection d; 
-} spacerEdgeStruct;
-
 inline std::string saySpacerEdgeDirectionLikeAHuman(SI_EdgeDirection d)
 {
 	if(d == REVERSE) { return "REVERSE"; }
@@ -77,19 +73,17 @@ typedef std::list<SpacerInstance * >::iterator SpacerInstanceList_Iterator;
 
 typedef std::pair<SpacerInstance *, SpacerInstance *> SpacerInstancePair;
 
-typedef std::vector<spacerEdgeStruct *> SpacerEdgeVector;
-typedef std::vector<spacerEdgeStruct *>::iterator SpacerEdgeVector_Iterator;
-
 inline SpacerKey makeSpacerKey(StringToken backST, StringToken frontST)
 {
     //-----
-    // make a spacer key from two string tokens
+    // make a spacer key from two string tokens, the smaller one goes in
+    // the high half so the keys sort the way the tokens do
     //
 	if(backST < frontST)
 	{
-		return (backST * 10000000) + frontST;
+		return (static_cast<SpacerKey>(static_cast<uint32_t>(backST)) << 32) | static_cast<uint32_t>(frontST);
 	}
-	return (frontST * 10000000) + backST;
+	return (static_cast<SpacerKey>(static_cast<uint32_t>(frontST)) << 32) | static_cast<uint32_t>(backST);
 }
 
 class SpacerInstance {
@@ -98,6 +92,7 @@ class SpacerInstance {
 public:
         SpacerInstance (void) {
             SI_SpacerSeqID = 0;
+            SI_Index = -1;
             SI_LeadingNode = NULL;
             SI_LastNode = NULL;
             SI_InstanceCount = 0;
@@ -108,7 +103,7 @@ public:
         
         SpacerInstance (StringToken spacerID);
         SpacerInstance (StringToken spacerID, CrisprNode * leadingNode, CrisprNode * lastNode);
-        ~SpacerInstance () {clearEdge();}
+        ~SpacerInstance () {}
         
         //
         // get / set
@@ -118,46 +113,21 @@ public:
         inline StringToken getID(void) { return SI_SpacerSeqID; }
         inline CrisprNode * getLeader(void) { return SI_LeadingNode; }
         inline CrisprNode * getLast(void) { return SI_LastNode; }
-        inline bool isAttached(void) 
-        { 
-            if ((SI_LeadingNode->isAttached() && SI_LastNode->isAttached() ^ SI_Attached))
-            {
-                std::cout<<"Spacer "<<SI_SpacerSeqID<<" has asynchronous attached state"<<std::endl;  
-            }
-            return SI_Attached;
-        }
+        inline bool isAttached(void) { return SI_Attached; }
         inline void setAttached(bool attached) { SI_Attached = attached; }
         inline bool isFlanker(void){return SI_isFlanker;}
         inline void setFlanker(bool f){SI_isFlanker = f;}
-        inline int isCap(void) {return (getSpacerRank() == 1);}
         //
         // contig functions
         //
         inline int getContigID(void) { return SI_ContigID; }
         inline void setContigID(int CID) { SI_ContigID = CID; }
-        inline int getSpacerRank(void) { return (int)SI_SpacerEdges.size(); }
-
-        //
-        // graph functions
-        //
-        bool isViable(void);
-        bool isFur(void);
-        void detachFromSpacerGraph(void);
-        bool detachSpecificSpacer(SpacerInstance * target);
 
         //
-        // edge functions/iterators
+        // Edges and ranks live in the SpacerGraph
         //
-        inline void addEdge(spacerEdgeStruct * s) { SI_SpacerEdges.push_back(s); }
-        void clearEdge(void);
-        
-    SpacerEdgeVector_Iterator begin(void) {return SI_SpacerEdges.begin();}
-    
-    SpacerEdgeVector_Iterator end(void) {return SI_SpacerEdges.end();}
-    
-    SpacerEdgeVector_Iterator find(SpacerInstance *);
-    
-    inline SpacerEdgeVector * getEdges(void) {return &SI_SpacerEdges;}
+        inline int getIndex(void) { return SI_Index; }
+        inline void setIndex(int index) { SI_Index = index; }
         
         //
         // File /IO
@@ -166,12 +136,12 @@ public:
         
     private:
         StringToken SI_SpacerSeqID;               // the StringToken of this spacer
+        int SI_Index;                             // where this spacer is in the spacer graph
         CrisprNode * SI_LeadingNode;              // the first node of this spacer
         CrisprNode * SI_LastNode;                 // the last node
         unsigned int SI_InstanceCount;            // the number of times this exact instance has been seen
         bool SI_Attached;							  // is this spacer attached?
         int SI_ContigID;							  // contig ID
-        SpacerEdgeVector SI_SpacerEdges;              // Pointers to the spacers that come off this spacer
         bool SI_isFlanker;                          // set if this spacer instance is considered a flanker or not
 };
 
@@ -0,0 +1,146 @@
+/*
+ *  SpacerTable.h is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  The SpacerInstances of a NodeManager by SpacerKey. The spacers sit in
+ *  a vector of (key, spacer) pairs and an open addressing index, linear
+ *  probing in a power of two table that is never more than half full,
+ *  points into it. The pairs are in the order they were added until
+ *  sortByKey() is called, after that they are walked in key order.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+#ifndef crass_SpacerTable_h
+#define crass_SpacerTable_h
+
+// system includes
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// local includes
+#include "SpacerInstance.h"
+
+class SpacerTable
+{
+    public:
+        typedef std::pair<SpacerKey, SpacerInstance *> Entry;
+        typedef std::vector<Entry>::iterator iterator;
+
+        SpacerTable(void) : 
+            ST_Index(16, -1),
+            ST_Shift(60)
+        {}
+
+        // NULL if the key isn't in the table
+        inline SpacerInstance * find(SpacerKey key) const
+        {
+            int entry = ST_Index[findSlot(key)];
+            return (-1 == entry) ? NULL : ST_Entries[entry].second;
+        }
+
+        //-----
+        // The spacer for the key, NULL if the key is new. The reference
+        // is only good until the next new key is added
+        //
+        inline SpacerInstance *& operator[](SpacerKey key)
+        {
+            size_t slot = findSlot(key);
+            if (-1 == ST_Index[slot])
+            {
+                if (2 * (ST_Entries.size() + 1) > ST_Index.size())
+                {
+                    grow();
+                    slot = findSlot(key);
+                }
+                ST_Index[slot] = static_cast<int>(ST_Entries.size());
+                ST_Entries.push_back(Entry(key, static_cast<SpacerInstance *>(NULL)));
+            }
+            return ST_Entries[ST_Index[slot]].second;
+        }
+
+        // walk the table in key order from here on
+        void sortByKey(void)
+        {
+            std::sort(ST_Entries.begin(), ST_Entries.end(), entryLess);
+            rebuildIndex();
+        }
+
+        void clear(void)
+        {
+            std::vector<Entry>().swap(ST_Entries);
+            ST_Index.assign(16, -1);
+            ST_Shift = 60;
+        }
+
+        inline size_t size(void) const { return ST_Entries.size(); }
+
+        inline iterator begin(void) { return ST_Entries.begin(); }
+
+        inline iterator end(void) { return ST_Entries.end(); }
+
+    private:
+        SpacerTable(const SpacerTable&);
+        SpacerTable& operator=(const SpacerTable&);
+
+        static bool entryLess(const Entry& a, const Entry& b) { return a.first < b.first; }
+
+        inline size_t findSlot(SpacerKey key) const
+        {
+            size_t mask = ST_Index.size() - 1;
+            size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> ST_Shift);
+            while (-1 != ST_Index[slot] && ST_Entries[ST_Index[slot]].first != key)
+            {
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        }
+
+        void rebuildIndex(void)
+        {
+            ST_Index.assign(ST_Index.size(), -1);
+            for (size_t i = 0; i < ST_Entries.size(); i++)
+            {
+                ST_Index[findSlot(ST_Entries[i].first)] = static_cast<int>(i);
+            }
+        }
+
+        void grow(void)
+        {
+            ST_Index.resize(ST_Index.size() * 2);
+            ST_Shift--;
+            rebuildIndex();
+        }
+
+        std::vector<Entry> ST_Entries;                      // (key, spacer) pairs
+        std::vector<int> ST_Index;                          // index into ST_Entries, -1 for an empty slot
+        unsigned int ST_Shift;                              // 64 - log2(table size)
+};
+
+#endif //crass_SpacerTable_h
@@ -42,40 +42,226 @@
 #include "StringCheck.h"
 #include <libcrispr/Exception.h>
 
+StringCheck::StringCheck(std::string name)
+{
+    init();
+    mName = name;
+}
+
+StringCheck::StringCheck(void)
+{
+    init();
+    mName = "unset";
+}
+
+StringCheck::~StringCheck(void)
+{
+    for(size_t i = 0; i < mBlocks.size(); i++)
+    {
+        delete [] mBlocks[i];
+    }
+}
+
+void StringCheck::init(void)
+{
+    //-----
+    // tokens start at 2, the first two slots are never used
+    //
+    mNextFreeToken = 1;
+    mBlockUsed = 0;
+    mBlockSize = 0;
+    mStrings.assign(2, (const char *)NULL);
+    mIndex.assign(16, 0);
+    mIndexUsed = 0;
+}
+
+uint64_t StringCheck::hashString(const char * str, uint32_t length)
+{
+    //-----
+    // FNV-1a
+    //
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(uint32_t i = 0; i < length; i++)
+    {
+        hash ^= static_cast<unsigned char>(str[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+size_t StringCheck::findSlot(const char * str, uint32_t length, uint64_t hash) const
+{
+    size_t mask = mIndex.size() - 1;
+    size_t slot = static_cast<size_t>(hash) & mask;
+    while(0 != mIndex[slot])
+    {
+        const char * stored = mStrings[mIndex[slot]];
+        if(storedLength(stored) == length && 0 == memcmp(stored, str, length))
+        {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
 
-StringToken StringCheck::addString(std::string newStr)
+const char * StringCheck::storeString(const std::string& newStr)
+{
+    //-----
+    // copy the string into the current block with its length in front and
+    // a null behind, starting a new block if it won't fit
+    //
+    size_t needed = sizeof(uint32_t) + newStr.length() + 1;
+    // keep the lengths aligned
+    needed = (needed + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+    if(mBlockUsed + needed > mBlockSize)
+    {
+        mBlockSize = (needed > CRASS_DEF_STRING_BLOCK_SIZE) ? needed : CRASS_DEF_STRING_BLOCK_SIZE;
+        mBlocks.push_back(new char[mBlockSize]);
+        mBlockUsed = 0;
+    }
+    char * record = mBlocks.back() + mBlockUsed;
+    uint32_t length = static_cast<uint32_t>(newStr.length());
+    memcpy(record, &length, sizeof(uint32_t));
+    memcpy(record + sizeof(uint32_t), newStr.data(), length);
+    record[sizeof(uint32_t) + length] = '\0';
+    mBlockUsed += needed;
+    return record + sizeof(uint32_t);
+}
+
+void StringCheck::growIndex(void)
+{
+    std::vector<StringToken> old_index;
+    old_index.swap(mIndex);
+    mIndex.assign(old_index.size() * 2, 0);
+    size_t mask = mIndex.size() - 1;
+    for(size_t i = 0; i < old_index.size(); i++)
+    {
+        if(0 != old_index[i])
+        {
+            const char * stored = mStrings[old_index[i]];
+            size_t slot = static_cast<size_t>(hashString(stored, storedLength(stored))) & mask;
+            while(0 != mIndex[slot])
+            {
+                slot = (slot + 1) & mask;
+            }
+            mIndex[slot] = old_index[i];
+        }
+    }
+}
+
+StringToken StringCheck::addString(const std::string& newStr)
 {
     //-----
     // add the string and retuen it's token
     //
+    uint32_t length = static_cast<uint32_t>(newStr.length());
+    uint64_t hash = hashString(newStr.data(), length);
+    size_t slot = findSlot(newStr.data(), length, hash);
+    
     mNextFreeToken++;
-    mT2S_map[mNextFreeToken] = newStr;
-    mS2T_map[newStr] = mNextFreeToken;
+    if(0 != mIndex[slot])
+    {
+        // seen it before, share the bytes
+        mStrings.push_back(mStrings[mIndex[slot]]);
+        mIndex[slot] = mNextFreeToken;
+        return mNextFreeToken;
+    }
+    
+    mStrings.push_back(storeString(newStr));
+    mIndex[slot] = mNextFreeToken;
+    mIndexUsed++;
+    
+    // keep the index under three quarters full
+    if(4 * mIndexUsed > 3 * mIndex.size())
+    {
+        growIndex();
+    }
     return mNextFreeToken;
 }
 
-std::string StringCheck::getString(StringToken token)
+const char * StringCheck::getCString(StringToken token)
 {
     //-----
     // return the string for a given token or spew
     //
-    if(mT2S_map.find(token) != mT2S_map.end()) {
-        return mT2S_map[token];
-    } else {
+    if(token < 2 || static_cast<size_t>(token) >= mStrings.size()) {
         throw crispr::exception(__FILE__, 
                                 __LINE__, 
                                 __PRETTY_FUNCTION__,
                                 "Token not stored");
     }
+    return mStrings[token];
+}
+
+size_t StringCheck::getLength(StringToken token)
+{
+    return storedLength(getCString(token));
+}
 
+std::string StringCheck::getString(StringToken token)
+{
+    const char * stored = getCString(token);
+    return std::string(stored, storedLength(stored));
 }
 
-StringToken StringCheck::getToken(std::string queryStr)
+StringToken StringCheck::getToken(const std::string& queryStr)
 {
     //-----
     // return the token or 0
     //
-    if(mS2T_map.end() == mS2T_map.find(queryStr))
-        return 0;
-    return mS2T_map[queryStr];
+    uint32_t length = static_cast<uint32_t>(queryStr.length());
+    return mIndex[findSlot(queryStr.data(), length, hashString(queryStr.data(), length))];
+}
+
+//-----
+// ShardedStringCheck
+//
+int ShardedStringCheck::shardFor(const std::string& str)
+{
+    //-----
+    // the top bits of a cheap hash so that the shard doesn't line up with
+    // the slots inside the shard
+    //
+    uint32_t hash = 2166136261u;
+    for(size_t i = 0; i < str.length(); i++)
+    {
+        hash ^= static_cast<unsigned char>(str[i]);
+        hash *= 16777619u;
+    }
+    return static_cast<int>((hash >> 16) % CRASS_DEF_STRING_SHARDS);
+}
+
+StringToken ShardedStringCheck::addString(const std::string& newStr)
+{
+    int shard = shardFor(newStr);
+    ScopedLock lock(mLocks[shard]);
+    return mShards[shard].addString(newStr) * CRASS_DEF_STRING_SHARDS + shard;
+}
+
+std::string ShardedStringCheck::getString(StringToken token)
+{
+    int shard = token % CRASS_DEF_STRING_SHARDS;
+    ScopedLock lock(mLocks[shard]);
+    return mShards[shard].getString(token / CRASS_DEF_STRING_SHARDS);
+}
+
+StringToken ShardedStringCheck::getToken(const std::string& queryStr)
+{
+    int shard = shardFor(queryStr);
+    ScopedLock lock(mLocks[shard]);
+    StringToken token = mShards[shard].getToken(queryStr);
+    return (0 == token) ? 0 : token * CRASS_DEF_STRING_SHARDS + shard;
+}
+
+StringToken ShardedStringCheck::getOrAddToken(const std::string& str)
+{
+    int shard = shardFor(str);
+    ScopedLock lock(mLocks[shard]);
+    StringToken token = mShards[shard].getToken(str);
+    if(0 == token)
+    {
+        token = mShards[shard].addString(str);
+    }
+    return token * CRASS_DEF_STRING_SHARDS + shard;
 }
@@ -43,31 +43,109 @@
 
 // system includes
 #include <iostream>
-#include <map>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdint.h>
 
+// local includes
+#include "crassDefines.h"
+#include "ThreadPool.h"
 
 // typedefs
 typedef int StringToken;
 
+//-----
+// Strings are copied once into big blocks that never move and are looked
+// up through an open addressing hash of tokens. Each string costs its
+// bytes, a length, a terminating null, a pointer and a hash slot.
+// Adding a string that is already stored gives a new token for the same
+// bytes and getToken returns the newest one
+//
 class StringCheck 
 {
     public:
-		StringCheck(std::string name) { mNextFreeToken = 1; mName = name;}  
-		StringCheck(void) { mNextFreeToken = 1; mName = "unset";}  
-        ~StringCheck(void) {}  
+		StringCheck(std::string name);
+		StringCheck(void);
+        ~StringCheck(void);
         
-        StringToken addString(std::string newStr);
+        StringToken addString(const std::string& newStr);
         std::string getString(StringToken token);
-        StringToken getToken(std::string queryStr);
+        StringToken getToken(const std::string& queryStr);
+        
+        // the stored string, good for as long as this StringCheck is
+        const char * getCString(StringToken token);
+        size_t getLength(StringToken token);
+        
+        inline size_t size(void) const { return mStrings.size() - 2; }
         
         inline void setName(std::string name) { mName = name; }
 
+    private:
+        StringCheck(const StringCheck&);
+        StringCheck& operator=(const StringCheck&);
+        
+        void init(void);
+        
+        // where a string is stored, or where it should go
+        size_t findSlot(const char * str, uint32_t length, uint64_t hash) const;
+        
+        const char * storeString(const std::string& newStr);
+        
+        void growIndex(void);
+        
+        inline uint32_t storedLength(const char * stored) const 
+        { 
+            uint32_t length;
+            memcpy(&length, stored - sizeof(uint32_t), sizeof(uint32_t));
+            return length;
+        }
+        
+        static uint64_t hashString(const char * str, uint32_t length);
+        
+    public:
         // members
         StringToken mNextFreeToken;                            // der
-        std::map<StringToken, std::string> mT2S_map;           // token to string map
-        std::map<std::string, StringToken> mS2T_map;           // string to token map
-        
         std::string mName;
+        
+    private:
+        std::vector<char *> mBlocks;                           // string storage
+        size_t mBlockUsed;                                     // bytes used in the last block
+        size_t mBlockSize;                                     // size of the last block
+        std::vector<const char *> mStrings;                    // token to string, each is preceded by its length
+        std::vector<StringToken> mIndex;                       // hash of string to token, 0 is empty
+        size_t mIndexUsed;                                     // number of different strings
+};
+
+//-----
+// A StringCheck that many threads can add to at once. Strings are spread
+// over shards by their hash and each shard has its own lock. The shard is
+// kept in the low bits of the token so tokens are still unique and never 0.
+// Tokens depend on which thread gets to a string first, so it is only for
+// places where the numbering doesn't matter; the search merge stays on a
+// StringCheck so that groups are numbered the same on any number of threads
+//
+class ShardedStringCheck
+{
+    public:
+        ShardedStringCheck(void) {}
+        ~ShardedStringCheck(void) {}
+        
+        StringToken addString(const std::string& newStr);
+        std::string getString(StringToken token);
+        StringToken getToken(const std::string& queryStr);
+        
+        // the token for the string, adding it if it isn't there already
+        StringToken getOrAddToken(const std::string& str);
+        
+    private:
+        ShardedStringCheck(const ShardedStringCheck&);
+        ShardedStringCheck& operator=(const ShardedStringCheck&);
+        
+        static int shardFor(const std::string& str);
+        
+        StringCheck mShards[CRASS_DEF_STRING_SHARDS];
+        Mutex mLocks[CRASS_DEF_STRING_SHARDS];
 };
 
 #endif //StringCheck_h
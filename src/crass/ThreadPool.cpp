@@ -0,0 +1,149 @@
+/*
+ *  ThreadPool.cpp is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+// system includes
+#include <exception>
+#include <libcrispr/Exception.h>
+
+// local includes
+#include "ThreadPool.h"
+
+static void * threadPoolTrampoline(void * arg)
+{
+    std::pair<ThreadPool *, int> * pool_arg = static_cast<std::pair<ThreadPool *, int> *>(arg);
+    pool_arg->first->runThread(pool_arg->second);
+    return NULL;
+}
+
+ThreadPool::ThreadPool(int numThreads) :
+    TP_NumThreads((numThreads < 1) ? 1 : numThreads),
+    TP_Task(NULL),
+    TP_Running(false),
+    TP_Failed(false)
+{}
+
+ThreadPool::~ThreadPool(void)
+{
+    //-----
+    // never leave threads dangling, errors are dropped at this point
+    //
+    if (TP_Running)
+    {
+        for (size_t i = 0; i < TP_Threads.size(); i++)
+        {
+            pthread_join(TP_Threads[i], NULL);
+        }
+    }
+}
+
+void ThreadPool::start(ThreadTask * task)
+{
+    if (TP_Running)
+    {
+        throw crispr::exception(__FILE__,
+                                __LINE__,
+                                __PRETTY_FUNCTION__,
+                                "Thread pool is already running");
+    }
+    TP_Task = task;
+    TP_Failed = false;
+    TP_Error.clear();
+    TP_Threads.resize(TP_NumThreads);
+    TP_Args.clear();
+    for (int i = 0; i < TP_NumThreads; i++)
+    {
+        TP_Args.push_back(std::make_pair(this, i));
+    }
+    TP_Running = true;
+    for (int i = 0; i < TP_NumThreads; i++)
+    {
+        if (0 != pthread_create(&(TP_Threads[i]), NULL, threadPoolTrampoline, &(TP_Args[i])))
+        {
+            // wait for the ones we did manage to start
+            for (int j = 0; j < i; j++)
+            {
+                pthread_join(TP_Threads[j], NULL);
+            }
+            TP_Running = false;
+            throw crispr::exception(__FILE__,
+                                    __LINE__,
+                                    __PRETTY_FUNCTION__,
+                                    "Could not create a new thread");
+        }
+    }
+}
+
+void ThreadPool::join(void)
+{
+    if (!TP_Running)
+    {
+        return;
+    }
+    for (size_t i = 0; i < TP_Threads.size(); i++)
+    {
+        pthread_join(TP_Threads[i], NULL);
+    }
+    TP_Running = false;
+    TP_Task = NULL;
+    if (TP_Failed)
+    {
+        throw crispr::exception(__FILE__,
+                                __LINE__,
+                                __PRETTY_FUNCTION__,
+                                TP_Error.c_str());
+    }
+}
+
+void ThreadPool::run(ThreadTask * task)
+{
+    start(task);
+    join();
+}
+
+void ThreadPool::runThread(int threadNumber)
+{
+    //-----
+    // exceptions cannot cross the thread boundary so we catch
+    // them here and keep the first message for join()
+    //
+    try {
+        TP_Task->run(threadNumber);
+    } catch (std::exception& e) {
+        ScopedLock lock(TP_ErrorMutex);
+        if (!TP_Failed)
+        {
+            TP_Failed = true;
+            TP_Error = e.what();
+        }
+    }
+}
@@ -0,0 +1,218 @@
+/*
+ *  ThreadPool.h is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Thin wrappers around pthreads. A ThreadPool starts a fixed number
+ *  of threads that all run the same ThreadTask and collects any exception
+ *  thrown on them so that it can be re-thrown on the calling thread.
+ *  WorkQueue is a bounded, closable FIFO for producer/consumer setups.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+#ifndef crass_ThreadPool_h
+#define crass_ThreadPool_h
+
+// system includes
+#include <pthread.h>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Condition;
+
+class Mutex
+{
+    public:
+        Mutex(void) { pthread_mutex_init(&mMutex, NULL); }
+        ~Mutex(void) { pthread_mutex_destroy(&mMutex); }
+
+        inline void lock(void) { pthread_mutex_lock(&mMutex); }
+        inline void unlock(void) { pthread_mutex_unlock(&mMutex); }
+
+    private:
+        friend class Condition;
+
+        // not copyable
+        Mutex(const Mutex&);
+        Mutex& operator=(const Mutex&);
+
+        pthread_mutex_t mMutex;
+};
+
+class ScopedLock
+{
+    public:
+        ScopedLock(Mutex& mutex) : mMutex(mutex) { mMutex.lock(); }
+        ~ScopedLock(void) { mMutex.unlock(); }
+
+    private:
+        ScopedLock(const ScopedLock&);
+        ScopedLock& operator=(const ScopedLock&);
+
+        Mutex& mMutex;
+};
+
+class Condition
+{
+    public:
+        Condition(void) { pthread_cond_init(&mCondition, NULL); }
+        ~Condition(void) { pthread_cond_destroy(&mCondition); }
+
+        // the mutex must be held by the caller
+        inline void wait(Mutex& mutex) { pthread_cond_wait(&mCondition, &(mutex.mMutex)); }
+        inline void signal(void) { pthread_cond_signal(&mCondition); }
+        inline void broadcast(void) { pthread_cond_broadcast(&mCondition); }
+
+    private:
+        Condition(const Condition&);
+        Condition& operator=(const Condition&);
+
+        pthread_cond_t mCondition;
+};
+
+template <class T>
+class WorkQueue
+{
+    public:
+        WorkQueue(size_t capacity) : WQ_Capacity(capacity), WQ_Closed(false) {}
+
+        // blocks while the queue is full, returns false if the queue was closed
+        bool push(const T& item)
+        {
+            ScopedLock lock(WQ_Mutex);
+            while (WQ_Items.size() >= WQ_Capacity && !WQ_Closed)
+            {
+                WQ_NotFull.wait(WQ_Mutex);
+            }
+            if (WQ_Closed)
+            {
+                return false;
+            }
+            WQ_Items.push_back(item);
+            WQ_NotEmpty.signal();
+            return true;
+        }
+
+        // blocks while the queue is empty, returns false once the queue
+        // has been closed and there is nothing left in it
+        bool pop(T& item)
+        {
+            ScopedLock lock(WQ_Mutex);
+            while (WQ_Items.empty() && !WQ_Closed)
+            {
+                WQ_NotEmpty.wait(WQ_Mutex);
+            }
+            if (WQ_Items.empty())
+            {
+                return false;
+            }
+            item = WQ_Items.front();
+            WQ_Items.pop_front();
+            WQ_NotFull.signal();
+            return true;
+        }
+
+        // no more pushes, consumers drain what is left
+        void close(void)
+        {
+            ScopedLock lock(WQ_Mutex);
+            WQ_Closed = true;
+            WQ_NotEmpty.broadcast();
+            WQ_NotFull.broadcast();
+        }
+
+        // close the queue and hand back anything still in it
+        void abort(std::vector<T>& leftOvers)
+        {
+            ScopedLock lock(WQ_Mutex);
+            WQ_Closed = true;
+            leftOvers.insert(leftOvers.end(), WQ_Items.begin(), WQ_Items.end());
+            WQ_Items.clear();
+            WQ_NotEmpty.broadcast();
+            WQ_NotFull.broadcast();
+        }
+
+    private:
+        WorkQueue(const WorkQueue&);
+        WorkQueue& operator=(const WorkQueue&);
+
+        std::deque<T> WQ_Items;
+        size_t WQ_Capacity;
+        bool WQ_Closed;
+        Mutex WQ_Mutex;
+        Condition WQ_NotEmpty;
+        Condition WQ_NotFull;
+};
+
+// work that can be handed to a ThreadPool
+class ThreadTask
+{
+    public:
+        virtual ~ThreadTask(void) {}
+
+        // threadNumber is in the range [0, poolSize)
+        virtual void run(int threadNumber) = 0;
+};
+
+class ThreadPool
+{
+    public:
+        ThreadPool(int numThreads);
+        ~ThreadPool(void);
+
+        // launch every thread in the pool on the task
+        void start(ThreadTask * task);
+
+        // wait for all threads to finish. If any of them threw then
+        // a crispr::exception is thrown here with the first message
+        void join(void);
+
+        // start and join in one go
+        void run(ThreadTask * task);
+
+        inline int size(void) { return TP_NumThreads; }
+
+        // called from the thread trampoline
+        void runThread(int threadNumber);
+
+    private:
+        ThreadPool(const ThreadPool&);
+        ThreadPool& operator=(const ThreadPool&);
+
+        int TP_NumThreads;
+        ThreadTask * TP_Task;
+        std::vector<pthread_t> TP_Threads;
+        std::vector<std::pair<ThreadPool *, int> > TP_Args;
+        bool TP_Running;
+        Mutex TP_ErrorMutex;
+        std::string TP_Error;
+        bool TP_Failed;
+};
+
+#endif //crass_ThreadPool_h
@@ -0,0 +1,113 @@
+/*
+ *  TokenTable.h is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  A map from a small non-negative int, a StringToken or a group ID, to
+ *  a VALUE. Both kinds of key are handed out one after the other from a
+ *  low number so the values sit in a table indexed by the key. The table
+ *  is a deque; it grows without moving the values already in it, so
+ *  references and iterators into a value stay good while other keys are
+ *  added. VALUE needs a swap() to hand back its memory when erased.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+#ifndef crass_TokenTable_h
+#define crass_TokenTable_h
+
+// system includes
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+template <class VALUE>
+class TokenTable
+{
+    public:
+        TokenTable(void) : TT_Size(0) {}
+
+        // true if the key has a value
+        inline bool contains(int key) const
+        {
+            return key >= 0 && key < end() && TT_Present[key];
+        }
+
+        // the value for the key, a new VALUE() if it wasn't there
+        inline VALUE& operator[](int key)
+        {
+            if (key >= end())
+            {
+                TT_Values.resize(key + 1);
+                TT_Present.resize(key + 1, false);
+            }
+            if (!TT_Present[key])
+            {
+                TT_Present[key] = true;
+                TT_Size++;
+            }
+            return TT_Values[key];
+        }
+
+        // the value for a key the table contains
+        inline const VALUE& at(int key) const { return TT_Values[key]; }
+
+        void erase(int key)
+        {
+            if (contains(key))
+            {
+                VALUE().swap(TT_Values[key]);
+                TT_Present[key] = false;
+                TT_Size--;
+            }
+        }
+
+        void clear(void)
+        {
+            std::deque<VALUE>().swap(TT_Values);
+            std::vector<bool>().swap(TT_Present);
+            TT_Size = 0;
+        }
+
+        // number of keys with a value
+        inline size_t size(void) const { return TT_Size; }
+
+        inline bool empty(void) const { return 0 == TT_Size; }
+
+        // one past the largest key there has been, walk the table with
+        // for (int key = 0; key < table.end(); key++) if (table.contains(key))
+        inline int end(void) const { return static_cast<int>(TT_Present.size()); }
+
+    private:
+        TokenTable(const TokenTable&);
+        TokenTable& operator=(const TokenTable&);
+
+        std::deque<VALUE> TT_Values;                        // indexed by key
+        std::vector<bool> TT_Present;
+        size_t TT_Size;
+};
+
+#endif //crass_TokenTable_h
@@ -38,7 +38,10 @@
 #include <vector>
 #include <string>
 #include "ReadHolder.h"
+#include "ReadMap.h"
 #include "StringCheck.h"
+#include "PackedKmer.h"
+#include "TokenTable.h"
 
 
 // forward declaration of readholder class
@@ -48,23 +51,17 @@
 // Types cut from libcrispr.h
 typedef std::map<std::string, bool> lookupTable;
 
-typedef std::vector<ReadHolder *> ReadList;
-typedef std::vector<ReadHolder *>::iterator ReadListIterator;
-
-// direct repeat as a string and a list of the read objects that contain that direct repeat
-typedef std::map<StringToken, ReadList *> ReadMap;
-typedef std::map<StringToken, ReadList *>::iterator ReadMapIterator;
-
 // Types from WorkHorse.h
 // for storing clusters of DRs
 // indexed using StringCheck type tokens
 typedef std::vector<StringToken> DR_Cluster; 
 typedef std::vector<StringToken>::iterator DR_ClusterIterator;
 
-typedef std::map<int, DR_Cluster *>::iterator DR_Cluster_MapIterator;
-typedef std::map<int, DR_Cluster *> DR_Cluster_Map;
+// the DRs of each group, indexed by group ID
+typedef TokenTable<DR_Cluster> DR_Cluster_Map;
 
-typedef std::map<int, std::map<std::string, int> * > GroupKmerMap;
+// laurenized kmer counts for each group
+typedef TokenTable<KmerHashMap<int> > GroupKmerMap;
 
 typedef std::vector<std::string> Vecstr;
 
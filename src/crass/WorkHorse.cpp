@@ -56,11 +56,16 @@
 #include "libcrispr.h"
 #include "LoggerSimp.h"
 #include "crassDefines.h"
+#include "ContainmentAutomaton.h"
+#include "DRClusterer.h"
 #include "NodeManager.h"
 #include "ReadHolder.h"
+#include "ReadCache.h"
+#include "ReadOrdinalSet.h"
 #include "SeqUtils.h"
 #include "SmithWaterman.h"
 #include "StringCheck.h"
+#include "ThreadPool.h"
 #include "config.h"
 #include "ksw.h"
 
@@ -109,71 +114,12 @@ WorkHorse::~WorkHorse()
     }
     mDRs.clear();
     
-    // check to see none of these are floating around
-    DR_Cluster_MapIterator drg_iter = mDR2GIDMap.begin();
-	while(drg_iter != mDR2GIDMap.end())
-	{
-		if(drg_iter->second != NULL)
-		{
-			delete drg_iter->second; 
-		}
-		drg_iter++;
-	}
-    
-    // clear the reads!
-    clearReadMap( &mReads);
-}
-
-void WorkHorse::clearReadList(ReadList * tmp_list)
-{
-    //-----
-    // clear all the reads from the readlist
-    //
-    ReadListIterator read_iter = tmp_list->begin();
-    while(read_iter != tmp_list->end())
-    {
-        if(*read_iter != NULL)
-        {
-            delete *read_iter;
-            *read_iter = NULL;
-        }
-        read_iter++;
-    }
-    tmp_list->clear();
-}
-
-void WorkHorse::clearReadMap(ReadMap * tmp_map)
-{
-    //-----
-    // clear all the reads from the readlist
-    //
-    ReadMapIterator read_iter = tmp_map->begin();
-    while(read_iter != tmp_map->end())
-    {
-        if (read_iter->second != NULL)
-        {
-            clearReadList(read_iter->second);
-            delete read_iter->second;
-            read_iter->second = NULL;
-        }
-        read_iter++;
-    }
-    tmp_map->clear();
+    // mReads deletes the reads when it goes
 }
 
 int WorkHorse::numOfReads(void)
 {
-    int count = 0;
-    ReadMapIterator read_iter = mReads.begin();
-    while(read_iter != mReads.end())
-    {
-        if (read_iter->second != NULL)
-        {
-            count += (int)(read_iter->second)->size();
-        }
-        read_iter++;
-    }
-    return count;
+    return (int)mReads.numberOfReads();
 }
 
 // do all the work!
@@ -328,8 +274,22 @@ int WorkHorse::parseSeqFiles(Vecstr seqFiles)
     // direct repeat sequence and unique ID
     lookupTable patterns_lookup;
     
-    // the sequence of whole spacers and their unique ID
-    lookupTable reads_found;
+    // the reads found in the first pass, by file and position in the file
+    ReadOrdinalSet reads_found;
+
+    // reads that weren't found in the first pass, so the singleton
+    // finder doesn't have to go back to the files
+    ReadCache * read_cache = NULL;
+    if (mOpts->readCacheSize > 0)
+    {
+#ifdef OUTPUT_READS_FASTQ
+        bool keep_qualities = true;
+#else
+        // qualities are never output
+        bool keep_qualities = false;
+#endif
+        read_cache = new ReadCache(static_cast<size_t>(mOpts->readCacheSize) * 1024 * 1024, keep_qualities);
+    }
 
     time_t start_time;
     time(&start_time);
@@ -338,11 +298,14 @@ int WorkHorse::parseSeqFiles(Vecstr seqFiles)
         logInfo("Parsing file: " << *seq_iter, 1);
         try {
             int max_len = decideWhichSearch(seq_iter->c_str(), 
+                                            static_cast<unsigned int>(seq_iter - seqFiles.begin()),
                                             *mOpts, 
                                             &mReads, 
                                             &mStringCheck, 
+                                            &mReadStore, 
                                             patterns_lookup, 
                                             reads_found,
+                                            read_cache,
                                             start_time);
             
             mMaxReadLength = (max_len > mMaxReadLength) ? max_len : mMaxReadLength;
@@ -350,6 +313,7 @@ int WorkHorse::parseSeqFiles(Vecstr seqFiles)
 
         } catch (crispr::exception& e) {
             std::cerr<<e.what()<<std::endl;
+            if (NULL != read_cache) delete read_cache;
             return 1;
         }
         
@@ -378,25 +342,46 @@ int WorkHorse::parseSeqFiles(Vecstr seqFiles)
 
 
         time(&start_time);
-        while (seq_iter != seqFiles.end()) {
-            
-            logInfo("Parsing file: " << *seq_iter, 1);
-            
+        if (NULL != read_cache && read_cache->isValid())
+        {
+            logInfo("Searching " << read_cache->size() << " cached reads (" << read_cache->memoryUsage() << " bytes)", 1);
             try {
-                findSingletons(seq_iter->c_str(), *mOpts, non_redundant_set, reads_found, &mReads, &mStringCheck, start_time);
+                findSingletons(NULL, 0, read_cache, *mOpts, non_redundant_set, reads_found, &mReads, &mStringCheck, &mReadStore, start_time);
             } catch (crispr::exception& e) {
                 std::cerr<<e.what()<<std::endl;
                 delete non_redundant_set;
+                delete read_cache;
                 return 1;
             }
-            seq_iter++;
         }
+        else
+        {
+            while (seq_iter != seqFiles.end()) {
+                
+                logInfo("Parsing file: " << *seq_iter, 1);
+                
+                try {
+                    findSingletons(seq_iter->c_str(), static_cast<unsigned int>(seq_iter - seqFiles.begin()), NULL, *mOpts, non_redundant_set, reads_found, &mReads, &mStringCheck, &mReadStore, start_time);
+                } catch (crispr::exception& e) {
+                    std::cerr<<e.what()<<std::endl;
+                    delete non_redundant_set;
+                    if (NULL != read_cache) delete read_cache;
+                    return 1;
+                }
+                seq_iter++;
+            }
+        }
+    }
+    if (NULL != read_cache)
+    {
+        delete read_cache;
     }
     // add in a new line so the ouptut won't overlap itself
     std::cout<<std::endl;
     delete non_redundant_set;
     std::cout<<"["<<PACKAGE_NAME<<"_patternFinder]: "<<"Found "<<numOfReads()<<" reads"<<std::endl;
     logInfo("Searching complete. " << mReads.size()<<" direct repeat variants have been found", 1);
+    logInfo("The reads take up " << mReadStore.memoryUsage() << " bytes", 1);
     logInfo("Number of reads found so far: "<<this->numOfReads(), 2);
 
     if(mOpts->removeHomopolymers) {
@@ -429,124 +414,379 @@ int WorkHorse::buildGraph(void)
 	// Load the spacers into a graph
 	//
     // go through the DR2GID_map and make all reads in each group into nodes
-    
-    DR_Cluster_MapIterator drg_iter = mDR2GIDMap.begin();
     std::cout<<'['<<PACKAGE_NAME<<"_graphBuilder]: "<<mTrueDRs.size()<<" putative CRISPRs found!"<<std::endl;
-    //MI std::cout<<'['<<PACKAGE_NAME<<"_graphBuilder]: "<<std::flush;
-    while(drg_iter != mDR2GIDMap.end())
+    makeNodeManagerChains();
+    return finishChainStep(CHAIN_BUILD_GRAPH);
+}
+
+int WorkHorse::cleanGraph(void)
+{
+	//-----
+	// Wrapper for graph cleaning
+	//
+	logInfo("Cleaning graphs", 1);
+	return finishChainStep(CHAIN_CLEAN_GRAPH);
+}
+
+int WorkHorse::removeLowConfidenceNodeManagers(void)
+{
+    logInfo("Removing CRISPRs with low numbers of spacers", 1);
+    if(finishChainStep(CHAIN_CONFIDENCE))
     {
-        if(NULL != drg_iter->second)
-        {            
+        return 1;
+    }
+	int counter = 0;
+    std::vector<NodeManagerChain>::iterator chain_iter;
+    for(chain_iter = mChains.begin(); chain_iter != mChains.end(); chain_iter++)
+    {
+        counter += chain_iter->passedChecks;
+    }
+    std::vector<NodeManagerChain>().swap(mChains);
+    std::vector<std::pair<int, size_t> >().swap(mChainGroupCalls);
+    std::vector<int>().swap(mChainsByDR);
+    std::vector<int>().swap(mChainOrder);
+    std::cout<<'['<<PACKAGE_NAME<<"_graphBuilder]: "<<counter<<" putative CRISPRs have passed all checks"<<std::endl;
+	return 0;
+}
+
+//**************************************
+// the NodeManager of each true DR
+//**************************************
+//-----
+// takes the chains of NodeManagers through the steps, each thread takes
+// the next chain nobody has started on
+//
+class NodeManagerChainTask : public ThreadTask
+{
+    public:
+        NodeManagerChainTask(WorkHorse * workHorse, int firstStep, int lastStep) : 
+            mWorkHorse(workHorse), 
+            mFirstStep(firstStep), 
+            mLastStep(lastStep), 
+            mNext(0)
+        {}
+
+        void run(int)
+        {
+            int num_chains = static_cast<int>(mWorkHorse->mChainOrder.size());
+            int i;
+            while ((i = __sync_fetch_and_add(&mNext, 1)) < num_chains)
+            {
+                NodeManagerChain& chain = mWorkHorse->mChains[mWorkHorse->mChainOrder[i]];
+                for (int step = mFirstStep; step <= mLastStep; step++)
+                {
+                    mWorkHorse->runChainStep(chain, step);
+                }
+            }
+        }
+
+    private:
+        WorkHorse * mWorkHorse;
+        int mFirstStep;
+        int mLastStep;
+        int mNext;
+};
+
+void WorkHorse::makeNodeManagerChains(void)
+{
+    //-----
+    // groups with the same true DR share a NodeManager so they go into
+    // the same chain
+    //
+    std::map<std::string, int> chain_of_DR;
+    for(int GID = 0; GID < mDR2GIDMap.end(); GID++)
+    {
+        if(!mDR2GIDMap.contains(GID))
+        {
+            continue;
+        }
+        const std::string& true_DR = mTrueDRs[GID];
+        std::map<std::string, int>::iterator cod_iter = chain_of_DR.find(true_DR);
+        if(cod_iter == chain_of_DR.end())
+        {
+            cod_iter = chain_of_DR.insert(std::pair<std::string, int>(true_DR, static_cast<int>(mChains.size()))).first;
+            mChains.push_back(NodeManagerChain());
+            mChains.back().trueDR = true_DR;
+            mChains.back().numReads = 0;
+            mChains.back().manager = NULL;
+            mChains.back().passedChecks = 0;
+            mChains.back().failedStep = CHAIN_NUM_STEPS;
+            mChains.back().failedCall = 0;
+        }
+        NodeManagerChain& chain = mChains[cod_iter->second];
+        mChainGroupCalls.push_back(std::pair<int, size_t>(cod_iter->second, chain.GIDs.size()));
+        chain.GIDs.push_back(GID);
+
+        // make the read lists here, the threads only look them up
+        DR_ClusterIterator drc_iter;
+        for(drc_iter = mDR2GIDMap[GID].begin(); drc_iter != mDR2GIDMap[GID].end(); drc_iter++)
+        {
+            chain.numReads += mReads[*drc_iter].size();
+        }
+    }
+
+    std::map<std::string, int>::iterator cod_iter;
+    for(cod_iter = chain_of_DR.begin(); cod_iter != chain_of_DR.end(); cod_iter++)
+    {
+        mChainsByDR.push_back(cod_iter->second);
+    }
+
+    // the big ones go first so that one isn't left running on its own
+    std::vector<std::pair<size_t, int> > by_size;
+    for(int i = 0; i < static_cast<int>(mChains.size()); i++)
+    {
+        by_size.push_back(std::pair<size_t, int>(mChains[i].numReads, -i));
+    }
+    std::sort(by_size.rbegin(), by_size.rend());
+    std::vector<std::pair<size_t, int> >::iterator bs_iter;
+    for(bs_iter = by_size.begin(); bs_iter != by_size.end(); bs_iter++)
+    {
+        mChainOrder.push_back(-(bs_iter->second));
+    }
+}
+
+void WorkHorse::runChainStep(NodeManagerChain& chain, int step)
+{
+    //-----
+    // make the calls the old loop over groups or DRs made for this chain,
+    // stopping at the first one that fails
+    //
+    if(chain.failedStep < CHAIN_NUM_STEPS)
+    {
+        return;
+    }
+    size_t num_calls = 1;
+    if(CHAIN_BUILD_GRAPH == step || CHAIN_CLEAN_GRAPH == step || CHAIN_FLANKERS == step || CHAIN_CONFIDENCE == step)
+    {
+        num_calls = chain.GIDs.size();
+    }
+    for(size_t call = 0; call < num_calls; call++)
+    {
+        std::stringstream log;
+        logger->captureThread(&log);
+        bool failed;
+        try {
+            failed = runChainCall(chain, step, call);
+        } catch (crispr::exception& e) {
+            chain.error = e.what();
+            failed = true;
+        }
+        logger->captureThread(NULL);
+        chain.logs[step].push_back(log.str());
+        if(failed)
+        {
+            chain.failedStep = step;
+            chain.failedCall = call;
+            return;
+        }
+    }
+}
+
+bool WorkHorse::runChainCall(NodeManagerChain& chain, int step, size_t call)
+{
+    //-----
+    // one call of a step, true if it failed
+    //
+    int GID = chain.GIDs[call];
+    switch(step)
+    {
+        case CHAIN_BUILD_GRAPH:
+        {
 #ifdef DEBUG
-            logInfo("Creating NodeManager "<<drg_iter->first, 6);
+            logInfo("Creating NodeManager "<<GID, 6);
 #endif
-            //MI std::cout<<'['<<drg_iter->first<<','<<mTrueDRs[drg_iter->first]<<std::flush;
-            mDRs[mTrueDRs[drg_iter->first]] = new NodeManager(mTrueDRs[drg_iter->first], mOpts);
-            //MI std::cout<<'.'<<std::flush;
-            DR_ClusterIterator drc_iter = (drg_iter->second)->begin();
-            while(drc_iter != (drg_iter->second)->end())
+            NodeManager * manager = new NodeManager(chain.trueDR, mOpts);
+            DR_ClusterIterator drc_iter = mDR2GIDMap[GID].begin();
+            while(drc_iter != mDR2GIDMap[GID].end())
             {
                 // go through each read
-            	//MI std::cout<<'|'<<std::flush;
-                ReadListIterator read_iter = mReads[*drc_iter]->begin();
-                while (read_iter != mReads[*drc_iter]->end()) 
+                ReadListIterator read_iter = mReads[*drc_iter].begin();
+                while (read_iter != mReads[*drc_iter].end()) 
                 {
                     if(*read_iter == NULL) {
+                        delete manager;
                         logError("Read is set to null");
                     }
-                    //MI std::cout<<'.'<<std::flush;
-#ifdef SEARCH_SINGLETON
-                    SearchCheckerList::iterator debug_iter = debugger->find((*read_iter)->getHeader());
-                    if (debug_iter != debugger->end()) {
-                        //found one of our interesting reads
-                        // add in the true DR
-                        debug_iter->second.truedr(mTrueDRs[drg_iter->first]);
-                        debug_iter->second.gid(drg_iter->first);
-                    }
-#endif
-                    mDRs[mTrueDRs[drg_iter->first]]->addReadHolder(*read_iter);
+                    manager->addReadHolder(*read_iter);
                     read_iter++;
                 }
                 drc_iter++;
             }
-            //MI std::cout<<"],"<<std::flush;
+            manager->freezeGraph();
+
+            // only the last group with this DR keeps its NodeManager
+            delete chain.manager;
+            chain.manager = manager;
+            return false;
         }
-        drg_iter++;
+        case CHAIN_CLEAN_GRAPH:
+            return 0 != chain.manager->cleanGraph();
+        case CHAIN_MAKE_SPACER_GRAPH:
+            logInfo("Making spacer graph for DR: " << chain.trueDR, 1);
+            return 0 != chain.manager->buildSpacerGraph();
+        case CHAIN_CLEAN_SPACER_GRAPH:
+            logInfo("Cleaning spacer graph for DR: " << chain.trueDR, 1);
+            return 0 != chain.manager->cleanSpacerGraph();
+        case CHAIN_SPLIT_CONTIGS:
+            logInfo("Making spacer contigs for DR: " << chain.trueDR, 1);
+            return 0 != chain.manager->splitIntoContigs();
+        case CHAIN_FLANKERS:
+            if(NULL != chain.manager)
+            {
+                logInfo("Assigning flankers for NodeManager "<<GID, 3);
+                chain.manager->generateFlankers();
+            }
+            return false;
+        case CHAIN_CONFIDENCE:
+            if(NULL != chain.manager)
+            {
+                if(chain.manager->getSpacerCountAndStats(false) < mOpts->covCutoff) 
+                {
+                    logInfo("Deleting NodeManager "<<GID<<" as it contained less than "<<mOpts->covCutoff<<" attached spacers",5);
+                    delete chain.manager;
+                    chain.manager = NULL;
+                } else if (chain.manager->stdevSpacerLength() > CRASS_DEF_STDEV_SPACER_LENGTH) {
+                    logInfo("Deleting NodeManager "<<GID<<" as the stdev ("<<chain.manager->stdevSpacerLength()<<") of the spacer lengths was greater than "<<CRASS_DEF_STDEV_SPACER_LENGTH, 4);
+                    delete chain.manager;
+                    chain.manager = NULL;
+                }
+                chain.passedChecks++;
+            }
+            return false;
+        default:
+            return false;
     }
-    //MI std::cout<<std::endl;
-    return 0;
 }
 
-int WorkHorse::cleanGraph(void)
+int WorkHorse::finishChainStep(int step)
 {
-	//-----
-	// Wrapper for graph cleaning
-	//
-	logInfo("Cleaning graphs", 1);
-	DR_Cluster_MapIterator drg_iter = mDR2GIDMap.begin();
-	while(drg_iter != mDR2GIDMap.end())
-	{
-		if(NULL != drg_iter->second)
-		{            
+    //-----
+    // all the chains go through the steps on the first call, in debug
+    // builds only up to this step so the graphs can be drawn in between.
+    // Then write out what the step logged in the order the calls used to
+    // be made in, groups for some steps and DRs for the others, and stop
+    // where the first call failed
+    //
+    if(mChainStepsDone <= step)
+    {
 #ifdef DEBUG
-            if (NULL == mDRs[mTrueDRs[drg_iter->first]])
+        int last_step = step;
+#else
+        int last_step = CHAIN_NUM_STEPS - 1;
+#endif
+        NodeManagerChainTask chain_task(this, mChainStepsDone, last_step);
+        ThreadPool pool(mOpts->numThreads);
+        pool.run(&chain_task);
+        mChainStepsDone = last_step + 1;
+    }
+
+    // the WorkHorse owns whatever NodeManagers are left from here on
+    std::vector<NodeManagerChain>::iterator chain_iter;
+    for(chain_iter = mChains.begin(); chain_iter != mChains.end(); chain_iter++)
+    {
+        mDRs[chain_iter->trueDR] = chain_iter->manager;
+    }
+
+    std::vector<std::pair<int, size_t> > calls;
+    if(CHAIN_MAKE_SPACER_GRAPH == step || CHAIN_CLEAN_SPACER_GRAPH == step || CHAIN_SPLIT_CONTIGS == step)
+    {
+        std::vector<int>::iterator cbd_iter;
+        for(cbd_iter = mChainsByDR.begin(); cbd_iter != mChainsByDR.end(); cbd_iter++)
+        {
+            calls.push_back(std::pair<int, size_t>(*cbd_iter, 0));
+        }
+    }
+    else
+    {
+        calls = mChainGroupCalls;
+    }
+
+    std::vector<std::pair<int, size_t> >::iterator call_iter;
+    for(call_iter = calls.begin(); call_iter != calls.end(); call_iter++)
+    {
+        NodeManagerChain& chain = mChains[call_iter->first];
+        if(call_iter->second >= chain.logs[step].size())
+        {
+            continue;
+        }
+        (*(logger->mGlobalHandle)) << chain.logs[step][call_iter->second];
+        if(chain.failedStep == step && chain.failedCall == call_iter->second)
+        {
+            if(!chain.error.empty())
             {
-                logWarn("Before Clean Graph: NodeManager "<<drg_iter->first<<" is NULL",6);
+                throw crispr::exception(__FILE__, 
+                                        __LINE__, 
+                                        __PRETTY_FUNCTION__,
+                                        chain.error.c_str());
             }
-            else
+            return 1;
+        }
+#ifdef SEARCH_SINGLETON
+        if(CHAIN_BUILD_GRAPH == step)
+        {
+            int GID = chain.GIDs[call_iter->second];
+            DR_ClusterIterator drc_iter;
+            for(drc_iter = mDR2GIDMap[GID].begin(); drc_iter != mDR2GIDMap[GID].end(); drc_iter++)
             {
-#endif
-                if((mDRs[mTrueDRs[drg_iter->first]])->cleanGraph())
+                ReadListIterator read_iter;
+                for(read_iter = mReads[*drc_iter].begin(); read_iter != mReads[*drc_iter].end(); read_iter++)
                 {
-                    return 1;
+                    SearchCheckerList::iterator debug_iter = debugger->find((*read_iter)->getHeader());
+                    if (debug_iter != debugger->end()) {
+                        //found one of our interesting reads
+                        // add in the true DR
+                        debug_iter->second.truedr(chain.trueDR);
+                        debug_iter->second.gid(GID);
+                    }
                 }
-#ifdef DEBUG
-            }
-            if (NULL == mDRs[mTrueDRs[drg_iter->first]])
-            {
-                logWarn("After Clean Graph: NodeManager "<<drg_iter->first<<" is NULL",6);
             }
+        }
 #endif
-		}
-		drg_iter++;
-	}
-	return 0;
+    }
+    return 0;
 }
 
-int WorkHorse::removeLowConfidenceNodeManagers(void)
+//**************************************
+// Functions used to cluster DRs into groups and identify the "true" DR
+//**************************************
+//-----
+// works out the consensus of a batch of groups, each thread takes the
+// next group nobody has started on
+//
+class ConsensusTask : public ThreadTask
 {
-    logInfo("Removing CRISPRs with low numbers of spacers", 1);
-	int counter = 0;
-    DR_Cluster_MapIterator drg_iter = mDR2GIDMap.begin();
-	while(drg_iter != mDR2GIDMap.end())
-	{
-		if(NULL != drg_iter->second)
-		{            
-            if (NULL != mDRs[mTrueDRs[drg_iter->first]])
+    public:
+        ConsensusTask(WorkHorse * workHorse, std::vector<GroupConsensus>& batch) : 
+            mWorkHorse(workHorse), 
+            mBatch(batch), 
+            mNext(0)
+        {}
+
+        void run(int)
+        {
+            int batch_size = static_cast<int>(mBatch.size());
+            int i;
+            while ((i = __sync_fetch_and_add(&mNext, 1)) < batch_size)
             {
-                NodeManager * current_manager = mDRs[mTrueDRs[drg_iter->first]];
-                if( current_manager->getSpacerCountAndStats(false) < mOpts->covCutoff) 
-                {
-                    logInfo("Deleting NodeManager "<<drg_iter->first<<" as it contained less than "<<mOpts->covCutoff<<" attached spacers",5);
-                    delete mDRs[mTrueDRs[drg_iter->first]];
-                     mDRs[mTrueDRs[drg_iter->first]] = NULL;
-                } else if (current_manager->stdevSpacerLength() > CRASS_DEF_STDEV_SPACER_LENGTH) {
-                    logInfo("Deleting NodeManager "<<drg_iter->first<<" as the stdev ("<<current_manager->stdevSpacerLength()<<") of the spacer lengths was greater than "<<CRASS_DEF_STDEV_SPACER_LENGTH, 4);
-                    delete mDRs[mTrueDRs[drg_iter->first]];
-                     mDRs[mTrueDRs[drg_iter->first]] = NULL;
+                GroupConsensus& consensus = mBatch[i];
+                std::stringstream log;
+                logger->captureThread(&log);
+                try {
+                    mWorkHorse->analyseGroup(consensus.GID, consensus);
+                } catch (crispr::exception& e) {
+                    consensus.error = e.what();
                 }
-                counter++;
+                logger->captureThread(NULL);
+                consensus.log = log.str();
             }
-		}
-		drg_iter++;
-	}
-    std::cout<<'['<<PACKAGE_NAME<<"_graphBuilder]: "<<counter<<" putative CRISPRs have passed all checks"<<std::endl;
-	return 0;
-}
+        }
+
+    private:
+        WorkHorse * mWorkHorse;
+        std::vector<GroupConsensus>& mBatch;
+        int mNext;
+};
 
-//**************************************
-// Functions used to cluster DRs into groups and identify the "true" DR
-//**************************************
 int WorkHorse::findConsensusDRs(GroupKmerMap& groupKmerCountsMap, int& nextFreeGID)
 {
     //-----
@@ -557,23 +797,54 @@ int WorkHorse::findConsensusDRs(GroupKmerMap& groupKmerCountsMap, int& nextFreeG
     logInfo("Reducing list of potential DRs (2): Cluster refinement and true DR finding", 1);
     
     // go through all the counts for each group
-    GroupKmerMap::iterator group_count_iter; 
-    for(group_count_iter =  groupKmerCountsMap.begin(); 
-        group_count_iter != groupKmerCountsMap.end(); 
-        group_count_iter++)
+    std::vector<int> GIDs;
+    for(int GID = 0; GID < groupKmerCountsMap.end(); GID++)
     {
-        if(NULL == mDR2GIDMap[group_count_iter->first])
+        if(groupKmerCountsMap.contains(GID) && mDR2GIDMap.contains(GID))
         {
-            continue;
+            GIDs.push_back(GID);
         }
-
-        parseGroupedDRs(group_count_iter->first, &nextFreeGID);
+    }
+    
+    //-----
+    // the groups don't share DRs or reads so their consensus can be worked
+    // out side by side. Anything that changes the tokens, the reads or the
+    // group IDs waits for the commit, which goes in group order so that
+    // the results are the same as doing one group after the other
+    //
+    ThreadPool pool(mOpts->numThreads);
+    for(size_t batch_start = 0; batch_start < GIDs.size(); batch_start += CRASS_DEF_CONSENSUS_BATCH_SIZE)
+    {
+        size_t batch_end = std::min(GIDs.size(), batch_start + CRASS_DEF_CONSENSUS_BATCH_SIZE);
+        std::vector<GroupConsensus> batch(batch_end - batch_start);
+        for(size_t i = 0; i < batch.size(); i++)
+        {
+            batch[i].GID = GIDs[batch_start + i];
+            batch[i].drAligner = NULL;
+        }
+        
+        ConsensusTask consensus_task(this, batch);
+        pool.run(&consensus_task);
         
-        // delete the kmer count lists cause we're finsihed with them now
-        if(NULL != group_count_iter->second)
+        for(size_t i = 0; i < batch.size(); i++)
         {
-            delete group_count_iter->second;
-            group_count_iter->second = NULL;
+            (*(logger->mGlobalHandle)) << batch[i].log;
+            if(!batch[i].error.empty())
+            {
+                for(size_t j = i; j < batch.size(); j++)
+                {
+                    delete batch[j].drAligner;
+                }
+                throw crispr::exception(__FILE__, 
+                                        __LINE__, 
+                                        __PRETTY_FUNCTION__,
+                                        batch[i].error.c_str());
+            }
+            commitGroup(batch[i], &nextFreeGID);
+            delete batch[i].drAligner;
+            
+            // delete the kmer count lists cause we're finsihed with them now
+            groupKmerCountsMap.erase(batch[i].GID);
         }
     }
     
@@ -585,25 +856,27 @@ void WorkHorse::removeRedundantRepeats(Vecstr& repeatVector)
     // length and then remove longer repeats if there is a shorter one that is
     // a perfect substring
     std::sort(repeatVector.begin(), repeatVector.end(), sortLengthAssending);
-    Vecstr::iterator iter;
 
-    // go though all of the patterns and determine which are substrings
-    // clear the string if it is
+    // every repeat and its reverse complement go into one automaton,
+    // repeat i is patterns 2i and 2i + 1
+    Vecstr patterns;
+    patterns.reserve(repeatVector.size() * 2);
+    Vecstr::iterator iter;
     for (iter = repeatVector.begin(); iter != repeatVector.end(); iter++) {
-        if (iter->empty()) {
-            continue;
-        }
-        Vecstr::iterator iter2;
-        for (iter2 = iter+1; iter2 != repeatVector.end(); iter2++) {
-            if (iter2->empty()) {
-                continue;
-            }
-            //pass both itererators into the comparison function
-            if (includeSubstring(*iter, *iter2)) {
-                iter2->clear();
-            }
+        patterns.push_back(*iter);
+        patterns.push_back(reverseComplement(*iter));
+    }
+    ContainmentAutomaton automaton(patterns);
+
+    // a repeat is a substring if either form of any repeat before it in
+    // the sorted order is in it, clear the string if it is. A repeat
+    // that was cleared itself is in all the repeats it would have cleared
+    // so it makes no difference that they are all still in the automaton
+    for (int i = 0; i < (int)repeatVector.size(); i++) {
+        int first_pattern = automaton.firstPatternIn(repeatVector[i]);
+        if (-1 != first_pattern && first_pattern / 2 < i) {
+            repeatVector[i].clear();
         }
-
     }
 
     // ok so now partition the vector so that all the empties are at one end
@@ -623,32 +896,54 @@ Vecstr * WorkHorse::createNonRedundantSet(GroupKmerMap& groupKmerCountsMap, int&
     // Cluster potential DRs and work out their true sequences
     // make the node managers while we're at it!
     //
-    std::map<std::string, int> k2GID_map;
     logInfo("Reducing list of potential DRs (1): Initial clustering", 1);
     logInfo("Reticulating splines...", 1);    
     // go through all of the read holder objects
-    ReadMapIterator read_map_iter = mReads.begin();
-    while (read_map_iter != mReads.end()) 
+    std::vector<StringToken> dr_tokens;
+    Vecstr dr_sequences;
+    for (StringToken token = 0; token < mReads.end(); ++token) 
     {
-        clusterDRReads(read_map_iter->first, &nextFreeGID, &k2GID_map, &groupKmerCountsMap);
-        ++read_map_iter;
+        if (mReads.contains(token))
+        {
+            dr_tokens.push_back(token);
+            dr_sequences.push_back(mStringCheck.getString(token));
+        }
+    }
+    
+    // variants join a group when they share mOpts->kmer_clust_size kmers
+    // with any other variant in it
+    std::vector<std::vector<int> > dr_clusters;
+    std::vector<KmerHashMap<int> > cluster_kmer_counts;
+    DRClusterer clusterer(CRASS_DEF_KMER_SIZE, mOpts->kmer_clust_size, mOpts->numThreads);
+    clusterer.cluster(dr_sequences, dr_clusters, cluster_kmer_counts);
+    
+    for (size_t i = 0; i < dr_clusters.size(); i++)
+    {
+        int group = nextFreeGID++;
+        mGroupMap[group] = true;
+        DR_Cluster * current_cluster = &(mDR2GIDMap[group]);
+        std::vector<int>::iterator member_iter;
+        for (member_iter = dr_clusters[i].begin(); member_iter != dr_clusters[i].end(); member_iter++)
+        {
+            current_cluster->push_back(dr_tokens[*member_iter]);
+        }
+        groupKmerCountsMap[group].swap(cluster_kmer_counts[i]);
     }
     std::cout<<'['<<PACKAGE_NAME<<"_clusterCore]: "<<mReads.size()<<" variants mapped to "<<mDR2GIDMap.size()<<" clusters"<<std::endl;
     std::cout<<'['<<PACKAGE_NAME<<"_clusterCore]: creating non-redundant set"<<std::endl;
 
     Vecstr * non_redundant_repeats = new Vecstr();
 
-    DR_Cluster_MapIterator dcg_iter = mDR2GIDMap.begin();
-    while(dcg_iter != mDR2GIDMap.end())
+    for (int GID = 0; GID < mDR2GIDMap.end(); GID++)
     {
-        DR_ClusterIterator dc_iter = (dcg_iter->second)->begin();
-        if (dcg_iter->second != NULL) 
+        if (mDR2GIDMap.contains(GID)) 
         {
             logInfo("-------------", 4);
-            logInfo("Group: " << dcg_iter->first, 4);
+            logInfo("Group: " << GID, 4);
             
             Vecstr clustered_repeats;
-            while(dc_iter != (dcg_iter->second)->end())
+            DR_ClusterIterator dc_iter = mDR2GIDMap[GID].begin();
+            while(dc_iter != mDR2GIDMap[GID].end())
             {
                 std::string tmp = mStringCheck.getString(*dc_iter);
                 clustered_repeats.push_back(tmp);
@@ -667,7 +962,6 @@ Vecstr * WorkHorse::createNonRedundantSet(GroupKmerMap& groupKmerCountsMap, int&
             non_redundant_repeats->insert(non_redundant_repeats->end(), tmp_vec.begin(), tmp_vec.end());
 
         }
-        dcg_iter++;
     }
     logInfo("non-redundant patterns:", 4);
     Vecstr::iterator nr_iter;
@@ -693,7 +987,7 @@ bool WorkHorse::findMasterDR(int GID, StringToken * masterDRToken, std::string *
     
     logInfo("Identifying a master DR", 1);
 
-    DR_Cluster * current_dr_cluster = mDR2GIDMap[GID];
+    DR_Cluster * current_dr_cluster = &(mDR2GIDMap[GID]);
     size_t current_longest_size = 0;
     DR_ClusterIterator dr_iter;// = dr_cluster->begin();
     
@@ -717,7 +1011,7 @@ bool WorkHorse::findMasterDR(int GID, StringToken * masterDRToken, std::string *
     return true;
 }
 
-bool WorkHorse::populateCoverageArray(int GID, Aligner& drAligner)
+bool WorkHorse::populateCoverageArray(int GID, Aligner& drAligner, std::vector<StringToken>& unfoundedDRs)
 {
 	//-----
 	// Use the data structures initialised in parseGroupedDRs
@@ -728,30 +1022,19 @@ bool WorkHorse::populateCoverageArray(int GID, Aligner& drAligner)
     //++++++++++++++++++++++++++++++++++++++++++++++++
     // now go thru all the other DRs in this group and add them into
     // the consensus array
-    DR_ClusterIterator dr_iter;// = (mDR2GIDMap[GID])->begin();
-    for (dr_iter = (mDR2GIDMap[GID])->begin(); dr_iter != (mDR2GIDMap[GID])->end(); dr_iter++) 
-    {
-        // we've already done the master DR
-        if(drAligner.getMasterDrToken() == *dr_iter)
-        {
-            continue;
-        }
-
-        // get the string for this mofo
-        //std::string tmp_DR = mStringCheck.getString(*dr_iter);
-        drAligner.alignSlave(*dr_iter);
-    }
+    drAligner.alignSlaves(mDR2GIDMap[GID]);
+    
     // kill the unfounded ones
-    dr_iter = (mDR2GIDMap[GID])->begin();
-    while (dr_iter != (mDR2GIDMap[GID])->end()) 
+    DR_ClusterIterator dr_iter = mDR2GIDMap[GID].begin();
+    while (dr_iter != mDR2GIDMap[GID].end()) 
     {
     	if(drAligner.offsetFind(*dr_iter) != drAligner.offsetEnd())
     	{
 			if(drAligner.offset(*dr_iter) == -1)
 			{
-                clearReadList(mReads[*dr_iter]);
-				mReads[*dr_iter] = NULL;
-				dr_iter = (mDR2GIDMap[GID])->erase(dr_iter); 
+                // the reads go when the group is committed
+                unfoundedDRs.push_back(*dr_iter);
+				dr_iter = mDR2GIDMap[GID].erase(dr_iter); 
 			}
 	    	else
 	    	{
@@ -832,10 +1115,10 @@ std::string WorkHorse::calculateDRConsensus(int GID,
 				// is this seen at the DR level?
 				refinedDREnds[i] = false;
 				std::map<char, int> collapsed_options2;
-				DR_ClusterIterator dr_iter = (mDR2GIDMap[GID])->begin();
-				while (dr_iter != (mDR2GIDMap[GID])->end()) 
+				DR_ClusterIterator dr_iter = mDR2GIDMap[GID].begin();
+				while (dr_iter != mDR2GIDMap[GID].end()) 
 				{
-					std::string tmp_DR = mStringCheck.getString(*dr_iter);
+					std::string tmp_DR = drAligner.drSequence(*dr_iter);
 					if(-1 != drAligner.offset(*dr_iter))
 					{
 						// check if the deciding character is within range of this DR
@@ -898,38 +1181,71 @@ std::string WorkHorse::calculateDRConsensus(int GID,
 	return true_dr;
 }
 
-bool WorkHorse::parseGroupedDRs(int GID, int * nextFreeGID) 
+void WorkHorse::analyseGroup(int GID, GroupConsensus& consensus)
 {
-	
     //-----
-    // Cluster refinement and possible splitting for a Group ID
+    // Find the true DR of a group. Only the DRs and reads of this group are
+    // changed, the tokens of flipped DRs and the reads of the unfounded ones
+    // are sorted out in commitGroup
     //
     logInfo("Parsing group: " << GID, 4);
+    
+    consensus.GID = GID;
+    consensus.drAligner = NULL;
+    consensus.collapsedPos = -1;
+    consensus.gidsUsed = 0;
     		
     //++++++++++++++++++++++++++++++++++++++++++++++++
     // Find a Master DR for this group of DRs
     StringToken master_DR_token = -1;
     std::string master_DR_sequence = "**unset**";
-    if(!findMasterDR(GID, &master_DR_token, &master_DR_sequence)) { return false; }
+    if(!findMasterDR(GID, &master_DR_token, &master_DR_sequence)) { return; }
     
     
     // now we have the n most abundant kmers and one DR which contains them all
     // time to rock and rrrroll!
     
-    Aligner dr_aligner((CRASS_DEF_CONS_ARRAY_RL_MULTIPLIER*mMaxReadLength), &mReads, &mStringCheck);
-    dr_aligner.setMasterDR(master_DR_sequence);
+    consensus.drAligner = new Aligner((CRASS_DEF_CONS_ARRAY_RL_MULTIPLIER*mMaxReadLength), &mReads, &mStringCheck);
+    consensus.drAligner->holdSlaveTokens();
+    consensus.drAligner->setMasterDR(master_DR_sequence);
 
     //++++++++++++++++++++++++++++++++++++++++++++++++
     // Set up the master DR's array and insert this guy into the main array
-    populateCoverageArray(GID, dr_aligner );
+    populateCoverageArray(GID, *(consensus.drAligner), consensus.unfoundedDRs);
     //++++++++++++++++++++++++++++++++++++++++++++++++
     // calculate consensus and diversity
 	// use these variables to identify and store possible
-	// collapsed clusters
-	int collapsed_pos = -1;
-	std::map<char, int> collapsed_options;            // holds the chars we need to split on
-	std::map<int, bool> refined_DR_ends;              // so we can update DR ends based on consensus 
-    std::string true_DR = calculateDRConsensus(GID, dr_aligner, *nextFreeGID, collapsed_pos, collapsed_options, refined_DR_ends);
+	// collapsed clusters. The collapsed options count their
+	// group IDs from zero until the commit
+    consensus.trueDR = calculateDRConsensus(GID, 
+                                            *(consensus.drAligner), 
+                                            consensus.gidsUsed, 
+                                            consensus.collapsedPos, 
+                                            consensus.collapsedOptions, 
+                                            consensus.refinedDREnds);
+}
+
+bool WorkHorse::commitGroup(GroupConsensus& consensus, int * nextFreeGID)
+{
+    //-----
+    // Cluster refinement and possible splitting for a Group ID
+    //
+    if(NULL == consensus.drAligner) { return false; }
+    
+    int GID = consensus.GID;
+    Aligner& dr_aligner = *(consensus.drAligner);
+    dr_aligner.releaseSlaveTokens(mDR2GIDMap[GID]);
+    std::vector<StringToken>::iterator unfounded_iter;
+    for(unfounded_iter = consensus.unfoundedDRs.begin(); unfounded_iter != consensus.unfoundedDRs.end(); unfounded_iter++)
+    {
+        mReads.erase(*unfounded_iter);
+    }
+    *nextFreeGID += consensus.gidsUsed;
+    
+	int collapsed_pos = consensus.collapsedPos;
+	std::map<char, int>& collapsed_options = consensus.collapsedOptions;
+	std::map<int, bool>& refined_DR_ends = consensus.refinedDREnds;
+    std::string& true_DR = consensus.trueDR;
 
     // check to make sure that the DR is not just some random long RE
     if((unsigned int)(true_DR.length()) > mOpts->highDRsize)
@@ -1053,14 +1369,14 @@ bool WorkHorse::parseGroupedDRs(int GID, int * nextFreeGID)
         while(co_iter != collapsed_options.end())
         {
             int group = (*nextFreeGID)++;
-            mDR2GIDMap[group] = new DR_Cluster;
+            mDR2GIDMap[group];
             coll_char_to_GID_map[co_iter->first] = group;
             logInfo("Mapping \""<< co_iter->first << " : "  << co_iter->second << "\" to group: " << group, 1);
             co_iter++;
         }
         
-        DR_ClusterIterator dr_iter = (mDR2GIDMap[GID])->begin();
-        while (dr_iter != (mDR2GIDMap[GID])->end()) 
+        DR_ClusterIterator dr_iter = mDR2GIDMap[GID].begin();
+        while (dr_iter != mDR2GIDMap[GID].end()) 
         {
             std::string tmp_DR = mStringCheck.getString(*dr_iter);
             if(-1 != dr_aligner.offset(*dr_iter))
@@ -1070,7 +1386,7 @@ bool WorkHorse::parseGroupedDRs(int GID, int * nextFreeGID)
                 {
                     // this is easy, we can compare based on this char only
                     char decision_char = tmp_DR[collapsed_pos - dr_aligner.offset(*dr_iter)];
-                    (mDR2GIDMap[ coll_char_to_GID_map[ decision_char ] ])->push_back(*dr_iter);
+                    mDR2GIDMap[ coll_char_to_GID_map[ decision_char ] ].push_back(*dr_iter);
                 }
                 else
                 {
@@ -1083,10 +1399,10 @@ bool WorkHorse::parseGroupedDRs(int GID, int * nextFreeGID)
                     
                     // we're not guaranteed to see all forms. So we need to be careful here...
                     // First we go through just to count the forms
-                    std::map<char, ReadList *> forms_map;
+                    std::map<char, StringToken> forms_map;
                     
-                    ReadListIterator read_iter = mReads[*dr_iter]->begin();
-                    while (read_iter != mReads[*dr_iter]->end()) 
+                    ReadListIterator read_iter = mReads[*dr_iter].begin();
+                    while (read_iter != mReads[*dr_iter].end()) 
                     {
                         StartStopListIterator ss_iter = (*read_iter)->begin();
                         while(ss_iter != (*read_iter)->end())
@@ -1099,7 +1415,7 @@ bool WorkHorse::parseGroupedDRs(int GID, int * nextFreeGID)
                                 // it must be one of the collapsed options!
                                 if(collapsed_options.find(decision_char) != collapsed_options.end())
                                 {
-                                	forms_map[decision_char] = NULL;
+                                	forms_map[decision_char] = 0;
                                 	break;
                                 }
                             }
@@ -1115,9 +1431,9 @@ bool WorkHorse::parseGroupedDRs(int GID, int * nextFreeGID)
                         {
                             // we can just reuse the existing ReadList!
                             // find out which group this bozo is in
-                            read_iter = mReads[*dr_iter]->begin();
+                            read_iter = mReads[*dr_iter].begin();
                             bool break_out = false;
-                            while (read_iter != mReads[*dr_iter]->end()) 
+                            while (read_iter != mReads[*dr_iter].end()) 
                             {
                                 StartStopListIterator ss_iter = (*read_iter)->begin();
                                 while(ss_iter != (*read_iter)->end())
@@ -1129,7 +1445,7 @@ bool WorkHorse::parseGroupedDRs(int GID, int * nextFreeGID)
                                         // it must be one of the collapsed options!
                                         if(forms_map.find(decision_char) != forms_map.end())
                                         {
-                                        	(mDR2GIDMap[ coll_char_to_GID_map[ decision_char ] ])->push_back(*dr_iter);
+                                        	mDR2GIDMap[ coll_char_to_GID_map[ decision_char ] ].push_back(*dr_iter);
                                             break_out = true;
                                             break;
                                         }
@@ -1148,36 +1464,31 @@ bool WorkHorse::parseGroupedDRs(int GID, int * nextFreeGID)
 #ifdef DEBUG                        	
                             logWarn("No reads fit the form: " << tmp_DR, 8);
 #endif
-                            if(NULL != mReads[*dr_iter])
-                            {
-                                clearReadList(mReads[*dr_iter]);
-                                delete mReads[*dr_iter];
-                                mReads[*dr_iter] = NULL;
-                            }
+                            mReads.erase(*dr_iter);
                             break;
                         }
                         default:
                         {
                             // we need to make a couple of new readlists and nuke the old one.
                             // first make the new readlists
-                            std::map<char, ReadList *>::iterator fm_iter = forms_map.begin();
+                            std::map<char, StringToken>::iterator fm_iter = forms_map.begin();
                             while(fm_iter != forms_map.end())
                             {
                                 // make the readlist
                                 StringToken st = mStringCheck.addString(tmp_DR);
-                                mReads[st] = new ReadList();
+                                mReads[st];
                                 // make sure we know which readlist is which
-                                forms_map[fm_iter->first] = mReads[st];
+                                forms_map[fm_iter->first] = st;
                                 // put the new dr_token into the right cluster
-                                (mDR2GIDMap[ coll_char_to_GID_map[ fm_iter->first ] ])->push_back(st);
+                                mDR2GIDMap[ coll_char_to_GID_map[ fm_iter->first ] ].push_back(st);
                                 
                                 // next!
                                 fm_iter++;
                             }
                             
                             // put the correct reads on the correct readlist
-                            read_iter = mReads[*dr_iter]->begin();
-                            while (read_iter != mReads[*dr_iter]->end()) 
+                            read_iter = mReads[*dr_iter].begin();
+                            while (read_iter != mReads[*dr_iter].end()) 
                             {
                                 StartStopListIterator ss_iter = (*read_iter)->begin();
                                 while(ss_iter != (*read_iter)->end())
@@ -1191,7 +1502,7 @@ bool WorkHorse::parseGroupedDRs(int GID, int * nextFreeGID)
                                         if(forms_map.find(decision_char) != forms_map.end())
                                         {
 											// push this readholder onto the correct list
-											(forms_map[decision_char])->push_back(*read_iter);
+											mReads[forms_map[decision_char]].push_back(*read_iter);
 											
 											// make the original pointer point to NULL so we don't delete twice
 											*read_iter = NULL;
@@ -1205,12 +1516,7 @@ bool WorkHorse::parseGroupedDRs(int GID, int * nextFreeGID)
                             }
                             
                             // nuke the old readlist
-                            if(NULL != mReads[*dr_iter])
-                            {
-                                clearReadList(mReads[*dr_iter]);
-                                delete mReads[*dr_iter];
-                                mReads[*dr_iter] = NULL;
-                            }                                
+                            mReads.erase(*dr_iter);
                             
                             break;
                         }
@@ -1247,8 +1553,11 @@ bool WorkHorse::parseGroupedDRs(int GID, int * nextFreeGID)
         logInfo("Found DR: " << laurenized_true_dr, 2);
         
         mTrueDRs[GID] = laurenized_true_dr;
-        DR_ClusterIterator drc_iter = (mDR2GIDMap[GID])->begin();
-        while(drc_iter != (mDR2GIDMap[GID])->end())
+        
+        // every read in the group is searched for partials of the same DR
+        PartialRepeatAligner partial_aligner(true_DR);
+        DR_ClusterIterator drc_iter = mDR2GIDMap[GID].begin();
+        while(drc_iter != mDR2GIDMap[GID].end())
         {
         	if(dr_aligner.offsetFind(*drc_iter) == dr_aligner.offsetEnd())
         	{
@@ -1264,10 +1573,10 @@ bool WorkHorse::parseGroupedDRs(int GID, int * nextFreeGID)
 				else 
 				{
 					// go through each read
-					ReadListIterator read_iter = mReads[*drc_iter]->begin();
-					while (read_iter != mReads[*drc_iter]->end()) 
+					ReadListIterator read_iter = mReads[*drc_iter].begin();
+					while (read_iter != mReads[*drc_iter].end()) 
 					{
-						(*read_iter)->updateStartStops((dr_aligner.offset(*drc_iter) - dr_aligner.getDRZoneStart()), &true_DR, mOpts);
+						(*read_iter)->updateStartStops((dr_aligner.offset(*drc_iter) - dr_aligner.getDRZoneStart()), &true_DR, &partial_aligner, mOpts);
 	
 						// reverse complement sequence if the true DR is not in its laurenized form
 						if (rev_comp) 
@@ -1292,14 +1601,19 @@ bool WorkHorse::parseGroupedDRs(int GID, int * nextFreeGID)
     return true;
 }
 
+bool WorkHorse::parseGroupedDRs(int GID, int * nextFreeGID) 
+{
+    GroupConsensus consensus;
+    analyseGroup(GID, consensus);
+    bool ret = commitGroup(consensus, nextFreeGID);
+    delete consensus.drAligner;
+    return ret;
+}
+
 
 void WorkHorse::cleanGroup(int GID)
 {
-    if(NULL != mDR2GIDMap[GID])
-    {
-        delete mDR2GIDMap[GID];
-        mDR2GIDMap[GID] = NULL;
-    }
+    mDR2GIDMap.erase(GID);
 }
 
 
@@ -1309,247 +1623,12 @@ int WorkHorse::numberOfReadsInGroup(DR_Cluster * currentGroup)
     size_t number_of_reads_in_group = 0;
     while (grouped_drs_iter != currentGroup->end()) 
     {
-        number_of_reads_in_group += mReads[*grouped_drs_iter]->size();
+        number_of_reads_in_group += mReads[*grouped_drs_iter].size();
         ++grouped_drs_iter;
     }
     return (int)number_of_reads_in_group;
 }
 
-bool WorkHorse::clusterDRReads(StringToken DRToken, 
-                               int * nextFreeGID, 
-                               std::map<std::string, int> * k2GIDMap, 
-                               GroupKmerMap * groupKmerCountsMap)
-{
-    //-----
-    // hash a DR!
-    //
-
-    std::string DR = mStringCheck.getString(DRToken);
-    int str_len = (int)DR.length();
-    int off = str_len - CRASS_DEF_KMER_SIZE;
-    int num_mers = off + 1;
-    
-    //***************************************
-    //***************************************
-    //***************************************
-    //***************************************
-    // LOOK AT ME!
-    // 
-    // Here we declare the minimum criteria for membership when clustering
-    // this is not cool!
-    int min_clust_membership_count = mOpts->kmer_clust_size;
-    // 
-    //***************************************
-    //***************************************
-    //***************************************
-    //***************************************
-    
-    // STOLED FROM SaSSY!!!!
-    // First we cut kmers from the sequence then we use these to
-    // determine overlaps, finally we make edges
-    //
-    // When we cut kmers from a read it is like this...
-    //
-    // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
-    // ------------------------------
-    // XXXXXXXXXXXXXXXXXXXXXXXXXX
-    // XXXXXXXXXXXXXXXXXXXXXXXXXX
-    // XXXXXXXXXXXXXXXXXXXXXXXXXX
-    // XXXXXXXXXXXXXXXXXXXXXXXXXX
-    // XXXXXXXXXXXXXXXXXXXXXXXXXX
-    //
-    // so we break the job into three parts
-    //
-    // XXXX|XXXXXXXXXXXXXXXXXXXXXX|XXXX
-    // ----|----------------------|----
-    // XXXX|XXXXXXXXXXXXXXXXXXXXXX|
-    //  XXX|XXXXXXXXXXXXXXXXXXXXXX|X
-    //   XX|XXXXXXXXXXXXXXXXXXXXXX|XX
-    //    X|XXXXXXXXXXXXXXXXXXXXXX|XXX
-    //     |XXXXXXXXXXXXXXXXXXXXXX|XXXX
-    //
-    // the first and last part may be a little slow but the middle part can fly through...
-    //
-    
-    // make a 2d array for the kmers!
-	char ** kmers = NULL;
-	int * kmer_offsets = NULL;
-	try {
-		kmers = new char*[num_mers];
-	} catch(std::exception& e) {
-		std::cerr<<"Attempting to alloc "<<num_mers<<std::endl;
-		throw crispr::exception(__FILE__, 
-		                        __LINE__, 
-		                        __PRETTY_FUNCTION__, 
-		                        e.what());
-	}
-	try {
-		for(int i = 0; i < num_mers; i++)
-		{
-			kmers[i] = new char [CRASS_DEF_KMER_SIZE+1];
-		}
-// use these offsets when we cut kmers, they are a component of the algorithm
-		kmer_offsets = new int[num_mers];              
-		for(int i = 0; i < num_mers; i++)
-		{
-			kmer_offsets[i] = i * -1; // Starts at [0, -1, -2, -3, -4, ...]
-		}
-	} catch(std::exception& e) {
-		std::cerr<<"Attempting to alloc "<<CRASS_DEF_KMER_SIZE+1<<std::endl;
-		throw crispr::exception(__FILE__, 
-		                        __LINE__, 
-		                        __PRETTY_FUNCTION__, 
-		                        e.what());
-	}
-    int pos_counter = 0;
-    
-    // a slow-ish first part
-    while(pos_counter < CRASS_DEF_KMER_SIZE)
-    {
-        for(int j = 0; j < num_mers; j++)
-        {
-            if(pos_counter >= j)
-            {
-                kmers[j][kmer_offsets[j]] = DR[pos_counter];
-            }
-            kmer_offsets[j]++;
-        }
-        pos_counter++;
-    }
-    
-    // this is the fast part of the loop
-    while(pos_counter < off)
-    {
-        for(int j = 0; j < num_mers; j++)
-        {
-            if(kmer_offsets[j] >= 0 && kmer_offsets[j] < CRASS_DEF_KMER_SIZE)
-            {
-                kmers[j][kmer_offsets[j]] = DR[pos_counter];
-            }
-            kmer_offsets[j]++;
-        }
-        pos_counter++;
-    }
-    
-    // an even slower ending
-    while(pos_counter < str_len)
-    {
-        for(int j = 0; j < num_mers; j++)
-        {
-            if(kmer_offsets[j] < CRASS_DEF_KMER_SIZE)
-            {
-                kmers[j][kmer_offsets[j]] = DR[pos_counter];
-            }
-            kmer_offsets[j]++;
-        }
-        pos_counter++;
-    }
-    
-    //
-    // Now the fun stuff begins:
-    //
-    Vecstr homeless_kmers;
-    std::map<int, int> group_count;
-    std::map<std::string, int> local_kmer_CountMap;
-    
-    int group = 0;
-    for(int i = 0; i < num_mers; ++i)
-    {
-        // make it a string!
-        kmers[i][CRASS_DEF_KMER_SIZE] = '\0';
-        
-        std::string tmp_str(kmers[i]);
-        tmp_str = laurenize(tmp_str);
-        
-        // see if this guy has been counted LOCALLY
-        // use this list when we go to select N most abundant kmers
-        if(local_kmer_CountMap.find(tmp_str) == local_kmer_CountMap.end())
-        {
-        	// first time this kmer has been seen in this read
-            local_kmer_CountMap[tmp_str] = 1;
-        }
-        else
-        {
-            local_kmer_CountMap[tmp_str]++;
-        }
-        
-        // see if we've seen this kmer before GLOBALLY
-        std::map<std::string, int>::iterator k2g_iter = k2GIDMap->find(tmp_str);
-        if(k2g_iter == k2GIDMap->end())
-        {
-            // first time we seen this one GLOBALLY
-            homeless_kmers.push_back(tmp_str);
-        }
-        else
-        {
-        	// we've seen this guy before.
-            // only do this if our guy doesn't belong to a group yet
-            if(0 == group)
-            {
-                // this kmer belongs to a group -> increment the local group count
-                std::map<int, int>::iterator this_group_iter = group_count.find(k2g_iter->second);
-                if(this_group_iter == group_count.end())
-                {
-                    group_count[k2g_iter->second] = 1;
-                }
-                else
-                {
-                    group_count[k2g_iter->second]++;
-                    // have we seen this guy enought times?
-                    if(min_clust_membership_count <= group_count[k2g_iter->second])
-                    {
-                        // we have found a group for this mofo!
-                        group = k2g_iter->second;
-                    }
-                }
-            }
-        }
-    }
-    
-    if(0 == group)
-    {
-    	// we couldn't put our guy into a group
-        group = (*nextFreeGID)++;
-        
-        // we need to make a new entry in the group map
-        mGroupMap[group] = true;
-        mDR2GIDMap[group] = new DR_Cluster;
-        
-        // we need a new kmer counter for this group
-        (*groupKmerCountsMap)[group] = new std::map<std::string, int>;
-    }
-    
-    // we need to record the group for this mofo!
-    mDR2GIDMap[group]->push_back(DRToken);
-    
-    // we need to assign all homeless kmers to the group!
-    Vecstr::iterator homeless_iter = homeless_kmers.begin();
-    while(homeless_iter != homeless_kmers.end())
-    {
-        (*k2GIDMap)[*homeless_iter] = group;
-        homeless_iter++;
-    }
-    
-    // we need to fix up the group counts
-    std::map<std::string, int>::iterator local_count_iter = local_kmer_CountMap.begin();
-    while(local_count_iter != local_kmer_CountMap.end())
-    {
-        (*(*groupKmerCountsMap)[group])[local_count_iter->first] += local_count_iter->second;
-        local_count_iter++;
-    }
-    
-    // clean up
-    delete [] kmer_offsets;
-    for(int i = 0; i < num_mers; i++)
-    {
-        delete [] kmers[i];
-    }
-    delete [] kmers;
-    
-    return true;
-    
-}
-
 //**************************************
 // spacer graphs
 //**************************************
@@ -1558,19 +1637,7 @@ int WorkHorse::makeSpacerGraphs(void)
 	//-----
 	// build the spacer graphs
 	//
-    // go through the DR2GID_map and make all reads in each group into nodes
-    DR_ListIterator dr_iter = mDRs.begin();
-    while(dr_iter != mDRs.end())
-    {
-        if(NULL != dr_iter->second)
-        {
-        	logInfo("Making spacer graph for DR: " << dr_iter->first, 1);
-        	if((dr_iter->second)->buildSpacerGraph())
-        		return 1;
-        }
-        dr_iter++;
-    }
-    return 0;
+	return finishChainStep(CHAIN_MAKE_SPACER_GRAPH);
 }
 
 int WorkHorse::cleanSpacerGraphs(void)
@@ -1578,46 +1645,19 @@ int WorkHorse::cleanSpacerGraphs(void)
 	//-----
 	// clean the spacer graphs
 	//
-    // go through the DR2GID_map and make all reads in each group into nodes
 #ifdef DEBUG
     renderSpacerGraphs("Spacer_Preclean_");
 #endif
-    DR_ListIterator dr_iter = mDRs.begin();
-    while(dr_iter != mDRs.end())
-    {
-        if(NULL != dr_iter->second)
-        {
-        	logInfo("Cleaning spacer graph for DR: " << dr_iter->first, 1);
-        	//(dr_iter->second)->printAllSpacers();
-        	if((dr_iter->second)->cleanSpacerGraph())
-        		return 1;
-        }
-        dr_iter++;
-    }
-    return 0;
+	return finishChainStep(CHAIN_CLEAN_SPACER_GRAPH);
 }
 
 int WorkHorse::generateFlankers(void)
 {
 	//-----
-	// Wrapper for graph cleaning
+	// Wrapper for flanker detection
 	//
-	// create a spacer dictionary
 	logInfo("Detecting Flanker sequences", 1);
-	DR_Cluster_MapIterator drg_iter = mDR2GIDMap.begin();
-	while(drg_iter != mDR2GIDMap.end())
-	{
-		if(NULL != drg_iter->second)
-		{            
-            if (NULL != mDRs[mTrueDRs[drg_iter->first]])
-            {
-                logInfo("Assigning flankers for NodeManager "<<drg_iter->first, 3);
-                (mDRs[mTrueDRs[drg_iter->first]])->generateFlankers();
-		    }
-        }
-		drg_iter++;
-	}
-	return 0;
+	return finishChainStep(CHAIN_FLANKERS);
 }
 //**************************************
 // contig making
@@ -1627,19 +1667,7 @@ int WorkHorse::splitIntoContigs(void)
 	//-----
 	// split all groups into contigs
 	//
-    DR_ListIterator dr_iter = mDRs.begin();
-    while(dr_iter != mDRs.end())
-    {
-        if(NULL != dr_iter->second)
-        {
-        	logInfo("Making spacer contigs for DR: " << dr_iter->first, 1);
-
-            if((dr_iter->second)->splitIntoContigs())
-        		return 1;
-        }
-        dr_iter++;
-    }
-    return 0;
+	return finishChainStep(CHAIN_SPLIT_CONTIGS);
 }
 
 //**************************************
@@ -1667,25 +1695,25 @@ int WorkHorse::renderDebugGraphs(std::string namePrefix)
     logInfo("Rendering debug graphs" , 1);
 #endif
     
-    DR_Cluster_MapIterator drg_iter = mDR2GIDMap.begin();
-    while(drg_iter != mDR2GIDMap.end())
+    int GID = 0;
+    while(GID < mDR2GIDMap.end())
     {
-        if(NULL != drg_iter->second)
+        if(mDR2GIDMap.contains(GID))
         {            
-            if (NULL != mDRs[mTrueDRs[drg_iter->first]])
+            if (NULL != mDRs[mTrueDRs[GID]])
             {
                 std::ofstream graph_file;
-                std::string graph_file_prefix = mOpts->output_fastq + namePrefix + to_string(drg_iter->first) + "_" + mTrueDRs[drg_iter->first];
+                std::string graph_file_prefix = mOpts->output_fastq + namePrefix + to_string(GID) + "_" + mTrueDRs[GID];
                 std::string graph_file_name = graph_file_prefix + "_debug.gv";
                 graph_file.open(graph_file_name.c_str());
                 if (graph_file.good()) 
                 {
-                    mDRs[mTrueDRs[drg_iter->first]]->printDebugGraph(graph_file, mTrueDRs[drg_iter->first], false, false, false);
+                    mDRs[mTrueDRs[GID]]->printDebugGraph(graph_file, mTrueDRs[GID], false, false, false);
 #if RENDERING
                     if (!mOpts->noRendering) 
                     {
                         // create a command string and call neato to make the image file
-                        std::cout<<"["<<PACKAGE_NAME<<"_imageRenderer]: Rendering group "<<drg_iter->first<<std::endl;
+                        std::cout<<"["<<PACKAGE_NAME<<"_imageRenderer]: Rendering group "<<GID<<std::endl;
                         std::string cmd = "neato -Teps " + graph_file_name + " > "+ graph_file_prefix + ".eps";
                         if (system(cmd.c_str()))
                         {
@@ -1701,7 +1729,7 @@ int WorkHorse::renderDebugGraphs(std::string namePrefix)
                 graph_file.close();
             }
         }
-        drg_iter++;
+        GID++;
     }
     return 0;
 }
@@ -1739,34 +1767,34 @@ int WorkHorse::renderSpacerGraphs(std::string namePrefix)
     }
 
     gvGraphHeader(key_file, "Keys");
-    DR_Cluster_MapIterator drg_iter = mDR2GIDMap.begin();
-    while(drg_iter != mDR2GIDMap.end())
+    int GID = 0;
+    while(GID < mDR2GIDMap.end())
     {
-        if(NULL != drg_iter->second)
+        if(mDR2GIDMap.contains(GID))
         {            
-            if(NULL != mDRs[mTrueDRs[drg_iter->first]])
+            if(NULL != mDRs[mTrueDRs[GID]])
             {
-                NodeManager * current_manager = mDRs[mTrueDRs[drg_iter->first]];
+                NodeManager * current_manager = mDRs[mTrueDRs[GID]];
                 
                 std::ofstream graph_file;
 
                 
-                std::string graph_file_prefix = mOpts->output_fastq + namePrefix + to_string(drg_iter->first) + "_" + mTrueDRs[drg_iter->first];
+                std::string graph_file_prefix = mOpts->output_fastq + namePrefix + to_string(GID) + "_" + mTrueDRs[GID];
                 std::string graph_file_name = graph_file_prefix + "_spacers.gv";
                 
                 // check to see if there is anything to print
                 if ( current_manager->printSpacerGraph(graph_file_name, 
-                                                       mTrueDRs[drg_iter->first], 
+                                                       mTrueDRs[GID], 
                                                        mOpts->longDescription, 
                                                        mOpts->showSingles))
                 {
                     // add our group to the key
                     current_manager->printSpacerKey(key_file, 
                                                     10, 
-                                                    namePrefix + to_string(drg_iter->first));
+                                                    namePrefix + to_string(GID));
                     
                     // output the reads
-                    std::string read_file_name = mOpts->output_fastq +  "Group_" + to_string(drg_iter->first) + "_" + mTrueDRs[drg_iter->first] + ".fa";
+                    std::string read_file_name = mOpts->output_fastq +  "Group_" + to_string(GID) + "_" + mTrueDRs[GID] + ".fa";
 
                     this->dumpReads(current_manager, read_file_name);
                 }
@@ -1774,14 +1802,14 @@ int WorkHorse::renderSpacerGraphs(std::string namePrefix)
                 {
                     // should delete this guy since there are no spacers
                     // this way the group will not be in the xml either
-                    delete mDRs[mTrueDRs[drg_iter->first]];
-                    mDRs[mTrueDRs[drg_iter->first]] = NULL;
+                    delete mDRs[mTrueDRs[GID]];
+                    mDRs[mTrueDRs[GID]] = NULL;
                 }
 #if RENDERING
                 if (!mOpts->noRendering) 
                 {
                     // create a command string and call graphviz to make the image file
-                    std::cout<<"["<<PACKAGE_NAME<<"_imageRenderer]: Rendering group "<<drg_iter->first<<std::endl;
+                    std::cout<<"["<<PACKAGE_NAME<<"_imageRenderer]: Rendering group "<<GID<<std::endl;
                     std::string cmd = mOpts->layoutAlgorithm + " -Teps " + graph_file_name + " > "+ graph_file_prefix + ".eps";
                     if(system(cmd.c_str()))
                     {
@@ -1792,7 +1820,7 @@ int WorkHorse::renderSpacerGraphs(std::string namePrefix)
 #endif
             }
         }
-        drg_iter++;
+        GID++;
     }
     gvGraphFooter(key_file);
     key_file.close();
@@ -1898,58 +1926,57 @@ bool WorkHorse::outputResults(std::string namePrefix)
     // go through the node managers and print the group info 
     // print all the inside information
     int final_out_number = 0;
-    DR_Cluster_MapIterator drg_iter =  mDR2GIDMap.begin();
-    for (drg_iter =  mDR2GIDMap.begin(); drg_iter != mDR2GIDMap.end(); drg_iter++) {
+    for (int GID = 0; GID < mDR2GIDMap.end(); GID++) {
 
         // make sure that our cluster is real
-        if (drg_iter->second == NULL) 
+        if (!mDR2GIDMap.contains(GID)) 
         {
             continue;
         }
-        if(NULL == mDRs[mTrueDRs[drg_iter->first]])
+        if(NULL == mDRs[mTrueDRs[GID]])
         {
             continue;
         }
 
-        NodeManager * current_manager = mDRs[mTrueDRs[drg_iter->first]];
+        NodeManager * current_manager = mDRs[mTrueDRs[GID]];
         
         std::ofstream graph_file;        
         
-        std::string graph_file_prefix = mOpts->output_fastq + "Spacers_" + to_string(drg_iter->first) + "_" + mTrueDRs[drg_iter->first];
+        std::string graph_file_prefix = mOpts->output_fastq + "Spacers_" + to_string(GID) + "_" + mTrueDRs[GID];
         std::string graph_file_name = graph_file_prefix + "_spacers.gv";
         
         // check to see if there is anything to print
         if ( current_manager->printSpacerGraph(graph_file_name, 
-                                               mTrueDRs[drg_iter->first], 
+                                               mTrueDRs[GID], 
                                                mOpts->longDescription, 
                                                mOpts->showSingles))
         {
             // add our group to the key
             current_manager->printSpacerKey(key_file, 
                                             10, 
-                                            namePrefix + to_string(drg_iter->first));
+                                            namePrefix + to_string(GID));
             
             // output the reads
-            std::string read_file_name = mOpts->output_fastq +  "Group_" + to_string(drg_iter->first) + "_" + mTrueDRs[drg_iter->first] + ".fa";
+            std::string read_file_name = mOpts->output_fastq +  "Group_" + to_string(GID) + "_" + mTrueDRs[GID] + ".fa";
             this->dumpReads(current_manager, read_file_name, true);
             
             /* 
              *   Output the xml data to crass.crispr
              */
-            std::string gid_as_string = "G" + to_string(drg_iter->first);
+            std::string gid_as_string = "G" + to_string(GID);
             final_out_number++;
             xercesc::DOMElement * group_elem = xml_doc->addGroup(gid_as_string, 
-                                                                 mTrueDRs[drg_iter->first], 
+                                                                 mTrueDRs[GID], 
                                                                  root_element);
             /*
              * <data> section
              */
-            this->addDataToDOM(xml_doc, group_elem, drg_iter->first);
+            this->addDataToDOM(xml_doc, group_elem, GID);
             
             /*
              * <metadata> section
              */
-            this->addMetadataToDOM(xml_doc, group_elem, drg_iter->first);
+            this->addMetadataToDOM(xml_doc, group_elem, GID);
             
             /*
              * <assembly> section
@@ -1960,7 +1987,7 @@ bool WorkHorse::outputResults(std::string namePrefix)
             if (!mOpts->noRendering) 
             {
                 // create a command string and call graphviz to make the image file
-                std::cout<<"["<<PACKAGE_NAME<<"_imageRenderer]: Rendering group "<<drg_iter->first<<std::endl;
+                std::cout<<"["<<PACKAGE_NAME<<"_imageRenderer]: Rendering group "<<GID<<std::endl;
                 std::string cmd = mOpts->layoutAlgorithm + " -Teps " + graph_file_name + " > "+ graph_file_prefix + ".eps";
                 if(system(cmd.c_str()))
                 {
@@ -1973,8 +2000,8 @@ bool WorkHorse::outputResults(std::string namePrefix)
         else 
         {
             // should delete this guy since there are no spacers
-            delete mDRs[mTrueDRs[drg_iter->first]];
-            mDRs[mTrueDRs[drg_iter->first]] = NULL;
+            delete mDRs[mTrueDRs[GID]];
+            mDRs[mTrueDRs[GID]] = NULL;
         }
     }
     std::cout<<"["<<PACKAGE_NAME<<"_graphBuilder]: "<<final_out_number<<" CRISPRs found!"<<std::endl;
@@ -49,6 +49,7 @@
 #include "libcrispr.h"
 #include "NodeManager.h"
 #include "ReadHolder.h"
+#include "ReadStore.h"
 #include "StringCheck.h"
 #include <libcrispr/writer.h>
 #if SEARCH_SINGLETON
@@ -64,20 +65,74 @@ typedef std::map<std::string, NodeManager *>::iterator DR_ListIterator;
 
 
 
+// the consensus of one group of DRs. It is worked out on any thread
+// without touching anything the other groups use, then committed to
+// the WorkHorse one group at a time in group order
+typedef struct {
+    int                         GID;
+    Aligner *                   drAligner;                                  // NULL if there was no master DR
+    std::string                 trueDR;
+    int                         collapsedPos;
+    std::map<char, int>         collapsedOptions;                           // holds the chars we need to split on
+    std::map<int, bool>         refinedDREnds;                              // so we can update DR ends based on consensus
+    int                         gidsUsed;                                   // group IDs taken by the collapsed options
+    std::vector<StringToken>    unfoundedDRs;                               // DRs that could not be placed in the array
+    std::string                 log;                                        // what was logged while working it out
+    std::string                 error;                                      // set if working it out threw
+} GroupConsensus;
+
+// the steps taken on the NodeManager of each true DR once the groups
+// are known, in the order doWork takes them
+enum {
+    CHAIN_BUILD_GRAPH = 0,
+    CHAIN_CLEAN_GRAPH,
+    CHAIN_MAKE_SPACER_GRAPH,
+    CHAIN_CLEAN_SPACER_GRAPH,
+    CHAIN_SPLIT_CONTIGS,
+    CHAIN_FLANKERS,
+    CHAIN_CONFIDENCE,
+    CHAIN_NUM_STEPS
+};
+
+// one true DR and the groups that have it. The steps run on any thread
+// without touching the other chains, what they log is kept per call and
+// written out afterwards in the order the calls were made in before
+typedef struct {
+    std::string                 trueDR;
+    std::vector<int>            GIDs;                                       // in group order
+    size_t                      numReads;
+    NodeManager *               manager;                                    // NULL once it fails the checks
+    std::vector<std::string>    logs[CHAIN_NUM_STEPS];                      // one per call made in the step
+    int                         passedChecks;
+    int                         failedStep;                                 // CHAIN_NUM_STEPS if nothing failed
+    size_t                      failedCall;
+    std::string                 error;                                      // set if the failed call threw
+} NodeManagerChain;
+
 bool sortLengthAssending( const std::string &a, const std::string &b);
 bool sortLengthDecending( const std::string &a, const std::string &b);
 bool includeSubstring(const std::string& a, const std::string& b);
 bool isNotEmpty(const std::string& a);
 
 class WorkHorse {
+    friend class ConsensusTask;
+    friend class NodeManagerChainTask;
+
     public:
-    WorkHorse (options * opts, std::string timestamp, std::string commandLine) 
+    WorkHorse (options * opts, std::string timestamp, std::string commandLine) :
+#ifdef OUTPUT_READS_FASTQ
+        mReadStore(true)
+#else
+        // qualities are never output
+        mReadStore(false)
+#endif
         { 
             mOpts = opts; 
             mMaxReadLength = 0;
             mStringCheck.setName("WH");
             mTimeStamp = timestamp;
             mCommandLine = commandLine;
+            mChainStepsDone = 0;
         }
         ~WorkHorse();
         
@@ -94,9 +149,6 @@ class WorkHorse {
         
     private:
         
-        void clearReadList(ReadList * tmp_list);
-        void clearReadMap(ReadMap * tmp_map);
-        
         //**************************************
         // functions used to cluster DRs into groups and identify the "true" DR
         //**************************************
@@ -116,16 +168,13 @@ class WorkHorse {
         int findConsensusDRs(GroupKmerMap& groupKmerCountsMap, 
                              int& nextFreeGID);
     
-        bool clusterDRReads(StringToken DRToken, 
-                int * nextFreeGID, 
-                std::map<std::string, int> * k2GIDMap, 
-                GroupKmerMap * groupKmerCountsMap);  // cut kmers and hash
-        
         bool findMasterDR(int GID, 
                 StringToken * masterDRToken, 
                 std::string * masterDRSequence);
         
-        bool populateCoverageArray( int GID, Aligner& drAligner );
+        bool populateCoverageArray( int GID, 
+                                    Aligner& drAligner,
+                                    std::vector<StringToken>& unfoundedDRs );
         
         std::string calculateDRConsensus(int GID, 
                                          Aligner& drAligner, 
@@ -135,12 +184,27 @@ class WorkHorse {
                                          std::map<int, bool> refinedDREnds
                                          );
         
+        void analyseGroup( int GID, GroupConsensus& consensus);    // safe to call for different groups at once
+        
+        bool commitGroup( GroupConsensus& consensus, int * nextFreeGID);
+        
         bool parseGroupedDRs( int GID, int * nextFreeGID);
         
         int numberOfReadsInGroup(DR_Cluster * currentGroup);
         
         void cleanGroup(int GID);
         
+        //**************************************
+        // the NodeManager of each true DR
+        //**************************************
+        void makeNodeManagerChains(void);
+        
+        void runChainStep(NodeManagerChain& chain, int step);    // safe to call for different chains at once
+        
+        bool runChainCall(NodeManagerChain& chain, int step, size_t call);
+        
+        int finishChainStep(int step);
+        
         //**************************************
         // spacer graphs
         //**************************************
@@ -183,6 +247,7 @@ class WorkHorse {
     // members
         DR_List mDRs;                               // list of nodemanagers, cannonical DRs, one nodemanager per direct repeat
         ReadMap mReads;                             // reads containing possible double DRs
+        ReadStore mReadStore;                       // where the reads in mReads live
         options * mOpts;                      // search options
         std::string mOutFileDir;                    // where to spew text to
         int mMaxReadLength;                       // the average seen read length
@@ -193,6 +258,12 @@ class WorkHorse {
         std::map<int, bool> mGroupMap;				// list of valid group IDs
         DR_Cluster_Map mDR2GIDMap;					// map a DR (StringToken) to a GID
         std::map<int, std::string> mTrueDRs;		// map GId to true DR strings
+        // the NodeManager steps from building the graphs to the last checks
+        std::vector<NodeManagerChain> mChains;
+        std::vector<std::pair<int, size_t> > mChainGroupCalls;   // chain and call of every group, in group order
+        std::vector<int> mChainsByDR;               // chains in the order of mDRs
+        std::vector<int> mChainOrder;               // chains with the most reads first
+        int mChainStepsDone;
 };
 
 #endif //WorkHorse_h
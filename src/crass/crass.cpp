@@ -111,6 +111,9 @@ void usage(void)
     std::cout<< "-o --outDir          <DIR>   Output directory [default: .]"<<std::endl;
     std::cout<< "-V --version                 Program and version information"<<std::endl;
     std::cout<< "-g --logToScreen             Print the logging information to screen rather than a file"<<std::endl;
+    std::cout<< "-t --threads         <INT>   Number of threads used to search the reads, cluster the DRs, work out"<<std::endl;
+    std::cout<< "                             the true DRs and build and clean the graphs [Default: "<<CRASS_DEF_NUM_THREADS<<"]"<<std::endl;
+    std::cout<< "-B --inputBackend    <TYPE>  How uncompressed input files are read. One of mmap, readahead or zlib [Default: mmap]"<<std::endl;
     std::cout<<std::endl;
     std::cout<<"CRISPR Identification Options:"<<std::endl;
     std::cout<< "-d --minDR           <INT>   Minimim length of the direct repeat"<<std::endl; 
@@ -130,6 +133,10 @@ void usage(void)
     std::cout<< "-z --noScalling              Use the given spacer and direct repeat ranges when --removeHomopolymers is set. "<<std::endl;
     std::cout<< "                             The default is to scale the numbers by "<<CRASS_DEF_HOMOPOLYMER_SCALLING<<" or by values set using -x or -y"<<std::endl;
     std::cout<< "-H --removeHomopolymers      Correct for homopolymer errors [default: no correction]"<<std::endl;
+    std::cout<< "-E --drErrors        <INT>   Allow up to INT mismatches or indels in a direct repeat when"<<std::endl;
+    std::cout<< "                             recruiting reads with a single repeat [Default: "<<CRASS_DEF_NUM_DR_ERRORS<<", max: "<<CRASS_DEF_MAX_DR_ERRORS<<"]"<<std::endl;
+    std::cout<< "-C --readCache       <INT>   Keep reads in up to INT MB of memory between the first search and the"<<std::endl;
+    std::cout<< "                             singleton search rather than reading the files twice [Default: "<<CRASS_DEF_READ_CACHE_SIZE<<" (off)]"<<std::endl;
     std::cout<<std::endl;
     std::cout<<"CRISPR Assembly Options:"<<std::endl;
     std::cout<< "-f --covCutoff       <INT>   Remove groups with less than x spacers [Default: "<<CRASS_DEF_COVCUTOFF<<"]"<<std::endl;
@@ -207,7 +214,7 @@ int processOptions(int argc, char *argv[], options *opts)
     int c;
     int index;
     bool scalling = false;
-    while( (c = getopt_long(argc, argv, "a:b:c:d:D:ef:gGhHk:K:l:Ln:o:rs:S:Vw:x:y:z", long_options, &index)) != -1 ) 
+    while( (c = getopt_long(argc, argv, "a:b:B:c:C:d:D:eE:f:gGhHk:K:l:Ln:o:rs:S:t:Vw:x:y:z", long_options, &index)) != -1 ) 
     {
         switch(c) 
         {
@@ -250,6 +257,25 @@ int processOptions(int argc, char *argv[], options *opts)
                     exit(1);
                 }
                 break;
+            case 'B':
+                if (strcmp(optarg, "mmap") == 0) 
+                {
+                    opts->inputBackend = INPUT_MMAP;
+                } 
+                else if (strcmp(optarg, "readahead") == 0)
+                {
+                    opts->inputBackend = INPUT_READ_AHEAD;
+                }
+                else if (strcmp(optarg, "zlib") == 0)
+                {
+                    opts->inputBackend = INPUT_ZLIB;
+                }
+                else
+                {
+                    std::cerr<<PACKAGE_NAME<<" [WARNING]: Unknown input backend "<<optarg<<" changing to default input backend (mmap)"<<std::endl;
+                    opts->inputBackend = CRASS_DEF_INPUT_BACKEND;
+                }
+                break;
             case 'c': 
                 if (strcmp(optarg, "red-blue") == 0) 
                 {
@@ -273,6 +299,14 @@ int processOptions(int argc, char *argv[], options *opts)
                     opts->graphColourType = RED_BLUE;
                 }
                 break;
+            case 'C':
+                from_string<int>(opts->readCacheSize, optarg, std::dec);
+                if (opts->readCacheSize < 0) 
+                {
+                    std::cerr<<PACKAGE_NAME<<" [WARNING]: The read cache size cannot be "<<opts->readCacheSize<<" changing to "<<CRASS_DEF_READ_CACHE_SIZE<<std::endl;
+                    opts->readCacheSize = CRASS_DEF_READ_CACHE_SIZE;
+                }
+                break;
             case 'd': 
                 from_string<unsigned int>(opts->lowDRsize, optarg, std::dec);
                 if (opts->lowDRsize < 8) 
@@ -289,6 +323,14 @@ int processOptions(int argc, char *argv[], options *opts)
                 opts->noDebugGraph = true;
 #endif
                 break;
+            case 'E':
+                from_string<unsigned int>(opts->numDRErrors, optarg, std::dec);
+                if (opts->numDRErrors > CRASS_DEF_MAX_DR_ERRORS) 
+                {
+                    std::cerr<<PACKAGE_NAME<<" [WARNING]: The number of errors allowed in a direct repeat cannot be "<<opts->numDRErrors<<" changing to "<<CRASS_DEF_MAX_DR_ERRORS<<std::endl;
+                    opts->numDRErrors = CRASS_DEF_MAX_DR_ERRORS;
+                }
+                break;
             case 'f':
                 from_string<int>(opts->covCutoff, optarg, std::dec);
                 break;
@@ -374,6 +416,14 @@ int processOptions(int argc, char *argv[], options *opts)
             case 'S': 
                 from_string<unsigned int>(opts->highSpacerSize, optarg, std::dec);
                 break;
+            case 't':
+                from_string<int>(opts->numThreads, optarg, std::dec);
+                if (opts->numThreads < 1) 
+                {
+                    std::cerr<<PACKAGE_NAME<<" [WARNING]: The number of threads cannot be "<<opts->numThreads<<" changing to "<<CRASS_DEF_NUM_THREADS<<std::endl;
+                    opts->numThreads = CRASS_DEF_NUM_THREADS;
+                }
+                break;
             case 'V': 
                 versionInfo(); 
                 exit(1); 
@@ -520,6 +570,10 @@ int main(int argc, char *argv[])
     opts.layoutAlgorithm       = "unset";
 #endif
     opts.covCutoff             = CRASS_DEF_COVCUTOFF;
+    opts.numThreads            = CRASS_DEF_NUM_THREADS;                  // number of threads to use when searching reads
+    opts.readCacheSize         = CRASS_DEF_READ_CACHE_SIZE;              // MB of memory to keep unrecruited reads in for the singleton finder
+    opts.inputBackend          = CRASS_DEF_INPUT_BACKEND;                // how uncompressed input files are read
+    opts.numDRErrors           = CRASS_DEF_NUM_DR_ERRORS;                // mismatches or indels allowed in a DR when recruiting singletons
 
     int opt_idx = processOptions(argc, argv, &opts);
 
@@ -58,12 +58,15 @@ static struct option long_options [] = {
 
     {"layoutAlgorithm",required_argument,NULL,'a'},
     {"numBins",required_argument,NULL,'b'},
+    {"inputBackend",required_argument,NULL,'B'},
     {"graphColour",required_argument,NULL,'c'},
     {"minDR", required_argument, NULL, 'd'},
     {"maxDR", required_argument, NULL, 'D'},
 #ifdef DEBUG
     {"noDebugGraph",no_argument,NULL,'e'},
 #endif
+    {"drErrors",required_argument,NULL,'E'},
+    {"readCache",required_argument,NULL,'C'},
     {"covCutoff",required_argument,NULL,'f'},
     {"logToScreen", no_argument, NULL, 'g'},
     {"showSingltons",no_argument,NULL,'G'},
@@ -80,6 +83,7 @@ static struct option long_options [] = {
 #endif
     {"minSpacer", required_argument, NULL, 's'},
     {"maxSpacer", required_argument, NULL, 'S'},
+    {"threads", required_argument, NULL, 't'},
     {"version", no_argument, NULL, 'V'},
     {"windowLength", required_argument, NULL, 'w'},
     {"spacerScalling",required_argument,NULL,'x'},
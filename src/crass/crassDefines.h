@@ -66,11 +66,19 @@
 #define CRASS_DEF_KMER_SIZE                     (11)					// length of the kmers used when clustering DR groups
 #define CRASS_DEF_K_CLUST_MIN                   (6)					// number of shared kmers needed to group DR variants together
 #define CRASS_DEF_READ_COUNTER_LOGGER           (100000)
+#define CRASS_DEF_READ_BATCH_SIZE               (4096)                // number of reads handed to a search thread at a time
+#define CRASS_DEF_INFLATE_BLOCK_SIZE            (1 << 20)             // most bytes of a gzip member inflated by a worker thread in one go
+#define CRASS_DEF_READ_AHEAD_SIZE               (4 << 20)             // bytes read from disk at a time by the read ahead input backend
+#define CRASS_DEF_READ_AHEAD_CHUNKS             (4)                   // number of chunks the read ahead backend can have in flight
+#define CRASS_DEF_STRING_BLOCK_SIZE             (1 << 20)             // bytes of string storage a StringCheck grabs at a time
+#define CRASS_DEF_STRING_SHARDS                 (16)                  // number of StringChecks in a ShardedStringCheck
+#define CRASS_DEF_START_STOP_ROOM               (4)                   // spare start stops kept after each read in the ReadStore
 #define CRASS_DEF_MAX_READS_FOR_DECISION        (1000)
   // HARD CODED PARAMS FOR FINDING TRUE DRs
 #define CRASS_DEF_MIN_CONS_ARRAY_LEN            (1200)                // minimum size of the consensus array
 #define CRASS_DEF_CONS_ARRAY_RL_MULTIPLIER      (4)                   // find the cons array length by multiplying read length by this guy
 #define CRASS_DEF_CONS_ARRAY_START              (0.5)               // how far into the cons array to start placing reads 
+#define CRASS_DEF_CONSENSUS_BATCH_SIZE          (64)                  // number of groups whose true DRs are worked out at the same time
 #define CRASS_DEF_PERCENT_IN_ZONE_CUT_OFF       (0.85)              // amount that a DR must agrre with the existsing DR within a zone to be added
 #define CRASS_DEF_NUM_KMERS_4_MODE              (5)                 // find the top XX occuring in the DR
 #define CRASS_DEF_NUM_KMERS_4_MODE_HALF         (CRASS_DEF_NUM_KMERS_4_MODE - (CRASS_DEF_NUM_KMERS_4_MODE/2)) // Ceil of 50% of CRASS_DEF_NUM_KMERS_4_MODE
@@ -80,7 +88,6 @@
 #define CRASS_DEF_COLLAPSED_THRESHOLD           (0.30)              // in the event that clustering has collapsed two DRs into one, this number is used to plait them apart
 #define CRASS_DEF_PARTIAL_SIM_CUT_OFF           (0.85)              // The similarity needed to exted into partial matches
 #define CRASS_DEF_MIN_PARTIAL_LENGTH            (4)                 // The mininum length allowed for a partial direct repeat at the beginning or end of a read 
-#define CRASS_DEF_MAX_SING_PATTERNS				(5000)				// the maximum number of patterns we'll search for in a single hit
 // --------------------------------------------------------------------
  // HARD CODED PARAMS FOR DR FILTERING
 // --------------------------------------------------------------------
@@ -123,7 +130,11 @@
 #define CRASS_DEF_MIN_SPACER_SIZE               (26)                  // minimum spacer size
 #define CRASS_DEF_MAX_SPACER_SIZE               (50)                  // maximum spacer size
 #define CRASS_DEF_NUM_DR_ERRORS                 (0)                   // maxiumum allowable errors in direct repeat
+#define CRASS_DEF_MAX_DR_ERRORS                 (3)                   // upper limit for the errors allowed in a direct repeat
 #define CRASS_DEF_COVCUTOFF                     (3)                   // minimum number of attached spacers that a group needs to have
+#define CRASS_DEF_NUM_THREADS                   (1)                   // number of threads used to search the reads
+#define CRASS_DEF_READ_CACHE_SIZE               (0)                   // MB of memory for keeping reads between the search passes, 0 to re-read the files
+#define CRASS_DEF_INPUT_BACKEND                 INPUT_MMAP            // how uncompressed input files are read
 #ifdef DEBUG
     #define CRASS_DEF_MAX_LOGGING               (10)
 #else
@@ -140,6 +151,15 @@
 #define CRASS_DEF_SPACER_LONG_DESC              false               // use a long desc of the spacer in the output graph
 #define CRASS_DEF_SPACER_SHOW_SINGLES           false                // do not show singles by default
 
+// the ways an uncompressed input file can be read. Compressed files
+// always go through zlib (or the block gzip reader)
+enum INPUT_BACKEND
+{
+    INPUT_ZLIB,                                                             // gzread, the way it has always been done
+    INPUT_MMAP,                                                             // map regular files into memory, zlib for pipes
+    INPUT_READ_AHEAD                                                        // read big chunks on a second thread
+};
+
 typedef struct {
     int                 logLevel;                                           // level of verbosity allowed in the log file
     bool                reportStats;                                        // print a starts report currently not used
@@ -173,6 +193,10 @@ typedef struct {
     bool                noRendering;                                        // Even if RENDERING preprocessor macro is set do not produce any rendered images
 #endif
     int                 covCutoff;                                          // The lower bounds of acceptable numbers of reads that a group can have
+    int                 numThreads;                                         // number of threads to use when searching reads and clustering DRs
+    int                 readCacheSize;                                      // MB of memory to keep unrecruited reads in for the singleton finder
+    INPUT_BACKEND       inputBackend;                                       // how uncompressed input files are read
+    unsigned int        numDRErrors;                                        // mismatches or indels allowed in a DR when recruiting singletons
 
 } options;
 
@@ -35,33 +35,81 @@
 #include <zlib.h>
 #include "kseq.h"
 
+static int ks_gzread(void *handle, char *buf, int len)
+{
+	return gzread((gzFile)handle, buf, len);
+}
+
 kstream_t *ks_init(gzFile f)
 {
-	kstream_t *ks = (kstream_t*)calloc(1, sizeof(kstream_t));
+	kstream_t *ks = ks_init_reader(f, ks_gzread);
 	ks->f = f;
+	return ks;
+}
+
+kstream_t *ks_init_reader(void *handle, ks_read_f read)
+{
+	kstream_t *ks = (kstream_t*)calloc(1, sizeof(kstream_t));
+	ks->handle = handle;
+	ks->read = read;
 	ks->buf = (char*)malloc(4096);
 	return ks;
 }
 
+kstream_t *ks_init_view(void *handle, ks_view_f view)
+{
+	kstream_t *ks = (kstream_t*)calloc(1, sizeof(kstream_t));
+	ks->handle = handle;
+	ks->view = view;
+	return ks;
+}
+
 void ks_destroy(kstream_t *ks)
 {
 	if (ks)
 	{
-		free(ks->buf);
+		if (!ks->view)
+			free(ks->buf);
 		free(ks);
 	}
 }
 
+static void ks_fill(kstream_t *ks)
+{
+	ks->begin = 0;
+	if (ks->view)
+	{
+		/* no copy, buf points into the input */
+		ks->end = ks->view(ks->handle, &ks->buf);
+		if (ks->end <= 0)
+			ks->is_eof = 1;
+	}
+	else
+	{
+		ks->end = ks->read(ks->handle, ks->buf, 4096);
+		if (ks->end < 4096)
+			ks->is_eof = 1;
+	}
+}
+
+/* make sure there is something in the buffer, 0 at the end of the input */
+static int ks_ready(kstream_t *ks)
+{
+	if (ks->begin < ks->end)
+		return 1;
+	if (ks->is_eof)
+		return 0;
+	ks_fill(ks);
+	return ks->end > 0;
+}
+
 int ks_getc(kstream_t *ks)
 {
 	if (ks->is_eof && ks->begin >= ks->end)
 		return -1;
 	if (ks->begin >= ks->end)
 	{
-		ks->begin = 0;
-		ks->end = gzread(ks->f, ks->buf, 4096);
-		if (ks->end < 4096)
-			ks->is_eof = 1;
+		ks_fill(ks);
 		if (ks->end == 0)
 			return -1;
 	}
@@ -83,10 +131,7 @@ int ks_getuntil(kstream_t *ks, int delimiter, kstring_t *str, int *dret)
 		{
 			if (!ks->is_eof)
 			{
-				ks->begin = 0;
-				ks->end = gzread(ks->f, ks->buf, 4096);
-				if (ks->end < 4096)
-					ks->is_eof = 1;
+				ks_fill(ks);
 				if (ks->end == 0)
 					break;
 			}
@@ -150,6 +195,20 @@ kseq_t *kseq_init(gzFile fd)
 	return s;
 }
 
+kseq_t *kseq_init_reader(void *handle, ks_read_f read)
+{
+	kseq_t *s = (kseq_t*)calloc(1, sizeof(kseq_t));
+	s->f = ks_init_reader(handle, read);
+	return s;
+}
+
+kseq_t *kseq_init_view(void *handle, ks_view_f view)
+{
+	kseq_t *s = (kseq_t*)calloc(1, sizeof(kseq_t));
+	s->f = ks_init_view(handle, view);
+	return s;
+}
+
 void kseq_rewind(kseq_t *ks)
 {
 	ks->last_char = 0;
@@ -184,18 +243,38 @@ int kseq_read(kseq_t *seq)
     	return -1;
     if (c != '\n')
     	ks_getuntil(ks, '\n', &seq->comment, 0);
-    while ((c = ks_getc(ks)) != -1 && c != '>' && c != '+' && c != '@')
+    /* same as calling ks_getc until a record marker but works on a line of the buffer at a time */
+    c = -1;
+    while (ks_ready(ks))
     {
-    	if (isgraph(c))
+    	int i;
+    	char *s;
+    	/* make room for the rest of the line up front, the buffer can be huge so only go as far as the next newline */
+    	char *nl = (char*)memchr(ks->buf + ks->begin, '\n', ks->end - ks->begin);
+    	int stop = (nl) ? (int)(nl - ks->buf) + 1 : ks->end;
+    	if (seq->seq.l + (stop - ks->begin) + 1 >= seq->seq.m)
     	{
-    		if (seq->seq.l + 1 >= seq->seq.m)
-    		{
-    			seq->seq.m = seq->seq.l + 2;
-    			(--(seq->seq.m), (seq->seq.m)|=(seq->seq.m)>>1, (seq->seq.m)|=(seq->seq.m)>>2, (seq->seq.m)|=(seq->seq.m)>>4, (seq->seq.m)|=(seq->seq.m)>>8, (seq->seq.m)|=(seq->seq.m)>>16, ++(seq->seq.m));
-    			seq->seq.s = (char*)realloc(seq->seq.s, seq->seq.m);
-    		} 
-    		seq->seq.s[seq->seq.l++] = (char)c;
-    	} 
+    		seq->seq.m = seq->seq.l + (stop - ks->begin) + 2;
+    		(--(seq->seq.m), (seq->seq.m)|=(seq->seq.m)>>1, (seq->seq.m)|=(seq->seq.m)>>2, (seq->seq.m)|=(seq->seq.m)>>4, (seq->seq.m)|=(seq->seq.m)>>8, (seq->seq.m)|=(seq->seq.m)>>16, ++(seq->seq.m));
+    		seq->seq.s = (char*)realloc(seq->seq.s, seq->seq.m);
+    	}
+    	s = seq->seq.s + seq->seq.l;
+    	for (i = ks->begin; i < stop; ++i)
+    	{
+    		c = ks->buf[i];
+    		if (c == '>' || c == '+' || c == '@')
+    			break;
+    		*s = (char)c;
+    		s += (c > ' ' && c < 127);
+    	}
+    	seq->seq.l = s - seq->seq.s;
+    	if (i < stop)
+    	{
+    		ks->begin = i + 1;
+    		break;
+    	}
+    	ks->begin = stop;
+    	c = -1;
     }
     if (c == '>' || c == '@')
     	seq->last_char = c;
@@ -210,13 +289,39 @@ int kseq_read(kseq_t *seq)
 		seq->qual.s = (char*)realloc(seq->qual.s, seq->qual.m);
     }
      
-    while ((c = ks_getc(ks)) != -1 && c != '\n');
+    c = -1;
+    while (ks_ready(ks))
+    {
+        char *nl = (char*)memchr(ks->buf + ks->begin, '\n', ks->end - ks->begin);
+        if (nl)
+        {
+            ks->begin = (int)(nl - ks->buf) + 1;
+            c = '\n';
+            break;
+        }
+        ks->begin = ks->end;
+    }
      
     if (c == -1)
         return -2;
-    while ((c = ks_getc(ks)) != -1 && seq->qual.l < seq->seq.l) {
-        if (c >= 33 && c <= 127)
-            seq->qual.s[seq->qual.l++] = (unsigned char)c;
+    /* the character after the last quality value is used up as well */
+    while (ks_ready(ks))
+    {
+        int i;
+        for (i = ks->begin; i < ks->end; ++i)
+        {
+            c = ks->buf[i];
+            if (seq->qual.l >= seq->seq.l)
+                break;
+            if (c >= 33 && c <= 127)
+                seq->qual.s[seq->qual.l++] = (unsigned char)c;
+        }
+        if (i < ks->end)
+        {
+            ks->begin = i + 1;
+            break;
+        }
+        ks->begin = ks->end;
     }
     seq->qual.s[seq->qual.l] = 0;
     seq->last_char = 0;
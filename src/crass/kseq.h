@@ -37,11 +37,21 @@
 #include <stdlib.h>
 #include <zlib.h>
 
+/* reads up to len bytes into buf, must only return less than len at the end of the input */
+typedef int (*ks_read_f)(void *handle, char *buf, int len);
+
+/* points *buf at the next chunk of input and returns its length, 0 at the end of the input.
+   The chunk is only read from and must stay valid until the next call */
+typedef int (*ks_view_f)(void *handle, char **buf);
+
 typedef struct //__kstream_t
 {
 	char *buf;
 	int begin, end, is_eof;
 	gzFile f;
+	void *handle;
+	ks_read_f read;
+	ks_view_f view;
 } kstream_t;
 
 typedef struct //__kstring_t
@@ -59,6 +69,10 @@ typedef struct
 
 kstream_t *ks_init(gzFile f);
 
+kstream_t *ks_init_reader(void *handle, ks_read_f read);
+
+kstream_t *ks_init_view(void *handle, ks_view_f view);
+
 void ks_destroy(kstream_t *ks);
 
 int ks_getc(kstream_t *ks);
@@ -67,6 +81,10 @@ int ks_getuntil(kstream_t *ks, int delimiter, kstring_t *str, int *dret);
 
 kseq_t *kseq_init(gzFile fd);
 
+kseq_t *kseq_init_reader(void *handle, ks_read_f read);
+
+kseq_t *kseq_init_view(void *handle, ks_view_f view);
+
 void kseq_rewind(kseq_t *ks);
 
 void kseq_destroy(kseq_t *ks);
@@ -46,6 +46,7 @@
 #include <cmath>
 #include <fcntl.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <exception>
 #include <libcrispr/StlExt.h>
 #include <libcrispr/Exception.h>
@@ -54,21 +55,400 @@
 #include "libcrispr.h"
 #include "LoggerSimp.h"
 #include "crassDefines.h"
-#include "WuManber.h"
+#include "MultiPatternSearch.h"
 #include "PatternMatcher.h"
 #include "SeqUtils.h"
+#include "PackedKmer.h"
 #include "kseq.h"
+#include "SeqInput.h"
+#include "ThreadPool.h"
 #include "config.h"
 
 #define longReadCut(d,s) ((4 * d) + (3 * s))
 #define shortReadCut(d,s) ((2 * d) + s)
 
+// reads are passed between the threads of the search pipeline in batches.
+// a non-empty string in foundRepeats marks a read that holds a CRISPR
+typedef struct {
+    unsigned long               batchNumber;                                // position of this batch in the file
+    std::vector<ReadHolder>     reads;                                      // the reads in file order
+    std::vector<std::string>    rawSequences;                               // unsqueezed reads, only kept for the read cache
+    std::vector<std::string>    foundRepeats;                               // the DR that went into the patterns hash for each read
+    int                         maxReadLength;                              // longest read in the batch
+    std::string                 error;                                      // set if the search threw on any read
+} ReadBatch;
+
+typedef std::map<unsigned long, ReadBatch *> ReadBatchMap;
+
+class SearchPipeline
+{
+    //-----
+    // State shared by the reader thread, the search workers and the
+    // thread that merges the results. Batches are searched in any order
+    // but merged strictly in file order so that tokens and read lists
+    // come out exactly as they do in a single threaded run
+    //
+    public:
+        SearchPipeline(kseq_t * seq, const options& opts, int numWorkers, bool keepRawSequences) :
+            SP_Seq(seq),
+            SP_Opts(opts),
+            SP_KeepRawSequences(keepRawSequences),
+            SP_Todo(2 * numWorkers),
+            SP_Window(4 * numWorkers),
+            SP_NextToMerge(0),
+            SP_NumBatches(0),
+            SP_ReaderFinished(false),
+            SP_Aborted(false)
+        {}
+
+        kseq_t * SP_Seq;
+        const options& SP_Opts;
+        bool SP_KeepRawSequences;                                           // the search will squeeze the reads but the cache needs them as they were
+        WorkQueue<ReadBatch *> SP_Todo;                                     // batches waiting to be searched
+        unsigned long SP_Window;                                            // how far the reader may run ahead of the merge
+
+        Mutex SP_Mutex;                                                     // guards everything below
+        Condition SP_BatchDone;
+        Condition SP_BatchMerged;
+        ReadBatchMap SP_Done;                                               // searched batches waiting to be merged
+        unsigned long SP_NextToMerge;
+        unsigned long SP_NumBatches;
+        bool SP_ReaderFinished;
+        bool SP_Aborted;
+        std::string SP_ReaderError;                                         // set if the reader stopped between batches
+};
+
+class SearchReaderTask : public ThreadTask
+{
+    public:
+        SearchReaderTask(SearchPipeline * pipeline) : mPipeline(pipeline) {}
+
+        void run(int)
+        {
+            //-----
+            // whatever happens the merge has to hear that the reader is done
+            //
+            std::string error;
+            try {
+                readBatches();
+            } catch (std::exception& e) {
+                error = e.what();
+            } catch (...) {
+                error = "Unknown error while reading the sequence file";
+            }
+            mPipeline->SP_Todo.close();
+            ScopedLock lock(mPipeline->SP_Mutex);
+            mPipeline->SP_ReaderError = error;
+            mPipeline->SP_ReaderFinished = true;
+            mPipeline->SP_BatchDone.broadcast();
+        }
+
+    private:
+        void readBatches(void)
+        {
+            //-----
+            // parse the file into batches and queue them for the workers
+            //
+            int l;
+            bool more_reads = true;
+            while (more_reads)
+            {
+                unsigned long batch_number;
+                {
+                    // don't get too far ahead of the merge
+                    ScopedLock lock(mPipeline->SP_Mutex);
+                    while (!mPipeline->SP_Aborted && 
+                           mPipeline->SP_NumBatches - mPipeline->SP_NextToMerge >= mPipeline->SP_Window)
+                    {
+                        mPipeline->SP_BatchMerged.wait(mPipeline->SP_Mutex);
+                    }
+                    if (mPipeline->SP_Aborted)
+                    {
+                        break;
+                    }
+                    batch_number = mPipeline->SP_NumBatches;
+                }
+
+                ReadBatch * batch = new ReadBatch();
+                batch->batchNumber = batch_number;
+                batch->maxReadLength = 0;
+                kseq_t * seq = mPipeline->SP_Seq;
+                // a bad input file or running out of memory, the merge
+                // will stop at this batch
+                try {
+                    batch->reads.reserve(CRASS_DEF_READ_BATCH_SIZE);
+                    while (batch->reads.size() < CRASS_DEF_READ_BATCH_SIZE)
+                    {
+                        l = kseq_read(seq);
+                        if (l < 0)
+                        {
+                            more_reads = false;
+                            break;
+                        }
+                        batch->maxReadLength = (l > batch->maxReadLength) ? l : batch->maxReadLength;
+                        batch->reads.push_back(ReadHolder());
+                        ReadHolder& tmp_holder = batch->reads.back();
+                        tmp_holder.setSequence(seq->seq.s);tmp_holder.setHeader( seq->name.s);
+                        if (seq->comment.s) 
+                        {
+                            tmp_holder.setComment(seq->comment.s);
+                        }
+                        if (seq->qual.s) 
+                        {
+                            tmp_holder.setQual(seq->qual.s);
+                        }
+                        if (mPipeline->SP_KeepRawSequences)
+                        {
+                            batch->rawSequences.push_back(seq->seq.s);
+                        }
+                    }
+                } catch (std::exception& e) {
+                    batch->error = e.what();
+                    more_reads = false;
+                } catch (...) {
+                    batch->error = "Unknown error while reading the sequence file";
+                    more_reads = false;
+                }
+                if (batch->reads.empty() && batch->error.empty())
+                {
+                    delete batch;
+                    break;
+                }
+                {
+                    ScopedLock lock(mPipeline->SP_Mutex);
+                    mPipeline->SP_NumBatches++;
+                }
+                if (!mPipeline->SP_Todo.push(batch))
+                {
+                    // aborted while we were waiting
+                    delete batch;
+                    break;
+                }
+            }
+        }
+
+    private:
+        SearchPipeline * mPipeline;
+};
+
+class SearchWorkerTask : public ThreadTask
+{
+    public:
+        SearchWorkerTask(SearchPipeline * pipeline) : mPipeline(pipeline) {}
+
+        void run(int)
+        {
+            ReadBatch * batch;
+            while (mPipeline->SP_Todo.pop(batch))
+            {
+                batch->foundRepeats.resize(batch->reads.size());
+                std::vector<ReadHolder>::iterator read_iter = batch->reads.begin();
+                std::vector<std::string>::iterator found_iter = batch->foundRepeats.begin();
+                try {
+                    while (batch->error.empty() && read_iter != batch->reads.end())
+                    {
+                        searchRead(*read_iter, mPipeline->SP_Opts, *found_iter);
+                        read_iter++;
+                        found_iter++;
+                    }
+                } catch (std::exception& e) {
+                    batch->error = e.what();
+                } catch (...) {
+                    batch->error = "Unknown error while searching the reads";
+                }
+                ScopedLock lock(mPipeline->SP_Mutex);
+                mPipeline->SP_Done[batch->batchNumber] = batch;
+                mPipeline->SP_BatchDone.broadcast();
+            }
+        }
+
+    private:
+        SearchPipeline * mPipeline;
+};
+
+static void cacheUnrecruitedRead(ReadCache * readCache,
+                                 const char * header,
+                                 const char * comment,
+                                 const char * sequence,
+                                 const char * quality)
+{
+    //-----
+    // keep a read for the singleton finder, say so when the cache fills up
+    //
+    if (NULL == readCache || !readCache->isValid())
+    {
+        return;
+    }
+    if (!readCache->add(header, comment, sequence, quality))
+    {
+        logInfo("Read cache is over its memory limit, singletons will be found by re-reading the input files", 1);
+    }
+}
+
+static void printSearchProgress(int readCounter, time_t& timeStart)
+{
+    time_t time_current;
+    time(&time_current);
+    double diff = difftime(time_current, timeStart);
+    std::cout<<"\r["<<PACKAGE_NAME<<"_patternFinder]: "
+             << "Processed "<<readCounter<<" ...";
+    std::cout<<diff<<" sec"<<std::flush;
+}
+
+static int threadedSearch(kseq_t * seq,
+                          unsigned int fileIndex,
+                          const options& opts, 
+                          ReadMap * mReads, 
+                          StringCheck * mStringCheck, 
+                          ReadStore * mReadStore,
+                          lookupTable& patternsHash, 
+                          ReadOrdinalSet& readsFound,
+                          ReadCache * readCache,
+                          time_t& timeStart,
+                          int& readCounter)
+{
+    //-----
+    // One thread reads, opts.numThreads threads search and this 
+    // thread merges the results back in file order
+    //
+    bool keep_raw_sequences = (NULL != readCache && readCache->isValid() && opts.removeHomopolymers);
+    SearchPipeline pipeline(seq, opts, opts.numThreads, keep_raw_sequences);
+    SearchReaderTask reader_task(&pipeline);
+    SearchWorkerTask worker_task(&pipeline);
+    ThreadPool reader(1);
+    ThreadPool workers(opts.numThreads);
+    reader.start(&reader_task);
+    workers.start(&worker_task);
+
+    int max_read_length = 0;
+    int log_counter = 0;
+    uint64_t read_ordinal = 0;
+    std::string error;
+    while (true)
+    {
+        ReadBatch * batch = NULL;
+        {
+            ScopedLock lock(pipeline.SP_Mutex);
+            ReadBatchMap::iterator done_iter;
+            while ((done_iter = pipeline.SP_Done.find(pipeline.SP_NextToMerge)) == pipeline.SP_Done.end())
+            {
+                // a reader that failed between batches may never send
+                // the last batch it counted
+                if (pipeline.SP_ReaderFinished && 
+                    (pipeline.SP_NextToMerge >= pipeline.SP_NumBatches || !pipeline.SP_ReaderError.empty()))
+                {
+                    error = pipeline.SP_ReaderError;
+                    break;
+                }
+                pipeline.SP_BatchDone.wait(pipeline.SP_Mutex);
+            }
+            if (done_iter == pipeline.SP_Done.end())
+            {
+                // nothing left
+                break;
+            }
+            batch = done_iter->second;
+            pipeline.SP_Done.erase(done_iter);
+        }
+
+        if (!batch->error.empty())
+        {
+            error = batch->error;
+            delete batch;
+            break;
+        }
+        
+        try {
+            for (size_t i = 0; i < batch->reads.size(); i++)
+            {
+                ReadHolder& tmp_holder = batch->reads[i];
+                if (!batch->foundRepeats[i].empty())
+                {
+                    recordFoundRead(tmp_holder, 
+                                    batch->foundRepeats[i], 
+                                    mReads, 
+                                    mStringCheck, 
+                                    mReadStore, 
+                                    patternsHash, 
+                                    readsFound,
+                                    fileIndex,
+                                    read_ordinal + i);
+                }
+                else if (NULL != readCache && readCache->isValid())
+                {
+                    cacheUnrecruitedRead(readCache,
+                                         tmp_holder.getHeader().c_str(),
+                                         tmp_holder.getComment().c_str(),
+                                         (keep_raw_sequences) ? batch->rawSequences[i].c_str() : tmp_holder.getSeq().c_str(),
+                                         (tmp_holder.getIsFasta()) ? NULL : tmp_holder.getQual().c_str());
+                }
+            }
+        } catch (std::exception& e) {
+            error = e.what();
+            delete batch;
+            break;
+        }
+        max_read_length = (batch->maxReadLength > max_read_length) ? batch->maxReadLength : max_read_length;
+        read_ordinal += batch->reads.size();
+        readCounter += static_cast<int>(batch->reads.size());
+        log_counter += static_cast<int>(batch->reads.size());
+        if (log_counter >= CRASS_DEF_READ_COUNTER_LOGGER) 
+        {
+            printSearchProgress(readCounter, timeStart);
+            log_counter = 0;
+        }
+        delete batch;
+        
+        ScopedLock lock(pipeline.SP_Mutex);
+        pipeline.SP_NextToMerge++;
+        pipeline.SP_BatchMerged.signal();
+    }
+    
+    if (!error.empty())
+    {
+        // stop the reader and throw away anything that hasn't been searched
+        {
+            ScopedLock lock(pipeline.SP_Mutex);
+            pipeline.SP_Aborted = true;
+            pipeline.SP_BatchMerged.broadcast();
+        }
+        std::vector<ReadBatch *> left_overs;
+        pipeline.SP_Todo.abort(left_overs);
+        std::vector<ReadBatch *>::iterator left_iter;
+        for (left_iter = left_overs.begin(); left_iter != left_overs.end(); left_iter++)
+        {
+            delete *left_iter;
+        }
+    }
+    reader.join();
+    workers.join();
+    
+    // only batches searched after an error can be left
+    ReadBatchMap::iterator done_iter;
+    for (done_iter = pipeline.SP_Done.begin(); done_iter != pipeline.SP_Done.end(); done_iter++)
+    {
+        delete done_iter->second;
+    }
+    
+    if (!error.empty())
+    {
+        throw crispr::exception(__FILE__, 
+                                __LINE__, 
+                                __PRETTY_FUNCTION__,
+                                error.c_str());
+    }
+    return max_read_length;
+}
+
 int decideWhichSearch(const char *inputFastq, 
+                      unsigned int fileIndex,
                       const options& opts, 
                       ReadMap * mReads, 
                       StringCheck * mStringCheck, 
+                      ReadStore * mReadStore,
                       lookupTable& patternsHash, 
-                      lookupTable& readsFound,
+                      ReadOrdinalSet& readsFound,
+                      ReadCache * readCache,
                       time_t& time_start
                       )
 
@@ -78,33 +458,50 @@ int decideWhichSearch(const char *inputFastq,
     // depending on the length of the read. 
 	// this funciton may use the boyer moore algorithm
     // or the CRT search algorithm
+    // Reads without a CRISPR are kept in the read cache (if any)
     //
-    gzFile fp = getFileHandle(inputFastq);
-    kseq_t * seq;
-
-    // initialize seq
-    seq = kseq_init(fp);
+    SeqInput input(inputFastq, opts);
+    kseq_t * seq = input.seq();
     
     int l, log_counter, max_read_length;
     log_counter = max_read_length = 0;
     static int read_counter = 0;
-    time_t time_current;
+    uint64_t read_ordinal = 0;
     
-    int long_read_cutoff = longReadCut(opts.lowDRsize, opts.lowSpacerSize);
-    int short_read_cutoff = shortReadCut(opts.lowDRsize, opts.lowSpacerSize);
+#if !SEARCH_SINGLETON
+    // the search checker changes the log level per read so it 
+    // only works with the single threaded search
+    if (opts.numThreads > 1)
+    {
+        try {
+            max_read_length = threadedSearch(seq, 
+                                             fileIndex,
+                                             opts, 
+                                             mReads, 
+                                             mStringCheck, 
+                                             mReadStore, 
+                                             patternsHash, 
+                                             readsFound, 
+                                             readCache,
+                                             time_start, 
+                                             read_counter);
+        } catch (crispr::exception& e) {
+            std::cerr<<e.what()<<std::endl;
+            throw crispr::exception(__FILE__, 
+                                    __LINE__, 
+                                    __PRETTY_FUNCTION__,
+                                    "Fatal error in search algorithm!");
+        }
+    }
+    else
+#endif
     // read sequence  
     while ( (l = kseq_read(seq)) >= 0 ) 
     {
         max_read_length = (l > max_read_length) ? l : max_read_length;
         if (log_counter == CRASS_DEF_READ_COUNTER_LOGGER) 
         {
-            time(&time_current);
-            double diff = difftime(time_current, time_start);
-            //time_start = time_current;
-
-            std::cout<<"\r["<<PACKAGE_NAME<<"_patternFinder]: "
-					 << "Processed "<<read_counter<<" ...";
-            std::cout<<diff<<" sec"<<std::flush;
+            printSearchProgress(read_counter, time_start);
             log_counter = 0;
         }
         try {
@@ -130,35 +527,25 @@ int decideWhichSearch(const char *inputFastq,
                 tmp_holder.setQual(seq->qual.s);
             }
             
-            if (opts.removeHomopolymers)
+            std::string found_repeat;
+            if (searchRead(tmp_holder, opts, found_repeat))
             {
-                // RLE is necessary...
-                tmp_holder.encode();
-                // update the value of l based on if we arre removing homopolymers
-                l = static_cast<int>(tmp_holder.getSeq().length());
-            }
-
-            if (l > long_read_cutoff) {
-                // perform long read seqrch
-                longReadSearch(tmp_holder, 
-                               opts, 
-                               mReads, 
-                               mStringCheck, 
-                               patternsHash, 
-                               readsFound);
-            } else if (l >= short_read_cutoff){
-                // perform short read search
-                shortReadSearch(tmp_holder, 
-                                opts, 
+                recordFoundRead(tmp_holder, 
+                                found_repeat, 
                                 mReads, 
                                 mStringCheck, 
+                                mReadStore, 
                                 patternsHash, 
-                                readsFound);
-            } 
+                                readsFound,
+                                fileIndex,
+                                read_ordinal);
+            }
+            else
+            {
+                cacheUnrecruitedRead(readCache, seq->name.s, seq->comment.s, seq->seq.s, seq->qual.s);
+            }
         } catch (crispr::exception& e) {
             std::cerr<<e.what()<<std::endl;
-            kseq_destroy(seq);
-            gzclose(fp);
             throw crispr::exception(__FILE__, 
                                     __LINE__, 
                                     __PRETTY_FUNCTION__,
@@ -166,22 +553,223 @@ int decideWhichSearch(const char *inputFastq,
         }
         log_counter++;
         read_counter++;
+        read_ordinal++;
     }
     
-    kseq_destroy(seq); // destroy seq
-    gzclose(fp);
-    
     logInfo("finished processing file:"<<inputFastq, 1);    
-    time(&time_current);
-    double diff = difftime(time_current, time_start);
-    //time_start = time_current;
-    std::cout<<"\r["<<PACKAGE_NAME<<"_patternFinder]: "<< "Processed "<<read_counter<<" ...";
-    std::cout<<diff<<" sec"<<std::flush;
+    printSearchProgress(read_counter, time_start);
     logInfo("So far " << mReads->size()<<" direct repeat variants have been found from " << read_counter << " reads", 2);
 
     return max_read_length;
 }
 
+bool searchRead(ReadHolder& tmpHolder, 
+                const options& opts, 
+                std::string& foundRepeat)
+{
+    //-----
+    // Pick the search that suits the length of this read. Only touches
+    // the read itself so it is safe to call from many threads
+    //
+    if (opts.removeHomopolymers)
+    {
+        // RLE is necessary...
+        tmpHolder.encode();
+    }
+    
+    // the length after any homopolymers have been removed
+    int l = static_cast<int>(tmpHolder.getSeqLength());
+    if (l > static_cast<int>(longReadCut(opts.lowDRsize, opts.lowSpacerSize))) 
+    {
+        // perform long read seqrch
+        return longReadSearch(tmpHolder, opts, foundRepeat);
+    } 
+    else if (l >= static_cast<int>(shortReadCut(opts.lowDRsize, opts.lowSpacerSize)))
+    {
+        // perform short read search
+        return shortReadSearch(tmpHolder, opts, foundRepeat);
+    }
+    return false;
+}
+
+void recordFoundRead(ReadHolder& tmpHolder, 
+                     std::string& foundRepeat, 
+                     ReadMap * mReads, 
+                     StringCheck * mStringCheck, 
+                     ReadStore * mReadStore,
+                     lookupTable& patternsHash, 
+                     ReadOrdinalSet& readsFound,
+                     unsigned int fileIndex,
+                     uint64_t readOrdinal)
+{
+    //-----
+    // Add a read that passed one of the searches to the global data
+    //
+    addReadHolder(mReads, mStringCheck, mReadStore, tmpHolder);
+    patternsHash[foundRepeat] = true;
+    readsFound.add(fileIndex, readOrdinal);
+}
+
+
+static void packKmers(const std::string& read,
+                      unsigned int kmerLength,
+                      std::vector<int>& codes)
+{
+    //-----
+    // Pack every kmer in the read two bits a base so that windows can be
+    // compared as ints. Kmers with anything other than upper case ACGT in
+    // them are rare and are marked with -1
+    //
+    int read_length = static_cast<int>(read.length());
+    int num_kmers = read_length - static_cast<int>(kmerLength) + 1;
+    codes.assign((num_kmers > 0) ? num_kmers : 0, -1);
+
+    RollingKmer rolling_kmer(kmerLength);
+    for (int i = 0; i < read_length; i++)
+    {
+        if (rolling_kmer.push(read[i]))
+        {
+            codes[i - kmerLength + 1] = static_cast<int>(rolling_kmer.forward());
+        }
+    }
+}
+
+static int findKmerRepeat(const std::string& read,
+                          const std::vector<int>& codes,
+                          unsigned int kmerLength,
+                          unsigned int kmerStart,
+                          unsigned int searchBegin,
+                          unsigned int searchEnd)
+{
+    //-----
+    // The leftmost copy of the kmer at kmerStart that lies completely within
+    // [searchBegin, searchEnd) or -1. Gives the same answer as a bmpSearch
+    // of that part of the read
+    //
+    if (searchEnd < searchBegin + kmerLength)
+    {
+        return -1;
+    }
+    unsigned int last = searchEnd - kmerLength;
+    int code = codes[kmerStart];
+    if (code >= 0)
+    {
+        for (unsigned int q = searchBegin; q <= last; q++)
+        {
+            if (codes[q] == code)
+            {
+                return static_cast<int>(q);
+            }
+        }
+    }
+    else
+    {
+        for (unsigned int q = searchBegin; q <= last; q++)
+        {
+            if (0 == read.compare(q, kmerLength, read, kmerStart, kmerLength))
+            {
+                return static_cast<int>(q);
+            }
+        }
+    }
+    return -1;
+}
+
+static void findRepeatedKmers(const std::string& read,
+                              unsigned int kmerLength,
+                              unsigned int minGap,
+                              std::vector<int>& nextRepeat)
+{
+    //-----
+    // For every kmer start j in the read find the leftmost start of the same
+    // kmer at or after j + minGap, or -1 if there isn't one. The kmers are
+    // rolling hashed and the read is swept right to left remembering the
+    // leftmost position of every hash seen so far, so the whole read is done
+    // in linear time. Hits are checked against the read so a hash collision
+    // can only ever cost a direct search
+    //
+    int read_length = static_cast<int>(read.length());
+    int num_kmers = read_length - static_cast<int>(kmerLength) + 1;
+    nextRepeat.assign((num_kmers > 0) ? num_kmers : 0, -1);
+    if (num_kmers <= static_cast<int>(minGap))
+    {
+        return;
+    }
+
+    const uint64_t base = 0x100000001b3ULL;
+    uint64_t top_power = 1;
+    for (unsigned int i = 1; i < kmerLength; i++)
+    {
+        top_power *= base;
+    }
+    std::vector<uint64_t> hashes(num_kmers);
+    uint64_t hash = 0;
+    for (int i = 0; i < read_length; i++)
+    {
+        if (i >= static_cast<int>(kmerLength))
+        {
+            hash -= top_power * static_cast<unsigned char>(read[i - kmerLength]);
+        }
+        hash = hash * base + static_cast<unsigned char>(read[i]);
+        if (i >= static_cast<int>(kmerLength) - 1)
+        {
+            hashes[i - kmerLength + 1] = hash;
+        }
+    }
+
+    // open addressing, hash -> leftmost position so far
+    size_t table_size = 1;
+    while (table_size < 2 * static_cast<size_t>(num_kmers))
+    {
+        table_size <<= 1;
+    }
+    std::vector<uint64_t> table_hashes(table_size);
+    std::vector<int> table_positions(table_size, -1);
+
+    for (int p = num_kmers - 1; p >= 0; p--)
+    {
+        size_t slot = static_cast<size_t>(hashes[p] ^ (hashes[p] >> 29)) & (table_size - 1);
+        while (table_positions[slot] != -1 && table_hashes[slot] != hashes[p])
+        {
+            slot = (slot + 1) & (table_size - 1);
+        }
+        table_hashes[slot] = hashes[p];
+        table_positions[slot] = p;
+
+        // everything at or after j + minGap is in the table now
+        int j = p - static_cast<int>(minGap);
+        if (j < 0)
+        {
+            continue;
+        }
+        slot = static_cast<size_t>(hashes[j] ^ (hashes[j] >> 29)) & (table_size - 1);
+        while (table_positions[slot] != -1 && table_hashes[slot] != hashes[j])
+        {
+            slot = (slot + 1) & (table_size - 1);
+        }
+        int candidate = table_positions[slot];
+        if (candidate == -1)
+        {
+            continue;
+        }
+        if (0 == read.compare(candidate, kmerLength, read, j, kmerLength))
+        {
+            nextRepeat[j] = candidate;
+        }
+        else
+        {
+            // collision, the first position with this hash is someone else
+            for (int q = p; q < num_kmers; q++)
+            {
+                if (0 == read.compare(q, kmerLength, read, j, kmerLength))
+                {
+                    nextRepeat[j] = q;
+                    break;
+                }
+            }
+        }
+    }
+}
 
 // CRT search
 int scanRight(ReadHolder&  tmp_holder, 
@@ -279,12 +867,9 @@ int scanRight(ReadHolder&  tmp_holder,
     return begin_search + position;
 }
 
-int longReadSearch(ReadHolder& tmpHolder, 
-                   const options& opts, 
-                   ReadMap * mReads, 
-                   StringCheck * mStringCheck, 
-                   lookupTable& patternsHash, 
-                   lookupTable& readsFound)
+bool longReadSearch(ReadHolder& tmpHolder, 
+                    const options& opts, 
+                    std::string& foundRepeat)
 {
     //-----
     // Code lifted from CRT, ported by Connor and hacked by Mike.
@@ -313,9 +898,13 @@ int longReadSearch(ReadHolder& tmpHolder,
     {
         logError("Read: "<<tmpHolder.getHeader()<<" length is less than "<<opts.highDRsize + opts.highSpacerSize + opts.searchWindowLength + 1<<"bp");
         //delete tmpHolder;
-        return 1;
+        return false;
     }
     
+    // the windows are compared as packed kmers rather than searched for
+    std::vector<int> kmer_codes;
+    packKmers(read, opts.searchWindowLength, kmer_codes);
+    
     for (unsigned int j = 0; j <= static_cast<unsigned int>(searchEnd); j = j + skips)
     {
                     
@@ -332,38 +921,32 @@ int longReadSearch(ReadHolder& tmpHolder,
             endSearch = beginSearch;
         }
         
-        std::string text;
-        std::string pattern;
-        try {
-            text = read.substr(beginSearch, (endSearch - beginSearch));
-
-        } catch (std::exception& e) {
-            throw crispr::substring_exception(e.what(), 
-                                              text.c_str(), 
-                                              beginSearch, 
-                                              (endSearch - beginSearch), 
-                                              __FILE__, 
-                                              __LINE__, 
-                                              __PRETTY_FUNCTION__);
-        }
-        try {
-            pattern = read.substr(j, opts.searchWindowLength);
-        } catch (std::exception& e) {
-            throw crispr::substring_exception(e.what(), 
-                                              read.c_str(), 
-                                              j, 
-                                              opts.searchWindowLength, 
-                                              __FILE__, 
-                                              __LINE__, 
-                                              __PRETTY_FUNCTION__);
-        }
-
         //if pattern is found, add it to candidate list and scan right for additional similarly spaced repeats
-        int pattern_in_text_index = -1;
-            pattern_in_text_index = PatternMatcher::bmpSearch(text, pattern);
+        int pattern_in_text_index = findKmerRepeat(read, 
+                                                   kmer_codes, 
+                                                   opts.searchWindowLength, 
+                                                   j, 
+                                                   beginSearch, 
+                                                   endSearch);
+        if (pattern_in_text_index >= 0)
+        {
+            pattern_in_text_index -= static_cast<int>(beginSearch);
+        }
 
         if (pattern_in_text_index >= 0)
         {
+            std::string pattern;
+            try {
+                pattern = read.substr(j, opts.searchWindowLength);
+            } catch (std::exception& e) {
+                throw crispr::substring_exception(e.what(), 
+                                                  read.c_str(), 
+                                                  j, 
+                                                  opts.searchWindowLength, 
+                                                  __FILE__, 
+                                                  __LINE__, 
+                                                  __PRETTY_FUNCTION__);
+            }
             tmpHolder.startStopsAdd(j,  j + opts.searchWindowLength);
             unsigned int found_pattern_start_index = beginSearch + static_cast<unsigned int>(pattern_in_text_index);
             
@@ -408,18 +991,13 @@ int longReadSearch(ReadHolder& tmpHolder,
                     logInfo("-------------------", 7)
 #endif                            
 
-                    //ReadHolder * candidate_read = new ReadHolder();
-                    //*candidate_read = *tmp_holder;
-                    //addReadHolder(mReads, mStringCheck, candidate_read);
-                    addReadHolder(mReads, mStringCheck, tmpHolder);
                     //match_found = true;
 					if(opts.removeHomopolymers) {
-							patternsHash[encoded_repeat] = true;
+							foundRepeat = encoded_repeat;
 						} else {
-							patternsHash[tmpHolder.repeatStringAt(0)] = true;
+							foundRepeat = tmpHolder.repeatStringAt(0);
 						}
-                    readsFound[tmpHolder.getHeader()] = true;
-                    break;
+                    return true;
                 }
             }
 #ifdef DEBUG                
@@ -432,15 +1010,12 @@ int longReadSearch(ReadHolder& tmpHolder,
         }
         tmpHolder.clearStartStops();
     }
-    return 0;
+    return false;
 }
 
-int shortReadSearch(ReadHolder&  tmpHolder, 
-                    const options &opts, 
-                    ReadMap * mReads, 
-                    StringCheck * mStringCheck, 
-                    lookupTable &patternsHash, 
-                    lookupTable &readsFound)
+bool shortReadSearch(ReadHolder&  tmpHolder, 
+                     const options &opts, 
+                     std::string& foundRepeat)
 {
 
     //bool match_found = false;
@@ -452,35 +1027,26 @@ int shortReadSearch(ReadHolder&  tmpHolder,
     unsigned int final_index = seq_length - 1;
     
     
-    // boyer-moore search
+    // where each kmer is next repeated far enough away to be a DR
+    std::vector<int> next_repeat;
+    findRepeatedKmers(read, 
+                      opts.lowDRsize, 
+                      opts.lowDRsize + opts.lowSpacerSize, 
+                      next_repeat);
+
     for (unsigned int first_start = 0; first_start < search_end; first_start++)
     {
         unsigned int search_begin = first_start + opts.lowDRsize + opts.lowSpacerSize;
         
         if (search_begin >= search_end ) break;
         
-        // do the search
-        int second_start = -1;
-
-        try {
-            second_start = PatternMatcher::bmpSearch(read.substr(search_begin), 
-                                                     read.substr(first_start, opts.lowDRsize) );
-        } catch (std::exception& e) {
-
-			std::stringstream ss;
-            ss<<read<<"\n";
-            ss<<search_begin<<" : "<<first_start<<" : "<<opts.lowDRsize;
-            throw crispr::runtime_exception( __FILE__, 
-                                    __LINE__, 
-                                    __PRETTY_FUNCTION__, 
-                                    ss);
-        }
+        // the leftmost copy at or after search_begin
+        int second_start = next_repeat[first_start];
 
         // check to see if we found something
         if (second_start > -1) 
         {
             // bingo!
-            second_start += search_begin;
             unsigned int second_end = static_cast<unsigned int>(second_start + opts.lowDRsize);
             unsigned int first_end = first_start + opts.lowDRsize;
 
@@ -546,13 +1112,11 @@ int shortReadSearch(ReadHolder&  tmpHolder,
                         logInfo("-------------------", 7)
 #endif
 						if(opts.removeHomopolymers) {
-							patternsHash[encoded_repeat] = true;
+							foundRepeat = encoded_repeat;
 						} else {
-							patternsHash[tmpHolder.repeatStringAt(0)] = true;
+							foundRepeat = tmpHolder.repeatStringAt(0);
 						}
-                        readsFound[tmpHolder.getHeader()] = true;
-                        addReadHolder(mReads, mStringCheck, tmpHolder);
-                        break;
+                        return true;
                     }
                 }
 #ifdef DEBUG
@@ -571,147 +1135,156 @@ int shortReadSearch(ReadHolder&  tmpHolder,
             first_start = tmpHolder.back();
         }
     }
-    return 0;
+    return false;
 }
 
 
-void findSingletons(const char *inputFastq, 
-                    const options &opts, 
-                    std::vector<std::string> * nonRedundantPatterns, 
-                    lookupTable &readsFound, 
-                    ReadMap * mReads, 
-                    StringCheck * mStringCheck,
-                    time_t& startTime)
-
+static bool recruitSingleton(ReadHolder& tmpHolder,
+                             const options &opts,
+                             const MultiPatternSearch& patternSearch,
+                             const std::vector<std::string>& patterns,
+                             ReadMap * mReads,
+                             StringCheck * mStringCheck,
+                             ReadStore * mReadStore)
 {
     //-----
-    // given a potentially large set of patterns, call an innefficent function
-    // on a possible broken down subset
+    // search one read for all the patterns, add it if it holds one.
+    // The caller makes sure it wasn't already found in the first pass
     //
-	if (nonRedundantPatterns->empty())
-	{
-
-		throw crispr::runtime_exception(__FILE__,
-		                                __LINE__,
-		                                __PRETTY_FUNCTION__,
-		                                "No patterns in vector for multimatch");
-	}
-
-
-    // If the patterns vector is too long, we'll need to break it up!
-    // in any case, we need to pass through a vector of vectors
-    std::vector<std::vector<std::string> * > vec_vec_patterns;
-    int cut_start = 0;
-    int cut_length = CRASS_DEF_MAX_SING_PATTERNS;
-    int total_pattern_size = static_cast<int>(nonRedundantPatterns->size());
-    std::vector<std::string>::iterator start_iter, end_iter;
-    while(total_pattern_size > 0)
+    if (opts.removeHomopolymers) 
     {
-        if(total_pattern_size <  cut_length)
-        {
-            cut_length = total_pattern_size;
-        }
-        
-        // in the second last iteration, we should check to
-        // see if halving is a better option
-        if((total_pattern_size < 2 * CRASS_DEF_MAX_SING_PATTERNS) && (total_pattern_size > CRASS_DEF_MAX_SING_PATTERNS))
-        {
-            // in most cases, halving is a better option
-            cut_length = (int)(total_pattern_size/2);
-        }
-        
-        // make out iterators
-        start_iter = nonRedundantPatterns->begin() + cut_start;
-        end_iter = start_iter + cut_length;
-        
-        // get a new vector to work with
-        // intialised with the subset of the patterns
-        std::vector<std::string> * tmp_vec = new std::vector<std::string>();
-        tmp_vec->insert(tmp_vec->begin(), start_iter, end_iter);
-        vec_vec_patterns.push_back(tmp_vec);
-        
-        // update our counters
-        cut_start += cut_length;
-        total_pattern_size -= cut_length;
-        cut_length = CRASS_DEF_MAX_SING_PATTERNS;
+        tmpHolder.encode();
     }
-
-    findSingletonsMultiVector(inputFastq, opts, vec_vec_patterns, readsFound, mReads, mStringCheck, startTime);
+    std::string read = tmpHolder.getSeq();
     
-    // clean up
-    std::vector<std::vector<std::string> * >::iterator vv_iter = vec_vec_patterns.begin();
-    std::vector<std::vector<std::string> * >::iterator vv_last = vec_vec_patterns.end();
-    while(vv_iter != vv_last)
+    int found_position;
+    int found_length;
+    int found_pattern;
+    bool found_exact;
+    if (patternSearch.search(read, found_position, found_length, found_pattern, found_exact))
     {
-        if(*vv_iter != NULL)
+#ifdef DEBUG
+        logInfo("new read recruited: "<<tmpHolder.getHeader(), 9);
+        logInfo(tmpHolder.getSeq(), 10);
+#endif
+
+        if (found_exact)
         {
-            delete *vv_iter;
-            *vv_iter = NULL;
+            unsigned int DR_end = static_cast<unsigned int>(found_position) + static_cast<unsigned int>(found_length) - 1;
+            if(DR_end >= static_cast<unsigned int>(read.length()))
+            {
+                DR_end = static_cast<unsigned int>(read.length()) - 1;
+            }
+            tmpHolder.startStopsAdd(found_position, DR_end);
+            addReadHolder(mReads, mStringCheck, mReadStore, tmpHolder);
         }
-        vv_iter++;
+        else
+        {
+            // a repeat with errors in it is filed under the pattern it
+            // matched, otherwise every error would make a DR of its own.
+            // Everything filed under a DR must hold it at full length so
+            // the pattern is laid over the start of the hit, or over its
+            // end if it would run off the read
+            const std::string& pattern = patterns[found_pattern];
+            int DR_start = found_position;
+            int pattern_length = static_cast<int>(pattern.length());
+            if (DR_start + pattern_length > static_cast<int>(read.length()))
+            {
+                DR_start = found_position + found_length - pattern_length;
+                if (DR_start < 0)
+                {
+                    return false;
+                }
+            }
+            tmpHolder.startStopsAdd(DR_start, DR_start + pattern_length - 1);
+            addReadHolder(mReads, mStringCheck, mReadStore, tmpHolder, &pattern);
+        }
+        return true;
     }
-    
+    return false;
 }
 
-void findSingletonsMultiVector(const char *inputFastq, 
-                               const options &opts, 
-                               std::vector<std::vector<std::string> *> &patterns, 
-                               lookupTable &readsFound, 
-                               ReadMap * mReads, 
-                               StringCheck * mStringCheck,
-                               time_t& start_time)
+void findSingletons(const char *inputFastq, 
+                    unsigned int fileIndex,
+                    ReadCache * readCache,
+                    const options &opts, 
+                    std::vector<std::string> * nonRedundantPatterns, 
+                    ReadOrdinalSet &readsFound, 
+                    ReadMap * mReads, 
+                    StringCheck * mStringCheck,
+                    ReadStore * mReadStore,
+                    time_t& start_time)
 {
     //-----
-    // Find sings given a vector of vectors of patterns
+    // Search every read for all of the patterns at once. Both strands are
+    // covered as the reverse complement of every DR is in the list too.
+    // Up to opts.numDRErrors mismatches or indels are allowed in a DR.
+    // The reads come from the read cache if one is given, otherwise
+    // the input file is read again. The cache only holds reads that
+    // weren't found in the first pass, reads from the file are
+    // looked up by their position in it
     //
+	if (nonRedundantPatterns->empty())
+	{
 
+		throw crispr::runtime_exception(__FILE__,
+		                                __LINE__,
+		                                __PRETTY_FUNCTION__,
+		                                "No patterns in vector for multimatch");
+	}
 
-    // make a wumanber for each set of patterns
-    MultiSearchVector mult_search;
-
-    std::vector<std::vector<std::string> *>::iterator pats_iter = patterns.begin();
-    std::vector<std::vector<std::string> *>::iterator pats_last = patterns.end();
-    while(pats_iter != pats_last)
-    {
-
-        WuManber * search = new WuManber(); 
-        search->Initialize(*(*pats_iter));
-
-        mult_search.push_back(search);
-        pats_iter++;
-    }
-    
+    MultiPatternSearch pattern_search(*nonRedundantPatterns, opts.numDRErrors);
     
-    // now we got lots of wumanbers, search each string
-    gzFile fp = getFileHandle(inputFastq);
-    kseq_t *seq;
-    seq = kseq_init(fp);
-
-    int l;
     int log_counter = 0;
     static int read_counter = 0;
 
     time_t time_current;
     
-    MultiSearchVector::iterator wm_iter =  mult_search.begin();
-
-    while ( (l = kseq_read(seq)) >= 0 ) 
+    if (NULL != readCache)
     {
-        // seq is a read what we love
-        // search it for the patterns until found
-        if (log_counter == CRASS_DEF_READ_COUNTER_LOGGER) 
+        size_t num_cached = readCache->size();
+        for (size_t i = 0; i < num_cached; i++)
         {
-            time(&time_current);
-            double diff = difftime(time_current, start_time);
-            std::cout<<"\r["<<PACKAGE_NAME<<"_singletonFinder]: "<<"Processed "<<read_counter<<" ...";
-            std::cout<<diff<<" sec"<<std::flush;
-            log_counter = 0;
+            if (log_counter == CRASS_DEF_READ_COUNTER_LOGGER) 
+            {
+                time(&time_current);
+                double diff = difftime(time_current, start_time);
+                std::cout<<"\r["<<PACKAGE_NAME<<"_singletonFinder]: "<<"Processed "<<read_counter<<" ...";
+                std::cout<<diff<<" sec"<<std::flush;
+                log_counter = 0;
+            }
+            ReadHolder tmp_holder;
+            readCache->getRead(i, tmp_holder);
+            recruitSingleton(tmp_holder, opts, pattern_search, *nonRedundantPatterns, mReads, mStringCheck, mReadStore);
+            log_counter++;
+            read_counter++;
         }
-        
-        for ((wm_iter = mult_search.begin(), pats_iter = patterns.begin()); 
-             wm_iter != mult_search.end(); 
-             (pats_iter++, wm_iter++)) {
+    }
+    else
+    {
+        SeqInput input(inputFastq, opts);
+        kseq_t *seq = input.seq();
+
+        uint64_t read_ordinal = 0;
+        for ( ; kseq_read(seq) >= 0; read_ordinal++) 
+        {
+            // seq is a read what we love
+            // search it for the patterns until found
+            if (log_counter == CRASS_DEF_READ_COUNTER_LOGGER) 
+            {
+                time(&time_current);
+                double diff = difftime(time_current, start_time);
+                std::cout<<"\r["<<PACKAGE_NAME<<"_singletonFinder]: "<<"Processed "<<read_counter<<" ...";
+                std::cout<<diff<<" sec"<<std::flush;
+                log_counter = 0;
+            }
             
+            if (readsFound.contains(fileIndex, read_ordinal))
+            {
+                log_counter++;
+                read_counter++;
+                continue;
+            }
             ReadHolder tmp_holder;
             tmp_holder.setSequence(seq->seq.s);tmp_holder.setHeader( seq->name.s);
             if (seq->comment.s) 
@@ -722,12 +1295,6 @@ void findSingletonsMultiVector(const char *inputFastq,
             {
                 tmp_holder.setQual(seq->qual.s);
             }
-            
-            if (opts.removeHomopolymers) 
-            {
-                tmp_holder.encode();
-            }
-            std::string read = tmp_holder.getSeq();
 #if SEARCH_SINGLETON
             SearchCheckerList::iterator debug_iter = debugger->find(seq->name.s);
             if (debug_iter != debugger->end()) {
@@ -737,48 +1304,12 @@ void findSingletonsMultiVector(const char *inputFastq,
                 changeLogLevel(opts.logLevel);
             }
 #endif            
-            multiSearchData search_data = (*wm_iter)->Search(read.length(), read.c_str(), *(*pats_iter));
-
-            if (!search_data.sDataFound.empty())
-            {
-                if (readsFound.find(tmp_holder.getHeader()) == readsFound.end())
-                {
-
-#ifdef DEBUG
-                    logInfo("new read recruited: "<<tmp_holder.getHeader(), 9);
-                    logInfo(tmp_holder.getSeq(), 10);
-#endif
-
-                    unsigned int DR_end = static_cast<unsigned int>(search_data.iFoundPosition) + static_cast<unsigned int>(search_data.sDataFound.length()) - 1;
-                    if(DR_end >= static_cast<unsigned int>(read.length()))
-                    {
-                        DR_end = static_cast<unsigned int>(read.length()) - 1;
-                    }
-                    tmp_holder.startStopsAdd(search_data.iFoundPosition, DR_end);
-                    addReadHolder(mReads, mStringCheck, tmp_holder);
-                    break;
-                }
-            }
+            recruitSingleton(tmp_holder, opts, pattern_search, *nonRedundantPatterns, mReads, mStringCheck, mReadStore);
+            log_counter++;
+            read_counter++;
         }
-        log_counter++;
-        read_counter++;
     }
 
-    gzclose(fp);
-    kseq_destroy(seq); // destroy seq
-
-    // clean up
-    wm_iter =  mult_search.begin();
-    //wm_last =  mult_search.end();
-    while(wm_iter != mult_search.end())
-    {
-        if(*wm_iter != NULL)
-        {
-            delete *wm_iter;
-            *wm_iter = NULL;
-        }
-        wm_iter++;
-    }
     time(&time_current);
     double diff = difftime(time_current, start_time);
     std::cout<<"\r["<<PACKAGE_NAME<<"_singletonFinder]: "<<"Processed "<<read_counter<<" ...";
@@ -1058,6 +1589,10 @@ bool qcFoundRepeats(ReadHolder& tmp_holder, int minSpacerLength, int maxSpacerLe
 
         tmp_holder.getAllSpacerStrings(spacer_vec);
         
+        // the repeat against every spacer in one go
+        std::vector<float> repeat_similarities;
+        PatternMatcher::getStringSimilarities(repeat, spacer_vec, repeat_similarities);
+        
         std::vector<std::string>::iterator spacer_iter = spacer_vec.begin();
         std::vector<std::string>::iterator spacer_last = spacer_vec.end();
 
@@ -1066,16 +1601,8 @@ bool qcFoundRepeats(ReadHolder& tmp_holder, int minSpacerLength, int maxSpacerLe
         while (spacer_iter != spacer_last) 
         {
 
+            ave_repeat_to_spacer_difference += repeat_similarities[num_compared];
             num_compared++;
-            try {
-            	ave_repeat_to_spacer_difference += PatternMatcher::getStringSimilarity(repeat, *spacer_iter);
-            } catch (std::exception& e) {
-                std::cerr<<"Failed to compare similarity between: "<<repeat<<" : "<<*spacer_iter<<std::endl;
-                throw crispr::exception(__FILE__,
-                                        __LINE__,
-                                        __PRETTY_FUNCTION__,
-                                        e.what());
-            }
             float ss_diff = 0;
             try {
             	ss_diff += PatternMatcher::getStringSimilarity(*spacer_iter, *(spacer_iter + 1));
@@ -1311,16 +1838,22 @@ bool drHasHighlyAbundantKmers(std::string& directRepeat, float& maxFrequency)
 {
     // cut kmers from the direct repeat to test whether
     // a particular kmer is vastly over represented
-    std::map<std::string, int> kmer_counter;
-    size_t kmer_length = 3;
+    // kmers with anything other than ACGT in them are rare enough to
+    // be counted as strings
+    const unsigned int kmer_length = 3;
+    KmerArrayCounter kmer_counter(kmer_length);
+    std::map<std::string, int> other_counter;
     size_t max_index = (directRepeat.length() - kmer_length);
-    std::string kmer;
     int total_count = 0;
     try {
         for (size_t i = 0; i < max_index; i++) {
-            kmer = directRepeat.substr(i, kmer_length);
-            //std::cout << kmer << ", ";
-            addOrIncrement(kmer_counter, kmer);
+            PackedKmer kmer;
+            if (i + kmer_length <= directRepeat.length() && packKmer(directRepeat, i, kmer_length, kmer)) {
+                kmer_counter.add(kmer);
+            } else {
+                std::string other_kmer = directRepeat.substr(i, kmer_length);
+                addOrIncrement(other_counter, other_kmer);
+            }
             total_count++;
         }
     } catch (std::exception& e) {
@@ -1329,18 +1862,14 @@ bool drHasHighlyAbundantKmers(std::string& directRepeat, float& maxFrequency)
                                         __PRETTY_FUNCTION__, 
                                         e.what());
     }
-    //std::cout << std::endl;
     
+    int max_count = kmer_counter.maxCount();
     std::map<std::string, int>::iterator iter;
-    //std::cout << directRepeat << std::endl;
-    int max_count = 0;
-    for (iter = kmer_counter.begin(); iter != kmer_counter.end(); ++iter) {
+    for (iter = other_counter.begin(); iter != other_counter.end(); ++iter) {
         if (iter->second > max_count) {
             max_count = iter->second;
         }
-        //std::cout << "{" << iter->first << ", " << iter->second << ", " << (float(iter->second)/float(total_count)) << "}, ";
     }
-    //std::cout << std::endl;
     maxFrequency = static_cast<float>(max_count)/static_cast<float>(total_count);
     if (maxFrequency > CRASS_DEF_KMER_MAX_ABUNDANCE_CUTOFF) {
         return true;
@@ -1351,13 +1880,23 @@ bool drHasHighlyAbundantKmers(std::string& directRepeat, float& maxFrequency)
 
 void addReadHolder(ReadMap * mReads, 
                    StringCheck * mStringCheck, 
-                   ReadHolder& tmpReadholder)
+                   ReadStore * mReadStore,
+                   ReadHolder& tmpReadholder,
+                   const std::string * knownRepeat)
 {
+    //-----
+    // File the read under its DR. knownRepeat overrides the DR cut from
+    // the read
+    //
 
-    ReadHolder * candidate = new ReadHolder(tmpReadholder);
+    ReadHolder * candidate = new ReadHolder(tmpReadholder, mReadStore);
     std::string dr_lowlexi;
 	try {
-		dr_lowlexi = candidate->DRLowLexi();
+		if (NULL != knownRepeat) {
+			dr_lowlexi = candidate->DRLowLexi(*knownRepeat);
+		} else {
+			dr_lowlexi = candidate->DRLowLexi();
+		}
 	} catch(crispr::exception& e) {
 		std::cerr<<e.what()<<std::endl;
 		throw crispr::exception(__FILE__,
@@ -1372,7 +1911,6 @@ void addReadHolder(ReadMap * mReads,
     {
         // new guy
         st = mStringCheck->addString(dr_lowlexi);
-        (*mReads)[st] = new ReadList();
     }
 
 #ifdef DEBUG
@@ -1391,6 +1929,6 @@ void addReadHolder(ReadMap * mReads,
     }
 #endif
     
-    (*mReads)[st]->push_back(candidate);
+    (*mReads)[st].push_back(candidate);
 }
 
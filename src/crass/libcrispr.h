@@ -48,10 +48,11 @@
 
 // local includes
 #include "crassDefines.h"
-#include "WuManber.h"
 #include "PatternMatcher.h"
 #include "kseq.h"
 #include "ReadHolder.h"
+#include "ReadCache.h"
+#include "ReadOrdinalSet.h"
 #include "SeqUtils.h"
 #include "StringCheck.h"
 #include "Types.h"
@@ -63,9 +64,6 @@
 
 
 
-typedef std::vector<WuManber*> MultiSearchVector;
-typedef WuManber::DataFound multiSearchData;
-
 enum READ_TYPE {
     LONG_READ,
     SHORT_READ
@@ -78,43 +76,52 @@ enum side{rightSide, leftSide};
 // search functions
 //**************************************
 int decideWhichSearch(const char *inputFile, 
+                      unsigned int fileIndex,
                       const options &opts, 
                       ReadMap * mReads, 
                       StringCheck * mStringCheck, 
+                      ReadStore * mReadStore,
                       lookupTable& patternsHash, 
-                      lookupTable& readsFound,
+                      ReadOrdinalSet& readsFound,
+                      ReadCache * readCache,
                       time_t& startTime);
 
-int longReadSearch(ReadHolder& seq, 
-                   const options &opts, 
-                   ReadMap * mReads, 
-                   StringCheck * mStringCheck, 
-                   lookupTable &patterns_hash, 
-                   lookupTable &readsFound);
+// the searches only touch the read they are given. If the read holds
+// a CRISPR they return true and set the DR to look for in the singleton search
+bool searchRead(ReadHolder& seq, 
+                const options &opts, 
+                std::string& foundRepeat);
 
-int shortReadSearch(ReadHolder&  seq, 
+bool longReadSearch(ReadHolder& seq, 
                     const options &opts, 
-                    ReadMap * mReads, 
-                    StringCheck * mStringCheck, 
-                    lookupTable &patterns_hash, 
-                    lookupTable &readsFound);
-
+                    std::string& foundRepeat);
+
+bool shortReadSearch(ReadHolder&  seq, 
+                     const options &opts, 
+                     std::string& foundRepeat);
+
+void recordFoundRead(ReadHolder& seq, 
+                     std::string& foundRepeat, 
+                     ReadMap * mReads, 
+                     StringCheck * mStringCheck, 
+                     ReadStore * mReadStore,
+                     lookupTable &patterns_hash, 
+                     ReadOrdinalSet &readsFound,
+                     unsigned int fileIndex,
+                     uint64_t readOrdinal);
+
+// if readCache is not NULL the reads are taken from it and inputFastq is ignored
 void findSingletons(const char *inputFastq, 
+                    unsigned int fileIndex,
+                    ReadCache * readCache,
                     const options &opts, 
                     std::vector<std::string> * nonRedundantPatterns, 
-                    lookupTable &readsFound, 
+                    ReadOrdinalSet &readsFound, 
                     ReadMap * mReads, 
                     StringCheck * mStringCheck,
+                    ReadStore * mReadStore,
                     time_t& startTime);
 
-void findSingletonsMultiVector(const char *inputFastq, 
-                               const options &opts, 
-                               std::vector<std::vector<std::string> *> &patterns, 
-                               lookupTable &readsFound, 
-                               ReadMap * mReads, 
-                               StringCheck * mStringCheck,
-                               time_t& startTime);
-
 int scanRight(ReadHolder& tmp_holder, 
               std::string& pattern, 
               unsigned int minSpacerLength, 
@@ -135,7 +142,9 @@ bool drHasHighlyAbundantKmers(std::string& directRepeat);
 
 void addReadHolder(ReadMap * mReads, 
                    StringCheck * mStringCheck, 
-                   ReadHolder& tmp_holder);
+                   ReadStore * mReadStore,
+                   ReadHolder& tmp_holder,
+                   const std::string * knownRepeat = NULL);
 
 //
 //
@@ -0,0 +1,250 @@
+/*
+ *  testDRClusterer.cpp is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Checks the clusters against every pair of variants compared the slow
+ *  way, and that one big family of variants clusters in close to linear
+ *  time. Run by make check.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+// system includes
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <sys/time.h>
+
+// local includes
+#include "DRClusterer.h"
+
+#define TEST_KMER_LENGTH            11
+#define TEST_MIN_SHARED             6
+
+// the same numbers every time on every platform
+static uint32_t nextRandom(uint32_t& state)
+{
+    state = state * 1103515245 + 12345;
+    return (state >> 16) & 0x7fff;
+}
+
+static double secondsNow(void)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return now.tv_sec + now.tv_usec / 1000000.0;
+}
+
+//-----
+// variants of a few DRs, each with minMutations to maxMutations point
+// mutations
+//
+static void makeVariants(int numVariants,
+                         int numFamilies,
+                         int minMutations,
+                         int maxMutations,
+                         uint32_t seed,
+                         std::vector<std::string>& variants)
+{
+    const char * bases = "ACGT";
+    std::vector<std::string> families;
+    for (int i = 0; i < numFamilies; i++)
+    {
+        std::string dr;
+        for (int j = 0; j < 32; j++)
+        {
+            dr += bases[nextRandom(seed) % 4];
+        }
+        families.push_back(dr);
+    }
+    variants.clear();
+    for (int i = 0; i < numVariants; i++)
+    {
+        std::string variant = families[nextRandom(seed) % numFamilies];
+        int num_mutations = minMutations + static_cast<int>(nextRandom(seed) % (maxMutations - minMutations + 1));
+        for (int j = 0; j < num_mutations; j++)
+        {
+            size_t position = nextRandom(seed) % variant.length();
+            char base;
+            do
+            {
+                base = bases[nextRandom(seed) % 4];
+            } while (base == variant[position]);
+            variant[position] = base;
+        }
+        variants.push_back(variant);
+    }
+}
+
+//-----
+// Join every pair of variants that share enough kmers, the clusters come
+// out in the same order as DRClusterer makes them
+//
+static void clusterSlowly(const std::vector<std::string>& variants,
+                          std::vector<std::vector<int> >& clusters)
+{
+    int num_variants = static_cast<int>(variants.size());
+    std::vector<std::set<PackedKmer> > kmers(num_variants);
+    for (int i = 0; i < num_variants; i++)
+    {
+        RollingKmer rolling_kmer(TEST_KMER_LENGTH);
+        for (size_t j = 0; j < variants[i].length(); j++)
+        {
+            if (rolling_kmer.push(variants[i][j]))
+            {
+                kmers[i].insert(rolling_kmer.canonical());
+            }
+        }
+    }
+    std::vector<int> root(num_variants);
+    for (int i = 0; i < num_variants; i++)
+    {
+        root[i] = i;
+        for (int j = 0; j < i; j++)
+        {
+            int shared = 0;
+            std::set<PackedKmer>::iterator kmer_iter;
+            for (kmer_iter = kmers[i].begin(); kmer_iter != kmers[i].end(); kmer_iter++)
+            {
+                shared += static_cast<int>(kmers[j].count(*kmer_iter));
+            }
+            if (shared >= TEST_MIN_SHARED && root[i] != root[j])
+            {
+                int old_root = (root[i] > root[j]) ? root[i] : root[j];
+                int new_root = (root[i] > root[j]) ? root[j] : root[i];
+                for (int k = 0; k <= i; k++)
+                {
+                    if (root[k] == old_root)
+                    {
+                        root[k] = new_root;
+                    }
+                }
+            }
+        }
+    }
+    clusters.clear();
+    std::vector<int> cluster_of_root(num_variants, -1);
+    for (int i = 0; i < num_variants; i++)
+    {
+        if (-1 == cluster_of_root[root[i]])
+        {
+            cluster_of_root[root[i]] = static_cast<int>(clusters.size());
+            clusters.push_back(std::vector<int>());
+        }
+        clusters[cluster_of_root[root[i]]].push_back(i);
+    }
+}
+
+static bool testAgainstPairs(int numThreads)
+{
+    bool passed = true;
+    for (uint32_t seed = 1; seed <= 20; seed++)
+    {
+        std::vector<std::string> variants;
+        makeVariants(400, 1 + seed % 4, 0, 6, seed, variants);
+
+        std::vector<std::vector<int> > expected;
+        clusterSlowly(variants, expected);
+
+        std::vector<std::vector<int> > clusters;
+        std::vector<KmerHashMap<int> > kmer_counts;
+        DRClusterer clusterer(TEST_KMER_LENGTH, TEST_MIN_SHARED, numThreads);
+        clusterer.cluster(variants, clusters, kmer_counts);
+        if (clusters != expected)
+        {
+            std::cerr<<"FAIL: seed "<<seed<<" on "<<numThreads<<" threads made "<<clusters.size()
+                     <<" clusters, comparing every pair makes "<<expected.size()<<std::endl;
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+static double timeOneFamily(int numVariants, size_t& biggest)
+{
+    std::vector<std::string> variants;
+    makeVariants(numVariants, 1, 2, 2, 7, variants);
+    std::vector<std::vector<int> > clusters;
+    std::vector<KmerHashMap<int> > kmer_counts;
+    DRClusterer clusterer(TEST_KMER_LENGTH, TEST_MIN_SHARED, 1);
+    double start = secondsNow();
+    clusterer.cluster(variants, clusters, kmer_counts);
+    double taken = secondsNow() - start;
+    biggest = 0;
+    for (size_t i = 0; i < clusters.size(); i++)
+    {
+        if (clusters[i].size() > biggest)
+        {
+            biggest = clusters[i].size();
+        }
+    }
+    return taken;
+}
+
+static bool testOneFamilyScales(void)
+{
+    //-----
+    // 32 times the variants may take about 32 times as long. Comparing
+    // every variant with the rest of its family takes about 1000 times
+    // as long, so a quarter of that is well clear of both
+    //
+    int small_size = 2000;
+    int large_size = 32 * small_size;
+    size_t biggest;
+    double small_time = timeOneFamily(small_size, biggest);
+    for (int i = 0; i < 2; i++)
+    {
+        double again = timeOneFamily(small_size, biggest);
+        if (again < small_time)
+        {
+            small_time = again;
+        }
+    }
+    double large_time = timeOneFamily(large_size, biggest);
+    std::cout<<small_size<<" variants: "<<small_time<<" sec, "<<large_size<<" variants: "<<large_time<<" sec"<<std::endl;
+    if (biggest < static_cast<size_t>(large_size) * 9 / 10)
+    {
+        std::cerr<<"FAIL: only "<<biggest<<" of "<<large_size<<" variants are in the biggest cluster"<<std::endl;
+        return false;
+    }
+    if (large_time > 256 * small_time && large_time > 1.0)
+    {
+        std::cerr<<"FAIL: clustering one family does not scale"<<std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(void)
+{
+    bool passed = testAgainstPairs(1);
+    passed = testAgainstPairs(4) && passed;
+    passed = testOneFamilyScales() && passed;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+/*
+ *  testStringCheck.cpp is part of the CRisprASSembler project
+ *
+ *  Copyright 2011 - 2013 Connor Skennerton & Michael Imelfort. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Checks how ShardedStringCheck packs the shard into its tokens and that
+ *  threads adding and looking up the same strings at once all agree on
+ *  them. Run by make check.
+ *
+ *                     A B R A K A D A B R A
+ *                      A B R A K A D A B R
+ *                       A B R A K A D A B
+ *                        A B R A K A D A
+ *                         A B R A K A D
+ *                          A B R A K A
+ *                           A B R A K
+ *                            A B R A
+ *                             A B R
+ *                              A B
+ *                               A
+ */
+
+// system includes
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// local includes
+#include "StringCheck.h"
+#include "ThreadPool.h"
+
+#define TEST_NUM_STRINGS            20000
+#define TEST_NUM_THREADS            4
+
+static std::string testString(int i)
+{
+    std::stringstream ss;
+    ss << "ACGT" << i << "TTGCA";
+    return ss.str();
+}
+
+static bool testTokens(void)
+{
+    //-----
+    // The shard is the token modulo the number of shards and the rest is
+    // the token inside the shard. Shards number from 2 the way a
+    // StringCheck does, in the order strings reach them
+    //
+    bool passed = true;
+    ShardedStringCheck strings;
+    std::vector<int> next_in_shard(CRASS_DEF_STRING_SHARDS, 2);
+    for (int i = 0; i < TEST_NUM_STRINGS; i++)
+    {
+        std::string str = testString(i);
+        if (0 != strings.getToken(str))
+        {
+            std::cerr<<"FAIL: found "<<str<<" before it was added"<<std::endl;
+            passed = false;
+        }
+        StringToken token = strings.addString(str);
+        int shard = token % CRASS_DEF_STRING_SHARDS;
+        if (token / CRASS_DEF_STRING_SHARDS != next_in_shard[shard])
+        {
+            std::cerr<<"FAIL: "<<str<<" is token "<<token / CRASS_DEF_STRING_SHARDS<<" in shard "<<shard
+                     <<", expected "<<next_in_shard[shard]<<std::endl;
+            passed = false;
+        }
+        next_in_shard[shard]++;
+        if (strings.getToken(str) != token || strings.getOrAddToken(str) != token || strings.getString(token) != str)
+        {
+            std::cerr<<"FAIL: "<<str<<" does not come back as token "<<token<<std::endl;
+            passed = false;
+        }
+    }
+
+    // every shard gets used
+    for (int i = 0; i < CRASS_DEF_STRING_SHARDS; i++)
+    {
+        if (2 == next_in_shard[i])
+        {
+            std::cerr<<"FAIL: shard "<<i<<" is empty"<<std::endl;
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+//-----
+// Every thread gets or adds every string, each starting at a different
+// place so the threads race for the same strings
+//
+class AddingTask : public ThreadTask
+{
+    public:
+        AddingTask(ShardedStringCheck * strings) : 
+            mStrings(strings), 
+            mTokens(TEST_NUM_THREADS, std::vector<StringToken>(TEST_NUM_STRINGS, 0))
+        {}
+
+        void run(int threadNumber)
+        {
+            for (int j = 0; j < TEST_NUM_STRINGS; j++)
+            {
+                int i = (j + threadNumber * TEST_NUM_STRINGS / TEST_NUM_THREADS) % TEST_NUM_STRINGS;
+                std::string str = testString(i);
+                StringToken token = mStrings->getOrAddToken(str);
+                if (mStrings->getToken(str) != token || mStrings->getString(token) != str)
+                {
+                    token = 0;
+                }
+                mTokens[threadNumber][i] = token;
+            }
+        }
+
+        ShardedStringCheck * mStrings;
+        std::vector<std::vector<StringToken> > mTokens;
+};
+
+static bool testThreads(void)
+{
+    bool passed = true;
+    ShardedStringCheck strings;
+    AddingTask task(&strings);
+    ThreadPool pool(TEST_NUM_THREADS);
+    pool.run(&task);
+
+    std::vector<StringToken> seen;
+    for (int i = 0; i < TEST_NUM_STRINGS; i++)
+    {
+        StringToken token = task.mTokens[0][i];
+        for (int j = 0; j < TEST_NUM_THREADS; j++)
+        {
+            if (0 == task.mTokens[j][i] || task.mTokens[j][i] != token)
+            {
+                std::cerr<<"FAIL: thread "<<j<<" got token "<<task.mTokens[j][i]<<" for "<<testString(i)
+                         <<", thread 0 got "<<token<<std::endl;
+                passed = false;
+            }
+        }
+        seen.push_back(token);
+    }
+
+    // one token per string
+    std::sort(seen.begin(), seen.end());
+    if (std::unique(seen.begin(), seen.end()) != seen.end())
+    {
+        std::cerr<<"FAIL: two strings share a token"<<std::endl;
+        passed = false;
+    }
+    return passed;
+}
+
+int main(void)
+{
+    bool passed = testTokens();
+    passed = testThreads() && passed;
+    return passed ? 0 : 1;
+}